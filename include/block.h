@@ -7,33 +7,66 @@
 #include <QString>
 #include <QList>
 #include <QColor>
-#include <QGraphicsItem>
 #include <QChildEvent>
 #include <QTimer>
 #include <QIODevice>
+#include <QHash>
+#include <QVector>
+#include <QStringList>
 
+#include <blockdata.h>
+#include <blockmemory.h>
 #include <blockparameter.h>
 #include <blockinput.h>
 #include <blockoutput.h>
-#include <graphicitemblock.h>
 
 namespace libblockdia {
 
 // forward declarations
-class GraphicItemBlock;
 class BlockParameter;
 class BlockInput;
 class BlockOutput;
+class BlockJournal;
+class Block;
+
+/**
+ * @brief A new value for a parameter of a block (see Block::applyParameterValues()).
+ * The parameter is either referenced directly or by its name.
+ */
+struct LIBBLOCKDIACORESHARED_EXPORT BlockParameterEdit
+{
+    BlockParameterEdit();
+    BlockParameterEdit(Block *block, const QString &parameterName, const BlockParameterValue &value);
+    BlockParameterEdit(Block *block, BlockParameter *parameter, const BlockParameterValue &value);
+
+    Block *block;
+    BlockParameter *parameter;      ///< looked up by parameterName if null
+    QString parameterName;
+    BlockParameterValue value;
+};
 
 /**
  * @brief Data storage class for a block representation.
  */
-class LIBBLOCKDIASHARED_EXPORT Block : public QObject
+class LIBBLOCKDIACORESHARED_EXPORT Block : public QObject
 {
     Q_OBJECT
 
+    // the journal restores children at their original position
+    friend class BlockJournal;
+
 public:
 
+    /**
+     * @brief Defines how a block definition is parsed.
+     *
+     * Full parses the complete block definition immediately.
+     * Lazy only reads the header elements (TypeName, TypeId, Color)
+     * and remembers the positions of the Parameters, Inputs and Outputs sections.
+     * These sections are parsed on the first access (eg. getParameters()).
+     */
+    enum struct ParseMode {Full, Lazy};
+
     /**
      * @details Construct a BDBlock
      * @param parent The Qt parent pointer.
@@ -98,7 +131,7 @@ public:
     void setInstanceName(const QString &name);
 
     /**
-     * @return This is used as background color for the BDGraphicItemBlock.
+     * @return This is used as background color for the GraphicItemBlock.
      */
     QColor color();
 
@@ -143,11 +176,6 @@ public:
      */
     BlockOutput *getOutput(const QString name);
 
-    /**
-     * @return The corresponding QGraphicsItem object
-     */
-    QGraphicsItem *getGraphicsItem();
-
     /**
      * @details Parsing a block definition
      *
@@ -159,18 +187,155 @@ public:
      * In that case the existing block is updated.
      * (Existing elements will not be deleted)
      *
+     * In ParseMode::Lazy the device is read completely,
+     * but only the header elements are parsed.
+     * Parameters, inputs and outputs are created on first access.
+     *
+     * @param dev The device to read the data from (eg. QFile)
+     * @param block A already existing block object
+     * @param mode Parse the complete definition or only the header
+     * @return A pointer to the block or Q_NULLPTR
+     */
+    static Block *parseBlockDef(QIODevice *dev, Block *block = Q_NULLPTR, ParseMode mode = ParseMode::Full);
+
+    /**
+     * @details Export a block definition into an xml structure.
+     * The writer of the current thread is reused (see BlockDefWriter::threadWriter()).
+     * @param dev The device to write the data to (eg. QFile)
+     * @param autoFormatting True for indented output, false for compact output
+     * @return True on success.
+     */
+    bool exportBlockDef(QIODevice *dev, bool autoFormatting = true);
+
+    /**
+     * @details Parsing a block definition in CBOR format (see BlockData::exportBlockDefCbor()).
+     *
+     * The block parameter can be set to an existing block.
+     * In that case the existing block is updated.
+     * (Existing elements will not be deleted)
+     *
      * @param dev The device to read the data from (eg. QFile)
      * @param block A already existing block object
      * @return A pointer to the block or Q_NULLPTR
      */
-    static Block *parseBlockDef(QIODevice *dev, Block *block = Q_NULLPTR);
+    static Block *parseBlockDefCbor(QIODevice *dev, Block *block = Q_NULLPTR);
 
     /**
-     * @details Export a block definition into an xml structure
+     * @details Export a block definition in CBOR format.
+     * The exported data carries the same information as exportBlockDef().
      * @param dev The device to write the data to (eg. QFile)
      * @return True on success.
      */
-    bool exportBlockDef(QIODevice *dev);
+    bool exportBlockDefCbor(QIODevice *dev);
+
+    /**
+     * @details Creating a block from plain data
+     *
+     * The plain data can be created in any thread (eg. with BlockData::parseBlockDef()),
+     * while this method must be called in the thread where the block shall live.
+     *
+     * The block parameter can be set to an existing block.
+     * In that case the existing block is updated.
+     * (Existing elements will not be deleted)
+     *
+     * @param data The plain block data
+     * @param block A already existing block object
+     * @return A pointer to the block
+     */
+    static Block *importBlockData(const BlockData &data, Block *block = Q_NULLPTR);
+
+    /**
+     * @details Updating the block to match plain data with a minimal set of changes.
+     *
+     * Only elements that differ are changed.
+     * Parameters are identified by their name, inputs and outputs by their position.
+     * Parameters, inputs and outputs that do not exist in the data are deleted.
+     * The graphic item is updated once (not for every change)
+     * and signalSomethingChanged() is not emitted,
+     * because the block is synchronized and not edited.
+     *
+     * @param data The plain block data
+     * @return True if something has been changed
+     */
+    bool applyBlockData(const BlockData &data);
+
+    /**
+     * @details Exporting the block into plain data (same as snapshot()).
+     * @return The plain data of the block
+     */
+    BlockData exportBlockData();
+
+    /**
+     * @details A consistent, immutable view of the block.
+     *
+     * The snapshot is a value that can be passed to and read from any thread
+     * (eg. for validation or BlockSaver), while the block is edited further.
+     * It is cached until the block changes, so repeated calls are cheap (O(1)).
+     * After a change only the changed parts are created again:
+     * unchanged parameters hand out their cached data
+     * and all strings and lists are implicitly shared (copy-on-write).
+     *
+     * @return The snapshot of the block
+     */
+    BlockData snapshot();
+
+    /**
+     * @details Serializing the block into a canonical binary form (see BlockData::canonicalSerialization()).
+     * @return The canonical serialization
+     */
+    QByteArray canonicalSerialization();
+
+    /**
+     * @details A hash over the content of the block (see BlockData::contentHash()).
+     * The hash is maintained incrementally:
+     * the hashes of parameters are cached within the parameters
+     * and only changed parts are hashed again.
+     * Two blocks with equal content hashes have equal content.
+     * @return The content hash
+     */
+    QByteArray contentHash();
+
+    /**
+     * @details A Merkle-style hash over several blocks (eg. all blocks of a process).
+     * Only the cached hashes of the blocks are combined.
+     * @param blocks The blocks in order
+     * @return The combined content hash
+     */
+    static QByteArray contentHash(const QList<Block *> &blocks);
+
+    /**
+     * @details Accounting the memory of the block and all its parameters, inputs and outputs (see BlockMemory).
+     * Sections of lazy parsed blocks are not materialized, their source is accounted as cache.
+     * @param usage The accounting to add the memory to
+     */
+    void addMemoryUsage(BlockMemory *usage);
+
+    /**
+     * @return The memory used by the block
+     */
+    BlockMemory memoryUsage();
+
+    /**
+     * @details The memory used by several blocks (eg. a loaded library),
+     * data that is shared between the blocks is counted only once.
+     * @param blocks The blocks
+     * @return The memory used by the blocks
+     */
+    static BlockMemory memoryUsage(const QList<Block *> &blocks);
+
+    /**
+     * @details Setting the values of many parameters of many blocks at once (eg. values pushed by a backend).
+     * All edits are validated first, integer values are clipped to the parameter range in one pass.
+     * The values are set while the signals of the affected blocks and parameters are blocked,
+     * afterwards every block that has been changed emits signalParametersChanged() and signalSomethingChanged() once
+     * (eg. a BlockJournal records one step and a BlockExpressionGraph updates derived parameters once).
+     * Edits that cannot be applied (unknown parameter, wrong value type) are skipped,
+     * the other edits are applied in order.
+     * @param edits The new parameter values
+     * @param errors If not null, a message for every edit that could not be applied exactly is appended
+     * @return The number of edits that changed a parameter value
+     */
+    static int applyParameterValues(const QVector<BlockParameterEdit> &edits, QStringList *errors = Q_NULLPTR);
 
 
 
@@ -182,11 +347,35 @@ signals:
      */
     void signalSomethingChanged(libblockdia::Block *block);
 
+    /**
+     * @details Is emitted when anything that is shown by a view has been changed
+     * (header, parameters, inputs or outputs).
+     * Graphic items connect to this signal to update themselves.
+     * @param block A reference to the changed block.
+     */
+    void signalDataChanged(libblockdia::Block *block);
+
+    /**
+     * @details Is emitted by applyParameterValues() for all parameters of the block it has changed.
+     * The parameters do not emit somethingHasChanged() for these changes,
+     * observers of parameters (eg. BlockJournal, BlockExpressionGraph) handle them at once.
+     * @param block A reference to the changed block.
+     * @param parameters The changed parameters (each of them once)
+     */
+    void signalParametersChanged(libblockdia::Block *block, const QList<libblockdia::BlockParameter *> &parameters);
+
 public slots:
 
 private:
+
+    /**
+     * @brief Sections of a block definition that can be parsed lazy.
+     */
+    enum LazySection {LazyParameters = 0, LazyInputs, LazyOutputs, LazySectionCount};
+
     void childEvent(QChildEvent *e);
-    static void parseBlockDefVersion1(QXmlStreamReader *xml, Block *block = Q_NULLPTR);
+    static void parseBlockDefVersion1(QXmlStreamReader *xml, Block *block = Q_NULLPTR, ParseMode mode = ParseMode::Full);
+    void materializeSection(LazySection section);
 
     QString _TypeId;
     QString _TypeName;
@@ -196,11 +385,20 @@ private:
     QList<BlockParameter *> parametersList;
     QList<BlockInput *> inputsList;
     QList<BlockOutput *> outputsList;
-    GraphicItemBlock *giBlock;
+    QByteArray cachedContentHash;
+    BlockData cachedSnapshot;
+    bool isSnapshotValid;
+
+    // lazy parsing: the source of the block definition
+    // and the character offset/length of every not yet parsed section
+    QString lazySource;
+    int lazySectionOffset[LazySectionCount];
+    int lazySectionLength[LazySectionCount];
 
 private slots:
-    void slotUpdateGraphicItem();
+    void slotDataChanged();
     void slotUpdateChildObjects();
+    void slotInvalidateCache();
 };
 
 } // namespace bd
@@ -0,0 +1,192 @@
+#ifndef BLOCKDATA_H
+#define BLOCKDATA_H
+
+#include "libglobals.h"
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QColor>
+#include <QIODevice>
+#include <QByteArray>
+#include <QXmlStreamReader>
+
+namespace libblockdia {
+
+/**
+ * @brief Plain data of a parameter.
+ *
+ * This is a value type without any QObject relation.
+ * It can be created, copied and read from any thread.
+ * Fields that are not used by the parameter type are ignored.
+ */
+struct LIBBLOCKDIACORESHARED_EXPORT BlockParameterData
+{
+    /**
+     * @details Constructing an empty parameter
+     */
+    BlockParameterData();
+
+    QString type;           ///< the parameter type as used in block definitions ("int", "str", "enum", "array")
+    QString name;
+    bool isPublic;
+    QString defaultValue;
+    QString value;          ///< a null string if no value is defined (block definitions do not store values)
+    int minimum;            ///< only for "int"
+    int maximum;            ///< only for "int"
+    QStringList enumItems;  ///< only for "enum"
+    QString elementType;    ///< only for "array" ("int" or "double", values are base64 encoded, see BlockParameterArray)
+    double elementMinimum;  ///< only for "array"
+    double elementMaximum;  ///< only for "array"
+    QString expression;     ///< the value is derived from other parameters (see BlockExpression), empty if the value is set directly
+
+    /**
+     * @return True if all fields are equal
+     */
+    bool operator==(const BlockParameterData &other) const;
+
+    /**
+     * @return True if any field differs
+     */
+    bool operator!=(const BlockParameterData &other) const;
+
+    /**
+     * @details The value as shown to the user (eg. in block thumbnails).
+     * This is the value itself, except for arrays (eg. "[1024 x double]").
+     * @return The value for display
+     */
+    QString displayValue() const;
+
+    /**
+     * @details The type is lowercased, integer values are normalized (eg. " 007" becomes "7")
+     * and fields that are not used by the parameter type are reset.
+     * @return A normalized copy of the parameter
+     */
+    BlockParameterData normalized() const;
+
+    /**
+     * @details Serializing the parameter into a canonical binary form.
+     * The fields of the normalized() parameter are written in a fixed order,
+     * fields that are not used by the parameter type are skipped.
+     * Equal parameters always result in equal byte arrays.
+     * @return The canonical serialization
+     */
+    QByteArray canonicalSerialization() const;
+
+    /**
+     * @return A hash over the canonical serialization
+     */
+    QByteArray contentHash() const;
+
+    /**
+     * @details Parsing a parameter definition (the current "Parameter" element of a block definition).
+     * This is the only XML parser of parameters, Block objects create their parameters from its result.
+     * In every case the XML parser is set to after the current element.
+     * @param xml The current xml parser
+     * @param param The data object where the parameter is stored to
+     * @return False if the element is not a valid parameter (no or unknown type)
+     */
+    static bool parseParamDef(QXmlStreamReader *xml, BlockParameterData *param);
+};
+
+/**
+ * @brief Plain data of a Block.
+ *
+ * This is a value type without any QObject relation.
+ * It is used to parse block definitions outside of the GUI thread.
+ * Block objects can be created from it with Block::importBlockData().
+ */
+struct LIBBLOCKDIACORESHARED_EXPORT BlockData
+{
+    /**
+     * @details Constructing empty block data
+     */
+    BlockData();
+
+    QString typeId;
+    QString typeName;
+    QString instanceId;
+    QString instanceName;
+    QColor color;
+    QList<BlockParameterData> parameters;
+    QStringList inputs;
+    QStringList outputs;
+
+    /**
+     * @details Parsing a block definition into plain data.
+     * This is thread-safe, no QObjects are created.
+     * @param dev The device to read the data from (eg. QFile)
+     * @param data The data object where the block definition is stored to
+     * @return True if a valid block definition has been found
+     */
+    static bool parseBlockDef(QIODevice *dev, BlockData *data);
+
+    /**
+     * @details Parsing a block definition in CBOR format into plain data.
+     * The CBOR format carries the same information as the XML block definition.
+     * @param dev The device to read the data from (eg. QFile)
+     * @param data The data object where the block definition is stored to
+     * @return True if a valid block definition has been found
+     */
+    static bool parseBlockDefCbor(QIODevice *dev, BlockData *data);
+
+    /**
+     * @details Exporting a block definition in CBOR format.
+     *
+     * The CBOR block definition is a map with the same structure as the XML block definition:
+     * {"BlockDef": 1, "TypeName": .., "TypeId": .., "Color": ..,
+     *  "Parameters": [{"type": .., "name": .., "isPublic": .., "default": .., "expression": .., "Min": .., "Max": .., "EnumItems": [..],
+     *                   "ElementType": .., "ElementMin": .., "ElementMax": ..}, ..],
+     *  "Inputs": [name, ..], "Outputs": [name, ..]}
+     *
+     * @param dev The device to write the data to (eg. QFile)
+     * @return True if the whole definition has been written to the device
+     */
+    bool exportBlockDefCbor(QIODevice *dev) const;
+
+    /**
+     * @return A copy of the block data with all parameters normalized (see BlockParameterData::normalized())
+     */
+    BlockData normalized() const;
+
+    /**
+     * @details Serializing the block into a canonical binary form.
+     * The header, parameters, inputs and outputs are written in a fixed order
+     * and all values are normalized (see BlockParameterData::canonicalSerialization()).
+     * Equal blocks always result in equal byte arrays.
+     * The order of parameters, inputs and outputs is part of the block and is kept.
+     * @return The canonical serialization
+     */
+    QByteArray canonicalSerialization() const;
+
+    /**
+     * @details A hash over the content of the block.
+     * The hash is built Merkle-style over the canonical header, inputs and outputs
+     * and the hashes of all parameters (see combineContentHash()).
+     * @return The content hash
+     */
+    QByteArray contentHash() const;
+
+    /**
+     * @details Combining the block content hash from already known parameter hashes.
+     * This allows to maintain the hash incrementally (only changed parameters must be hashed again).
+     * @param data The block data (the parameters are ignored)
+     * @param parameterHashes The hashes of all parameters of the block in order
+     * @return The content hash of the block
+     */
+    static QByteArray combineContentHash(const BlockData &data, const QList<QByteArray> &parameterHashes);
+
+    /**
+     * @details Combining the content hashes of several blocks (eg. of a process) into one hash.
+     * @param hashes The content hashes of the blocks in order
+     * @return The combined hash
+     */
+    static QByteArray combineContentHashes(const QList<QByteArray> &hashes);
+
+private:
+    static void parseBlockDefVersion1(QXmlStreamReader *xml, BlockData *data);
+};
+
+} // namespace libblockdia
+
+#endif // BLOCKDATA_H
@@ -0,0 +1,100 @@
+#ifndef BLOCKDEFWRITER_H
+#define BLOCKDEFWRITER_H
+
+#include "libglobals.h"
+
+#include <QString>
+#include <QByteArray>
+#include <QIODevice>
+
+#include <blockdata.h>
+
+namespace libblockdia {
+
+/**
+ * @brief Writing block definitions (XML) with a minimum of allocations.
+ *
+ * The XML is encoded (UTF-8) directly into an internal buffer,
+ * that is reused for every written block definition.
+ * Numbers and colors are formatted without temporary strings.
+ * A single writer can be used to export thousands of block definitions
+ * without allocating memory after the buffer has grown to its working size.
+ *
+ * The output is identical to the output of a QXmlStreamWriter,
+ * either with auto formatting (indented) or compact (no whitespace between elements).
+ *
+ * A BlockDefWriter object is not thread-safe,
+ * but it works on plain BlockData and can be used in any thread.
+ */
+class LIBBLOCKDIACORESHARED_EXPORT BlockDefWriter
+{
+public:
+
+    /**
+     * @details Constructing a writer with auto formatting enabled.
+     */
+    BlockDefWriter();
+
+    /**
+     * @details A writer owned by the current thread.
+     * The writer (and its buffer) lives until the thread ends,
+     * so repeated exports in one thread do not allocate a new buffer.
+     * The formatting is not reset, set it before every use.
+     * @return The writer of the current thread
+     */
+    static BlockDefWriter *threadWriter();
+
+    /**
+     * @param enable True for indented output, false for compact output
+     */
+    void setAutoFormatting(bool enable);
+
+    /**
+     * @return True if the output is indented
+     */
+    bool autoFormatting();
+
+    /**
+     * @details Writing a block definition into the internal buffer.
+     * The previous content of the buffer is discarded.
+     * @param data The block data to write
+     * @return True on success, otherwise see errorString()
+     */
+    bool write(const BlockData &data);
+
+    /**
+     * @details Writing a block definition into a device.
+     * @param data The block data to write
+     * @param dev The device to write the data to (eg. QFile)
+     * @return True on success, otherwise see errorString()
+     */
+    bool write(const BlockData &data, QIODevice *dev);
+
+    /**
+     * @return The block definition of the last write() call
+     */
+    const QByteArray &buffer();
+
+    /**
+     * @return A description of the last error or an empty string
+     */
+    QString errorString();
+
+private:
+    void writeNewLine(int level);
+    void writeText(const QString &text, bool isAttribute);
+    void writeNumber(int number);
+    void writeColor(const QColor &color);
+    void writeAttribute(const char *name, const QString &value);
+    void writeTextElement(int level, const char *name, const QString &text);
+    bool writeParameter(const BlockParameterData &param);
+    void writeNameList(const char *listName, const char *elementName, const QStringList &names);
+
+    QByteArray outputBuffer;
+    bool isAutoFormatting;
+    QString error;
+};
+
+} // namespace libblockdia
+
+#endif // BLOCKDEFWRITER_H
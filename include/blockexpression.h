@@ -0,0 +1,102 @@
+#ifndef BLOCKEXPRESSION_H
+#define BLOCKEXPRESSION_H
+
+#include "libglobals.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace libblockdia {
+
+/**
+ * @brief A compiled arithmetic expression over parameter values.
+ *
+ * Expressions are used to derive the value of a parameter from other parameters
+ * (see BlockParameter::expression() and BlockExpressionGraph).
+ * The source is compiled once into a compact stack program (with constant folding),
+ * evaluating it does not parse or allocate anything.
+ *
+ * Syntax:
+ *  - numbers: 42, 0.5, 1e3
+ *  - references to parameters of the same block: rate, {buffer size}
+ *  - references to parameters of another block by its instance id: B1.rate, {B 1}.{buffer size}
+ *    (names in braces may contain any character except braces)
+ *  - operators: + - * / % ^ (power, right associative), unary + and -, parentheses
+ *  - functions: min(a, b, ..), max(a, b, ..), abs(a), round(a), floor(a), ceil(a)
+ */
+class LIBBLOCKDIACORESHARED_EXPORT BlockExpression
+{
+public:
+
+    /**
+     * @details Constructing an invalid expression
+     */
+    BlockExpression();
+
+    /**
+     * @details Compiling an expression.
+     * @param source The expression source
+     * @param errorString Set to a description of the error on failure
+     * @return The compiled expression (invalid on syntax errors)
+     */
+    static BlockExpression compile(const QString &source, QString *errorString = Q_NULLPTR);
+
+    /**
+     * @return True if the expression has been compiled successfully
+     */
+    bool isValid() const;
+
+    /**
+     * @return The source the expression has been compiled from
+     */
+    QString source() const;
+
+    /**
+     * @details The distinct parameters referenced by the expression
+     * as written in the source, without braces (eg. "rate" or "B1.rate").
+     * @return The references in the order expected by evaluate()
+     */
+    QStringList references() const;
+
+    /**
+     * @details Evaluating the expression.
+     * @param values The values of all references (in the order of references())
+     * @return The result (not finite on errors like division by zero, NaN if the expression is invalid)
+     */
+    double evaluate(const double *values) const;
+
+    /**
+     * @return The number of instructions of the compiled program
+     */
+    int countInstructions() const;
+
+private:
+    friend class BlockExpressionCompiler;
+
+    enum OpCode {
+        PushConstant,   // operand: index of the constant
+        PushReference,  // operand: index of the reference
+        Add, Subtract, Multiply, Divide, Modulo, Power, Negate,
+        Minimum,        // operand: number of arguments
+        Maximum,        // operand: number of arguments
+        Absolute, Round, Floor, Ceil
+    };
+
+    struct Instruction
+    {
+        qint32 op;
+        qint32 operand;
+    };
+
+    QString _source;
+    QStringList _references;
+    QVector<Instruction> code;
+    QVector<double> constants;
+    int maxStackSize;
+    bool valid;
+};
+
+} // namespace libblockdia
+
+#endif // BLOCKEXPRESSION_H
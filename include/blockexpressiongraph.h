@@ -0,0 +1,152 @@
+#ifndef BLOCKEXPRESSIONGRAPH_H
+#define BLOCKEXPRESSIONGRAPH_H
+
+#include "libglobals.h"
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include <QTimer>
+
+#include <block.h>
+#include <blockexpression.h>
+
+namespace libblockdia {
+
+/**
+ * @brief Keeping parameters with expressions consistent with the parameters they depend on.
+ *
+ * The graph contains a set of blocks (eg. a single block or all blocks of a process).
+ * Every parameter with an expression (see BlockParameter::expression()) is a node
+ * with edges from the parameters it references; references to other blocks use their instance id.
+ * The nodes are ordered topologically once, expressions are compiled once (see BlockExpression).
+ *
+ * When a parameter changes, only the parameters that depend on it (directly or transitively)
+ * are evaluated again, each of them exactly once and in topological order.
+ * The parameters changed by Block::applyParameterValues() are propagated together.
+ * Changes of the structure (expressions, names, added or removed parameters and blocks)
+ * rebuild the graph and evaluate all expressions.
+ *
+ * Expressions are evaluated as floating point numbers.
+ * Int parameters receive the rounded result (clipped to their range),
+ * enum parameters the item with the rounded result as index.
+ * Only int and enum parameters can be referenced (enums by their item index).
+ * Parameters with invalid expressions, unknown references or cyclic dependencies
+ * keep their value and report an error (see errorString()).
+ * Evaluated values are not recorded by a BlockJournal (see BlockJournal::beginDerivedChanges()).
+ */
+class LIBBLOCKDIACORESHARED_EXPORT BlockExpressionGraph : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BlockExpressionGraph(QObject *parent = 0);
+
+    /**
+     * @details Adding a block to the graph.
+     * The expressions of all blocks are evaluated again.
+     * @param block The block (it is not owned by the graph, destroyed blocks are removed automatically)
+     */
+    void addBlock(Block *block);
+
+    /**
+     * @param block Removing a block from the graph
+     */
+    void removeBlock(Block *block);
+
+    /**
+     * @return All blocks of the graph
+     */
+    QList<Block *> blocks();
+
+    /**
+     * @details Evaluating all expressions (eg. after the graph has been changed with blocked signals).
+     */
+    void recomputeAll();
+
+    /**
+     * @param param A parameter of the graph
+     * @return A description why the expression of the parameter cannot be evaluated (empty if there is no error)
+     */
+    QString errorString(BlockParameter *param);
+
+    /**
+     * @param param A parameter of the graph
+     * @return The parameters that reference the parameter directly
+     */
+    QList<BlockParameter *> dependents(BlockParameter *param);
+
+    /**
+     * @return The number of parameters with expression
+     */
+    int countExpressions();
+
+    /**
+     * @return The number of expression evaluations since the graph has been created (for diagnostics)
+     */
+    qint64 countEvaluations();
+
+signals:
+
+    /**
+     * @details Emitted after the graph has been rebuilt (eg. the errors may have changed).
+     */
+    void signalRebuilt();
+
+private slots:
+    void slotParameterChanged();
+    void slotParametersChanged(libblockdia::Block *block, const QList<libblockdia::BlockParameter *> &parameters);
+    void slotParameterDestroyed(QObject *obj);
+    void slotBlockDataChanged(libblockdia::Block *block);
+    void slotBlockDestroyed(QObject *obj);
+    void slotRebuild();
+
+private:
+    struct Node
+    {
+        BlockParameter *param;
+        Block *block;
+        QString name;               // the name and expression the graph was built with
+        QString expression;
+        BlockExpression compiled;
+        QVector<int> inputs;        // the node of every reference of the compiled expression
+        QVector<int> dependents;
+        int rank;                   // topological position (-1 if the expression cannot be evaluated)
+        double value;               // the current numeric value (NaN if not numeric)
+        QString error;
+        quint32 mark;
+    };
+
+    void setDirty();
+    void ensureBuilt();
+    void build();
+    bool isStructureChanged(int node);
+    void propagate(const QVector<int> &changedNodes);
+    bool evaluate(int node);
+    static double numericValue(BlockParameter *param);
+
+    // the structure of a block the graph was built with
+    struct BlockState
+    {
+        QList<BlockParameter *> params;
+        QString instanceId;
+    };
+
+    QList<Block *> _blocks;
+    QHash<Block *, BlockState> blockStates;
+    QVector<Node> nodes;
+    QHash<QObject *, int> nodeIndex;
+    QHash<QString, BlockExpression> compiledExpressions;   // expressions of the current nodes, pruned by build()
+    QTimer *timerRebuild;
+    bool isDirty;
+    bool isUpdating;
+    quint32 currentMark;
+    int _countExpressions;
+    qint64 _countEvaluations;
+};
+
+} // namespace libblockdia
+
+#endif // BLOCKEXPRESSIONGRAPH_H
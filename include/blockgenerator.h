@@ -0,0 +1,131 @@
+#ifndef BLOCKGENERATOR_H
+#define BLOCKGENERATOR_H
+
+#include "libglobals.h"
+
+#include <QString>
+#include <QIODevice>
+#include <QRandomGenerator>
+
+#include <blockdata.h>
+
+namespace libblockdia {
+
+/**
+ * @brief Generating synthetic block definitions and processes for scale testing.
+ *
+ * The generator is deterministic: the same seed and settings always result in the same data.
+ * Every block is generated from the seed and its index only,
+ * so blocks can be generated in any order and on several threads (generateBlock() is thread-safe).
+ *
+ * Generated blocks are valid block definitions:
+ * parameter, input and output names are unique ("param<i>", "in<i>", "out<i>"),
+ * integer defaults are within their range and enum defaults are enum items.
+ *
+ * Processes are written as XML "process definition" (see writeProcessDef()).
+ */
+class LIBBLOCKDIACORESHARED_EXPORT BlockGenerator
+{
+public:
+
+    /**
+     * @details Constructing a generator with default settings
+     * @param seed The seed of all generated data
+     */
+    explicit BlockGenerator(quint32 seed = 1);
+
+    /**
+     * @param seed The seed of all generated data
+     */
+    void setSeed(quint32 seed);
+
+    /**
+     * @param minimum The minimum number of parameters per block
+     * @param maximum The maximum number of parameters per block
+     */
+    void setParameterCount(int minimum, int maximum);
+
+    /**
+     * @param minimum The minimum number of inputs per block
+     * @param maximum The maximum number of inputs per block
+     */
+    void setInputCount(int minimum, int maximum);
+
+    /**
+     * @param minimum The minimum number of outputs per block
+     * @param maximum The maximum number of outputs per block
+     */
+    void setOutputCount(int minimum, int maximum);
+
+    /**
+     * @param minimum The minimum number of items of enum parameters
+     * @param maximum The maximum number of items of enum parameters
+     */
+    void setEnumItemCount(int minimum, int maximum);
+
+    /**
+     * @details Setting the mix of parameter types (relative weights, 0 disables a type).
+     * @param weightInt The weight of "int" parameters
+     * @param weightStr The weight of "str" parameters
+     * @param weightEnum The weight of "enum" parameters
+     */
+    void setParameterTypeWeights(int weightInt, int weightStr, int weightEnum);
+
+    /**
+     * @details Generating a block definition.
+     * @param index The index of the block (blocks with the same index are equal)
+     * @return The block data (type id "gen.block<index>")
+     */
+    BlockData generateBlock(int index) const;
+
+    /**
+     * @details Writing a process definition.
+     *
+     * The process contains countBlocks instances of countTypes block types (see generateBlock()).
+     * Every instance sets all its parameters and every instance (except the first)
+     * has its first input connected to an output of a preceding instance, so the process is acyclic.
+     * The process is streamed, so arbitrary large processes can be written.
+     *
+     * The format is:
+     * @code
+     * <ProcessDef version="1">
+     *     <Blocks>
+     *         <Block typeId=".." instanceId=".." instanceName="..">
+     *             <Parameter name=".." value=".."/>
+     *         </Block>
+     *     </Blocks>
+     *     <Connections>
+     *         <Connection fromBlock=".." fromOutput=".." toBlock=".." toInput=".."/>
+     *     </Connections>
+     * </ProcessDef>
+     * @endcode
+     *
+     * @param dev The device to write the process to (eg. QFile)
+     * @param countBlocks The number of block instances
+     * @param countTypes The number of different block types
+     * @return True on success
+     */
+    bool writeProcessDef(QIODevice *dev, int countBlocks, int countTypes) const;
+
+private:
+    QRandomGenerator randomGenerator(quint32 stream, int index) const;
+    static int bounded(QRandomGenerator *rng, int minimum, int maximum);
+    static QString randomText(QRandomGenerator *rng, int minimum, int maximum);
+
+    quint32 seed;
+    int minParameters;
+    int maxParameters;
+    int minInputs;
+    int maxInputs;
+    int minOutputs;
+    int maxOutputs;
+    int minEnumItems;
+    int maxEnumItems;
+    int weightInt;
+    int weightStr;
+    int weightEnum;
+};
+
+} // namespace libblockdia
+
+#endif // BLOCKGENERATOR_H
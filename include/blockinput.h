@@ -5,7 +5,6 @@
 
 #include <QObject>
 #include <QXmlStreamReader>
-#include <QXmlStreamWriter>
 
 namespace  libblockdia {
 
@@ -14,7 +13,7 @@ namespace  libblockdia {
  * Input objects represent inputs for Blocks.
  * Input objects can be connected to exactely one output.
  */
-class LIBBLOCKDIASHARED_EXPORT BlockInput : public QObject
+class LIBBLOCKDIACORESHARED_EXPORT BlockInput : public QObject
 {
     Q_OBJECT
 public:
@@ -49,13 +48,6 @@ public:
      */
     static void parseBlockDef(QXmlStreamReader *xml, QObject *parent);
 
-    /**
-     * @details Exporting to an xml stream
-     * @param xml The current xml writer
-     * @return True on success
-     */
-    bool exportBlockDef(QXmlStreamWriter *xml);
-
 
 signals:
     /**
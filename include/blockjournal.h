@@ -0,0 +1,227 @@
+#ifndef BLOCKJOURNAL_H
+#define BLOCKJOURNAL_H
+
+#include "libglobals.h"
+
+#include <QObject>
+#include <QString>
+#include <QList>
+
+#include <block.h>
+#include <blockdata.h>
+
+namespace libblockdia {
+
+/**
+ * @brief An undo/redo journal of a block.
+ *
+ * The journal observes a block and records every change as a compact diff:
+ * the old and new value of a changed header field, input or output,
+ * only the changed fields of a parameter (eg. the value)
+ * and the data of added or removed parameters, inputs and outputs.
+ * No copies of the complete block are stored,
+ * so undo and redo only touch the changed items.
+ *
+ * Consecutive changes of the same item (eg. typing a value) are merged into one step,
+ * the parameters changed by Block::applyParameterValues() are recorded as one step,
+ * several changes can be combined into one step with beginMacro() and endMacro().
+ * The oldest steps are dropped when the journal exceeds its memory budget.
+ *
+ * Changes that are derived from other changes (eg. values of expressions, see BlockExpressionGraph)
+ * are not recorded, they are derived again when the original change is undone or redone
+ * (see beginDerivedChanges()).
+ *
+ * Parameters, inputs and outputs are identified by their position within the block.
+ * When the block is changed while its signals are blocked (eg. Block::applyBlockData()),
+ * the journal cannot follow and clear() must be called.
+ */
+class LIBBLOCKDIACORESHARED_EXPORT BlockJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @details Constructing a journal for a block
+     * @param block The observed block
+     * @param parent The Qt parent pointer (eg. the block).
+     */
+    explicit BlockJournal(Block *block, QObject *parent = 0);
+
+    /**
+     * @return The observed block
+     */
+    Block *block();
+
+    /**
+     * @param bytes The maximum (estimated) memory used by all undo and redo steps
+     */
+    void setMemoryBudget(qint64 bytes);
+
+    /**
+     * @return The estimated memory used by all undo and redo steps
+     */
+    qint64 memoryUsage();
+
+    /**
+     * @param ms Changes of the same item within this interval are merged into one step (0 disables merging)
+     */
+    void setMergeInterval(int ms);
+
+    /**
+     * @return True if there is a step that can be undone
+     */
+    bool canUndo();
+
+    /**
+     * @return True if there is a step that can be redone
+     */
+    bool canRedo();
+
+    /**
+     * @return A description of the next undo step
+     */
+    QString undoText();
+
+    /**
+     * @return A description of the next redo step
+     */
+    QString redoText();
+
+    /**
+     * @details Starting a macro: all changes until endMacro() are recorded as one step.
+     * Macros can be nested, the outermost macro defines the step.
+     * @param text A description of the step
+     */
+    void beginMacro(const QString &text);
+
+    /**
+     * @details Finishing a macro.
+     */
+    void endMacro();
+
+    /**
+     * @details Dropping all steps and reading the current state of the block.
+     */
+    void clear();
+
+    /**
+     * @details Marking all following parameter changes of the current thread as derived,
+     * until endDerivedChanges() is called (calls can be nested).
+     * Journals take derived values as known state without recording a step.
+     */
+    static void beginDerivedChanges();
+
+    /**
+     * @details Finishing beginDerivedChanges().
+     */
+    static void endDerivedChanges();
+
+public slots:
+
+    /**
+     * @details Reverting the last step.
+     */
+    void undo();
+
+    /**
+     * @details Applying the last reverted step again.
+     */
+    void redo();
+
+signals:
+
+    /**
+     * @details Is emitted when steps have been added, undone or redone.
+     */
+    void signalChanged();
+
+private:
+
+    /**
+     * @brief The header fields of a block
+     */
+    enum HeaderField {HeaderTypeId = 0, HeaderTypeName, HeaderInstanceId, HeaderInstanceName, HeaderColor, HeaderFieldCount};
+
+    /**
+     * @brief The fields of a parameter that are recorded by a ParameterChanged change
+     */
+    enum ParameterField {
+        ParameterName = 0x01,
+        ParameterPublic = 0x02,
+        ParameterDefault = 0x04,
+        ParameterValue = 0x08,
+        ParameterRange = 0x10,              ///< minimum and maximum
+        ParameterEnumItems = 0x20,
+        ParameterElements = 0x40,           ///< element type, minimum and maximum of arrays
+        ParameterExpression = 0x80
+    };
+
+    /**
+     * @brief A single change of the block
+     */
+    struct Change {
+        enum Kind {HeaderChanged, ParameterChanged, ParameterAdded, ParameterRemoved,
+                   InputChanged, InputAdded, InputRemoved, OutputChanged, OutputAdded, OutputRemoved};
+        Kind kind;
+        int index;                          ///< the header field or the position of the parameter/input/output
+        QString oldText;                    ///< old header value or input/output name
+        QString newText;                    ///< new header value or input/output name
+        int parameterFields;                ///< the fields stored by a ParameterChanged change (see ParameterField)
+        BlockParameterData oldParameter;    ///< only the changed fields, the complete data of a removed parameter
+        BlockParameterData newParameter;    ///< only the changed fields, the complete data of an added parameter
+        Change() : kind(HeaderChanged), index(-1), parameterFields(0) {}
+    };
+
+    /**
+     * @brief A step that is undone/redone at once
+     */
+    struct Step {
+        QString text;
+        QList<Change> changes;
+        qint64 timestamp;
+        qint64 memorySize;
+    };
+
+    void readKnownState();
+    QString headerValue(int field);
+    void setHeaderValue(int field, const QString &value);
+    void record(const QList<Change> &changes, const QString &text);
+    void applyChange(const Change &change, bool isUndo);
+    void enforceMemoryBudget();
+    static bool isMergeable(const Change &last, const Change &next);
+    static qint64 estimateSize(const Change &change);
+    static Change parameterChange(int index, const BlockParameterData &oldData, const BlockParameterData &newData);
+    static int changedParameterFields(const BlockParameterData &a, const BlockParameterData &b);
+    static void copyParameterFields(const BlockParameterData &from, BlockParameterData *to, int fields);
+
+    Block *_block;
+    qint64 memoryBudget;
+    qint64 usedMemory;
+    int mergeInterval;
+    bool isApplying;
+    int macroDepth;
+    Step macroStep;
+    QList<Step> undoSteps;
+    QList<Step> redoSteps;
+
+    // the state of the block as known by the journal
+    QString knownHeader[HeaderFieldCount];
+    QList<BlockParameter *> knownParameters;
+    QList<BlockParameterData> knownParameterData;
+    QList<BlockInput *> knownInputs;
+    QStringList knownInputNames;
+    QList<BlockOutput *> knownOutputs;
+    QStringList knownOutputNames;
+
+private slots:
+    void slotBlockChanged();
+    void slotParameterChanged();
+    void slotParametersChanged(libblockdia::Block *block, const QList<libblockdia::BlockParameter *> &parameters);
+    void slotInputChanged();
+    void slotOutputChanged();
+};
+
+} // namespace libblockdia
+
+#endif // BLOCKJOURNAL_H
@@ -0,0 +1,149 @@
+#ifndef BLOCKLAYOUT_H
+#define BLOCKLAYOUT_H
+
+#include "libglobals.h"
+
+#include <QString>
+#include <QColor>
+#include <QFont>
+#include <QRectF>
+#include <QPointF>
+#include <QList>
+#include <QPainter>
+
+#include <blockdata.h>
+
+namespace libblockdia {
+
+/**
+ * @brief The geometry of a block as it is shown in the editor.
+ *
+ * The layout is calculated from plain BlockData,
+ * so it can be created and painted in any thread (into a QImage or QSvgGenerator).
+ * The graphic items (GraphicItemBlock, GraphicItemTextBox, GraphicItemBlockHeader)
+ * use the same functions to calculate and paint their boxes,
+ * so offscreen renderings look exactly like the editor.
+ *
+ * The block is centered at (0, 0).
+ * From top to bottom it consists of the header, the public parameters,
+ * the inputs/outputs (side by side) and the private parameters.
+ */
+class LIBBLOCKDIASHARED_EXPORT BlockLayout
+{
+public:
+
+    /**
+     * @brief Text alignement within a box.
+     */
+    enum struct Align {Center, Left, Right};
+
+    /**
+     * @brief A box with a single text (parameter, input or output).
+     */
+    struct TextBox {
+        QString text;
+        Align align;
+        QColor bgColor;
+        int index;              ///< the index of the parameter/input/output in the block (-1 for empty boxes)
+        qreal neededWidth;      ///< the width that is needed for the text (regardless of the minimal width)
+        QRectF rect;            ///< the rect of the box, centered at (0, 0)
+        QPointF pos;            ///< the center of the box within the block
+    };
+
+    /**
+     * @brief The header box of a block.
+     */
+    struct Header {
+        QString instanceName;
+        QString typeName;
+        QString ids;            ///< type id + instance id
+        QColor color;
+        QPointF posInstanceName;// text positions relative to the center of the box
+        QPointF posTypeName;
+        QPointF posIds;
+        qreal neededWidth;      ///< the width that is needed for the texts (regardless of the minimal width)
+        QRectF rect;            ///< the rect of the box, centered at (0, 0)
+        QPointF pos;            ///< the center of the box within the block
+    };
+
+    /**
+     * @details Constructing an empty layout
+     */
+    BlockLayout();
+
+    /**
+     * @details Calculating the layout of a block
+     * @param data The block data (eg. from Block::snapshot())
+     */
+    explicit BlockLayout(const BlockData &data);
+
+    Header header;
+    QList<TextBox> publicParameters;
+    QList<TextBox> inputs;              ///< same number of boxes as outputs (filled with empty boxes)
+    QList<TextBox> outputs;             ///< same number of boxes as inputs (filled with empty boxes)
+    QList<TextBox> privateParameters;
+    QRectF boundingRect;
+
+    /**
+     * @details Painting the block
+     * @param painter A painter with the block center at (0, 0)
+     */
+    void paint(QPainter *painter) const;
+
+    /**
+     * @details Calculating a text box
+     * @param text The text of the box
+     * @param align The alignment of the text
+     * @param bgColor The background color of the box
+     * @param minWidth The minimal width of the box
+     * @return The box (at position (0, 0) with index -1)
+     */
+    static TextBox layoutTextBox(const QString &text, Align align, const QColor &bgColor, qreal minWidth = 0);
+
+    /**
+     * @details Painting a text box
+     * @param painter A painter with the center of the box at (0, 0)
+     * @param box The box
+     * @param isHovered True to paint the box highlighted
+     */
+    static void paintTextBox(QPainter *painter, const TextBox &box, bool isHovered = false);
+
+    /**
+     * @details Calculating a header box
+     * @param instanceName The instance name of the block
+     * @param typeName The type name of the block
+     * @param ids The type id and instance id of the block
+     * @param color The color of the block
+     * @param minWidth The minimal width of the box
+     * @return The header (at position (0, 0))
+     */
+    static Header layoutHeader(const QString &instanceName, const QString &typeName, const QString &ids, const QColor &color, qreal minWidth = 0);
+
+    /**
+     * @details Painting a header box
+     * @param painter A painter with the center of the box at (0, 0)
+     * @param header The header
+     * @param isHovered True to paint the box highlighted
+     */
+    static void paintHeader(QPainter *painter, const Header &header, bool isHovered = false);
+
+    /**
+     * @details Setting a new minimal width of a box (the box stays centered).
+     */
+    static void setMinWidth(TextBox *box, qreal minWidth);
+
+    /**
+     * @details Setting a new minimal width of a header (the box stays centered).
+     */
+    static void setMinWidth(Header *header, qreal minWidth);
+
+private:
+    static QFont textBoxFont();
+    static QFont instanceNameFont();
+    static QFont typeNameFont();
+    static QFont idFont();
+};
+
+} // namespace libblockdia
+
+#endif // BLOCKLAYOUT_H
@@ -0,0 +1,180 @@
+#ifndef BLOCKLIBRARYINDEX_H
+#define BLOCKLIBRARYINDEX_H
+
+#include "libglobals.h"
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QColor>
+#include <QIODevice>
+#include <QFileInfo>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QThreadPool>
+
+namespace libblockdia {
+
+/**
+ * @brief A persistent index of all block definitions below a base directory.
+ *
+ * The index stores the most important meta data of every block definition file
+ * (type id, type name, color, number of parameters/inputs/outputs)
+ * together with the file modification time and file size.
+ * The index can be saved to and loaded from disk.
+ * When scanning the base directory again, only files that have been changed are parsed.
+ * The scan can also run on a worker thread (see startScan()), so that the GUI stays responsive on large libraries.
+ */
+class LIBBLOCKDIACORESHARED_EXPORT BlockLibraryIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief The meta data of a single block definition file.
+     */
+    struct Entry {
+        QString filePath;       ///< file path relative to the base directory
+        bool isValid;           ///< false if the file does not contain a valid block definition
+        QString typeId;
+        QString typeName;
+        QColor color;
+        int countParameters;
+        int countInputs;
+        int countOutputs;
+        qint64 lastModified;    ///< modification time in ms since epoch
+        qint64 size;            ///< file size in bytes
+    };
+
+    /**
+     * @details Constructing an empty index
+     * @param parent The Qt parent pointer.
+     */
+    explicit BlockLibraryIndex(QObject *parent = 0);
+
+    /**
+     * @details A running background scan is waited for, its result is dropped.
+     */
+    ~BlockLibraryIndex();
+
+    /**
+     * @return The base directory of the currently indexed library
+     */
+    QString basePath();
+
+    /**
+     * @details Set a new base directory.
+     * If the base directory differs from the current one, all entries are cleared.
+     * @param path The new base directory
+     */
+    void setBasePath(const QString &path);
+
+    /**
+     * @return A list of all valid block definition entries
+     */
+    QList<Entry> entries();
+
+    /**
+     * @param filePath The path of the file relative to the base directory
+     * @return A pointer to the entry or Q_NULLPTR if the file is not indexed
+     */
+    const Entry *entry(const QString &filePath);
+
+    /**
+     * @details Scanning the base directory for block definition files (*.xml) and packs (*.bdpack).
+     * Files whose size and modification time did not change since the last scan are not parsed again.
+     * Files that do not exist anymore are removed from the index.
+     * New and changed files are parsed in parallel on all available cores.
+     * The entries of packs are read from the pack directory (see BlockLibraryPack),
+     * their file path continues the path of the pack (eg. "standard.bdpack/filters/lowpass.xml").
+     * @return The number of files (or pack entries) that have been (re-)read
+     */
+    int scan();
+
+    /**
+     * @details Scanning the base directory like scan(), but on a worker thread.
+     * The entries are replaced in the thread of the index when the scan has finished,
+     * then signalScanFinished() is emitted.
+     * The result of a scan is dropped if the base directory has been changed,
+     * or the index has been loaded or scanned again in the meantime.
+     */
+    void startScan();
+
+    /**
+     * @return True if a background scan has not finished yet
+     */
+    bool isScanning();
+
+    /**
+     * @details Load a previously saved index from disk.
+     * The index is only loaded if it belongs to the current base directory.
+     * @param indexFilePath The path of the index file
+     * @return True on success
+     */
+    bool load(const QString &indexFilePath);
+
+    /**
+     * @details Save the index to disk.
+     * @param indexFilePath The path of the index file
+     * @return True on success
+     */
+    bool save(const QString &indexFilePath);
+
+    /**
+     * @details Reading the meta data of a block definition without creating a Block object.
+     * Only the header elements are read, parameters, inputs and outputs are just counted.
+     * @param dev The device to read the data from (eg. QFile)
+     * @param entry The entry where the meta data is stored to
+     * @return True if a valid block definition has been found
+     */
+    static bool parseEntry(QIODevice *dev, Entry *entry);
+
+signals:
+
+    /**
+     * @details Is emitted when entries have been added, changed or removed.
+     */
+    void signalIndexChanged();
+
+    /**
+     * @details Is emitted when the entries of a background scan have been applied (see startScan()).
+     * @param countRead The number of files (or pack entries) that have been (re-)read
+     */
+    void signalScanFinished(int countRead);
+
+private:
+
+    /**
+     * @brief The result of a background scan
+     */
+    struct ScanResult {
+        int generation;         ///< results of outdated scans are dropped
+        QHash<QString, Entry> entries;
+        int countRead;
+        bool somethingChanged;
+    };
+
+    friend class BlockLibraryIndexScanJob;
+    void addScanResult(const ScanResult &result);
+
+    static int scanDirectory(const QString &basePath, const QHash<QString, Entry> &oldEntries, QHash<QString, Entry> *newEntries, bool *somethingChanged);
+    static int scanPack(const QString &relPackPath, const QFileInfo &packFileInfo, const QHash<QString, Entry> &indexEntries, QHash<QString, Entry> *newEntries);
+
+    QString _basePath;
+    QHash<QString, Entry> entriesHash;
+
+    QThreadPool *threadPool;
+    QMutex scanResultsMutex;
+    QList<ScanResult> scanResults;
+    int countPendingScans;      // only used in the index thread
+    QAtomicInt generation;      // increased when a scan is started or the entries are replaced
+
+private slots:
+    void slotCollectScanResults();
+};
+
+} // namespace libblockdia
+
+#endif // BLOCKLIBRARYINDEX_H
@@ -0,0 +1,116 @@
+#ifndef BLOCKLIBRARYLOADER_H
+#define BLOCKLIBRARYLOADER_H
+
+#include "libglobals.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QThreadPool>
+
+#include <block.h>
+#include <blockdata.h>
+
+namespace libblockdia {
+
+/**
+ * @brief Loading many block definition files in parallel.
+ *
+ * The block definition files are parsed on a pool of worker threads into plain BlockData.
+ * The Block objects are created from this data in the thread of the loader (normally the GUI thread).
+ * Blocks are handed over in small portions, so that the event loop of the loader thread stays responsive.
+ * Block definitions within packs (see BlockLibraryPack) are loaded like normal files.
+ */
+class LIBBLOCKDIACORESHARED_EXPORT BlockLibraryLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @details Constructing a loader
+     * @param parent The Qt parent pointer.
+     */
+    explicit BlockLibraryLoader(QObject *parent = 0);
+
+    /**
+     * @details Pending parse jobs are canceled and running jobs are waited for.
+     */
+    ~BlockLibraryLoader();
+
+    /**
+     * @param count The maximum number of worker threads (by default the number of cores)
+     */
+    void setMaxThreadCount(int count);
+
+    /**
+     * @details Start loading files (in addition to files that are still loading).
+     * For every file either signalBlockLoaded() or signalLoadFailed() is emitted.
+     * When all files are processed signalFinished() is emitted.
+     * @param filePaths A list of block definition files
+     */
+    void load(const QStringList &filePaths);
+
+    /**
+     * @details All files that are still loading are dropped.
+     * Files that have not been parsed yet are skipped,
+     * no more signals are emitted for any of the dropped files (not even signalFinished()).
+     */
+    void cancel();
+
+    /**
+     * @return True if there are files not processed yet
+     */
+    bool isRunning();
+
+signals:
+
+    /**
+     * @details Is emitted for every loaded block.
+     * The receiver takes the ownership of the block.
+     * @param filePath The path of the block definition file
+     * @param block The new block object
+     */
+    void signalBlockLoaded(QString filePath, libblockdia::Block *block);
+
+    /**
+     * @param filePath The path of the block definition file that could not be loaded
+     */
+    void signalLoadFailed(QString filePath);
+
+    /**
+     * @details Is emitted when all requested files are processed.
+     */
+    void signalFinished();
+
+private:
+
+    /**
+     * @brief The result of a worker job
+     */
+    struct Result {
+        int generation;         ///< results of canceled loads are dropped
+        QString filePath;
+        bool isValid;
+        BlockData data;
+    };
+
+    friend class BlockLibraryLoaderJob;
+    void addResult(const Result &result);
+
+    QThreadPool *threadPool;
+    QMutex resultsMutex;
+    QList<Result> results;
+    int countPendingJobs;       // only used in the loader thread
+    QAtomicInt generation;      // increased by cancel()
+
+private slots:
+    void slotCollectResults();
+};
+
+} // namespace libblockdia
+
+#endif // BLOCKLIBRARYLOADER_H
@@ -0,0 +1,142 @@
+#ifndef BLOCKLIBRARYPACK_H
+#define BLOCKLIBRARYPACK_H
+
+#include "libglobals.h"
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QFile>
+#include <QIODevice>
+
+#include <blocklibraryindex.h>
+
+namespace libblockdia {
+
+/**
+ * @brief A single file that contains a complete block library.
+ *
+ * A pack file (*.bdpack) starts with a directory of all contained block definitions.
+ * The directory stores the same meta data as the BlockLibraryIndex
+ * and the position of every block definition within the pack.
+ * Every block definition is compressed separately (qCompress),
+ * so a single block definition can be read with one seek
+ * without decoding the rest of the pack.
+ *
+ * Block definitions within a pack are addressed by a path
+ * that continues the path of the pack file,
+ * eg. "/lib/standard.bdpack/filters/lowpass.xml".
+ *
+ * A BlockLibraryPack object is not thread-safe,
+ * but several objects can read the same pack file concurrently.
+ */
+class LIBBLOCKDIACORESHARED_EXPORT BlockLibraryPack
+{
+public:
+
+    /**
+     * @details Constructing a pack reader
+     */
+    BlockLibraryPack();
+
+    /**
+     * @details The pack file is closed.
+     */
+    ~BlockLibraryPack();
+
+    /**
+     * @details Opening a pack file and reading its directory.
+     * @param packFilePath The path of the pack file
+     * @return True on success
+     */
+    bool open(const QString &packFilePath);
+
+    /**
+     * @details Closing the pack file.
+     */
+    void close();
+
+    /**
+     * @return True if a pack file is opened
+     */
+    bool isOpen();
+
+    /**
+     * @return The directory of the pack. The file paths are relative to the pack.
+     */
+    QList<BlockLibraryIndex::Entry> entries();
+
+    /**
+     * @details Reading a block definition from the pack.
+     * @param filePath The path of the block definition within the pack
+     * @return The uncompressed block definition or an empty array if the entry does not exist
+     */
+    QByteArray blockDef(const QString &filePath);
+
+    /**
+     * @details Reading a block definition from the pack.
+     * @param typeId The type id of the block
+     * @return The uncompressed block definition or an empty array if the type id does not exist
+     */
+    QByteArray blockDefByTypeId(const QString &typeId);
+
+    /**
+     * @details Reading the compressed data of a block definition.
+     * The data can be uncompressed with qUncompress() (eg. in a worker thread).
+     * @param filePath The path of the block definition within the pack
+     * @return The compressed block definition or an empty array if the entry does not exist
+     */
+    QByteArray compressedBlockDef(const QString &filePath);
+
+    /**
+     * @details Creating a pack file from all block definitions (*.xml) below a directory.
+     * @param packFilePath The path of the new pack file
+     * @param basePath The base directory of the library
+     * @return True on success
+     */
+    static bool create(const QString &packFilePath, const QString &basePath);
+
+    /**
+     * @param filePath A file path
+     * @return True if the file path has the suffix of pack files
+     */
+    static bool isPackFile(const QString &filePath);
+
+    /**
+     * @details Splitting a path into the path of a pack file and the path within the pack.
+     * @param path A path of a block definition (eg. "/lib/standard.bdpack/filters/lowpass.xml")
+     * @param packFilePath The path of the pack file (eg. "/lib/standard.bdpack")
+     * @param entryPath The path within the pack (eg. "filters/lowpass.xml")
+     * @return False if the path does not point into a pack
+     */
+    static bool splitPackPath(const QString &path, QString *packFilePath, QString *entryPath);
+
+    /**
+     * @details Opening a block definition for reading.
+     * This works for normal files as well as for block definitions within packs.
+     * @param path The path of the block definition
+     * @return An opened device (the caller takes the ownership) or Q_NULLPTR on failure
+     */
+    static QIODevice *openBlockDef(const QString &path);
+
+private:
+
+    /**
+     * @brief The location of a block definition within the pack
+     */
+    struct Location {
+        qint64 offset;
+        qint64 size;
+    };
+
+    QFile packFile;
+    qint64 dataOffset;
+    QList<BlockLibraryIndex::Entry> directory;
+    QHash<QString, Location> locationsByPath;
+    QHash<QString, QString> pathsByTypeId;
+};
+
+} // namespace libblockdia
+
+#endif // BLOCKLIBRARYPACK_H
@@ -0,0 +1,155 @@
+#ifndef BLOCKMEMORY_H
+#define BLOCKMEMORY_H
+
+#include "libglobals.h"
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QSet>
+
+#include <blockdata.h>
+
+namespace libblockdia {
+
+/**
+ * @brief Accounting of the memory used by blocks and their graphic items.
+ *
+ * The memory is estimated from the object sizes and the capacity of strings and lists
+ * (the allocator overhead is not included).
+ * Implicitly shared data (eg. a string that is referenced by a parameter and by its snapshot)
+ * is counted only once per BlockMemory object,
+ * so several blocks should be added to the same object to get the total usage.
+ *
+ * Objects are accounted by Block::addMemoryUsage() and GraphicItemBlock::addMemoryUsage().
+ * The resident memory of the whole process is available from processResidentBytes().
+ */
+class LIBBLOCKDIACORESHARED_EXPORT BlockMemory
+{
+public:
+
+    /**
+     * @brief The categories of accounted memory
+     */
+    enum Category {
+        Blocks = 0,     ///< Block objects (including their lists of children)
+        Parameters,     ///< BlockParameter objects
+        Inputs,         ///< BlockInput objects
+        Outputs,        ///< BlockOutput objects
+        Strings,        ///< names, ids and values
+        EnumItems,      ///< lists and strings of enum items
+        Caches,         ///< snapshots, content hashes and sources of lazy parsed blocks
+        GraphicItems,   ///< graphic items (including their texts)
+        CategoryCount
+    };
+
+    /**
+     * @brief The memory of one category
+     */
+    struct Usage
+    {
+        qint64 bytes;
+        int count;      ///< number of objects (strings: number of distinct string buffers)
+    };
+
+    /// estimated size of the private data of a QObject (not accessible through the public API)
+    static const qint64 QObjectPrivateBytes = 128;
+
+    /// estimated size of the private data of a QGraphicsItem (not accessible through the public API)
+    static const qint64 GraphicsItemPrivateBytes = 224;
+
+    BlockMemory();
+
+    /**
+     * @details Accounting an object.
+     * @param category The category of the object
+     * @param bytes The size of the object
+     */
+    void addObject(Category category, qint64 bytes);
+
+    /**
+     * @details Accounting memory that belongs to an already accounted object (eg. list storage).
+     * @param category The category of the memory
+     * @param bytes The size of the memory
+     */
+    void addBytes(Category category, qint64 bytes);
+
+    /**
+     * @details Accounting memory that is shared between several objects (eg. a shared table).
+     * The memory is only counted once per data pointer.
+     * @param category The category of the memory
+     * @param data The address that identifies the shared memory
+     * @param bytes The size of the memory
+     */
+    void addSharedBytes(Category category, const void *data, qint64 bytes);
+
+    /**
+     * @details Accounting the data of a string (the QString object itself belongs to its owner).
+     * Shared string data is only counted once.
+     * @param category The category of the string
+     * @param str The string
+     */
+    void addString(Category category, const QString &str);
+
+    /**
+     * @details Accounting the list storage and all strings of a string list.
+     * @param category The category of the list
+     * @param list The list
+     */
+    void addStringList(Category category, const QStringList &list);
+
+    /**
+     * @param category The category of the data
+     * @param data The data (shared data is only counted once)
+     */
+    void addByteArray(Category category, const QByteArray &data);
+
+    /**
+     * @details Accounting the plain data of a block (eg. a cached snapshot).
+     * Strings that are shared with the block objects are not counted again.
+     * @param category The category of the data
+     * @param data The plain block data
+     */
+    void addBlockData(Category category, const BlockData &data);
+
+    /**
+     * @param category A category
+     * @return The accounted memory of the category
+     */
+    Usage usage(Category category) const;
+
+    /**
+     * @return The accounted memory of all categories
+     */
+    qint64 totalBytes() const;
+
+    /**
+     * @details Adding the accounted memory of another object.
+     * Data that was counted by both objects is counted twice.
+     * @param other The other accounting
+     * @return This object
+     */
+    BlockMemory &operator+=(const BlockMemory &other);
+
+    /**
+     * @param category A category
+     * @return A readable name of the category (eg. "Parameters")
+     */
+    static QString categoryName(Category category);
+
+    /**
+     * @details The resident memory of the current process, as reported by the operating system.
+     * @return The number of bytes or -1 if not supported on this platform
+     */
+    static qint64 processResidentBytes();
+
+private:
+    bool isNewSharedData(const void *data);
+
+    Usage usages[CategoryCount];
+    QSet<const void *> sharedData;
+};
+
+} // namespace libblockdia
+
+#endif // BLOCKMEMORY_H
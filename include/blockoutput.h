@@ -13,7 +13,7 @@ namespace  libblockdia {
  * Output objects represent inputs for Blocks.
  * Output objects can be connected to multiple inputs.
  */
-class LIBBLOCKDIASHARED_EXPORT BlockOutput : public QObject
+class LIBBLOCKDIACORESHARED_EXPORT BlockOutput : public QObject
 {
     Q_OBJECT
 public:
@@ -50,13 +50,6 @@ public:
      */
     static void parseBlockDef(QXmlStreamReader *xml, QObject *parent);
 
-    /**
-     * @details Exporting to an xml stream
-     * @param xml The current xml writer
-     * @return True on success
-     */
-    bool exportBlockDef(QXmlStreamWriter *xml);
-
 signals:
     /**
      * @details This signal is emitted whenever something has changed.
@@ -7,6 +7,10 @@
 #include <QString>
 #include <QXmlStreamReader>
 
+#include <blockdata.h>
+#include <blockmemory.h>
+#include <blockparametervalue.h>
+
 namespace libblockdia {
 
 // forward declarations
@@ -15,7 +19,7 @@ class Block;
 /**
  * @brief Common base class (interface) for paramerters.
  */
-class LIBBLOCKDIASHARED_EXPORT BlockParameter : public QObject
+class LIBBLOCKDIACORESHARED_EXPORT BlockParameter : public QObject
 {
     Q_OBJECT
 
@@ -52,6 +56,26 @@ public:
      */
     void setPublic(bool isPublic);
 
+    /**
+     * @details An expression the value of the parameter is derived from (eg. "rate * window").
+     * The expression is evaluated by a BlockExpressionGraph that contains the block,
+     * the parameter itself only stores it (see BlockExpression for the syntax).
+     * @return The expression or an empty string if the value is set directly
+     */
+    QString expression();
+
+    /**
+     * @param expression Setting a new expression (an empty string removes the expression)
+     */
+    void setExpression(const QString &expression);
+
+    /**
+     * @details The type of the parameter as used in block definitions.
+     * This must be implemented by every derived class.
+     * @return The type identifier (eg. "int", "str", "enum")
+     */
+    virtual QString type() = 0;
+
     /**
      * @details Every parameter must have a default value.
      * A derived class must implement the default value.
@@ -77,6 +101,39 @@ public:
      */
     virtual bool setValue(QString value) = 0;
 
+    /**
+     * @details The value as shown to the user (eg. in graphic items).
+     * By default this is strValue(), parameters with long values return a short description.
+     * @return The value for display
+     */
+    virtual QString displayValue();
+
+    /**
+     * @details The current value without string conversion.
+     * This must be implemented by every derived class.
+     * @return The current value (eg. BlockParameterValue::Int for "int" parameters)
+     */
+    virtual BlockParameterValue typedValue() = 0;
+
+    /**
+     * @details Setting a new value without string conversion.
+     * This must be implemented by every derived class.
+     * @param value The new value (values of another alternative are rejected)
+     * @return False if the value could not be set exactly
+     */
+    virtual bool setTypedValue(const BlockParameterValue &value) = 0;
+
+    /**
+     * @return The default value without string conversion (see typedValue())
+     */
+    virtual BlockParameterValue typedDefaultValue() = 0;
+
+    /**
+     * @param value Setting the default value without string conversion (see setTypedValue())
+     * @return False if the value could not be set exactly
+     */
+    virtual bool setTypedDefaultValue(const BlockParameterValue &value) = 0;
+
     /**
      * @details An information about the allowed values for this parameter.
      * This is used as informational message.
@@ -89,6 +146,8 @@ public:
     /**
      * @details Parsing a XML stram for parameters
      * The XML stream is parsed from the current element for an parameter definition.
+     * Every parameter is parsed into plain data (see BlockParameterData::parseParamDef())
+     * and created by importBlockData().
      * In every case the XML parser is set to after the current element (parent or next child).
      * @param xml The current xml parser
      * @param parent The parent Block object
@@ -96,29 +155,68 @@ public:
     static void importBlockDef(QXmlStreamReader *xml, QObject *parent);
 
     /**
-     * @details This function imports parameter specific data from an xml stream.
-     * It must be implemented by every subclass.
-     * This is automatically called during importBlockDef()
-     * @param xml The current xml parser
-     * @return True if parsing was successful
+     * @details Creating a parameter from plain data.
+     * The parameter class is selected by BlockParameterData::type.
+     * @param data The plain parameter data
+     * @param parent The parent Block object
+     * @return The new parameter or Q_NULLPTR if the type is unknown
      */
-    virtual bool importParamDef(QXmlStreamReader *xml) = 0;
+    static BlockParameter *importBlockData(const BlockParameterData &data, QObject *parent);
 
     /**
-     * @details Exporting to an xml stream
-     * @param xml The current xml writer
+     * @details This function imports parameter specific data from plain data.
+     * It must be implemented by every subclass.
+     * This is automatically called during importBlockData()
+     * @param data The plain parameter data
      * @return True on success
      */
-    bool exportBlockDef(QXmlStreamWriter *xml);
+    virtual bool importParamData(const BlockParameterData &data) = 0;
 
     /**
-     * @details This function export parameter specific data into an xml file.
+     * @details Exporting into plain data
+     * @param data The plain data object to write to
+     */
+    void exportBlockData(BlockParameterData *data);
+
+    /**
+     * @details This function exports parameter specific data into plain data.
      * It must be implemented by every subclass.
-     * This is automatically called during exportBlockDef()
-     * @param xml The current xml writer
+     * This is automatically called during exportBlockData()
+     * @param data The plain data object to write to
      * @return True on success
      */
-    virtual bool exportParamDef(QXmlStreamWriter *xml) = 0;
+    virtual bool exportParamData(BlockParameterData *data) = 0;
+
+    /**
+     * @details The plain data of the parameter as immutable value (see Block::snapshot()).
+     * The data is cached and only exported again after the parameter has been changed.
+     * @return The snapshot of the parameter
+     */
+    BlockParameterData snapshot();
+
+    /**
+     * @details A hash over the canonical serialization of the parameter (see BlockParameterData::contentHash()).
+     * The hash is cached and only calculated again after the parameter has been changed.
+     * @return The content hash
+     */
+    QByteArray contentHash();
+
+    /**
+     * @details Accounting the memory of the parameter (see BlockMemory).
+     * Derived classes with own data must extend this (and call the base implementation).
+     * @param usage The accounting to add the memory to
+     */
+    virtual void addMemoryUsage(BlockMemory *usage);
+
+
+public slots:
+
+    /**
+     * @details Discarding the cached snapshot and content hash.
+     * This is called automatically by somethingHasChanged(),
+     * it only needs to be called when the parameter is changed while its signals are blocked.
+     */
+    void invalidateCache();
 
 
 signals:
@@ -130,6 +228,10 @@ signals:
 private:
     QString _name;
     bool _isPublic;
+    QString _expression;
+    QByteArray cachedContentHash;
+    BlockParameterData cachedSnapshot;
+    bool isSnapshotValid;
 };
 
 } // namespace bd
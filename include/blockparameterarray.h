@@ -0,0 +1,245 @@
+#ifndef BDPARAMETERARRAY_H
+#define BDPARAMETERARRAY_H
+
+#include "libglobals.h"
+#include <blockparameter.h>
+
+#include <QByteArray>
+#include <QVector>
+
+namespace libblockdia {
+
+/**
+ * @brief An array parameter (eg. the coefficient table of a calibration).
+ * Array parameters hold any number of integer or floating point elements,
+ * every element must be within the range defined by minimum and maximum.
+ *
+ * The elements are stored contiguously in their binary form (32 bit integers or 64 bit doubles),
+ * they are never formatted or parsed as text.
+ * The string representation (strValue(), strDefaultValue() and the "default" attribute in block definitions)
+ * is the base64 encoding of the little endian elements.
+ */
+class LIBBLOCKDIACORESHARED_EXPORT BlockParameterArray : public BlockParameter
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief The type of the array elements
+     */
+    enum ElementType {
+        Int,        ///< 32 bit integer elements ("int")
+        Double      ///< 64 bit floating point elements ("double")
+    };
+
+    /**
+     * @details Constructing a parameter
+     * @param parent The block this parameter belogns to.
+     * @param name The name for the parameter
+     */
+    BlockParameterArray(const QString &name, QObject *parent = 0);
+
+    /**
+     * @return The parameter type "array"
+     */
+    QString type();
+
+    /**
+     * @return The type of the elements (Double by default)
+     */
+    ElementType elementType();
+
+    /**
+     * @details Setting the element type.
+     * The value and the default value are converted (rounded and clipped for Int).
+     * @param type The new element type
+     */
+    void setElementType(ElementType type);
+
+    /**
+     * @param type An element type
+     * @return The name of the element type as used in block definitions ("int" or "double")
+     */
+    static QString elementTypeName(ElementType type);
+
+    /**
+     * @param name The name of an element type ("int" or "double")
+     * @param type Set to the element type
+     * @return False if the name is unknown
+     */
+    static bool elementTypeFromName(const QString &name, ElementType *type);
+
+    /**
+     * @param type An element type
+     * @return The number of bytes of one element
+     */
+    static int elementSize(ElementType type);
+
+    /**
+     * @details The minimum allowed value of every element
+     * By default the minimum is the lowest value of the element type
+     * @return The minimum allowed element value
+     */
+    double minimum();
+
+    /**
+     * @details Setting the minimum allowed element value
+     * (the elements of the value and default value are clipped)
+     * @param min The new minimum element value
+     */
+    void setMinimum(double min);
+
+    /**
+     * @details The maximum allowed value of every element
+     * By default the maximum is the highest value of the element type
+     * @return The maximum allowed element value
+     */
+    double maximum();
+
+    /**
+     * @details Setting the maximum allowed element value
+     * (the elements of the value and default value are clipped)
+     * @param max The new maximum element value
+     */
+    void setMaximum(double max);
+
+    /**
+     * @details Setting the minimum and maximum allowed element value at once
+     * (the elements of the value and default value are clipped only once, against the new range)
+     * @param min The new minimum element value
+     * @param max The new maximum element value
+     */
+    void setRange(double min, double max);
+
+    /**
+     * @return The number of elements of the current value
+     */
+    int count();
+
+    /**
+     * @param index The element index (must be less than count())
+     * @return The element of the current value
+     */
+    double valueAt(int index);
+
+    /**
+     * @return The elements of the current value
+     */
+    QVector<double> values();
+
+    /**
+     * @details Setting all elements of the value.
+     * The elements are clipped to the range defined by minimum and maximum
+     * (and rounded for Int elements). NaN elements are set to the minimum.
+     * @param values The new elements
+     * @return False if an element could not be set exactly
+     */
+    bool setValues(const QVector<double> &values);
+
+    /**
+     * @return The elements of the default value
+     */
+    QVector<double> defaultValues();
+
+    /**
+     * @param values The new default elements (see setValues())
+     * @return False if an element could not be set exactly
+     */
+    bool setDefaultValues(const QVector<double> &values);
+
+    /**
+     * @return The default value as base64 encoding
+     */
+    QString strDefaultValue();
+
+    /**
+     * @param value Setting the default value from the base64 encoding
+     * @return False if the encoding is invalid or an element has been clipped
+     */
+    bool setDefaultValue(QString value);
+
+    /**
+     * @details Setting a new value from the base64 encoding.
+     * Elements out of range are clipped.
+     * @param value The base64 encoded elements
+     * @return False if the encoding is invalid or an element has been clipped
+     */
+    bool setValue(QString value);
+
+    /**
+     * @return The current value as base64 encoding
+     */
+    QString strValue();
+
+    /**
+     * @return A short description of the value (eg. "[1024 x double]"), the value itself can be very long
+     */
+    QString displayValue();
+
+    /**
+     * @return The current value as BlockParameterValue::String (base64 encoding)
+     */
+    BlockParameterValue typedValue();
+
+    /**
+     * @param value The new value (only BlockParameterValue::String with the base64 encoding is accepted)
+     * @return False if the new value could not be set exactly
+     */
+    bool setTypedValue(const BlockParameterValue &value);
+
+    /**
+     * @return The default value as BlockParameterValue::String (base64 encoding)
+     */
+    BlockParameterValue typedDefaultValue();
+
+    /**
+     * @param value The new default value (only BlockParameterValue::String with the base64 encoding is accepted)
+     * @return False if the default value could not be set exactly
+     */
+    bool setTypedDefaultValue(const BlockParameterValue &value);
+
+    /**
+     * @return An information about the allowed element range.
+     */
+    QString allowedValues();
+
+    /**
+     * @details Importing parameter specific data
+     * @param data The plain parameter data
+     * @return True on success
+     */
+    bool importParamData(const BlockParameterData &data);
+
+    /**
+     * @details Exporting parameter specific data
+     * @param data The plain data object to write to
+     * @return True on success
+     */
+    bool exportParamData(BlockParameterData *data);
+
+    /**
+     * @details Accounting the memory of the parameter (see BlockParameter::addMemoryUsage()).
+     * @param usage The accounting to add the memory to
+     */
+    void addMemoryUsage(BlockMemory *usage);
+
+
+private:
+    bool setElements(QByteArray *elements, QByteArray raw);
+    bool setElements(QByteArray *elements, const QVector<double> &values);
+    QVector<double> toValues(const QByteArray &elements);
+    QString encode(const QByteArray &elements);
+    bool decode(const QString &value, QByteArray *raw);
+
+    ElementType _elementType;
+    double _minimum;
+    double _maximum;
+    QByteArray _value;          // the elements in host byte order
+    QByteArray _defaultValue;
+
+};
+
+} // namespace libblockdia
+
+#endif // BDPARAMETERARRAY_H
@@ -4,13 +4,25 @@
 #include "libglobals.h"
 #include <blockparameter.h>
 
+#include <QSharedPointer>
+#include <QStringList>
+
 namespace libblockdia {
 
+// forward declarations
+struct BlockParameterEnumItems;
+
 /**
- * @brief An integer parameter.
- * Integer parameters have an minimum and maximum allowed value.
+ * @brief An enum parameter.
+ * Enum parameters select one item out of a list of allowed items.
+ *
+ * The value and the default value are stored as item indices.
+ * The items are kept in an immutable table with a hashed item-to-index lookup,
+ * so selecting an item by name does not search the list.
+ * Tables are shared between all enum parameters with identical item lists
+ * (eg. the same channel list used by many blocks is stored only once).
  */
-class LIBBLOCKDIASHARED_EXPORT BlockParameterEnum : public BlockParameter
+class LIBBLOCKDIACORESHARED_EXPORT BlockParameterEnum : public BlockParameter
 {
     Q_OBJECT
 
@@ -23,6 +35,11 @@ public:
      */
     BlockParameterEnum(const QString &name, QObject *parent = 0);
 
+    /**
+     * @return The parameter type "enum"
+     */
+    QString type();
+
     /**
      * @return The default value as string representation
      */
@@ -47,6 +64,30 @@ public:
      */
     QString strValue();
 
+    /**
+     * @return The index of the current item as BlockParameterValue::EnumIndex (-1 if no item is selected)
+     */
+    BlockParameterValue typedValue();
+
+    /**
+     * @details Selecting an item by its index (BlockParameterValue::EnumIndex)
+     * or by its name (BlockParameterValue::String, same as setValue()).
+     * @param value The new value
+     * @return False if the item does not exist
+     */
+    bool setTypedValue(const BlockParameterValue &value);
+
+    /**
+     * @return The index of the default item as BlockParameterValue::EnumIndex (-1 if there are no items)
+     */
+    BlockParameterValue typedDefaultValue();
+
+    /**
+     * @param value The new default item (see setTypedValue())
+     * @return False if the item does not exist
+     */
+    bool setTypedDefaultValue(const BlockParameterValue &value);
+
     /**
      * @return An information about the allowed values range.
      */
@@ -54,6 +95,8 @@ public:
 
     /**
      * @details Only added items can be set as default or as value.
+     * A shared item table is copied once into a table of this parameter,
+     * further items are appended to it (the table is shared again by setEnumItems()).
      * @param item Adding an item.
      * @return True if the item did not already exist
      */
@@ -65,30 +108,70 @@ public:
     QStringList enumItems();
 
     /**
+     * @details Setting a new list of allowed items.
+     * The value and the default value keep their items (by name) if they still exist,
+     * otherwise the value is cleared and the default value is set to the first item.
      * @param items Setting a new list of allowed items
      * @return True if the list could be set
      */
     bool setEnumItems(QStringList items);
 
     /**
-     * @details Parsing a XML stram for parameter definition.
-     * @param xml The current xml parser
-     * @return True if parsing was successful
+     * @param item The name of an item
+     * @return The index of the item or -1 if it does not exist
+     */
+    int indexOfEnumItem(const QString &item);
+
+    /**
+     * @return The index of the current item or -1 if no item is selected
+     */
+    int valueIndex();
+
+    /**
+     * @details Selecting the current item by index.
+     * @param index The index of the item
+     * @return False if the index is out of range
+     */
+    bool setValueIndex(int index);
+
+    /**
+     * @return The index of the default item or -1 if there are no items
+     */
+    int defaultIndex();
+
+    /**
+     * @details Selecting the default item by index.
+     * @param index The index of the item
+     * @return False if the index is out of range
      */
-    bool importParamDef(QXmlStreamReader *xml);
+    bool setDefaultIndex(int index);
 
     /**
-     * @details Exporting to an xml stream
-     * @param xml The current xml writer
+     * @details Importing parameter specific data
+     * @param data The plain parameter data
      * @return True on success
      */
-    bool exportParamDef(QXmlStreamWriter *xml);
+    bool importParamData(const BlockParameterData &data);
+
+    /**
+     * @details Exporting parameter specific data
+     * @param data The plain data object to write to
+     * @return True on success
+     */
+    bool exportParamData(BlockParameterData *data);
+
+    /**
+     * @details Accounting the memory of the parameter (see BlockParameter::addMemoryUsage()).
+     * @param usage The accounting to add the memory to
+     */
+    void addMemoryUsage(BlockMemory *usage);
 
 
 private:
-    QString _value;
-    QString _defaultValue;
-    QStringList _enumItems;
+    QSharedPointer<const BlockParameterEnumItems> items;
+    bool isItemsShared;     // false if the table is only used by this parameter (see addEnumItem())
+    int _valueIndex;
+    int _defaultIndex;
 
 };
 
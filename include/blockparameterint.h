@@ -10,7 +10,7 @@ namespace libblockdia {
  * @brief An integer parameter.
  * Integer parameters have an minimum and maximum allowed value.
  */
-class LIBBLOCKDIASHARED_EXPORT BlockParameterInt : public BlockParameter
+class LIBBLOCKDIACORESHARED_EXPORT BlockParameterInt : public BlockParameter
 {
     Q_OBJECT
 
@@ -23,6 +23,11 @@ public:
      */
     BlockParameterInt(const QString &name, QObject *parent = 0);
 
+    /**
+     * @return The parameter type "int"
+     */
+    QString type();
+
     /**
      * @details The minimum allowed parameter value
      * By default the minimum is set to INT_MIN
@@ -98,24 +103,53 @@ public:
      */
     QString strValue();
 
+    /**
+     * @return The current value as BlockParameterValue::Int
+     */
+    BlockParameterValue typedValue();
+
+    /**
+     * @param value The new value (only BlockParameterValue::Int is accepted, it is clipped as by setValue(int))
+     * @return False if the new value could not be set exactly
+     */
+    bool setTypedValue(const BlockParameterValue &value);
+
+    /**
+     * @return The default value as BlockParameterValue::Int
+     */
+    BlockParameterValue typedDefaultValue();
+
+    /**
+     * @param value The new default value (only BlockParameterValue::Int is accepted)
+     * @return False if the default value could not be set exactly
+     */
+    bool setTypedDefaultValue(const BlockParameterValue &value);
+
     /**
      * @return An information about the allowed values range.
      */
     QString allowedValues();
 
     /**
-     * @details Parsing a XML stram for parameter definition.
-     * @param xml The current xml parser
-     * @return True if parsing was successful
+     * @details Importing parameter specific data
+     * @param data The plain parameter data
+     * @return True on success
      */
-    bool importParamDef(QXmlStreamReader *xml);
+    bool importParamData(const BlockParameterData &data);
 
     /**
-     * @details Exporting to an xml stream
-     * @param xml The current xml writer
+     * @details Exporting parameter specific data
+     * @param data The plain data object to write to
      * @return True on success
      */
-    bool exportParamDef(QXmlStreamWriter *xml);
+    bool exportParamData(BlockParameterData *data);
+
+    /**
+     * @details Accounting the memory of the parameter (see BlockParameter::addMemoryUsage()).
+     * @param usage The accounting to add the memory to
+     */
+    void addMemoryUsage(BlockMemory *usage);
+
 
 private:
     int _minimum;
@@ -9,7 +9,7 @@ namespace libblockdia {
 /**
  * @brief A string parameter.
  */
-class LIBBLOCKDIASHARED_EXPORT BlockParameterStr : public BlockParameter
+class LIBBLOCKDIACORESHARED_EXPORT BlockParameterStr : public BlockParameter
 {
     Q_OBJECT
 
@@ -22,6 +22,11 @@ public:
      */
     BlockParameterStr(const QString &name, QObject *parent = 0);
 
+    /**
+     * @return The parameter type "str"
+     */
+    QString type();
+
     /**
      * @return The default value as string representation
      */
@@ -46,24 +51,52 @@ public:
      */
     QString strValue();
 
+    /**
+     * @return The current value as BlockParameterValue::String
+     */
+    BlockParameterValue typedValue();
+
+    /**
+     * @param value The new value (only BlockParameterValue::String is accepted)
+     * @return False if the new value could not be set
+     */
+    bool setTypedValue(const BlockParameterValue &value);
+
+    /**
+     * @return The default value as BlockParameterValue::String
+     */
+    BlockParameterValue typedDefaultValue();
+
+    /**
+     * @param value The new default value (only BlockParameterValue::String is accepted)
+     * @return False if the default value could not be set
+     */
+    bool setTypedDefaultValue(const BlockParameterValue &value);
+
     /**
      * @return An information about the allowed values range.
      */
     QString allowedValues();
 
     /**
-     * @details Parsing a XML stram for parameter definition.
-     * @param xml The current xml parser
-     * @return True if parsing was successful
+     * @details Importing parameter specific data
+     * @param data The plain parameter data
+     * @return True on success
      */
-    bool importParamDef(QXmlStreamReader *xml);
+    bool importParamData(const BlockParameterData &data);
 
     /**
-     * @details Exporting to an xml stream
-     * @param xml The current xml writer
+     * @details Exporting parameter specific data
+     * @param data The plain data object to write to
      * @return True on success
      */
-    bool exportParamDef(QXmlStreamWriter *xml);
+    bool exportParamData(BlockParameterData *data);
+
+    /**
+     * @details Accounting the memory of the parameter (see BlockParameter::addMemoryUsage()).
+     * @param usage The accounting to add the memory to
+     */
+    void addMemoryUsage(BlockMemory *usage);
 
 
 private:
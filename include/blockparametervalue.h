@@ -0,0 +1,104 @@
+#ifndef BLOCKPARAMETERVALUE_H
+#define BLOCKPARAMETERVALUE_H
+
+#include "libglobals.h"
+
+#include <QString>
+#include <QMetaType>
+
+namespace libblockdia {
+
+/**
+ * @brief A typed parameter value.
+ *
+ * The value holds one of several alternatives (integer, string, enum item index or float)
+ * together with a tag of the alternative.
+ * It allows to read and write parameters generically (see BlockParameter::typedValue())
+ * without formatting and parsing strings.
+ *
+ * Values are never converted implicitly:
+ * the accessors return the value only if it holds the requested alternative.
+ */
+class LIBBLOCKDIACORESHARED_EXPORT BlockParameterValue
+{
+public:
+
+    /**
+     * @brief The alternatives of a value
+     */
+    enum Type {
+        Invalid = 0,    ///< no value
+        Int,            ///< integer (eg. "int" parameters)
+        String,         ///< string (eg. "str" parameters)
+        EnumIndex,      ///< index into the enum items (eg. "enum" parameters, -1 if no item is selected)
+        Float           ///< floating point number
+    };
+
+    /**
+     * @details Constructing an invalid value
+     */
+    BlockParameterValue();
+
+    static BlockParameterValue fromInt(int value);
+    static BlockParameterValue fromString(const QString &value);
+    static BlockParameterValue fromEnumIndex(int index);
+    static BlockParameterValue fromFloat(double value);
+
+    /**
+     * @return The alternative that is held by the value
+     */
+    Type type() const;
+
+    /**
+     * @return False if the value is Invalid
+     */
+    bool isValid() const;
+
+    /**
+     * @param ok Set to true if the value is an Int
+     * @return The integer value (0 for other alternatives)
+     */
+    int toInt(bool *ok = Q_NULLPTR) const;
+
+    /**
+     * @param ok Set to true if the value is a String
+     * @return The string value (a null string for other alternatives)
+     */
+    QString toString(bool *ok = Q_NULLPTR) const;
+
+    /**
+     * @param ok Set to true if the value is an EnumIndex
+     * @return The enum item index (-1 for other alternatives)
+     */
+    int toEnumIndex(bool *ok = Q_NULLPTR) const;
+
+    /**
+     * @param ok Set to true if the value is a Float
+     * @return The float value (0 for other alternatives)
+     */
+    double toFloat(bool *ok = Q_NULLPTR) const;
+
+    /**
+     * @return True if both values hold the same alternative with the same value
+     */
+    bool operator==(const BlockParameterValue &other) const;
+
+    /**
+     * @return True if the alternatives or the values differ
+     */
+    bool operator!=(const BlockParameterValue &other) const;
+
+private:
+    Type _type;
+    union {
+        int i;
+        double f;
+    } number;
+    QString str;
+};
+
+} // namespace libblockdia
+
+Q_DECLARE_METATYPE(libblockdia::BlockParameterValue)
+
+#endif // BLOCKPARAMETERVALUE_H
@@ -0,0 +1,124 @@
+#ifndef BLOCKRENDERER_H
+#define BLOCKRENDERER_H
+
+#include "libglobals.h"
+
+#include <QObject>
+#include <QString>
+#include <QImage>
+#include <QIODevice>
+#include <QThreadPool>
+#include <QAtomicInt>
+
+#include <blockdata.h>
+
+namespace libblockdia {
+
+/**
+ * @brief Rendering blocks offscreen into images (eg. PNG) or SVG files.
+ *
+ * The blocks are painted with their BlockLayout directly into a QImage or a QSvgGenerator,
+ * no QGraphicsScene or widget is involved.
+ * Because the layout is shared with GraphicItemBlock, the output matches the editor.
+ *
+ * The static render functions are thread-safe.
+ * render() renders many blocks concurrently on a thread pool.
+ * If the platform does not support font rendering outside of the GUI thread
+ * (see QFontDatabase::supportsThreadedFontRendering()), render() works synchronously.
+ *
+ * A QGuiApplication must exist.
+ */
+class LIBBLOCKDIASHARED_EXPORT BlockRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @details Constructing a renderer
+     * @param parent The Qt parent pointer.
+     */
+    explicit BlockRenderer(QObject *parent = 0);
+
+    /**
+     * @details Pending renderings are finished before the renderer is destroyed.
+     */
+    ~BlockRenderer();
+
+    /**
+     * @param count The maximum number of worker threads (default is the number of cores)
+     */
+    void setMaxThreadCount(int count);
+
+    /**
+     * @param scale The scale factor of images (default 1.0, SVG files are not scaled)
+     */
+    void setScale(qreal scale);
+
+    /**
+     * @details Start rendering a block into a file.
+     * The format is defined by the suffix of the file path (".svg" or any image format, eg. ".png").
+     * When the file is written signalRendered() is emitted.
+     * @param data The block data (eg. from Block::snapshot())
+     * @param filePath The path of the file to write
+     */
+    void render(const BlockData &data, const QString &filePath);
+
+    /**
+     * @return True if there are renderings not finished yet
+     */
+    bool isRunning();
+
+    /**
+     * @details Blocking until all renderings are finished.
+     */
+    void waitForFinished();
+
+    /**
+     * @details Rendering a block into an image (transparent background).
+     * @param data The block data
+     * @param scale The scale factor
+     * @return The image
+     */
+    static QImage renderImage(const BlockData &data, qreal scale = 1.0);
+
+    /**
+     * @details Rendering a block as SVG.
+     * @param data The block data
+     * @param dev The device to write the SVG to (eg. QFile)
+     * @return True on success
+     */
+    static bool renderSvg(const BlockData &data, QIODevice *dev);
+
+    /**
+     * @details Rendering a block into a file.
+     * @param data The block data
+     * @param filePath The path of the file (the suffix defines the format)
+     * @param scale The scale factor (only for images)
+     * @param errorString A description of the error if rendering failed (can be Q_NULLPTR)
+     * @return True on success
+     */
+    static bool renderFile(const BlockData &data, const QString &filePath, qreal scale = 1.0, QString *errorString = Q_NULLPTR);
+
+signals:
+
+    /**
+     * @details Is emitted (from the worker thread) when a file has been written.
+     * @param filePath The path of the written file
+     * @param success True if the file has been written
+     * @param errorString A description of the error if rendering failed
+     */
+    void signalRendered(QString filePath, bool success, QString errorString);
+
+private:
+    friend class BlockRendererJob;
+
+    QThreadPool *threadPool;
+    QAtomicInt countPendingJobs;
+    qreal imageScale;
+    bool isThreaded;
+};
+
+} // namespace libblockdia
+
+#endif // BLOCKRENDERER_H
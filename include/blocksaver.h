@@ -0,0 +1,99 @@
+#ifndef BLOCKSAVER_H
+#define BLOCKSAVER_H
+
+#include "libglobals.h"
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QByteArray>
+#include <QMutex>
+#include <QThreadPool>
+
+#include <blockdata.h>
+
+namespace libblockdia {
+
+/**
+ * @brief Writing block definitions in the background.
+ *
+ * A snapshot of a block (see Block::snapshot()) is serialized
+ * and written on a worker thread, so the GUI thread is not blocked.
+ * Files are replaced atomically (QSaveFile),
+ * so a crash during writing never leaves a half written file.
+ *
+ * All files are written one after another in the order of the save() calls.
+ * When a file is saved again before the previous snapshot has been written,
+ * only the newest snapshot is written.
+ *
+ * The saver remembers a hash of the content it has written to every file,
+ * so file system watchers can tell its own writes from external changes (see isWrittenContent()).
+ */
+class LIBBLOCKDIACORESHARED_EXPORT BlockSaver : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @details Constructing a saver
+     * @param parent The Qt parent pointer.
+     */
+    explicit BlockSaver(QObject *parent = 0);
+
+    /**
+     * @details Pending snapshots are written before the saver is destroyed.
+     */
+    ~BlockSaver();
+
+    /**
+     * @details Start writing a block definition.
+     * When the file is written signalSaved() is emitted.
+     * @param snapshot The block data to write (eg. from Block::snapshot())
+     * @param filePath The path of the file to write
+     */
+    void save(const BlockData &snapshot, const QString &filePath);
+
+    /**
+     * @return True if there are snapshots not written yet
+     */
+    bool isRunning();
+
+    /**
+     * @details Blocking until all pending snapshots are written.
+     */
+    void waitForFinished();
+
+    /**
+     * @details Checking if the content of a file is the content that has been written last by this saver
+     * (eg. to ignore file system notifications caused by saving).
+     * @param filePath The path of the file
+     * @param content The current content of the file
+     * @return True if the saver has written exactly this content to the file
+     */
+    bool isWrittenContent(const QString &filePath, const QByteArray &content);
+
+signals:
+
+    /**
+     * @details Is emitted (from the worker thread) when a file has been written.
+     * @param filePath The path of the written file
+     * @param success True if the file has been written completely
+     * @param errorString A description of the error if writing failed
+     */
+    void signalSaved(QString filePath, bool success, QString errorString);
+
+private:
+    friend class BlockSaverJob;
+    bool takeSnapshot(const QString &filePath, BlockData *snapshot);
+    void setWrittenContent(const QString &filePath, const QByteArray &content);
+
+    QThreadPool *threadPool;
+    QMutex pendingMutex;
+    QHash<QString, BlockData> pendingSnapshots;
+    QHash<QString, QByteArray> writtenContentHashes;    // guarded by pendingMutex
+};
+
+} // namespace libblockdia
+
+#endif // BLOCKSAVER_H
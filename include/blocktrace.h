@@ -0,0 +1,121 @@
+#ifndef BLOCKTRACE_H
+#define BLOCKTRACE_H
+
+#include "libglobals.h"
+
+#include <QIODevice>
+#include <QString>
+
+namespace libblockdia {
+
+/**
+ * @brief Recording the duration of scoped trace points for performance analysis.
+ *
+ * Trace points are placed with BLOCKDIA_TRACE_SCOPE("Class::method") at the top of a scope.
+ * They are compiled out completely, unless the library is built with BLOCKDIA_TRACING defined
+ * (qmake "CONFIG+=blockdia_tracing" or "./make.py build --tracing").
+ * Even when compiled in, nothing is recorded until tracing is enabled with setEnabled().
+ *
+ * Every thread records into its own buffer, so recording does not need any lock.
+ * The events of finished threads are kept until clear() frees their buffers,
+ * the size of every buffer is limited to TRACE_MAX_EVENTS_PER_THREAD events (further events are dropped).
+ *
+ * The recorded events can be exported in the Chrome trace-event format (see writeChromeTrace()),
+ * which can be loaded into trace viewers like chrome://tracing, Perfetto or Speedscope.
+ */
+class LIBBLOCKDIACORESHARED_EXPORT BlockTrace
+{
+public:
+
+    /**
+     * @return True if the core library was built with BLOCKDIA_TRACING (trace points are compiled in)
+     */
+    static bool isAvailable();
+
+    /**
+     * @details Starting or stopping the recording of trace points (disabled by default).
+     * @param enabled True to record trace points
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * @return True if trace points are recorded
+     */
+    static bool isEnabled();
+
+    /**
+     * @details Discarding all events that were recorded until now.
+     * This is safe while other threads record:
+     * the buffers of finished threads are freed at once,
+     * every other thread starts over with an empty buffer on its next event.
+     */
+    static void clear();
+
+    /**
+     * @return The number of recorded events (since the last clear())
+     */
+    static int countEvents();
+
+    /**
+     * @return The number of events that were dropped because a buffer was full
+     */
+    static int countDroppedEvents();
+
+    /**
+     * @details Writing all recorded events in the Chrome trace-event JSON format.
+     * The events are streamed, so large traces do not need to fit into memory twice.
+     * Recording should be disabled while exporting, events that are recorded during the export may be missing.
+     * @param dev The device to write to (eg. QFile)
+     * @return True on success
+     */
+    static bool writeChromeTrace(QIODevice *dev);
+
+    /**
+     * @details Recording a finished trace point (called by BlockTraceScope).
+     * @param name The name of the trace point (must be a string literal, it is not copied)
+     * @param startNs The start time from now() in nanoseconds
+     * @param endNs The end time from now() in nanoseconds
+     */
+    static void record(const char *name, qint64 startNs, qint64 endNs);
+
+    /**
+     * @return A monotonic timestamp in nanoseconds (relative to the first use of the trace)
+     */
+    static qint64 now();
+};
+
+/**
+ * @brief Recording the lifetime of a scope (use BLOCKDIA_TRACE_SCOPE instead of using it directly).
+ */
+class BlockTraceScope
+{
+public:
+    explicit BlockTraceScope(const char *name)
+    {
+        this->name = BlockTrace::isEnabled() ? name : Q_NULLPTR;
+        this->startNs = (this->name) ? BlockTrace::now() : 0;
+    }
+
+    ~BlockTraceScope()
+    {
+        if (this->name) BlockTrace::record(this->name, this->startNs, BlockTrace::now());
+    }
+
+private:
+    Q_DISABLE_COPY(BlockTraceScope)
+    const char *name;
+    qint64 startNs;
+};
+
+} // namespace libblockdia
+
+// trace points (compiled out unless BLOCKDIA_TRACING is defined)
+#define BLOCKDIA_TRACE_CONCAT_(a, b) a##b
+#define BLOCKDIA_TRACE_CONCAT(a, b) BLOCKDIA_TRACE_CONCAT_(a, b)
+#if defined(BLOCKDIA_TRACING)
+#  define BLOCKDIA_TRACE_SCOPE(name) libblockdia::BlockTraceScope BLOCKDIA_TRACE_CONCAT(blockdiaTraceScope, __LINE__)(name)
+#else
+#  define BLOCKDIA_TRACE_SCOPE(name) do {} while (0)
+#endif
+
+#endif // BLOCKTRACE_H
@@ -1,6 +1,8 @@
 #ifndef DIALOGEDITHEADER_H
 #define DIALOGEDITHEADER_H
 
+#include "libglobals.h"
+
 #include <QDialog>
 #include <QLineEdit>
 #include <QColor>
@@ -10,12 +12,19 @@
 
 namespace libblockdia {
 
-class DialogEditHeader : public QDialog
+class LIBBLOCKDIASHARED_EXPORT DialogEditHeader : public QDialog
 {
     Q_OBJECT
 public:
     explicit DialogEditHeader(Block *block, QWidget *parent = nullptr);
 
+    /**
+     * @details Filling the fields from plain data, as if they were entered by the user
+     * (eg. to replay a recorded edit). The block is changed when the dialog is accepted.
+     * @param data The plain block data (only the header is used)
+     */
+    void loadData(const BlockData &data);
+
 signals:
 
 public slots:
@@ -1,6 +1,8 @@
 #ifndef DIALOGEDITINPUT_H
 #define DIALOGEDITINPUT_H
 
+#include "libglobals.h"
+
 #include <QDialog>
 #include <QLineEdit>
 
@@ -8,12 +10,18 @@
 
 namespace libblockdia {
 
-class DialogEditInput : public QDialog
+class LIBBLOCKDIASHARED_EXPORT DialogEditInput : public QDialog
 {
     Q_OBJECT
 public:
     explicit DialogEditInput(BlockInput *input, QWidget *parent = nullptr);
 
+    /**
+     * @details Filling the name field, as if it was entered by the user (eg. to replay a recorded edit).
+     * @param name The name of the input
+     */
+    void loadName(const QString &name);
+
 signals:
 
 public slots:
@@ -1,6 +1,8 @@
 #ifndef DIALOGEDITOUTPUT_H
 #define DIALOGEDITOUTPUT_H
 
+#include "libglobals.h"
+
 #include <QDialog>
 #include <QLineEdit>
 
@@ -8,12 +10,18 @@
 
 namespace libblockdia {
 
-class DialogEditOutput : public QDialog
+class LIBBLOCKDIASHARED_EXPORT DialogEditOutput : public QDialog
 {
     Q_OBJECT
 public:
     explicit DialogEditOutput(BlockOutput *output, QWidget *parent = nullptr);
 
+    /**
+     * @details Filling the name field, as if it was entered by the user (eg. to replay a recorded edit).
+     * @param name The name of the output
+     */
+    void loadName(const QString &name);
+
 signals:
 
 public slots:
@@ -0,0 +1,69 @@
+#ifndef DIALOGEDITPARAMETERARRAY_H
+#define DIALOGEDITPARAMETERARRAY_H
+
+#include "libglobals.h"
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QTableView>
+#include <QLabel>
+
+#include <blockparameterarray.h>
+
+namespace libblockdia {
+
+// forward declarations
+class DialogEditParameterArrayModel;
+
+/**
+ * @brief Editing an array parameter.
+ *
+ * The default elements are shown in a table that only creates the visible cells,
+ * so tables with hundreds of thousands of elements can be edited.
+ * Elements can be pasted from the clipboard (separated by spaces, commas, semicolons or line breaks).
+ */
+class LIBBLOCKDIASHARED_EXPORT DialogEditParameterArray : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit DialogEditParameterArray(BlockParameterArray *param, QWidget *parent = nullptr);
+
+    /**
+     * @details Filling the fields from plain data, as if they were entered by the user
+     * (eg. to replay a recorded edit). The parameter is changed when the dialog is accepted.
+     * @param data The plain parameter data
+     */
+    void loadData(const BlockParameterData &data);
+
+signals:
+
+public slots:
+
+private:
+    BlockParameterArray *param;
+    QLineEdit lineEditName;
+    QCheckBox checkPublic;
+    QComboBox comboElementType;
+    QLineEdit lineEditMin;
+    QLineEdit lineEditMax;
+    QSpinBox spinSize;
+    QTableView tableElements;
+    QLabel labelStatus;
+    DialogEditParameterArrayModel *model;
+
+    void loadElements(const QVector<double> &values);
+
+private slots:
+    void slotWriteData();
+    void slotElementTypeChanged(int index);
+    void slotSizeChanged(int size);
+    void slotPaste();
+};
+
+} // namespace libblockdia
+
+
+#endif // DIALOGEDITPARAMETERARRAY_H
@@ -1,6 +1,8 @@
 #ifndef DIALOGEDITPARAMETERENUM_H
 #define DIALOGEDITPARAMETERENUM_H
 
+#include "libglobals.h"
+
 #include <QDialog>
 #include <QLineEdit>
 #include <QCheckBox>
@@ -10,12 +12,19 @@
 
 namespace libblockdia {
 
-class DialogEditParameterEnum : public QDialog
+class LIBBLOCKDIASHARED_EXPORT DialogEditParameterEnum : public QDialog
 {
     Q_OBJECT
 public:
     explicit DialogEditParameterEnum(BlockParameterEnum *param, QWidget *parent = nullptr);
 
+    /**
+     * @details Filling the fields from plain data, as if they were entered by the user
+     * (eg. to replay a recorded edit). The parameter is changed when the dialog is accepted.
+     * @param data The plain parameter data
+     */
+    void loadData(const BlockParameterData &data);
+
 signals:
 
 public slots:
@@ -25,6 +34,7 @@ private:
     QLineEdit lineEditName;
     QCheckBox checkPublic;
     QLineEdit lineEditDefault;
+    QLineEdit lineEditExpression;
     QPlainTextEdit textEditEnumItems;
 
 private slots:
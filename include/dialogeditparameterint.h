@@ -1,6 +1,8 @@
 #ifndef DIALOGEDITPARAMETERINT_H
 #define DIALOGEDITPARAMETERINT_H
 
+#include "libglobals.h"
+
 #include <QDialog>
 #include <QLineEdit>
 #include <QCheckBox>
@@ -9,12 +11,19 @@
 
 namespace libblockdia {
 
-class DialogEditParameterInt : public QDialog
+class LIBBLOCKDIASHARED_EXPORT DialogEditParameterInt : public QDialog
 {
     Q_OBJECT
 public:
     explicit DialogEditParameterInt(BlockParameterInt *param, QWidget *parent = nullptr);
 
+    /**
+     * @details Filling the fields from plain data, as if they were entered by the user
+     * (eg. to replay a recorded edit). The parameter is changed when the dialog is accepted.
+     * @param data The plain parameter data
+     */
+    void loadData(const BlockParameterData &data);
+
 signals:
 
 public slots:
@@ -26,6 +35,7 @@ private:
     QLineEdit lineEditMin;
     QLineEdit lineEditMax;
     QLineEdit lineEditDefault;
+    QLineEdit lineEditExpression;
 
 private slots:
     void slotWriteData();
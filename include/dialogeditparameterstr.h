@@ -1,6 +1,8 @@
 #ifndef DIALOGEDITPARAMETERSTR_H
 #define DIALOGEDITPARAMETERSTR_H
 
+#include "libglobals.h"
+
 #include <QDialog>
 #include <QLineEdit>
 #include <QCheckBox>
@@ -9,12 +11,19 @@
 
 namespace libblockdia {
 
-class DialogEditParameterStr : public QDialog
+class LIBBLOCKDIASHARED_EXPORT DialogEditParameterStr : public QDialog
 {
     Q_OBJECT
 public:
     explicit DialogEditParameterStr(BlockParameterStr *param, QWidget *parent = nullptr);
 
+    /**
+     * @details Filling the fields from plain data, as if they were entered by the user
+     * (eg. to replay a recorded edit). The parameter is changed when the dialog is accepted.
+     * @param data The plain parameter data
+     */
+    void loadData(const BlockParameterData &data);
+
 signals:
 
 public slots:
@@ -5,6 +5,7 @@
 
 #include <QObject>
 #include <QGraphicsItem>
+#include <QGraphicsObject>
 #include <QRectF>
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
@@ -17,6 +18,8 @@
 #include <QMenu>
 #include <QGraphicsSceneContextMenuEvent>
 
+#include <block.h>
+#include <blocklayout.h>
 #include <graphicitemblockheader.h>
 #include <graphicitemtextbox.h>
 #include <graphicitemparameter.h>
@@ -32,17 +35,50 @@ class GraphicItemParameter;
 class GraphicItemInput;
 class GraphicItemOutput;
 
-class LIBBLOCKDIASHARED_EXPORT GraphicItemBlock : public QGraphicsItem
+/**
+ * @brief The graphical representation of a Block
+ *
+ * Blocks do not create any graphics on their own,
+ * a view creates a GraphicItemBlock for every block it shows.
+ * The geometry is calculated by BlockLayout (same as offscreen renderings).
+ * The item follows the changes of the block (Block::signalDataChanged())
+ * and removes itself when the block is destroyed.
+ */
+class LIBBLOCKDIASHARED_EXPORT GraphicItemBlock : public QGraphicsObject
 {
+    Q_OBJECT
+
 public:
     explicit GraphicItemBlock(Block *block, QGraphicsItem *parent=Q_NULLPTR);
     QRectF boundingRect() const;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
     QMenu *contextMenu();
 
+    /**
+     * @details Accounting the memory of the item and all its child items (see BlockMemory).
+     * The block itself is not accounted (see Block::addMemoryUsage()).
+     * @param usage The accounting to add the memory to
+     */
+    void addMemoryUsage(BlockMemory *usage) const;
+
+signals:
+    /**
+     * @details Emitted after the child items have been layouted again (see updateData()).
+     */
+    void signalLayoutChanged();
+
+    /**
+     * @details Emitted after an action of the context menu has been executed (eg. an edit dialog was closed).
+     * Adding and deleting children changes the block delayed (see Block::signalDataChanged()).
+     */
+    void signalEdited();
+
 public slots:
     void updateData();
 
+private slots:
+    void slotBlockDestroyed();
+
 private:
     void hoverEnterEvent(QGraphicsSceneHoverEvent *e);
     void hoverLeaveEvent(QGraphicsSceneHoverEvent *e);
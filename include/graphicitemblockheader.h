@@ -12,6 +12,7 @@
 
 #include <block.h>
 #include <graphicitemtextbox.h>
+#include <blocklayout.h>
 
 
 namespace libblockdia {
@@ -54,6 +55,12 @@ public:
      */
     void setMinWidth(qreal minWidth);
 
+    /**
+     * @details Accounting the memory of the header and its texts (see BlockMemory).
+     * @param usage The accounting to add the memory to
+     */
+    void addMemoryUsage(BlockMemory *usage) const;
+
 
 private:
 
@@ -62,28 +69,8 @@ private:
 
     // storing status
     Block *_block;
-    QRectF currentBoundingRect;
     qreal minWidth;
-    qreal paddingH;
-    qreal paddingV;
-    QFont fontInstanceName;
-    QFont fontTypeName;
-    QFont fontId;
-
-    // instance name
-    QString textInstanceName;
-    qreal xInstanceName;
-    qreal yInstanceName;
-
-    // type name
-    QString textTypeName;
-    qreal xTypeName;
-    qreal yTypeName;
-
-    // id
-    QString textIds;
-    qreal xIds;
-    qreal yIds;
+    BlockLayout::Header header;
 
 };
 
@@ -9,10 +9,15 @@
 #include <QFont>
 #include <QFontMetrics>
 
+#include <blocklayout.h>
+#include <blockmemory.h>
+
 namespace libblockdia {
 
 /**
  * @brief A rectangle containing a text inside.
+ *
+ * The box is calculated and painted by BlockLayout.
  */
 class LIBBLOCKDIASHARED_EXPORT GraphicItemTextBox : public QGraphicsItem
 {
@@ -23,7 +28,7 @@ public:
     /**
      * @brief Text alignement within the rectable.
      */
-    enum struct Align {Center, Left, Right};
+    typedef BlockLayout::Align Align;
 
     /**
      * @param parent The QGraphicsItem parent object.
@@ -73,6 +78,12 @@ public:
      */
     bool isMouseHovered();
 
+    /**
+     * @details Accounting the memory of the item and its text (see BlockMemory).
+     * @param usage The accounting to add the memory to
+     */
+    virtual void addMemoryUsage(BlockMemory *usage) const;
+
     /**
      * @details Define if the mouse hover effect shall be shown
      */
@@ -87,14 +98,7 @@ private:
     void hoverEnterEvent(QGraphicsSceneHoverEvent *event);
     void hoverLeaveEvent(QGraphicsSceneHoverEvent *event);
 
-    QColor bgColor;
-    QString text;
-    QFont font;
-    int padding;
-    Align algn;
-    QRectF currentBoundingRect;
-    qreal _actualNeededWidth;
-    qreal _actaulNeededHeight;
+    BlockLayout::TextBox box;
     qreal minWidth;
     bool _isMouseHovered;
 };
@@ -12,6 +12,8 @@
  * Blocks can be connected together by their Input and Output objects.
  *
  * The library contains graphic views and edit widgets to show and edit blocks and block diagrams.
+ * The data classes are part of the core library (see libblockdiacore.h),
+ * that can be used without QtWidgets.
  *
  * The Block data hierarchy looks like this:
  * @image html BlockHierarchy.svg "Block data hierarchy" width=200px
@@ -22,17 +24,13 @@ namespace libblockdia {
 }
 
 
-// block data classes
-#include <blockinput.h>
-#include <blockoutput.h>
-#include <blockparameter.h>
-#include <blockparameterint.h>
-#include <blockparameterstr.h>
-#include <blockparameterenum.h>
-#include <block.h>
+// block data classes (core library)
+#include <libblockdiacore.h>
 
 // block graphic classes
 #include <viewblock.h>
 #include <viewblockeditor.h>
+#include <blocklayout.h>
+#include <blockrenderer.h>
 
 #endif // LIBBLOCKDIA_H
@@ -0,0 +1,40 @@
+#ifndef LIBBLOCKDIACORE_H
+#define LIBBLOCKDIACORE_H
+
+// this can be used as central include file for users of the core library
+
+/**
+ * @brief The core of libblockdia: block data model and IO
+ *
+ * The core library contains the Block data classes,
+ * parsing and exporting of block definitions and block libraries.
+ * It does not depend on QtWidgets and does not create any graphic objects,
+ * so it can be used by command line tools and servers.
+ *
+ * Graphic items, views and edit dialogs are part of the gui library (see libblockdia.h).
+ */
+
+// block data classes
+#include <blockinput.h>
+#include <blockoutput.h>
+#include <blockparameter.h>
+#include <blockparameterint.h>
+#include <blockparameterstr.h>
+#include <blockparameterenum.h>
+#include <blockparameterarray.h>
+#include <blockparametervalue.h>
+#include <blockdata.h>
+#include <block.h>
+#include <blocklibraryindex.h>
+#include <blocklibraryloader.h>
+#include <blocklibrarypack.h>
+#include <blockdefwriter.h>
+#include <blocksaver.h>
+#include <blockjournal.h>
+#include <blockgenerator.h>
+#include <blocktrace.h>
+#include <blockmemory.h>
+#include <blockexpression.h>
+#include <blockexpressiongraph.h>
+
+#endif // LIBBLOCKDIACORE_H
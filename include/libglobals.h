@@ -2,6 +2,15 @@
 #define LIBBLOCKDIA_GLOBALS_H
 
 #include <QtCore/qglobal.h>
+
+// the core library (block model and IO)
+#if defined(LIBBLOCKDIACORE_LIBRARY)
+#  define LIBBLOCKDIACORESHARED_EXPORT Q_DECL_EXPORT
+#else
+#  define LIBBLOCKDIACORESHARED_EXPORT Q_DECL_IMPORT
+#endif
+
+// the gui library (graphic items, views and dialogs)
 #if defined(LIBBLOCKDIA_LIBRARY)
 #  define LIBBLOCKDIASHARED_EXPORT Q_DECL_EXPORT
 #else
@@ -7,24 +7,85 @@
 #include <QObject>
 #include <QGraphicsView>
 #include <QWheelEvent>
+#include <QPaintEvent>
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QVector>
 
 namespace libblockdia {
 
+// forward declarations
+class GraphicItemBlock;
+
 class LIBBLOCKDIASHARED_EXPORT ViewBlockEditor : public QGraphicsView
 {
     Q_OBJECT
 public:
     explicit ViewBlockEditor(Block *block, QWidget *parent = 0);
     Block *block();
+    GraphicItemBlock *graphicItem();
+
+    /**
+     * @details Showing a performance overlay (HUD) in the top left corner of the view.
+     *
+     * The overlay shows the paint time of the last frame (with average and maximum),
+     * the number of items within the painted region, the relayouts of the block per second,
+     * the level of detail of the current zoom and a rolling histogram of the last frame times.
+     * Painting the overlay itself is not included in the frame times.
+     *
+     * @param visible True to show the overlay
+     */
+    void setHudVisible(bool visible);
+
+    /**
+     * @return True if the performance overlay is shown
+     */
+    bool isHudVisible();
+
+    /**
+     * @details The level of detail bucket of a zoom level.
+     * @param levelOfDetail The level of detail (see QStyleOptionGraphicsItem::levelOfDetailFromTransform())
+     * @return The name of the bucket ("overview", "low", "normal" or "high")
+     */
+    static QString levelOfDetailBucket(qreal levelOfDetail);
 
 
 signals:
 
+    /**
+     * @details Emitted when the view has been zoomed (see zoom()).
+     * @param factor The relative zoom factor
+     */
+    void signalZoomed(qreal factor);
+
 public slots:
 
+    /**
+     * @details Zooming the view relative to the current zoom (as CTRL + mouse wheel).
+     * @param factor The relative zoom factor (eg. 1.07 to zoom in)
+     */
+    void zoom(qreal factor);
+
+private slots:
+    void slotLayoutChanged();
+
 private:
     void wheelEvent(QWheelEvent *e);
+    void paintEvent(QPaintEvent *e);
+    void scrollContentsBy(int dx, int dy);
+    void paintHud(QPainter *painter, int countItems);
+    QRect hudRect();
     Block *_block;
+    GraphicItemBlock *_graphicItem;
+
+    // performance overlay
+    bool hudVisible;
+    bool hudRepaintPending;
+    QVector<qint64> hudFrameTimes;  // ring buffer of paint times in nanoseconds
+    int hudFrameIndex;
+    int hudFrameCount;
+    QElapsedTimer hudClock;
+    QQueue<qint64> hudLayoutTimes;  // times of the relayouts within the last second
     QGraphicsItem *giTest;
     int testCounter;
 };
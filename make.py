@@ -64,15 +64,56 @@ def make_doc(args):
 def make_build(args):
 
     # call qmake
+    cmd = [QMAKE, "subdirs.pro"]
     if args.debug:
-        subprocess.run([QMAKE, "subdirs.pro", "CONFIG+=debug"])
-    else:
-        subprocess.run([QMAKE, "subdirs.pro"])
+        cmd.append("CONFIG+=debug")
+    if args.tracing:
+        cmd.append("CONFIG+=blockdia_tracing")
+    subprocess.run(cmd)
 
     # make
     subprocess.run(["make"])
 
 
+def make_bench(args):
+
+    # benchmark executables (gui benchmarks run without display)
+    benchmarks = []
+    benchmarks.append(["bench_libblockdia"])
+    benchmarks.append(["bench_libblockdiagui", "-platform", "offscreen"])
+
+    # output directory
+    dir_results = os.path.abspath(args.output)
+    if not os.path.isdir(dir_results):
+        os.makedirs(dir_results)
+
+    # run all benchmarks
+    # QtTest writes machine-readable results directly (-o file,format)
+    for bench in benchmarks:
+        cmd = [os.path.join(PROJECTDIR, "bin", bench[0])] + bench[1:]
+        cmd += ["-o", os.path.join(dir_results, bench[0] + "." + args.format) + "," + args.format]
+        cmd += ["-o", "-,txt"]
+        if args.iterations:
+            cmd += ["-iterations", str(args.iterations)]
+        subprocess.run(cmd)
+
+
+def make_test(args):
+
+    # test executables
+    tests = []
+    tests.append(["test_libblockdiacore"])
+
+    # run all tests, the exit code tells if any test failed
+    failed = False
+    for test in tests:
+        cmd = [os.path.join(PROJECTDIR, "bin", test[0])] + test[1:]
+        if subprocess.run(cmd).returncode != 0:
+            failed = True
+    if failed:
+        exit(1)
+
+
 def make_all(args):
     raise NotImplementedError("To Be Done :-|")
 
@@ -122,9 +163,21 @@ parser_doc.set_defaults(func=make_doc)
 # make build
 parser_build = subparsers.add_parser('build', help='build')
 parser_build.add_argument('--debug', action='store_true', help='build debug instead of release version')
+parser_build.add_argument('--tracing', action='store_true', help='compile in the trace points (see blocktrace.h)')
 #parser_build.add_argument('--run',   action='store_true', help='run the application after build')
 parser_build.set_defaults(func=make_build)
 
+# make bench
+parser_bench = subparsers.add_parser('bench', help='run the benchmarks (needs a build)')
+parser_bench.add_argument('--output', default=os.path.join(PROJECTDIR, "build", "bench"), help='directory of the result files (default: build/bench)')
+parser_bench.add_argument('--format', default='xml', choices=['xml', 'csv', 'junitxml', 'tap'], help='format of the result files (default: xml)')
+parser_bench.add_argument('--iterations', type=int, help='fixed number of iterations per benchmark')
+parser_bench.set_defaults(func=make_bench)
+
+# make test
+parser_test = subparsers.add_parser('test', help='run the unit tests (needs a build)')
+parser_test.set_defaults(func=make_test)
+
 # make all
 parser_all = subparsers.add_parser('all', help='build all versions and documentation')
 parser_all.set_defaults(func=make_all)
@@ -0,0 +1,446 @@
+#include <QtTest>
+#include <QBuffer>
+#include <limits.h>
+
+#include <libblockdiacore.h>
+
+#include "benchfixtures.h"
+
+using namespace libblockdia;
+using namespace BenchFixtures;
+
+/**
+ * @brief Benchmarks of the libblockdia serialization formats.
+ *
+ * Run with "bench_libblockdia" (or "bench_libblockdia -iterations 1000" for stable numbers).
+ * Every benchmark is executed for a small, medium and large block definition.
+ * Machine-readable results are written with the QtTest output options
+ * (eg. "bench_libblockdia -o results.xml,xml", see also "./make.py bench").
+ */
+class BenchLibBlockDia : public QObject
+{
+    Q_OBJECT
+
+private:
+
+    static QByteArray toXml(const BlockData &data)
+    {
+        Block *block = Block::importBlockData(data);
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        block->exportBlockDef(&buffer);
+        delete block;
+        return buffer.data();
+    }
+
+    static QByteArray toCbor(const BlockData &data)
+    {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        data.exportBlockDefCbor(&buffer);
+        return buffer.data();
+    }
+
+    static BlockData createExpressionData(int countParameters, bool chain)
+    {
+        // "param0" is set by the user, every other parameter depends on
+        // its predecessor (chain) or on "param0" directly (fan)
+        BlockData data;
+        data.typeId = "EXPR";
+        data.instanceId = "E1";
+        BlockParameterData param;
+        param.type = "int";
+        param.minimum = INT_MIN;
+        param.maximum = INT_MAX;
+        param.defaultValue = "0";
+        param.value = "0";
+        for (int i=0; i < countParameters; ++i) {
+            param.name = QString("param%1").arg(i);
+            if (i > 0) param.expression = QString("param%1 + 1").arg(chain ? i - 1 : 0);
+            data.parameters.append(param);
+        }
+        return data;
+    }
+
+    static QList<Block *> createIntBlocks(int countBlocks, int countParameters)
+    {
+        // independent blocks with integer parameters in the range 0..1000
+        QList<Block *> blocks;
+        BlockData data;
+        data.typeId = "INT";
+        BlockParameterData param;
+        param.type = "int";
+        param.minimum = 0;
+        param.maximum = 1000;
+        param.defaultValue = "0";
+        param.value = "0";
+        for (int i=0; i < countParameters; ++i) {
+            param.name = QString("param%1").arg(i);
+            data.parameters.append(param);
+        }
+        for (int i=0; i < countBlocks; ++i) {
+            data.instanceId = QString("I%1").arg(i);
+            blocks.append(Block::importBlockData(data));
+        }
+        return blocks;
+    }
+
+private slots:
+
+    void parseBlock_data() { addSizes(); }
+    void parseBlock()
+    {
+        QFETCH(int, countElements);
+        QByteArray xml = toXml(createBlockData(countElements));
+
+        QBENCHMARK {
+            QBuffer buffer(&xml);
+            buffer.open(QIODevice::ReadOnly);
+            delete Block::parseBlockDef(&buffer);
+        }
+    }
+
+    void parseBlockLazy_data() { addSizes(); }
+    void parseBlockLazy()
+    {
+        QFETCH(int, countElements);
+        QByteArray xml = toXml(createBlockData(countElements));
+
+        QBENCHMARK {
+            QBuffer buffer(&xml);
+            buffer.open(QIODevice::ReadOnly);
+            delete Block::parseBlockDef(&buffer, Q_NULLPTR, Block::ParseMode::Lazy);
+        }
+    }
+
+    void parseXml_data() { addSizes(); }
+    void parseXml()
+    {
+        QFETCH(int, countElements);
+        QByteArray xml = toXml(createBlockData(countElements));
+
+        QBENCHMARK {
+            BlockData data;
+            QBuffer buffer(&xml);
+            buffer.open(QIODevice::ReadOnly);
+            BlockData::parseBlockDef(&buffer, &data);
+        }
+    }
+
+    void parseCbor_data() { addSizes(); }
+    void parseCbor()
+    {
+        QFETCH(int, countElements);
+        QByteArray cbor = toCbor(createBlockData(countElements));
+
+        QBENCHMARK {
+            BlockData data;
+            QBuffer buffer(&cbor);
+            buffer.open(QIODevice::ReadOnly);
+            BlockData::parseBlockDefCbor(&buffer, &data);
+        }
+    }
+
+    void exportXml_data() { addSizes(); }
+    void exportXml()
+    {
+        QFETCH(int, countElements);
+        Block *block = Block::importBlockData(createBlockData(countElements));
+
+        QBENCHMARK {
+            QBuffer buffer;
+            buffer.open(QIODevice::WriteOnly);
+            block->exportBlockDef(&buffer);
+        }
+
+        delete block;
+    }
+
+    void exportXmlWriter_data()
+    {
+        QTest::addColumn<int>("countElements");
+        QTest::addColumn<bool>("autoFormatting");
+        QTest::newRow("small indented") << 5 << true;
+        QTest::newRow("small compact") << 5 << false;
+        QTest::newRow("medium indented") << 50 << true;
+        QTest::newRow("medium compact") << 50 << false;
+        QTest::newRow("large indented") << 500 << true;
+        QTest::newRow("large compact") << 500 << false;
+    }
+    void exportXmlWriter()
+    {
+        QFETCH(int, countElements);
+        QFETCH(bool, autoFormatting);
+        BlockData data = createBlockData(countElements);
+
+        // one writer for all iterations, as in a bulk export
+        BlockDefWriter writer;
+        writer.setAutoFormatting(autoFormatting);
+
+        QBENCHMARK {
+            writer.write(data);
+        }
+
+        QVERIFY(!writer.buffer().isEmpty());
+    }
+
+    void getParameter_data() { addSizes(); }
+    void getParameter()
+    {
+        QFETCH(int, countElements);
+        Block *block = Block::importBlockData(createBlockData(countElements));
+
+        // the last parameter is the worst case for a linear search
+        QString name = QString("param%1").arg(countElements - 1);
+        QVERIFY(block->getParameter(name) != Q_NULLPTR);
+
+        QBENCHMARK {
+            block->getParameter(name);
+        }
+
+        delete block;
+    }
+
+    void updateChildObjects_data() { addSizes(); }
+    void updateChildObjects()
+    {
+        QFETCH(int, countElements);
+        Block *block = Block::importBlockData(createBlockData(countElements));
+
+        // rescanning unchanged children (eg. after any child event)
+        QBENCHMARK {
+            QMetaObject::invokeMethod(block, "slotUpdateChildObjects", Qt::DirectConnection);
+        }
+
+        delete block;
+    }
+
+    void addChildObjects_data() { addSizes(); }
+    void addChildObjects()
+    {
+        QFETCH(int, countElements);
+
+        // adding N children and registering them at once
+        QBENCHMARK {
+            Block block;
+            for (int i=0; i < countElements; ++i) {
+                new BlockParameterStr(QString("param%1").arg(i), &block);
+                new BlockInput(QString("in%1").arg(i), &block);
+                new BlockOutput(QString("out%1").arg(i), &block);
+            }
+            QMetaObject::invokeMethod(&block, "slotUpdateChildObjects", Qt::DirectConnection);
+        }
+    }
+
+    void copyValuesString_data() { addSizes(); }
+    void copyValuesString()
+    {
+        QFETCH(int, countElements);
+        Block *source = Block::importBlockData(createBlockData(countElements));
+        Block *target = Block::importBlockData(createBlockData(countElements));
+        QList<BlockParameter *> sourceParams = source->getParameters();
+        QList<BlockParameter *> targetParams = target->getParameters();
+
+        // copying all parameter values through their string representation
+        QBENCHMARK {
+            for (int i=0; i < sourceParams.size(); ++i) targetParams.at(i)->setValue(sourceParams.at(i)->strValue());
+        }
+
+        delete source;
+        delete target;
+    }
+
+    void copyValuesTyped_data() { addSizes(); }
+    void copyValuesTyped()
+    {
+        QFETCH(int, countElements);
+        Block *source = Block::importBlockData(createBlockData(countElements));
+        Block *target = Block::importBlockData(createBlockData(countElements));
+        QList<BlockParameter *> sourceParams = source->getParameters();
+        QList<BlockParameter *> targetParams = target->getParameters();
+
+        // copying all parameter values without string conversion
+        QBENCHMARK {
+            for (int i=0; i < sourceParams.size(); ++i) targetParams.at(i)->setTypedValue(sourceParams.at(i)->typedValue());
+        }
+
+        delete source;
+        delete target;
+    }
+
+    void importLargeEnums_data()
+    {
+        QTest::addColumn<int>("countItems");
+        QTest::newRow("100 items") << 100;
+        QTest::newRow("1000 items") << 1000;
+        QTest::newRow("10000 items") << 10000;
+    }
+    void importLargeEnums()
+    {
+        QFETCH(int, countItems);
+
+        // ten enum parameters with the same (long) item list, selecting the last item
+        BlockData data;
+        data.typeId = "ENUMS";
+        BlockParameterData param;
+        param.type = "enum";
+        for (int i=0; i < countItems; ++i) param.enumItems << QString("channel%1").arg(i);
+        param.defaultValue = param.enumItems.last();
+        param.value = param.enumItems.last();
+        for (int i=0; i < 10; ++i) {
+            param.name = QString("param%1").arg(i);
+            data.parameters.append(param);
+        }
+
+        QBENCHMARK {
+            Block *block = Block::importBlockData(data);
+            block->getParameters();
+            delete block;
+        }
+    }
+
+    void parseArrays_data()
+    {
+        QTest::addColumn<int>("countElements");
+        QTest::newRow("1000 elements") << 1000;
+        QTest::newRow("100000 elements") << 100000;
+    }
+    void parseArrays()
+    {
+        QFETCH(int, countElements);
+
+        // a calibration table as double array (base64 encoded in the XML)
+        QVector<double> values(countElements);
+        for (int i=0; i < countElements; ++i) values[i] = 0.001 * i - 0.5;
+        BlockParameterArray encoder("encoder");
+        encoder.setValues(values);
+        BlockData data;
+        data.typeId = "CAL";
+        BlockParameterData param;
+        param.type = "array";
+        param.name = "coefficients";
+        param.elementType = "double";
+        param.elementMinimum = -1000;
+        param.elementMaximum = 1000;
+        param.defaultValue = encoder.strValue();
+        data.parameters.append(param);
+        QByteArray xml = toXml(data);
+
+        // decoding and range checking all elements
+        QBENCHMARK {
+            QBuffer buffer(&xml);
+            buffer.open(QIODevice::ReadOnly);
+            Block *block = Block::parseBlockDef(&buffer);
+            block->getParameters();
+            delete block;
+        }
+    }
+
+    void exportCbor_data() { addSizes(); }
+    void exportCbor()
+    {
+        QFETCH(int, countElements);
+        Block *block = Block::importBlockData(createBlockData(countElements));
+
+        QBENCHMARK {
+            QBuffer buffer;
+            buffer.open(QIODevice::WriteOnly);
+            block->exportBlockDefCbor(&buffer);
+        }
+
+        delete block;
+    }
+    void propagateExpressions_data()
+    {
+        QTest::addColumn<int>("countParameters");
+        QTest::addColumn<bool>("chain");
+        QTest::newRow("chain 1000") << 1000 << true;
+        QTest::newRow("chain 10000") << 10000 << true;
+        QTest::newRow("fan 1000") << 1000 << false;
+        QTest::newRow("fan 10000") << 10000 << false;
+    }
+    void propagateExpressions()
+    {
+        QFETCH(int, countParameters);
+        QFETCH(bool, chain);
+        Block *block = Block::importBlockData(createExpressionData(countParameters, chain));
+        BlockExpressionGraph graph;
+        graph.addBlock(block);
+        graph.recomputeAll();
+        BlockParameterInt *first = qobject_cast<BlockParameterInt *>(block->getParameter("param0"));
+
+        // changing the root value, every dependent parameter is evaluated once
+        int value = 0;
+        QBENCHMARK {
+            first->setValue(++value);
+        }
+        QCOMPARE(block->getParameter(QString("param%1").arg(countParameters - 1))->strValue(),
+                 QString::number(chain ? value + countParameters - 1 : value + 1));
+
+        delete block;
+    }
+
+    void rebuildExpressions_data() { propagateExpressions_data(); }
+    void rebuildExpressions()
+    {
+        QFETCH(int, countParameters);
+        QFETCH(bool, chain);
+        Block *block = Block::importBlockData(createExpressionData(countParameters, chain));
+        BlockExpressionGraph graph;
+        graph.addBlock(block);
+
+        // ordering, compiling (cached) and evaluating the whole graph
+        QBENCHMARK {
+            graph.recomputeAll();
+        }
+
+        delete block;
+    }
+
+    void setParameterValues_data()
+    {
+        QTest::addColumn<int>("countBlocks");
+        QTest::addColumn<bool>("batch");
+        QTest::newRow("single 100 x 1000") << 100 << false;
+        QTest::newRow("batch 100 x 1000") << 100 << true;
+        QTest::newRow("single 1000 x 100") << 1000 << false;
+        QTest::newRow("batch 1000 x 100") << 1000 << true;
+    }
+    void setParameterValues()
+    {
+        // 100k edits spread over the blocks, every second value is out of range
+        QFETCH(int, countBlocks);
+        QFETCH(bool, batch);
+        int countParameters = 100000 / countBlocks;
+        QList<Block *> blocks = createIntBlocks(countBlocks, countParameters);
+
+        // the parameters are resolved before, so both variants only measure setting the values
+        QVector<BlockParameterEdit> edits;
+        edits.reserve(countBlocks * countParameters);
+        for (int b=0; b < countBlocks; ++b) {
+            QList<BlockParameter *> params = blocks.at(b)->getParameters();
+            for (int p=0; p < countParameters; ++p) {
+                edits.append(BlockParameterEdit(blocks.at(b), params.at(p), BlockParameterValue()));
+            }
+        }
+
+        int value = 0;
+        QBENCHMARK {
+            value = (value % 1000) + 1;
+            if (batch) {
+                for (int i=0; i < edits.size(); ++i) edits[i].value = BlockParameterValue::fromInt(value + (i & 1) * 2000);
+                Block::applyParameterValues(edits);
+            } else {
+                for (int i=0; i < edits.size(); ++i) {
+                    ((BlockParameterInt *) edits.at(i).parameter)->setValue(value + (i & 1) * 2000);
+                }
+            }
+        }
+        QCOMPARE(blocks.last()->getParameter("param0")->strValue(), QString::number(value));
+
+        qDeleteAll(blocks);
+    }
+};
+
+QTEST_MAIN(BenchLibBlockDia)
+#include "bench_libblockdia.moc"
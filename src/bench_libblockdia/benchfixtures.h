@@ -0,0 +1,40 @@
+#ifndef BENCHFIXTURES_H
+#define BENCHFIXTURES_H
+
+#include <QtTest>
+
+#include <blockdata.h>
+#include <blockgenerator.h>
+
+/**
+ * @brief Block definitions used by the benchmarks.
+ */
+namespace BenchFixtures {
+
+/**
+ * @details Creating a block definition with a certain number of parameters, inputs and outputs.
+ * The data is generated deterministically (mixed parameter types, names "param<i>", "in<i>", "out<i>").
+ */
+inline libblockdia::BlockData createBlockData(int countElements)
+{
+    libblockdia::BlockGenerator generator;
+    generator.setParameterCount(countElements, countElements);
+    generator.setInputCount(countElements, countElements);
+    generator.setOutputCount(countElements, countElements);
+    return generator.generateBlock(0);
+}
+
+/**
+ * @details Adding the "countElements" column with a small, medium and large block.
+ */
+inline void addSizes()
+{
+    QTest::addColumn<int>("countElements");
+    QTest::newRow("small") << 5;
+    QTest::newRow("medium") << 50;
+    QTest::newRow("large") << 500;
+}
+
+} // namespace BenchFixtures
+
+#endif // BENCHFIXTURES_H
@@ -0,0 +1,118 @@
+#include <QtTest>
+#include <QGraphicsScene>
+#include <QImage>
+#include <QPainter>
+
+#include <libblockdia.h>
+#include <graphicitemblock.h>
+
+#include "../bench_libblockdia/benchfixtures.h"
+
+using namespace libblockdia;
+using namespace BenchFixtures;
+
+/**
+ * @brief Benchmarks of the libblockdia layout and painting.
+ *
+ * Run with "bench_libblockdiagui" (use "-platform offscreen" on machines without display).
+ * Machine-readable results are written with the QtTest output options
+ * (eg. "bench_libblockdiagui -o results.xml,xml", see also "./make.py bench").
+ */
+class BenchLibBlockDiaGui : public QObject
+{
+    Q_OBJECT
+
+private:
+
+    static void addImageSizes()
+    {
+        QTest::addColumn<int>("countElements");
+        QTest::addColumn<int>("imageSize");
+        QTest::newRow("small 128px") << 5 << 128;
+        QTest::newRow("small 1024px") << 5 << 1024;
+        QTest::newRow("medium 128px") << 50 << 128;
+        QTest::newRow("medium 1024px") << 50 << 1024;
+        QTest::newRow("large 1024px") << 500 << 1024;
+        QTest::newRow("large 4096px") << 500 << 4096;
+    }
+
+private slots:
+
+    void layout_data() { addSizes(); }
+    void layout()
+    {
+        QFETCH(int, countElements);
+        BlockData data = createBlockData(countElements);
+
+        QBENCHMARK {
+            BlockLayout layout(data);
+        }
+    }
+
+    void updateData_data() { addSizes(); }
+    void updateData()
+    {
+        QFETCH(int, countElements);
+        Block *block = Block::importBlockData(createBlockData(countElements));
+        GraphicItemBlock *item = new GraphicItemBlock(block);
+
+        QBENCHMARK {
+            item->updateData();
+        }
+
+        delete item;
+        delete block;
+    }
+
+    void paintScene_data() { addImageSizes(); }
+    void paintScene()
+    {
+        QFETCH(int, countElements);
+        QFETCH(int, imageSize);
+        Block *block = Block::importBlockData(createBlockData(countElements));
+        QGraphicsScene scene;
+        scene.addItem(new GraphicItemBlock(block));
+        QImage image(imageSize, imageSize, QImage::Format_ARGB32_Premultiplied);
+
+        QBENCHMARK {
+            image.fill(Qt::white);
+            QPainter painter(&image);
+            scene.render(&painter);
+        }
+
+        scene.clear();
+        delete block;
+    }
+
+    void paintLayout_data() { addImageSizes(); }
+    void paintLayout()
+    {
+        QFETCH(int, countElements);
+        QFETCH(int, imageSize);
+        BlockLayout layout(createBlockData(countElements));
+        QImage image(imageSize, imageSize, QImage::Format_ARGB32_Premultiplied);
+        qreal scale = imageSize / qMax(layout.boundingRect.width(), layout.boundingRect.height());
+
+        QBENCHMARK {
+            image.fill(Qt::white);
+            QPainter painter(&image);
+            painter.translate(imageSize / 2.0, imageSize / 2.0);
+            painter.scale(scale, scale);
+            layout.paint(&painter);
+        }
+    }
+
+    void renderImage_data() { addSizes(); }
+    void renderImage()
+    {
+        QFETCH(int, countElements);
+        BlockData data = createBlockData(countElements);
+
+        QBENCHMARK {
+            BlockRenderer::renderImage(data);
+        }
+    }
+};
+
+QTEST_MAIN(BenchLibBlockDiaGui)
+#include "bench_libblockdiagui.moc"
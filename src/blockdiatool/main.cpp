@@ -0,0 +1,359 @@
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QFontDatabase>
+#include <QCommandLineParser>
+#include <QScopedPointer>
+#include <QThreadPool>
+#include <QFileInfo>
+#include <QDir>
+#include <QDirIterator>
+#include <QVector>
+#include <QTextStream>
+
+#include <QFile>
+#include <QSaveFile>
+
+#include <blocklibrarypack.h>
+#include <blockgenerator.h>
+#include <blocktrace.h>
+
+#include "tooljob.h"
+
+// exit codes
+#define EXIT_OK         0
+#define EXIT_FAILED     1
+#define EXIT_USAGE      2
+
+using namespace libblockdia;
+
+/**
+ * @details Collecting all block definitions of the given paths.
+ * Directories are scanned recursively for block definitions (*.xml, *.cbor) and packs,
+ * packs are expanded to their entries.
+ * The (compressed) entries are read while the pack is open,
+ * so the jobs do not need to open the pack again.
+ */
+static QVector<ToolResult> collectInputs(const QStringList &paths)
+{
+    QVector<ToolResult> inputs;
+
+    for (const QString &path : paths) {
+        QFileInfo fi(path);
+        QStringList files;
+        QString basePath;
+
+        if (fi.isDir()) {
+            basePath = path;
+            QDirIterator it(path, QStringList() << "*.xml" << "*.cbor" << "*.bdpack", QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) files << it.next();
+            files.sort();
+        } else {
+            basePath = fi.path();
+            files << path;
+        }
+
+        for (const QString &file : files) {
+
+            // all entries of a pack
+            if (BlockLibraryPack::isPackFile(file)) {
+                BlockLibraryPack pack;
+                if (!pack.open(file)) {
+                    ToolResult r;
+                    r.inputPath = file;
+                    r.index = -1;
+                    r.success = false;
+                    r.error = QString("%1: cannot open pack").arg(file);
+                    inputs.append(r);
+                    continue;
+                }
+                QString packRelative = QFileInfo(QDir(basePath).relativeFilePath(file)).completeBaseName();
+                QList<BlockLibraryIndex::Entry> entries = pack.entries();
+                for (int i=0; i < entries.size(); ++i) {
+                    ToolResult r;
+                    r.inputPath = file + "/" + entries.at(i).filePath;
+                    r.relativePath = packRelative + "/" + entries.at(i).filePath;
+                    r.packedData = pack.compressedBlockDef(entries.at(i).filePath);
+                    r.index = -1;
+                    r.success = false;
+                    if (r.packedData.isEmpty()) r.error = QString("%1: cannot read pack entry").arg(r.inputPath);
+                    inputs.append(r);
+                }
+            }
+
+            // single file
+            else {
+                ToolResult r;
+                r.inputPath = file;
+                r.relativePath = QDir(basePath).relativeFilePath(file);
+                r.index = -1;
+                r.success = false;
+                inputs.append(r);
+            }
+        }
+    }
+
+    return inputs;
+}
+
+/**
+ * @details Parsing a range "min:max" or a single value "n".
+ */
+static bool parseRange(const QString &text, int *minimum, int *maximum)
+{
+    QStringList parts = text.split(':');
+    if (parts.size() > 2) return false;
+
+    bool ok1, ok2;
+    *minimum = parts.first().toInt(&ok1);
+    *maximum = parts.last().toInt(&ok2);
+    return ok1 && ok2 && *minimum >= 0 && *minimum <= *maximum;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication::setOrganizationName("Oinosseus");
+    QCoreApplication::setOrganizationDomain("https://github.com/Oinosseus/blockdia");
+    QCoreApplication::setApplicationName("blockdiatool");
+
+    // command line
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Batch processing of block definitions.\n\n"
+                                     "Commands:\n"
+                                     "  validate      Check block definitions\n"
+                                     "  convert       Convert block definitions (see --format)\n"
+                                     "  canonicalize  Rewrite block definitions in canonical XML and print their content hash\n"
+                                     "  render        Render block definitions into images (see --format)\n"
+                                     "  generate      Generate synthetic block definitions (and a process) into the output directory\n\n"
+                                     "Inputs can be block definitions (*.xml, *.cbor), packs (*.bdpack) or directories.\n"
+                                     "The generate command has no inputs, ranges are given as \"min:max\" or \"n\".");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "validate, convert, canonicalize, render or generate");
+    parser.addPositionalArgument("inputs", "Files, packs or directories", "<inputs...>");
+    QCommandLineOption optJobs(QStringList() << "j" << "jobs", "Number of parallel jobs (default: number of cores).", "count");
+    QCommandLineOption optOutput(QStringList() << "o" << "output", "Output directory (default: next to the input).", "dir");
+    QCommandLineOption optFormat(QStringList() << "f" << "format", "Output format of convert: xml (default) or cbor, of render: png (default) or svg.", "format");
+    QCommandLineOption optScale("scale", "Scale factor of rendered images (default: 1).", "factor", "1");
+    QCommandLineOption optCompact("compact", "Write XML without indentation.");
+    QCommandLineOption optQuiet(QStringList() << "q" << "quiet", "Only print errors.");
+    QCommandLineOption optSeed("seed", "Seed of generated data (default: 1).", "seed", "1");
+    QCommandLineOption optCount("count", "Number of generated block definitions (default: 100).", "count", "100");
+    QCommandLineOption optParameters("parameters", "Parameters per generated block (default: 5:20).", "range", "5:20");
+    QCommandLineOption optInputs("inputs", "Inputs per generated block (default: 1:5).", "range", "1:5");
+    QCommandLineOption optOutputs("outputs", "Outputs per generated block (default: 1:5).", "range", "1:5");
+    QCommandLineOption optEnumItems("enum-items", "Items per generated enum parameter (default: 2:10).", "range", "2:10");
+    QCommandLineOption optTypes("types", "Weights of generated parameter types int:str:enum (default: 1:1:1).", "weights", "1:1:1");
+    QCommandLineOption optTrace("trace", "Record trace points into a Chrome trace file (needs a build with tracing).", "file");
+    QCommandLineOption optProcess("process", "Also generate a process (process.xml) with this number of block instances.", "count");
+    parser.addOption(optJobs);
+    parser.addOption(optOutput);
+    parser.addOption(optFormat);
+    parser.addOption(optScale);
+    parser.addOption(optCompact);
+    parser.addOption(optQuiet);
+    parser.addOption(optSeed);
+    parser.addOption(optCount);
+    parser.addOption(optParameters);
+    parser.addOption(optInputs);
+    parser.addOption(optOutputs);
+    parser.addOption(optEnumItems);
+    parser.addOption(optTypes);
+    parser.addOption(optProcess);
+    parser.addOption(optTrace);
+
+    // only rendering needs fonts (started without a display)
+    QStringList arguments;
+    for (int i=0; i < argc; ++i) arguments << QString::fromLocal8Bit(argv[i]);
+    parser.parse(arguments);
+    bool needsGui = !parser.positionalArguments().isEmpty() && parser.positionalArguments().first() == "render";
+    if (needsGui && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QScopedPointer<QCoreApplication> app(needsGui ? new QGuiApplication(argc, argv) : new QCoreApplication(argc, argv));
+    parser.process(*app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    // options
+    QStringList positional = parser.positionalArguments();
+    bool isGenerate = !positional.isEmpty() && positional.first() == "generate";
+    if (positional.size() < (isGenerate ? 1 : 2)) {
+        err << parser.helpText();
+        return EXIT_USAGE;
+    }
+
+    ToolOptions options;
+    QString command = positional.takeFirst();
+    if (command == "validate") options.command = ToolOptions::Validate;
+    else if (command == "convert") options.command = ToolOptions::Convert;
+    else if (command == "canonicalize") options.command = ToolOptions::Canonicalize;
+    else if (command == "render") options.command = ToolOptions::Render;
+    else if (command == "generate") options.command = ToolOptions::Generate;
+    else {
+        err << "unknown command '" << command << "'\n";
+        return EXIT_USAGE;
+    }
+
+    QString format = parser.value(optFormat).toLower();
+    if (format.isEmpty()) format = (options.command == ToolOptions::Render) ? "png" : "xml";
+    if (format == "xml" && options.command != ToolOptions::Render) options.format = ToolOptions::Xml;
+    else if (format == "cbor" && options.command != ToolOptions::Render) options.format = ToolOptions::Cbor;
+    else if (format == "png" && options.command == ToolOptions::Render) options.format = ToolOptions::Png;
+    else if (format == "svg" && options.command == ToolOptions::Render) options.format = ToolOptions::Svg;
+    else {
+        err << "unknown format '" << format << "'\n";
+        return EXIT_USAGE;
+    }
+
+    bool ok;
+    options.scale = parser.value(optScale).toDouble(&ok);
+    if (!ok || options.scale <= 0) {
+        err << "invalid scale factor '" << parser.value(optScale) << "'\n";
+        return EXIT_USAGE;
+    }
+
+    options.compact = parser.isSet(optCompact);
+    options.outputDir = parser.value(optOutput);
+    bool quiet = parser.isSet(optQuiet);
+
+    // tracing
+    QString tracePath = parser.value(optTrace);
+    if (!tracePath.isEmpty()) {
+        if (!BlockTrace::isAvailable()) err << "tracing is not available in this build\n";
+        BlockTrace::setEnabled(true);
+    }
+
+    // generator settings
+    BlockGenerator generator;
+    options.generator = &generator;
+    int countGenerate = 0;
+    int countProcessBlocks = 0;
+    if (isGenerate) {
+        int minimum, maximum;
+        QStringList weights = parser.value(optTypes).split(':');
+        if (options.outputDir.isEmpty()) {
+            err << "an output directory is needed\n";
+            return EXIT_USAGE;
+        }
+        generator.setSeed(parser.value(optSeed).toUInt(&ok));
+        if (!ok) {
+            err << "invalid seed '" << parser.value(optSeed) << "'\n";
+            return EXIT_USAGE;
+        }
+        countGenerate = parser.value(optCount).toInt(&ok);
+        if (!ok || countGenerate < 1) {
+            err << "invalid count '" << parser.value(optCount) << "'\n";
+            return EXIT_USAGE;
+        }
+        if (parser.isSet(optProcess)) {
+            countProcessBlocks = parser.value(optProcess).toInt(&ok);
+            if (!ok || countProcessBlocks < 1) {
+                err << "invalid process size '" << parser.value(optProcess) << "'\n";
+                return EXIT_USAGE;
+            }
+        }
+        if (!parseRange(parser.value(optParameters), &minimum, &maximum)) {
+            err << "invalid range '" << parser.value(optParameters) << "'\n";
+            return EXIT_USAGE;
+        }
+        generator.setParameterCount(minimum, maximum);
+        if (!parseRange(parser.value(optInputs), &minimum, &maximum)) {
+            err << "invalid range '" << parser.value(optInputs) << "'\n";
+            return EXIT_USAGE;
+        }
+        generator.setInputCount(minimum, maximum);
+        if (!parseRange(parser.value(optOutputs), &minimum, &maximum)) {
+            err << "invalid range '" << parser.value(optOutputs) << "'\n";
+            return EXIT_USAGE;
+        }
+        generator.setOutputCount(minimum, maximum);
+        if (!parseRange(parser.value(optEnumItems), &minimum, &maximum)) {
+            err << "invalid range '" << parser.value(optEnumItems) << "'\n";
+            return EXIT_USAGE;
+        }
+        generator.setEnumItemCount(minimum, maximum);
+        if (weights.size() != 3) {
+            err << "invalid type weights '" << parser.value(optTypes) << "'\n";
+            return EXIT_USAGE;
+        }
+        generator.setParameterTypeWeights(weights.at(0).toInt(), weights.at(1).toInt(), weights.at(2).toInt());
+    }
+
+    QThreadPool pool;
+    if (parser.isSet(optJobs)) {
+        int jobs = parser.value(optJobs).toInt(&ok);
+        if (!ok || jobs < 1) {
+            err << "invalid job count '" << parser.value(optJobs) << "'\n";
+            return EXIT_USAGE;
+        }
+        pool.setMaxThreadCount(jobs);
+    }
+
+    // process all inputs in parallel
+    // (every job writes into its own result, the vector is not resized anymore)
+    // (without threaded font rendering, images are rendered in the main thread)
+    QVector<ToolResult> results;
+    if (isGenerate) {
+        QString suffix = (options.format == ToolOptions::Cbor) ? ".cbor" : ".xml";
+        results.resize(countGenerate);
+        for (int i=0; i < countGenerate; ++i) {
+            results[i].index = i;
+            results[i].inputPath = QString("gen.block%1").arg(i);
+            results[i].relativePath = QString("block%1%2").arg(i).arg(suffix);
+            results[i].success = false;
+        }
+    } else {
+        results = collectInputs(positional);
+    }
+    bool isThreaded = !needsGui || QFontDatabase::supportsThreadedFontRendering();
+    for (int i=0; i < results.size(); ++i) {
+        if (!results.at(i).error.isEmpty()) continue;
+        ToolJob *job = new ToolJob(options, &results[i]);
+        if (isThreaded) {
+            pool.start(job);
+        } else {
+            job->run();
+            delete job;
+        }
+    }
+
+    // the process is written while the block definitions are generated
+    int countProcessFailed = 0;
+    if (countProcessBlocks > 0) {
+        QDir().mkpath(options.outputDir);
+        QString processPath = QDir(options.outputDir).filePath("process.xml");
+        QSaveFile f(processPath);
+        if (f.open(QIODevice::WriteOnly) && generator.writeProcessDef(&f, countProcessBlocks, countGenerate) && f.commit()) {
+            if (!quiet) out << "process with " << countProcessBlocks << " blocks -> " << processPath << "\n";
+        } else {
+            err << processPath << ": " << f.errorString() << "\n";
+            countProcessFailed = 1;
+        }
+    }
+
+    pool.waitForDone();
+
+    // report in input order
+    int countFailed = countProcessFailed;
+    for (int i=0; i < results.size(); ++i) {
+        const ToolResult &r = results.at(i);
+        if (r.success) {
+            if (!quiet) out << r.message << "\n";
+        } else {
+            err << r.error << "\n";
+            ++countFailed;
+        }
+    }
+    out.flush();
+
+    // write trace
+    if (!tracePath.isEmpty()) {
+        BlockTrace::setEnabled(false);
+        QSaveFile f(tracePath);
+        if (!f.open(QIODevice::WriteOnly) || !BlockTrace::writeChromeTrace(&f) || !f.commit()) {
+            err << tracePath << ": " << f.errorString() << "\n";
+        }
+    }
+
+    if (countFailed > 0) err << countFailed << " of " << results.size() << " inputs failed\n";
+
+    return (countFailed > 0) ? EXIT_FAILED : EXIT_OK;
+}
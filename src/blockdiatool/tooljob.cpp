@@ -0,0 +1,238 @@
+#include "tooljob.h"
+
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QSet>
+#include <QScopedPointer>
+#include <QBuffer>
+
+#include <blocklibrarypack.h>
+#include <blockdefwriter.h>
+#include <blockparameterarray.h>
+#include <blockrenderer.h>
+
+using namespace libblockdia;
+
+#define CBOR_SUFFIX ".cbor"
+
+ToolJob::ToolJob(const ToolOptions &options, ToolResult *result)
+{
+    this->options = options;
+    this->result = result;
+}
+
+void ToolJob::run()
+{
+    this->result->success = false;
+
+    // generate block definition
+    if (this->options.command == ToolOptions::Generate) {
+        BlockData data = this->options.generator->generateBlock(this->result->index);
+        QString outPath = QDir(this->options.outputDir).filePath(this->result->relativePath);
+        if (this->write(data, this->options.format, outPath)) {
+            this->result->message = QString("%1 -> %2").arg(data.typeId, outPath);
+            this->result->success = true;
+        }
+        return;
+    }
+
+    // read input
+    BlockData data;
+    if (!this->read(&data)) return;
+
+    switch (this->options.command) {
+
+    case ToolOptions::Validate: {
+        QStringList problems = validate(data);
+        if (problems.isEmpty()) {
+            this->result->message = QString("OK    %1").arg(this->result->inputPath);
+            this->result->success = true;
+        } else {
+            this->result->error = QString("%1: %2").arg(this->result->inputPath, problems.join("; "));
+        }
+        break;
+    }
+
+    case ToolOptions::Convert: {
+        QString suffix = (this->options.format == ToolOptions::Cbor) ? CBOR_SUFFIX : ".xml";
+        QString outPath = outputPath(this->result->inputPath, this->result->relativePath, suffix, this->options.outputDir);
+        if (outPath.isEmpty()) {
+            this->result->error = QString("%1: an output directory is needed").arg(this->result->inputPath);
+        } else if (this->write(data, this->options.format, outPath)) {
+            this->result->message = QString("%1 -> %2").arg(this->result->inputPath, outPath);
+            this->result->success = true;
+        }
+        break;
+    }
+
+    case ToolOptions::Canonicalize: {
+        // the canonical form is always XML (in place when no output directory is given)
+        BlockData normalized = data.normalized();
+        QString outPath = outputPath(this->result->inputPath, this->result->relativePath, ".xml", this->options.outputDir);
+        if (outPath.isEmpty()) {
+            this->result->error = QString("%1: an output directory is needed").arg(this->result->inputPath);
+        } else if (this->write(normalized, ToolOptions::Xml, outPath)) {
+            this->result->message = QString("%1  %2").arg(QString::fromLatin1(normalized.contentHash().toHex()), outPath);
+            this->result->success = true;
+        }
+        break;
+    }
+
+    case ToolOptions::Render: {
+        QString suffix = (this->options.format == ToolOptions::Svg) ? ".svg" : ".png";
+        QString outPath = outputPath(this->result->inputPath, this->result->relativePath, suffix, this->options.outputDir);
+        QString error;
+        if (outPath.isEmpty()) {
+            this->result->error = QString("%1: an output directory is needed").arg(this->result->inputPath);
+        } else if (QDir().mkpath(QFileInfo(outPath).path()) && BlockRenderer::renderFile(data, outPath, this->options.scale, &error)) {
+            this->result->message = QString("%1 -> %2").arg(this->result->inputPath, outPath);
+            this->result->success = true;
+        } else {
+            this->result->error = QString("%1: %2").arg(outPath, error);
+        }
+        break;
+    }
+
+    case ToolOptions::Generate:
+        break;
+    }
+}
+
+QString ToolJob::outputPath(const QString &inputPath, const QString &relativePath, const QString &suffix, const QString &outputDir)
+{
+    // next to the input (not possible for block definitions in packs)
+    if (outputDir.isEmpty()) {
+        QString packFilePath, entryPath;
+        if (BlockLibraryPack::splitPackPath(inputPath, &packFilePath, &entryPath)) return QString();
+        QFileInfo fi(inputPath);
+        return fi.dir().filePath(fi.completeBaseName() + suffix);
+    }
+
+    // same relative structure within the output directory
+    QFileInfo fi(relativePath);
+    return QDir::cleanPath(QDir(outputDir).filePath(fi.path() + "/" + fi.completeBaseName() + suffix));
+}
+
+bool ToolJob::isCborFile(const QString &filePath)
+{
+    return filePath.endsWith(CBOR_SUFFIX, Qt::CaseInsensitive);
+}
+
+QStringList ToolJob::validate(const BlockData &data)
+{
+    QStringList problems;
+
+    if (data.typeId.isEmpty()) problems << "missing TypeId";
+
+    // parameters
+    QSet<QString> names;
+    for (int i=0; i < data.parameters.size(); ++i) {
+        BlockParameterData param = data.parameters.at(i).normalized();
+
+        if (names.contains(param.name)) problems << QString("duplicate parameter '%1'").arg(param.name);
+        names.insert(param.name);
+
+        if (param.type == "int") {
+            bool ok;
+            int value = param.defaultValue.toInt(&ok);
+            if (param.minimum > param.maximum) {
+                problems << QString("parameter '%1': minimum is greater than maximum").arg(param.name);
+            } else if (!ok || value < param.minimum || value > param.maximum) {
+                problems << QString("parameter '%1': invalid default value '%2'").arg(param.name, param.defaultValue);
+            }
+        } else if (param.type == "enum") {
+            if (!param.enumItems.contains(param.defaultValue)) {
+                problems << QString("parameter '%1': default value '%2' is not an enum item").arg(param.name, param.defaultValue);
+            }
+        } else if (param.type == "array") {
+            // the parameter checks the encoding and the range of all elements
+            BlockParameterArray array(param.name);
+            array.importParamData(param);
+            if (param.elementMinimum > param.elementMaximum) {
+                problems << QString("parameter '%1': minimum is greater than maximum").arg(param.name);
+            } else if (!array.setDefaultValue(param.defaultValue)) {
+                problems << QString("parameter '%1': invalid default value (%2)").arg(param.name, array.allowedValues());
+            }
+        } else if (param.type != "str") {
+            problems << QString("parameter '%1': unknown type '%2'").arg(param.name, param.type);
+        }
+    }
+
+    // inputs and outputs
+    QStringList inputs = data.inputs;
+    if (inputs.removeDuplicates() > 0) problems << "duplicate input names";
+    QStringList outputs = data.outputs;
+    if (outputs.removeDuplicates() > 0) problems << "duplicate output names";
+
+    return problems;
+}
+
+bool ToolJob::read(BlockData *data)
+{
+    QScopedPointer<QIODevice> dev;
+    if (this->result->packedData.isEmpty()) {
+        dev.reset(BlockLibraryPack::openBlockDef(this->result->inputPath));
+    } else {
+        // pack entries are already read, they only need to be uncompressed
+        QByteArray content = qUncompress(this->result->packedData);
+        this->result->packedData.clear();
+        if (!content.isEmpty()) {
+            QBuffer *buffer = new QBuffer();
+            buffer->setData(content);
+            buffer->open(QIODevice::ReadOnly);
+            dev.reset(buffer);
+        }
+    }
+    if (dev.isNull()) {
+        this->result->error = QString("%1: cannot open file").arg(this->result->inputPath);
+        return false;
+    }
+
+    bool ok;
+    if (isCborFile(this->result->inputPath)) {
+        ok = BlockData::parseBlockDefCbor(dev.data(), data);
+    } else {
+        ok = BlockData::parseBlockDef(dev.data(), data);
+    }
+
+    if (!ok) this->result->error = QString("%1: not a valid block definition").arg(this->result->inputPath);
+    return ok;
+}
+
+bool ToolJob::write(const BlockData &data, ToolOptions::Format format, const QString &filePath)
+{
+    QDir().mkpath(QFileInfo(filePath).path());
+
+    // the file is replaced atomically (inputs may be overwritten)
+    QSaveFile f(filePath);
+    if (!f.open(QIODevice::WriteOnly)) {
+        this->result->error = QString("%1: %2").arg(filePath, f.errorString());
+        return false;
+    }
+
+    bool ok;
+    QString error;
+    if (format == ToolOptions::Cbor) {
+        ok = data.exportBlockDefCbor(&f);
+        if (!ok) error = f.errorString();
+    } else {
+        BlockDefWriter *writer = BlockDefWriter::threadWriter();
+        writer->setAutoFormatting(!this->options.compact);
+        ok = writer->write(data, &f);
+        if (!ok) error = writer->errorString();
+    }
+
+    if (!ok) {
+        f.cancelWriting();
+        this->result->error = QString("%1: %2").arg(filePath, error);
+        return false;
+    }
+
+    if (!f.commit()) {
+        this->result->error = QString("%1: %2").arg(filePath, f.errorString());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef TOOLJOB_H
+#define TOOLJOB_H
+
+#include <QRunnable>
+#include <QString>
+#include <QByteArray>
+
+#include <blockdata.h>
+#include <blockgenerator.h>
+
+/**
+ * @brief The options of a blockdiatool invocation.
+ */
+struct ToolOptions
+{
+    enum Command {Validate, Convert, Canonicalize, Render, Generate};
+    enum Format {Xml, Cbor, Png, Svg};
+
+    Command command;
+    Format format;          ///< output format of convert (Xml, Cbor) or render (Png, Svg)
+    qreal scale;            ///< scale factor of rendered images
+    bool compact;           ///< XML output without indentation
+    QString outputDir;      ///< empty to write the output next to the input
+    const libblockdia::BlockGenerator *generator;   ///< the generator of the generate command
+};
+
+/**
+ * @brief The result of one input file.
+ */
+struct ToolResult
+{
+    QString inputPath;
+    int index;              ///< the index of the generated block (generate command)
+    QString relativePath;   ///< path of the input relative to the given directory or pack (used for output paths)
+    QByteArray packedData;  ///< compressed block definition of a pack entry (read while collecting the inputs)
+    bool success;
+    QString message;        ///< printed to stdout on success
+    QString error;          ///< printed to stderr on failure
+};
+
+/**
+ * @brief A worker job that processes one input file.
+ *
+ * The job reads the block definition (XML or CBOR, also from packs)
+ * and executes the command.
+ * Entries of packs are not read from the pack again,
+ * the job only uncompresses the ToolResult::packedData.
+ * For the generate command, the block definition is generated instead of read.
+ * The result is written into a preallocated slot, so no locking is needed.
+ */
+class ToolJob : public QRunnable
+{
+public:
+    ToolJob(const ToolOptions &options, ToolResult *result);
+    void run();
+
+    /**
+     * @param inputPath The path of the input
+     * @param relativePath The path of the input relative to the given directory or pack
+     * @param suffix The suffix of the output file (eg. ".xml")
+     * @param outputDir The output directory or an empty string to write next to the input
+     * @return The path of the output file or an empty string if there is no sensible output path
+     */
+    static QString outputPath(const QString &inputPath, const QString &relativePath, const QString &suffix, const QString &outputDir);
+
+    /**
+     * @param filePath A file path
+     * @return True if the file is a block definition in CBOR format (by suffix)
+     */
+    static bool isCborFile(const QString &filePath);
+
+    /**
+     * @details Checking a block definition for problems that the parser accepts
+     * (eg. duplicate names or default values that are out of range).
+     * @param data The block data
+     * @return A description of every problem, empty if the block definition is valid
+     */
+    static QStringList validate(const libblockdia::BlockData &data);
+
+private:
+    bool read(libblockdia::BlockData *data);
+    bool write(const libblockdia::BlockData &data, ToolOptions::Format format, const QString &filePath);
+
+    ToolOptions options;
+    ToolResult *result;
+};
+
+#endif // TOOLJOB_H
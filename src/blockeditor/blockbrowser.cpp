@@ -1,12 +1,24 @@
 #include "blockbrowser.h"
 
 #include <QLabel>
-#include <QFileSystemModel>
-#include <QTreeView>
 #include <QPushButton>
 #include <QFileDialog>
 #include <QDir>
 #include <QSettings>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QHeaderView>
+#include <QPixmap>
+#include <QDirIterator>
+
+// delay between a file system change and the rescan of the library
+// (many files are changed at once when a library is regenerated)
+#define RESCAN_DELAY_MS 300
+
+// columns of the block tree
+#define COLUMN_TYPEID   0
+#define COLUMN_TYPENAME 1
+#define COLUMN_FILE     2
 
 BlockBrowser::BlockBrowser(QWidget *parent) : QWidget(parent)
 {
@@ -18,52 +30,182 @@ BlockBrowser::BlockBrowser(QWidget *parent) : QWidget(parent)
     vbl->addWidget(btnDirBrowse, 0, Qt::AlignCenter);
     connect(btnDirBrowse, SIGNAL(clicked(bool)), this, SLOT(slotDirBrowse()));
 
-    // create tree view with model
-    this->viewFsTree = new QTreeView(this);
-    this->modelFs = new QFileSystemModel(this);
-    this->modelFs->setRootPath(QDir::currentPath());
-    this->viewFsTree->setModel(this->modelFs);
-    vbl->addWidget(this->viewFsTree, 1);
-    connect(this->viewFsTree, SIGNAL(clicked(QModelIndex)), this, SLOT(slotItemClicked(QModelIndex)));
+    // create tree with block meta data
+    this->treeBlocks = new QTreeWidget(this);
+    this->treeBlocks->setColumnCount(3);
+    this->treeBlocks->setHeaderLabels(QStringList() << "Id" << "Type" << "File");
+    this->treeBlocks->setRootIsDecorated(false);
+    this->treeBlocks->setUniformRowHeights(true);
+    this->treeBlocks->setSortingEnabled(true);
+    this->treeBlocks->sortByColumn(COLUMN_TYPEID, Qt::AscendingOrder);
+    this->treeBlocks->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    this->treeBlocks->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    vbl->addWidget(this->treeBlocks, 1);
+    connect(this->treeBlocks, SIGNAL(itemClicked(QTreeWidgetItem*,int)), this, SLOT(slotItemClicked(QTreeWidgetItem*)));
+
+    // create open button (selected blocks are loaded in parallel)
+    QPushButton *btnOpenSelected = new QPushButton("Open Selected", this);
+    vbl->addWidget(btnOpenSelected, 0, Qt::AlignCenter);
+    connect(btnOpenSelected, SIGNAL(clicked(bool)), this, SLOT(slotOpenSelected()));
 
-    // layout treeview
-    this->viewFsTree->setHeaderHidden(true);
-    this->viewFsTree->setColumnHidden(1, true);
-    this->viewFsTree->setColumnHidden(2, true);
-    this->viewFsTree->setColumnHidden(3, true);
+    // create library index
+    this->libraryIndex = new libblockdia::BlockLibraryIndex(this);
+    connect(this->libraryIndex, SIGNAL(signalIndexChanged()), this, SLOT(slotUpdateTree()));
+    connect(this->libraryIndex, SIGNAL(signalScanFinished(int)), this, SLOT(slotScanFinished(int)));
+
+    // watch the library directories for changes
+    this->fsWatcher = new QFileSystemWatcher(this);
+    this->timerRescan = new QTimer(this);
+    this->timerRescan->setSingleShot(true);
+    this->timerRescan->setInterval(RESCAN_DELAY_MS);
+    connect(this->fsWatcher, SIGNAL(directoryChanged(QString)), this, SLOT(slotDirectoryChanged()));
+    connect(this->timerRescan, SIGNAL(timeout()), this, SLOT(slotRescan()));
 
     // load base path
     QSettings s;
-    this->viewFsTree->setRootIndex(this->modelFs->index(s.value("BlockBrowser/BasePath").toString()));
+    this->setBasePath(s.value("BlockBrowser/BasePath").toString());
 }
 
 QString BlockBrowser::currentRootPath()
 {
-    QModelIndex idx = this->viewFsTree->rootIndex();
-    QString path = this->modelFs->filePath(idx);
-    return path;
+    return this->libraryIndex->basePath();
 }
 
 void BlockBrowser::slotDirBrowse()
 {
     // get current root path
-    QString dirPath = this->modelFs->rootPath();
+    QString dirPath = this->libraryIndex->basePath();
 
     // promt dialog for new root path
     dirPath = QFileDialog::getExistingDirectory(this, "Base Directory", dirPath, QFileDialog::ShowDirsOnly);
+    if (dirPath.isEmpty()) return;
 
-    // set path to treeview
-    this->viewFsTree->setRootIndex(this->modelFs->index(dirPath));
+    // set path to library index
+    this->setBasePath(dirPath);
 
     // save path
     QSettings s;
     s.setValue("BlockBrowser/BasePath", dirPath);
 }
 
-void BlockBrowser::slotItemClicked(QModelIndex idx)
+void BlockBrowser::slotItemClicked(QTreeWidgetItem *item)
 {
-    if (!this->modelFs->isDir(idx)) {
-        QString path = this->modelFs->filePath(idx);
+    // extending the selection does not open anything
+    if (item && this->treeBlocks->selectedItems().size() == 1) {
+        QString path = QDir(this->libraryIndex->basePath()).filePath(item->text(COLUMN_FILE));
         emit signalFileOpen(path);
     }
 }
+
+void BlockBrowser::slotOpenSelected()
+{
+    QList<QTreeWidgetItem *> items = this->treeBlocks->selectedItems();
+    QStringList paths;
+    for (int i=0; i < items.size(); ++i) {
+        paths.append(QDir(this->libraryIndex->basePath()).filePath(items.at(i)->text(COLUMN_FILE)));
+    }
+    if (!paths.isEmpty()) emit signalFilesOpen(paths);
+}
+
+void BlockBrowser::slotUpdateTree()
+{
+    QList<libblockdia::BlockLibraryIndex::Entry> entries = this->libraryIndex->entries();
+
+    // refill tree
+    this->treeBlocks->setUpdatesEnabled(false);
+    this->treeBlocks->setSortingEnabled(false);
+    this->treeBlocks->clear();
+    QList<QTreeWidgetItem *> items;
+    items.reserve(entries.size());
+    for (int i=0; i < entries.size(); ++i) {
+        const libblockdia::BlockLibraryIndex::Entry &e = entries.at(i);
+        QTreeWidgetItem *item = new QTreeWidgetItem();
+        item->setText(COLUMN_TYPEID, e.typeId);
+        item->setIcon(COLUMN_TYPEID, this->colorIcon(e.color));
+        item->setText(COLUMN_TYPENAME, e.typeName);
+        item->setText(COLUMN_FILE, e.filePath);
+        item->setToolTip(COLUMN_TYPENAME, QString("%1 parameters, %2 inputs, %3 outputs").arg(e.countParameters).arg(e.countInputs).arg(e.countOutputs));
+        items.append(item);
+    }
+    this->treeBlocks->addTopLevelItems(items);
+    this->treeBlocks->setSortingEnabled(true);
+    this->treeBlocks->setUpdatesEnabled(true);
+}
+
+void BlockBrowser::slotDirectoryChanged()
+{
+    // collect multiple changes into one rescan
+    this->timerRescan->start();
+}
+
+void BlockBrowser::slotRescan()
+{
+    // only changed files are parsed again (in the background)
+    this->libraryIndex->startScan();
+
+    // new sub directories must be watched too
+    this->updateWatchedDirectories();
+}
+
+void BlockBrowser::slotScanFinished(int countRead)
+{
+    // keep the index on disk up to date
+    if (countRead > 0) {
+        this->libraryIndex->save(this->indexFilePath());
+    }
+}
+
+void BlockBrowser::setBasePath(const QString &path)
+{
+    this->libraryIndex->setBasePath(path);
+
+    // show cached index immediately and update only changed files in the background
+    this->libraryIndex->load(this->indexFilePath());
+    this->libraryIndex->startScan();
+
+    // watch the new library
+    this->updateWatchedDirectories();
+}
+
+void BlockBrowser::updateWatchedDirectories()
+{
+    // find all directories of the library
+    QStringList dirs;
+    QString basePath = this->libraryIndex->basePath();
+    if (!basePath.isEmpty() && QDir(basePath).exists()) {
+        dirs.append(basePath);
+        QDirIterator it(basePath, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (it.hasNext()) dirs.append(it.next());
+    }
+
+    // update watched directories
+    QStringList watchedDirs = this->fsWatcher->directories();
+    for (int i=0; i < watchedDirs.size(); ++i) {
+        if (!dirs.contains(watchedDirs.at(i))) this->fsWatcher->removePath(watchedDirs.at(i));
+    }
+    for (int i=0; i < dirs.size(); ++i) {
+        if (!watchedDirs.contains(dirs.at(i))) this->fsWatcher->addPath(dirs.at(i));
+    }
+}
+
+QString BlockBrowser::indexFilePath()
+{
+    // every base directory gets its own index file in the cache location
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    QDir().mkpath(cacheDir);
+    QByteArray hash = QCryptographicHash::hash(this->libraryIndex->basePath().toUtf8(), QCryptographicHash::Md5).toHex();
+    return QDir(cacheDir).filePath("libraryindex_" + QString::fromLatin1(hash) + ".dat");
+}
+
+QIcon BlockBrowser::colorIcon(const QColor &color)
+{
+    // icons are shared between all items of the same color
+    QHash<QRgb, QIcon>::const_iterator it = this->colorIconCache.constFind(color.rgb());
+    if (it != this->colorIconCache.constEnd()) return it.value();
+
+    QPixmap pm(12, 12);
+    pm.fill(color);
+    QIcon icon(pm);
+    this->colorIconCache.insert(color.rgb(), icon);
+    return icon;
+}
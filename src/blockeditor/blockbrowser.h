@@ -3,9 +3,13 @@
 
 #include <QWidget>
 #include <QVBoxLayout>
-#include <QFileSystemModel>
-#include <QTreeView>
-#include <QModelIndex>
+#include <QTreeWidget>
+#include <QHash>
+#include <QIcon>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+#include <blocklibraryindex.h>
 
 class BlockBrowser : public QWidget
 {
@@ -16,16 +20,30 @@ public:
 
 signals:
     void signalFileOpen(QString filePath);
+    void signalFilesOpen(QStringList filePaths);
 
 public slots:
 
 private slots:
     void slotDirBrowse(void);
-    void slotItemClicked(QModelIndex idx);
+    void slotItemClicked(QTreeWidgetItem *item);
+    void slotOpenSelected(void);
+    void slotUpdateTree(void);
+    void slotDirectoryChanged(void);
+    void slotRescan(void);
+    void slotScanFinished(int countRead);
 
 private:
-    QTreeView *viewFsTree;
-    QFileSystemModel *modelFs;
+    void setBasePath(const QString &path);
+    QString indexFilePath(void);
+    QIcon colorIcon(const QColor &color);
+    void updateWatchedDirectories(void);
+
+    QTreeWidget *treeBlocks;
+    libblockdia::BlockLibraryIndex *libraryIndex;
+    QHash<QRgb, QIcon> colorIconCache;
+    QFileSystemWatcher *fsWatcher;
+    QTimer *timerRescan;
 };
 
 #endif // BLOCKBROWSER_H
@@ -32,18 +32,24 @@ DEFINES += QT_DEPRECATED_WARNINGS
 SOURCES += \
         main.cpp \
         mainwindow.cpp \
-    blockbrowser.cpp
+    blockbrowser.cpp \
+    memorypanel.cpp \
+    sessionrecorder.cpp \
+    sessionplayer.cpp
 
 HEADERS += \
         mainwindow.h \
-    blockbrowser.h
+    blockbrowser.h \
+    memorypanel.h \
+    sessionrecorder.h \
+    sessionplayer.h
 
 
 # include library
 CONFIG(debug, debug|release) {
-    LIBS += -L$$PWD/../../bin/ -llibblockdia_d
+    LIBS += -L$$PWD/../../bin/ -llibblockdia_d -llibblockdiacore_d
 } else {
-    LIBS += -L$$PWD/../../bin/ -llibblockdia
+    LIBS += -L$$PWD/../../bin/ -llibblockdia -llibblockdiacore
 }
 INCLUDEPATH += ../../include/
 DEPENDPATH += $$PWD/../../build
@@ -1,6 +1,9 @@
 #include "mainwindow.h"
+#include "sessionplayer.h"
 #include <QCoreApplication>
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
 
 int main(int argc, char *argv[])
 {
@@ -8,9 +11,58 @@ int main(int argc, char *argv[])
     QCoreApplication::setOrganizationDomain("https://github.com/Oinosseus/blockdia");
     QCoreApplication::setApplicationName("Block Editor");
 
+    // replays run headless, unless a platform is requested explicitly
+    bool isReplay = false;
+    for (int i=1; i < argc; ++i) {
+        if (QString(argv[i]) == "--replay") isReplay = true;
+    }
+    if (isReplay && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Editor for block definitions");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("replay", "Replay a recorded session and report the latency of each operation.", "session"));
+    parser.addOption(QCommandLineOption("library", "Library root for the blocks of the replayed session (default: library of the recording).", "dir"));
+    parser.addOption(QCommandLineOption("report", "Write the latencies of the replay as CSV.", "file"));
+    parser.process(a);
+
+    // interactive editor
+    if (!parser.isSet("replay")) {
+        MainWindow w;
+        w.show();
+        return a.exec();
+    }
+
+    // replays do not touch the settings of the user
+    QCoreApplication::setApplicationName("Block Editor Replay");
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
     MainWindow w;
     w.show();
 
-    return a.exec();
+    SessionPlayer player(&w);
+    if (parser.isSet("library")) player.setLibraryPath(parser.value("library"));
+    QString errorString;
+    if (!player.load(parser.value("replay"), &errorString)) {
+        err << errorString << "\n";
+        return 1;
+    }
+
+    bool success = player.run(&errorString);
+    out << player.report();
+    out.flush();
+    if (!success) {
+        err << "Replay failed at " << errorString << "\n";
+        return 1;
+    }
+
+    if (parser.isSet("report") && !player.writeCsv(parser.value("report"), &errorString)) {
+        err << "Cannot write report '" << parser.value("report") << "': " << errorString << "\n";
+        return 1;
+    }
+
+    return 0;
 }
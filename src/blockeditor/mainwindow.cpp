@@ -9,11 +9,21 @@
 #include <QFile>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QSaveFile>
+#include <QBuffer>
+#include <QDebug>
+
+// interval of automatic backups of unsaved blocks
+#define AUTOSAVE_INTERVAL_MS 60000
+
+// suffix of automatic backup files
+#define AUTOSAVE_SUFFIX ".autosave"
 
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
 {
+    this->sessionRecorder = Q_NULLPTR;
 
     // ========================================================================
     //                                   File Menu
@@ -41,6 +51,11 @@ MainWindow::MainWindow(QWidget *parent)
     actSaveAs->setShortcut(Qt::Key_S | Qt::CTRL | Qt::SHIFT);
     connect(actSaveAs, SIGNAL(triggered(bool)), this, SLOT(slotActionSaveAs()));
 
+    // action - pack library
+    QAction *actPackLibrary = new QAction("pack library", this);
+    menuFile->addAction(actPackLibrary);
+    connect(actPackLibrary, SIGNAL(triggered(bool)), this, SLOT(slotActionPackLibrary()));
+
     // action - close
     QAction *actClose = new QAction("close block", this);
     menuFile->addAction(actClose);
@@ -54,6 +69,27 @@ MainWindow::MainWindow(QWidget *parent)
     connect(actQuit, SIGNAL(triggered(bool)), this, SLOT(slotActionQuit()));
 
 
+    // ========================================================================
+    //                                   Edit Menu
+    // ========================================================================
+
+    // menu - edit
+    QMenu *menuEdit = new QMenu("Edit", this);
+    this->menuBar()->addMenu(menuEdit);
+
+    // action - undo
+    this->actUndo = new QAction("undo", this);
+    menuEdit->addAction(this->actUndo);
+    this->actUndo->setShortcut(Qt::Key_Z | Qt::CTRL);
+    connect(this->actUndo, SIGNAL(triggered(bool)), this, SLOT(slotActionUndo()));
+
+    // action - redo
+    this->actRedo = new QAction("redo", this);
+    menuEdit->addAction(this->actRedo);
+    this->actRedo->setShortcut(Qt::Key_Z | Qt::CTRL | Qt::SHIFT);
+    connect(this->actRedo, SIGNAL(triggered(bool)), this, SLOT(slotActionRedo()));
+
+
     // ========================================================================
     //                                   View Menu
     // ========================================================================
@@ -68,6 +104,44 @@ MainWindow::MainWindow(QWidget *parent)
     actViewZoomDefault->setShortcut(Qt::Key_0 | Qt::CTRL);
     connect(actViewZoomDefault, SIGNAL(triggered(bool)), this, SLOT(slotActionViewZoomDefault()));
 
+    // action - performance overlay
+    this->actViewHud = new QAction("performance overlay", this);
+    this->actViewHud->setCheckable(true);
+    menuView->addAction(this->actViewHud);
+    this->actViewHud->setShortcut(Qt::Key_F12);
+    connect(this->actViewHud, SIGNAL(toggled(bool)), this, SLOT(slotActionViewHud(bool)));
+
+
+    // ========================================================================
+    //                                   Debug Menu
+    // ========================================================================
+
+    // menu - debug
+    QMenu *menuDebug = new QMenu("Debug", this);
+    this->menuBar()->addMenu(menuDebug);
+
+    // action - record session
+    QAction *actSessionRecord = new QAction("record session", this);
+    actSessionRecord->setCheckable(true);
+    menuDebug->addAction(actSessionRecord);
+    connect(actSessionRecord, SIGNAL(toggled(bool)), this, SLOT(slotActionSessionRecord(bool)));
+
+    // trace actions are only available if the libraries are built with trace points
+    if (libblockdia::BlockTrace::isAvailable()) {
+        menuDebug->addSeparator();
+
+        // action - record trace
+        QAction *actTraceRecord = new QAction("record trace", this);
+        actTraceRecord->setCheckable(true);
+        menuDebug->addAction(actTraceRecord);
+        connect(actTraceRecord, SIGNAL(toggled(bool)), this, SLOT(slotActionTraceRecord(bool)));
+
+        // action - save trace
+        QAction *actTraceSave = new QAction("save trace", this);
+        menuDebug->addAction(actTraceSave);
+        connect(actTraceSave, SIGNAL(triggered(bool)), this, SLOT(slotActionTraceSave()));
+    }
+
 
     // ========================================================================
     //                                   Sub Widgets
@@ -76,10 +150,37 @@ MainWindow::MainWindow(QWidget *parent)
     // central widget
     this->widgetMain = new QTabWidget(this);
     this->setCentralWidget(this->widgetMain);
+    connect(this->widgetMain, SIGNAL(currentChanged(int)), this, SLOT(slotUpdateUndoActions()));
+    connect(this->widgetMain, SIGNAL(currentChanged(int)), this, SLOT(slotTabChanged(int)));
+    this->slotUpdateUndoActions();
+
+    // watch open files for external changes
+    this->fileWatcher = new QFileSystemWatcher(this);
+    this->timerReload = new QTimer(this);
+    this->timerReload->setSingleShot(true);
+    this->timerReload->setInterval(200);
+    connect(this->fileWatcher, SIGNAL(fileChanged(QString)), this, SLOT(slotFileChanged(QString)));
+    connect(this->timerReload, SIGNAL(timeout()), this, SLOT(slotReloadChangedFiles()));
+
+    // save files in the background
+    this->blockSaver = new libblockdia::BlockSaver(this);
+    connect(this->blockSaver, SIGNAL(signalSaved(QString,bool,QString)), this, SLOT(slotBlockSaved(QString,bool,QString)));
+
+    // backup unsaved blocks periodically
+    this->timerAutosave = new QTimer(this);
+    this->timerAutosave->setInterval(AUTOSAVE_INTERVAL_MS);
+    connect(this->timerAutosave, SIGNAL(timeout()), this, SLOT(slotAutosave()));
+    this->timerAutosave->start();
 
     // block browser
     this->blockBrowser = new BlockBrowser(this);
     connect(this->blockBrowser, SIGNAL(signalFileOpen(QString)), this, SLOT(slotFileOpen(QString)));
+    connect(this->blockBrowser, SIGNAL(signalFilesOpen(QStringList)), this, SLOT(slotFilesOpen(QStringList)));
+
+    // parse opened files in the background
+    this->blockLoader = new libblockdia::BlockLibraryLoader(this);
+    connect(this->blockLoader, SIGNAL(signalBlockLoaded(QString,libblockdia::Block*)), this, SLOT(slotBlockLoaded(QString,libblockdia::Block*)));
+    connect(this->blockLoader, SIGNAL(signalLoadFailed(QString)), this, SLOT(slotBlockLoadFailed(QString)));
 
     // block browser dock
     QDockWidget *dock = new QDockWidget("", this);
@@ -90,6 +191,19 @@ MainWindow::MainWindow(QWidget *parent)
     dock->setFeatures(QDockWidget::NoDockWidgetFeatures);
     this->addDockWidget(Qt::LeftDockWidgetArea, dock);    
 
+    // parameter expressions of all open blocks
+    this->expressionGraph = new libblockdia::BlockExpressionGraph(this);
+
+    // memory diagnostics dock (hidden by default)
+    this->memoryPanel = new MemoryPanel(this->widgetMain, this);
+    QDockWidget *dockMemory = new QDockWidget("Memory", this);
+    dockMemory->setObjectName("MemoryPanel");
+    dockMemory->setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea);
+    dockMemory->setWidget(this->memoryPanel);
+    this->addDockWidget(Qt::RightDockWidgetArea, dockMemory);
+    dockMemory->hide();
+    menuView->addAction(dockMemory->toggleViewAction());
+
     // restore window state
     QSettings s;
     this->restoreState(s.value("Mainwindow/State").toByteArray());
@@ -102,14 +216,79 @@ MainWindow::~MainWindow()
     QSettings s;
     s.setValue("MainWindow/State", this->saveState());
     s.setValue("MainWindow/Geometry", this->saveGeometry());
+
+    // finish writing files
+    this->blockSaver->waitForFinished();
 }
 
 void MainWindow::slotFileOpen(QString filePath)
+{
+    this->slotFilesOpen(QStringList() << filePath);
+}
+
+void MainWindow::slotFilesOpen(QStringList filePaths)
+{
+    // files that are open or loading already are only activated
+    QStringList newFilePaths;
+    for (int i=0; i < filePaths.size(); ++i) {
+        if (this->activateOpenFile(filePaths.at(i))) continue;
+        if (this->loadingFilePaths.contains(filePaths.at(i))) continue;
+        this->loadingFilePaths.insert(filePaths.at(i));
+        newFilePaths.append(filePaths.at(i));
+    }
+
+    // the files are parsed on worker threads, the editors are opened when the blocks arrive
+    this->blockLoader->load(newFilePaths);
+}
+
+void MainWindow::slotBlockLoaded(QString filePath, libblockdia::Block *block)
+{
+    this->loadingFilePaths.remove(filePath);
+    this->addBlockEditor(block, filePath);
+}
+
+void MainWindow::slotBlockLoadFailed(QString filePath)
+{
+    this->loadingFilePaths.remove(filePath);
+    QMessageBox::critical(this, "Error", "Cannot open or parse file '" + filePath + "'!");
+}
+
+bool MainWindow::openFile(const QString &filePath, QString *errorString)
+{
+    // check if file is already open
+    if (this->activateOpenFile(filePath)) return true;
+
+    // open file (or block definition within a pack)
+    QIODevice *dev = libblockdia::BlockLibraryPack::openBlockDef(filePath);
+    if (!dev) {
+        if (errorString) *errorString = "Cannot open file!";
+        return false;
+    }
+
+    // parse block
+    libblockdia::Block * block = libblockdia::Block::parseBlockDef(dev);
+    dev->close();
+    delete dev;
+    if (!block) {
+        if (errorString) *errorString = "Error on parsing file!";
+        return false;
+    }
+
+    // Ignore the first change signal for just created block
+    // Because instantiating the block causes the signal.
+    // (blocks of the loader have their children already, so they do not emit it)
+    this->ignoreChangedBlocks.append(block);
+
+    this->addBlockEditor(block, filePath);
+    return true;
+}
+
+bool MainWindow::activateOpenFile(const QString &filePath)
 {
     QTabWidget *tw = (QTabWidget *) this->centralWidget();
 
     // check if file is already open
-    // in this case set it as current tab and abort opening
+    // in this case set it as current tab
     QList<libblockdia::Block*> openBlocks = this->openFilePathHash.keys();
     for (int ib=0; ib < openBlocks.size(); ++ib) {
         if (this->openFilePathHash[openBlocks.at(ib)] == filePath) {
@@ -119,38 +298,43 @@ void MainWindow::slotFileOpen(QString filePath)
                     break;
                 }
             }
-            return;
+            return true;
         }
     }
 
-    // open file
-    QFile f(filePath);
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "Error", "Cannot open file!");
-        return;
-    }
+    return false;
+}
 
-    // parse block
-    libblockdia::Block * block = libblockdia::Block::parseBlockDef(&f);
-    f.close();
-    if (!block) {
-        QMessageBox::critical(this, "Error", "Error on parsing file!");
-        return;
-    }
+void MainWindow::addBlockEditor(libblockdia::Block *block, const QString &filePath)
+{
+    QTabWidget *tw = (QTabWidget *) this->centralWidget();
 
     // remember opened file
-    this->openFilePathHash[block] = filePath;
-
-    // Ignore the first change signal for just created block
-    // Because instantiating the block causes the signal.
-    this->ignoreChangedBlocks.append(block);
+    this->setBlockFilePath(block, filePath);
 
     // open new tab for block
-    int index = tw->addTab(new libblockdia::ViewBlockEditor(block), block->typeId());
+    libblockdia::ViewBlockEditor *bEditor = new libblockdia::ViewBlockEditor(block);
+    bEditor->setHudVisible(this->actViewHud->isChecked());
+    int index = tw->addTab(bEditor, block->typeId());
     tw->setCurrentIndex(index);
 
     // catch changes inside the block
     connect(block, SIGNAL(signalSomethingChanged(libblockdia::Block*)), this, SLOT(slotBlockChanged(libblockdia::Block*)));
+
+    // record changes for undo/redo
+    libblockdia::BlockJournal *journal = new libblockdia::BlockJournal(block, block);
+    this->journals.insert(block, journal);
+    connect(journal, SIGNAL(signalChanged()), this, SLOT(slotUpdateUndoActions()));
+    this->slotUpdateUndoActions();
+
+    // keep expression parameters up to date
+    this->expressionGraph->addBlock(block);
+
+    // record session
+    if (this->sessionRecorder) {
+        this->sessionRecorder->recordOpen(filePath);
+        this->sessionRecorder->attachEditor(bEditor);
+    }
 }
 
 void MainWindow::slotActionNewBlock()
@@ -162,6 +346,7 @@ void MainWindow::slotActionNewBlock()
 
     // create new block editor
     libblockdia::ViewBlockEditor *bEditor = new libblockdia::ViewBlockEditor(block);
+    bEditor->setHudVisible(this->actViewHud->isChecked());
 
     // add block editor to central widget
     QTabWidget *tw = (QTabWidget *) this->centralWidget();
@@ -171,6 +356,21 @@ void MainWindow::slotActionNewBlock()
     // catch changes inside the block
     this->unsavedBlocks.append(block);
     connect(block, SIGNAL(signalSomethingChanged(libblockdia::Block*)), this, SLOT(slotBlockChanged(libblockdia::Block*)));
+
+    // record changes for undo/redo
+    libblockdia::BlockJournal *journal = new libblockdia::BlockJournal(block, block);
+    this->journals.insert(block, journal);
+    connect(journal, SIGNAL(signalChanged()), this, SLOT(slotUpdateUndoActions()));
+    this->slotUpdateUndoActions();
+
+    // keep expression parameters up to date
+    this->expressionGraph->addBlock(block);
+
+    // record session
+    if (this->sessionRecorder) {
+        this->sessionRecorder->recordNewBlock();
+        this->sessionRecorder->attachEditor(bEditor);
+    }
 }
 
 void MainWindow::slotActionSave()
@@ -185,40 +385,24 @@ void MainWindow::slotActionSave()
     libblockdia::Block *block = editor->block();
 
 
-    QFile *f = Q_NULLPTR;
+    QString fileName;
 
     // file path is already known
-    if (this->openFilePathHash.contains(block)) {
-        f = new QFile(this->openFilePathHash[block]);
+    // (packs cannot be written, so a new file must be selected)
+    if (this->openFilePathHash.contains(block) && !libblockdia::BlockLibraryPack::splitPackPath(this->openFilePathHash[block], Q_NULLPTR, Q_NULLPTR)) {
+        fileName = this->openFilePathHash[block];
     }
 
     // open file dialog
     else {
-        QString fileName = QFileDialog::getSaveFileName(this, "Save Block", this->blockBrowser->currentRootPath(), "XML (*.xml)");
-        this->openFilePathHash[block] = fileName;
-        f = new QFile(fileName);
+        fileName = QFileDialog::getSaveFileName(this, "Save Block", this->blockBrowser->currentRootPath(), "XML (*.xml)");
     }
 
     // check if file is valid
-    if (!f || !f->open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "Error", "Cannot open file for writing!");
-        return;
-    }
+    if (fileName.isEmpty()) return;
 
     // export block
-    block->exportBlockDef(f);
-
-    // catch unsaved blocks
-    this->unsavedBlocks.removeAll(block);
-
-    // close file
-    if (f) {
-        f->close();
-        f->deleteLater();
-        f = Q_NULLPTR;
-    }
-
-    // update tab text
+    this->saveBlock(block, fileName);
     tw->setTabText(currentIndex, block->typeId());
 }
 
@@ -233,38 +417,29 @@ void MainWindow::slotActionSaveAs()
     libblockdia::ViewBlockEditor *editor = static_cast<libblockdia::ViewBlockEditor*>(tw->currentWidget());
     libblockdia::Block *block = editor->block();
 
-    QFile *f = Q_NULLPTR;
-
     // open file dialog
     QString defaultPath = (this->openFilePathHash.contains(block)) ? this->openFilePathHash[block] : this->blockBrowser->currentRootPath();
     QString fileName = QFileDialog::getSaveFileName(this, "Save Block As", defaultPath, "XML (*.xml)");
-    f = new QFile(fileName);
 
     // check if file is valid
-    if (!f || !f->open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "Error", "Cannot open file for writing!");
-        return;
-    }
+    if (fileName.isEmpty()) return;
 
     // export block
-    block->exportBlockDef(f);
-
-    // remember state
-    this->openFilePathHash[block] = fileName;
-    this->unsavedBlocks.removeAll(block);
+    this->saveBlock(block, fileName);
+    tw->setTabText(currentIndex, block->typeId());
+}
 
-    // close file
-    if (f) {
-        f->close();
-        f->deleteLater();
-        f = Q_NULLPTR;
+void MainWindow::slotActionPackLibrary()
+{
+    // select pack file
+    QString libraryPath = this->blockBrowser->currentRootPath();
+    QString fileName = QFileDialog::getSaveFileName(this, "Pack Library", libraryPath + ".bdpack", "Block Library Pack (*.bdpack)");
+    if (fileName.isEmpty()) return;
+
+    // pack all block definitions of the library
+    if (!libblockdia::BlockLibraryPack::create(fileName, libraryPath)) {
+        QMessageBox::critical(this, "Error", "Cannot create library pack!");
     }
-
-    // remember file path
-    this->openFilePathHash[block] = fileName;
-
-    // update tab text
-    tw->setTabText(currentIndex, block->typeId());
 }
 
 void MainWindow::slotActionQuit()
@@ -309,14 +484,28 @@ void MainWindow::slotActionClose()
 
     }
 
+    this->closeEditor(currentIndex);
+}
+
+void MainWindow::closeEditor(int index)
+{
+    QTabWidget *tw = (QTabWidget *) this->centralWidget();
+    libblockdia::ViewBlockEditor *editor = static_cast<libblockdia::ViewBlockEditor*>(tw->widget(index));
+    libblockdia::Block *block = editor->block();
+
+    // record session
+    if (this->sessionRecorder) this->sessionRecorder->recordClose(index);
+
     // forget current file and block
-    if (this->openFilePathHash.contains(block)) this->openFilePathHash.remove(block);
+    this->setBlockFilePath(block, "");
     this->unsavedBlocks.removeAll(block);
+    this->autosavedContentHashes.remove(block);
+    this->journals.remove(block);
 
     // delete block
     block->deleteLater();
     editor->deleteLater();
-    tw->removeTab(currentIndex);
+    tw->removeTab(index);
 }
 
 void MainWindow::slotActionViewZoomDefault()
@@ -330,6 +519,16 @@ void MainWindow::slotActionViewZoomDefault()
 
     // reset transformation
     editor->setTransform(QTransform());
+    if (this->sessionRecorder) this->sessionRecorder->recordZoomDefault();
+}
+
+void MainWindow::slotActionViewHud(bool visible)
+{
+    // the overlay is shown in all editors
+    QTabWidget *tw = (QTabWidget *) this->centralWidget();
+    for (int i=0; i < tw->count(); ++i) {
+        static_cast<libblockdia::ViewBlockEditor*>(tw->widget(i))->setHudVisible(visible);
+    }
 }
 
 void MainWindow::slotBlockChanged(libblockdia::Block *block)
@@ -354,3 +553,259 @@ void MainWindow::slotBlockChanged(libblockdia::Block *block)
         }
     }
 }
+
+void MainWindow::slotFileChanged(QString filePath)
+{
+    // files are often written in several steps,
+    // so wait a moment before reloading
+    this->changedFilePaths.insert(filePath);
+    this->timerReload->start();
+}
+
+void MainWindow::slotReloadChangedFiles()
+{
+    QSet<QString> filePaths = this->changedFilePaths;
+    this->changedFilePaths.clear();
+
+    for (QSet<QString>::const_iterator it = filePaths.constBegin(); it != filePaths.constEnd(); ++it) {
+        const QString &filePath = *it;
+
+        // find block of the file
+        libblockdia::Block *block = this->openFilePathHash.key(filePath, Q_NULLPTR);
+        if (!block) continue;
+
+        // files that are replaced (instead of rewritten) are removed from the watcher
+        if (!this->fileWatcher->files().contains(filePath)) {
+            if (!QFile::exists(filePath)) continue;
+            this->fileWatcher->addPath(filePath);
+        }
+
+        // read file
+        QFile f(filePath);
+        if (!f.open(QIODevice::ReadOnly)) continue;
+        QByteArray content = f.readAll();
+        f.close();
+
+        // the file has been written by the editor itself (save or autosave)
+        if (this->blockSaver->isWrittenContent(filePath, content)) continue;
+
+        // parse file
+        QBuffer buffer(&content);
+        buffer.open(QIODevice::ReadOnly);
+        libblockdia::BlockData data;
+        if (!libblockdia::BlockData::parseBlockDef(&buffer, &data)) continue;
+
+        // block definitions do not contain instance information, so keep the current one
+        data.instanceId = block->instanceId();
+        data.instanceName = block->instanceName();
+
+        // ask before discarding unsaved changes
+        if (this->unsavedBlocks.contains(block)) {
+            QMessageBox::StandardButton reply = QMessageBox::question(this, "File Changed", "The file '" + filePath + "' has been changed outside of the editor.\nReload and discard unsaved changes?", QMessageBox::Yes | QMessageBox::No);
+            if (reply != QMessageBox::Yes) continue;
+        }
+
+        // apply only the differences to the open block
+        // (this does not emit signalSomethingChanged(), so the block stays saved)
+        block->applyBlockData(data);
+        this->unsavedBlocks.removeAll(block);
+
+        // the journal cannot follow changes with blocked signals
+        if (this->journals.contains(block)) this->journals[block]->clear();
+
+        // neither can the expression graph
+        this->expressionGraph->recomputeAll();
+
+        // update tab text
+        QTabWidget *tw = (QTabWidget *) this->centralWidget();
+        for (int i=0; i < tw->count(); ++i) {
+            libblockdia::ViewBlockEditor *editor = static_cast<libblockdia::ViewBlockEditor*>(tw->widget(i));
+            if (editor->block() == block) {
+                tw->setTabText(i, block->typeId());
+            }
+        }
+    }
+}
+
+void MainWindow::setBlockFilePath(libblockdia::Block *block, const QString &filePath)
+{
+    // stop watching the old file
+    if (this->openFilePathHash.contains(block)) {
+        this->fileWatcher->removePath(this->openFilePathHash[block]);
+        this->openFilePathHash.remove(block);
+    }
+
+    // watch the new file
+    if (!filePath.isEmpty()) {
+        this->openFilePathHash[block] = filePath;
+        if (QFile::exists(filePath)) this->fileWatcher->addPath(filePath);
+    }
+}
+
+void MainWindow::saveBlock(libblockdia::Block *block, const QString &filePath)
+{
+    // the snapshot is written in the background,
+    // so the block is saved from now on (later changes are unsaved again)
+    this->blockSaver->save(block->snapshot(), filePath);
+    this->setBlockFilePath(block, filePath);
+    this->unsavedBlocks.removeAll(block);
+    this->autosavedContentHashes.remove(block);
+    if (this->sessionRecorder) this->sessionRecorder->recordSave(block);
+}
+
+void MainWindow::updateTabText(libblockdia::Block *block)
+{
+    QTabWidget *tw = (QTabWidget *) this->centralWidget();
+    for (int i=0; i < tw->count(); ++i) {
+        libblockdia::ViewBlockEditor *editor = static_cast<libblockdia::ViewBlockEditor*>(tw->widget(i));
+        if (editor->block() == block) {
+            tw->setTabText(i, block->typeId() + ((this->unsavedBlocks.contains(block)) ? " *" : ""));
+        }
+    }
+}
+
+void MainWindow::slotAutosave()
+{
+    for (int i=0; i < this->unsavedBlocks.size(); ++i) {
+        libblockdia::Block *block = this->unsavedBlocks.at(i);
+
+        // only blocks with a writable file are backed up
+        QString filePath = this->openFilePathHash.value(block);
+        if (filePath.isEmpty() || libblockdia::BlockLibraryPack::splitPackPath(filePath, Q_NULLPTR, Q_NULLPTR)) continue;
+
+        // skip blocks that did not change since the last backup
+        QByteArray hash = block->contentHash();
+        if (this->autosavedContentHashes.value(block) == hash) continue;
+        this->autosavedContentHashes.insert(block, hash);
+
+        this->blockSaver->save(block->snapshot(), filePath + AUTOSAVE_SUFFIX);
+    }
+}
+
+void MainWindow::slotBlockSaved(QString filePath, bool success, QString errorString)
+{
+    // backups
+    if (filePath.endsWith(AUTOSAVE_SUFFIX)) {
+        if (!success) qWarning() << "MainWindow: autosave failed:" << filePath << errorString;
+        return;
+    }
+
+    libblockdia::Block *block = this->openFilePathHash.key(filePath, Q_NULLPTR);
+
+    // the block is unsaved again
+    if (!success) {
+        QMessageBox::critical(this, "Error", "Cannot write file '" + filePath + "'!\n" + errorString);
+        if (block && !this->unsavedBlocks.contains(block)) this->unsavedBlocks.append(block);
+        if (block) this->updateTabText(block);
+        return;
+    }
+
+    // the backup is not needed anymore (unless there are new changes)
+    if (!block || !this->unsavedBlocks.contains(block)) QFile::remove(filePath + AUTOSAVE_SUFFIX);
+
+    // a new file can be watched now
+    if (block && !this->fileWatcher->files().contains(filePath)) this->fileWatcher->addPath(filePath);
+}
+
+libblockdia::Block *MainWindow::currentBlock()
+{
+    QTabWidget *tw = (QTabWidget *) this->centralWidget();
+    if (!tw || tw->count() == 0) return Q_NULLPTR;
+    return static_cast<libblockdia::ViewBlockEditor*>(tw->currentWidget())->block();
+}
+
+void MainWindow::slotActionUndo()
+{
+    libblockdia::Block *block = this->currentBlock();
+    if (!block || !this->journals.contains(block)) return;
+    if (this->sessionRecorder) this->sessionRecorder->flushEdits();
+    this->journals[block]->undo();
+    if (this->sessionRecorder) this->sessionRecorder->recordUndo(block);
+
+    // parameter changes are not announced by the block
+    if (!this->unsavedBlocks.contains(block)) this->unsavedBlocks.append(block);
+    this->updateTabText(block);
+}
+
+void MainWindow::slotActionRedo()
+{
+    libblockdia::Block *block = this->currentBlock();
+    if (!block || !this->journals.contains(block)) return;
+    if (this->sessionRecorder) this->sessionRecorder->flushEdits();
+    this->journals[block]->redo();
+    if (this->sessionRecorder) this->sessionRecorder->recordRedo(block);
+
+    // parameter changes are not announced by the block
+    if (!this->unsavedBlocks.contains(block)) this->unsavedBlocks.append(block);
+    this->updateTabText(block);
+}
+
+void MainWindow::slotUpdateUndoActions()
+{
+    libblockdia::Block *block = this->currentBlock();
+    libblockdia::BlockJournal *journal = (block) ? this->journals.value(block, Q_NULLPTR) : Q_NULLPTR;
+
+    this->actUndo->setEnabled(journal && journal->canUndo());
+    this->actUndo->setText((journal && journal->canUndo()) ? "undo " + journal->undoText() : "undo");
+    this->actRedo->setEnabled(journal && journal->canRedo());
+    this->actRedo->setText((journal && journal->canRedo()) ? "redo " + journal->redoText() : "redo");
+}
+
+void MainWindow::slotActionTraceRecord(bool enabled)
+{
+    // a new recording starts with an empty trace
+    if (enabled) libblockdia::BlockTrace::clear();
+    libblockdia::BlockTrace::setEnabled(enabled);
+}
+
+void MainWindow::slotActionTraceSave()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, "Save Trace", "trace.json", "Chrome Trace (*.json)");
+    if (fileName.isEmpty()) return;
+
+    QSaveFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly) || !libblockdia::BlockTrace::writeChromeTrace(&f) || !f.commit()) {
+        QMessageBox::critical(this, "Error", "Cannot write file '" + fileName + "'!\n" + f.errorString());
+        return;
+    }
+
+    if (libblockdia::BlockTrace::countDroppedEvents() > 0) {
+        qWarning() << "MainWindow: trace is incomplete," << libblockdia::BlockTrace::countDroppedEvents() << "events dropped";
+    }
+}
+
+void MainWindow::slotActionSessionRecord(bool enabled)
+{
+    // start recording with the currently open blocks
+    if (enabled) {
+        this->sessionRecorder = new SessionRecorder(this->blockBrowser->currentRootPath(), this);
+        QTabWidget *tw = (QTabWidget *) this->centralWidget();
+        int currentIndex = tw->currentIndex();
+        for (int i=0; i < tw->count(); ++i) {
+            libblockdia::ViewBlockEditor *editor = static_cast<libblockdia::ViewBlockEditor*>(tw->widget(i));
+            QString filePath = this->openFilePathHash.value(editor->block());
+            if (filePath.isEmpty()) this->sessionRecorder->recordNewBlock();
+            else this->sessionRecorder->recordOpen(filePath);
+            this->sessionRecorder->attachEditor(editor);
+        }
+        if (currentIndex >= 0) this->sessionRecorder->recordTab(currentIndex);
+        return;
+    }
+
+    // stop recording and save the session
+    if (!this->sessionRecorder) return;
+    SessionRecorder *recorder = this->sessionRecorder;
+    this->sessionRecorder = Q_NULLPTR;
+    recorder->flushEdits();
+    QString fileName = QFileDialog::getSaveFileName(this, "Save Session", "session.json", "Editor Session (*.json)");
+    QString errorString;
+    if (!fileName.isEmpty() && !recorder->save(fileName, &errorString)) {
+        QMessageBox::critical(this, "Error", "Cannot write file '" + fileName + "'!\n" + errorString);
+    }
+    recorder->deleteLater();
+}
+
+void MainWindow::slotTabChanged(int index)
+{
+    if (this->sessionRecorder && index >= 0) this->sessionRecorder->recordTab(index);
+}
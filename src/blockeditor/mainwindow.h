@@ -5,34 +5,89 @@
 #include <QTabWidget>
 #include <QList>
 #include <QHash>
+#include <QSet>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QAction>
 
 #include <libblockdia.h>
 #include <blockbrowser.h>
+#include <memorypanel.h>
+#include <sessionrecorder.h>
 
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
 
+    // the player drives the editor like a user
+    friend class SessionPlayer;
+
 public:
     MainWindow(QWidget *parent = 0);
     ~MainWindow();
 
+    /**
+     * @details Opening a block definition in a new tab (or activating its tab if already open).
+     * @param filePath The file path (or pack path) of the block definition
+     * @param errorString Set to a description of the error on failure
+     * @return True on success
+     */
+    bool openFile(const QString &filePath, QString *errorString = Q_NULLPTR);
+
 private:
     QTabWidget *widgetMain;
     BlockBrowser *blockBrowser;
+    MemoryPanel *memoryPanel;
     QList<libblockdia::Block*> ignoreChangedBlocks;
     QHash<libblockdia::Block*, QString> openFilePathHash;
     QList<libblockdia::Block*> unsavedBlocks;
+    QFileSystemWatcher *fileWatcher;
+    QTimer *timerReload;
+    QSet<QString> changedFilePaths;
+    libblockdia::BlockSaver *blockSaver;
+    QTimer *timerAutosave;
+    QHash<libblockdia::Block*, QByteArray> autosavedContentHashes;
+    QHash<libblockdia::Block*, libblockdia::BlockJournal*> journals;
+    libblockdia::BlockExpressionGraph *expressionGraph;
+    libblockdia::BlockLibraryLoader *blockLoader;
+    QSet<QString> loadingFilePaths;
+    QAction *actUndo;
+    QAction *actRedo;
+    QAction *actViewHud;
+    SessionRecorder *sessionRecorder;
+    libblockdia::Block *currentBlock();
+    bool activateOpenFile(const QString &filePath);
+    void addBlockEditor(libblockdia::Block *block, const QString &filePath);
+    void setBlockFilePath(libblockdia::Block *block, const QString &filePath);
+    void saveBlock(libblockdia::Block *block, const QString &filePath);
+    void updateTabText(libblockdia::Block *block);
+    void closeEditor(int index);
 
 private slots:
     void slotFileOpen(QString filePath);
+    void slotFilesOpen(QStringList filePaths);
+    void slotBlockLoaded(QString filePath, libblockdia::Block *block);
+    void slotBlockLoadFailed(QString filePath);
     void slotActionNewBlock();
     void slotActionSave();
     void slotActionSaveAs();
+    void slotActionPackLibrary();
     void slotActionQuit();
     void slotActionClose();
     void slotActionViewZoomDefault();
+    void slotActionViewHud(bool visible);
     void slotBlockChanged(libblockdia::Block *block);
+    void slotFileChanged(QString filePath);
+    void slotReloadChangedFiles();
+    void slotAutosave();
+    void slotActionUndo();
+    void slotActionRedo();
+    void slotUpdateUndoActions();
+    void slotBlockSaved(QString filePath, bool success, QString errorString);
+    void slotActionTraceRecord(bool enabled);
+    void slotActionTraceSave();
+    void slotActionSessionRecord(bool enabled);
+    void slotTabChanged(int index);
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,122 @@
+#include "memorypanel.h"
+
+#include <QVBoxLayout>
+#include <QPushButton>
+#include <QHeaderView>
+#include <QLocale>
+#include <QSet>
+
+#include <graphicitemblock.h>
+
+// interval of the automatic refresh
+#define REFRESH_INTERVAL_MS 2000
+
+// columns of the usage tree
+#define COLUMN_NAME     0
+#define COLUMN_COUNT    1
+#define COLUMN_BYTES    2
+
+MemoryPanel::MemoryPanel(QTabWidget *editors, QWidget *parent) : QWidget(parent)
+{
+    this->editors = editors;
+
+    QVBoxLayout *vbl = new QVBoxLayout(this);
+    this->setLayout(vbl);
+
+    // resident memory of the process
+    this->labelProcess = new QLabel(this);
+    vbl->addWidget(this->labelProcess);
+
+    // memory per block and category
+    this->treeUsage = new QTreeWidget(this);
+    this->treeUsage->setColumnCount(3);
+    this->treeUsage->setHeaderLabels(QStringList() << "Block" << "Objects" << "Bytes");
+    this->treeUsage->setUniformRowHeights(true);
+    this->treeUsage->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    vbl->addWidget(this->treeUsage, 1);
+
+    // refresh button
+    QPushButton *btnRefresh = new QPushButton("Refresh", this);
+    vbl->addWidget(btnRefresh, 0, Qt::AlignCenter);
+    connect(btnRefresh, SIGNAL(clicked(bool)), this, SLOT(slotRefresh()));
+
+    // refresh periodically (only while visible)
+    this->timerRefresh = new QTimer(this);
+    this->timerRefresh->setInterval(REFRESH_INTERVAL_MS);
+    connect(this->timerRefresh, SIGNAL(timeout()), this, SLOT(slotRefresh()));
+}
+
+void MemoryPanel::slotRefresh()
+{
+    QLocale locale;
+
+    // process
+    qint64 residentBytes = libblockdia::BlockMemory::processResidentBytes();
+    if (residentBytes < 0) this->labelProcess->setText("Process: not available");
+    else this->labelProcess->setText("Process: " + locale.formattedDataSize(residentBytes) + " resident");
+
+    // remember expanded blocks
+    QSet<QString> expanded;
+    for (int i=0; i < this->treeUsage->topLevelItemCount(); ++i) {
+        QTreeWidgetItem *item = this->treeUsage->topLevelItem(i);
+        if (item->isExpanded()) expanded.insert(item->text(COLUMN_NAME));
+    }
+    this->treeUsage->clear();
+
+    // every open block (the total counts shared data only once)
+    libblockdia::BlockMemory total;
+    QList<QTreeWidgetItem *> blockItems;
+    for (int i=0; i < this->editors->count(); ++i) {
+        libblockdia::ViewBlockEditor *editor = static_cast<libblockdia::ViewBlockEditor*>(this->editors->widget(i));
+        libblockdia::BlockMemory usage;
+        editor->block()->addMemoryUsage(&usage);
+        editor->graphicItem()->addMemoryUsage(&usage);
+        editor->block()->addMemoryUsage(&total);
+        editor->graphicItem()->addMemoryUsage(&total);
+        blockItems << this->createItem(QString("%1 (%2)").arg(editor->block()->typeId()).arg(i + 1), usage);
+    }
+
+    QTreeWidgetItem *totalItem = this->createItem("Total", total);
+    this->treeUsage->addTopLevelItem(totalItem);
+    this->treeUsage->addTopLevelItems(blockItems);
+    totalItem->setExpanded(true);
+    for (int i=0; i < blockItems.size(); ++i) {
+        if (expanded.contains(blockItems.at(i)->text(COLUMN_NAME))) blockItems.at(i)->setExpanded(true);
+    }
+}
+
+void MemoryPanel::showEvent(QShowEvent *e)
+{
+    QWidget::showEvent(e);
+    this->slotRefresh();
+    this->timerRefresh->start();
+}
+
+void MemoryPanel::hideEvent(QHideEvent *e)
+{
+    QWidget::hideEvent(e);
+    this->timerRefresh->stop();
+}
+
+QTreeWidgetItem *MemoryPanel::createItem(const QString &name, const libblockdia::BlockMemory &usage)
+{
+    QLocale locale;
+    QTreeWidgetItem *item = new QTreeWidgetItem();
+    item->setText(COLUMN_NAME, name);
+    item->setText(COLUMN_BYTES, locale.formattedDataSize(usage.totalBytes()));
+    item->setTextAlignment(COLUMN_BYTES, Qt::AlignRight);
+
+    // categories
+    for (int c=0; c < libblockdia::BlockMemory::CategoryCount; ++c) {
+        libblockdia::BlockMemory::Category category = static_cast<libblockdia::BlockMemory::Category>(c);
+        libblockdia::BlockMemory::Usage u = usage.usage(category);
+        QTreeWidgetItem *child = new QTreeWidgetItem(item);
+        child->setText(COLUMN_NAME, libblockdia::BlockMemory::categoryName(category));
+        child->setText(COLUMN_COUNT, QString::number(u.count));
+        child->setText(COLUMN_BYTES, locale.formattedDataSize(u.bytes));
+        child->setTextAlignment(COLUMN_COUNT, Qt::AlignRight);
+        child->setTextAlignment(COLUMN_BYTES, Qt::AlignRight);
+    }
+
+    return item;
+}
@@ -0,0 +1,40 @@
+#ifndef MEMORYPANEL_H
+#define MEMORYPANEL_H
+
+#include <QWidget>
+#include <QTabWidget>
+#include <QTreeWidget>
+#include <QLabel>
+#include <QTimer>
+
+#include <libblockdia.h>
+
+/**
+ * @brief A diagnostics panel that shows the memory used by the open blocks.
+ *
+ * Every open block is listed with its memory per category (see libblockdia::BlockMemory),
+ * including the graphic items of its editor.
+ * The total of all blocks and the resident memory of the process are shown on top.
+ * The panel is refreshed periodically while it is visible.
+ */
+class MemoryPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit MemoryPanel(QTabWidget *editors, QWidget *parent = nullptr);
+
+public slots:
+    void slotRefresh(void);
+
+private:
+    void showEvent(QShowEvent *e);
+    void hideEvent(QHideEvent *e);
+    QTreeWidgetItem *createItem(const QString &name, const libblockdia::BlockMemory &usage);
+
+    QTabWidget *editors;
+    QTreeWidget *treeUsage;
+    QLabel *labelProcess;
+    QTimer *timerRefresh;
+};
+
+#endif // MEMORYPANEL_H
@@ -0,0 +1,323 @@
+#include "sessionplayer.h"
+
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QElapsedTimer>
+#include <QMouseEvent>
+#include <QTextStream>
+#include <QtMath>
+
+#include <algorithm>
+
+#include <sessionrecorder.h>
+#include <dialogeditheader.h>
+#include <dialogeditparameterint.h>
+#include <dialogeditparameterstr.h>
+#include <dialogeditparameterenum.h>
+#include <dialogeditparameterarray.h>
+#include <dialogeditinput.h>
+#include <dialogeditoutput.h>
+
+SessionPlayer::SessionPlayer(MainWindow *window, QObject *parent) : QObject(parent)
+{
+    this->window = window;
+    this->countSaves = 0;
+}
+
+bool SessionPlayer::load(const QString &filePath, QString *errorString)
+{
+    QFile f(filePath);
+    if (!f.open(QIODevice::ReadOnly)) {
+        if (errorString) *errorString = "Cannot open session file '" + filePath + "'!";
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &parseError);
+    if (!doc.isObject() || doc.object().value("version").toInt() != 1) {
+        if (errorString) *errorString = "Invalid session file '" + filePath + "'! " + parseError.errorString();
+        return false;
+    }
+
+    if (this->libraryPath.isEmpty()) this->libraryPath = doc.object().value("library").toString();
+    this->operations = doc.object().value("operations").toArray();
+    return true;
+}
+
+void SessionPlayer::setLibraryPath(const QString &libraryPath)
+{
+    this->libraryPath = libraryPath;
+}
+
+bool SessionPlayer::run(QString *errorString)
+{
+    if (!this->saveDir.isValid()) {
+        if (errorString) *errorString = "Cannot create a temporary directory!";
+        return false;
+    }
+
+    this->latencies.clear();
+    for (int i=0; i < this->operations.size(); ++i) {
+        QJsonObject operation = this->operations.at(i).toObject();
+        QString op = operation.value("op").toString();
+
+        QElapsedTimer timer;
+        timer.start();
+        QString error;
+        if (!this->execute(operation, &error)) {
+            if (errorString) *errorString = QString("operation %1 (%2): %3").arg(i).arg(op).arg(error);
+            return false;
+        }
+        this->settle(static_cast<libblockdia::ViewBlockEditor*>(this->window->widgetMain->currentWidget()));
+        this->latencies[op].append(timer.nsecsElapsed() / 1e6);
+    }
+
+    return true;
+}
+
+QString SessionPlayer::report() const
+{
+    QString text;
+    QTextStream out(&text);
+    out << QString("%1 %2 %3 %4 %5 %6\n").arg("operation", -16).arg("count", 7).arg("p50 ms", 9).arg("p90 ms", 9).arg("p99 ms", 9).arg("max ms", 9);
+    for (QMap<QString, QList<double> >::const_iterator it = this->latencies.constBegin(); it != this->latencies.constEnd(); ++it) {
+        QList<double> values = it.value();
+        std::sort(values.begin(), values.end());
+        out << QString("%1 %2 %3 %4 %5 %6\n").arg(it.key(), -16).arg(values.size(), 7)
+               .arg(SessionPlayer::percentile(values, 50), 9, 'f', 3)
+               .arg(SessionPlayer::percentile(values, 90), 9, 'f', 3)
+               .arg(SessionPlayer::percentile(values, 99), 9, 'f', 3)
+               .arg(values.last(), 9, 'f', 3);
+    }
+    return text;
+}
+
+bool SessionPlayer::writeCsv(const QString &filePath, QString *errorString) const
+{
+    QSaveFile f(filePath);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (errorString) *errorString = f.errorString();
+        return false;
+    }
+
+    QTextStream out(&f);
+    out << "operation,count,p50_ms,p90_ms,p99_ms,max_ms\n";
+    for (QMap<QString, QList<double> >::const_iterator it = this->latencies.constBegin(); it != this->latencies.constEnd(); ++it) {
+        QList<double> values = it.value();
+        std::sort(values.begin(), values.end());
+        out << it.key() << "," << values.size()
+            << "," << QString::number(SessionPlayer::percentile(values, 50), 'f', 3)
+            << "," << QString::number(SessionPlayer::percentile(values, 90), 'f', 3)
+            << "," << QString::number(SessionPlayer::percentile(values, 99), 'f', 3)
+            << "," << QString::number(values.last(), 'f', 3) << "\n";
+    }
+    out.flush();
+
+    if (!f.commit()) {
+        if (errorString) *errorString = f.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool SessionPlayer::execute(const QJsonObject &operation, QString *errorString)
+{
+    QString op = operation.value("op").toString();
+    QTabWidget *tw = this->window->widgetMain;
+
+    // operations without an editor
+    if (op == "open") {
+        QString path = operation.value("path").toString();
+        if (QDir::isRelativePath(path)) path = QDir(this->libraryPath).filePath(path);
+        return this->window->openFile(path, errorString);
+    } else if (op == "new") {
+        this->window->slotActionNewBlock();
+        return true;
+    }
+
+    // all other operations need an editor
+    libblockdia::ViewBlockEditor *editor = this->editor(operation);
+    if (!editor) {
+        *errorString = "no such tab";
+        return false;
+    }
+    libblockdia::Block *block = editor->block();
+    int index = operation.value("index").toInt();
+
+    if (op == "close") {
+        this->window->closeEditor(tw->indexOf(editor));
+    }
+
+    else if (op == "tab") {
+        tw->setCurrentWidget(editor);
+    }
+
+    else if (op == "zoom") {
+        editor->zoom(operation.value("factor").toDouble());
+    }
+
+    else if (op == "zoomDefault") {
+        this->window->slotActionViewZoomDefault();
+    }
+
+    // hovering is replayed as mouse move of the viewport
+    else if (op == "hover") {
+        QPoint pos = editor->mapFromScene(QPointF(operation.value("x").toDouble(), operation.value("y").toDouble()));
+        QMouseEvent event(QEvent::MouseMove, pos, editor->viewport()->mapToGlobal(pos), Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+        QApplication::sendEvent(editor->viewport(), &event);
+    }
+
+    // edits are replayed through the dialogs of the context menu
+    else if (op == "editHeader") {
+        libblockdia::BlockData data;
+        data.typeId = operation.value("typeId").toString();
+        data.typeName = operation.value("typeName").toString();
+        data.instanceId = operation.value("instanceId").toString();
+        data.instanceName = operation.value("instanceName").toString();
+        data.color = QColor(operation.value("color").toString());
+        libblockdia::DialogEditHeader dialog(block);
+        dialog.loadData(data);
+        dialog.accept();
+    }
+
+    else if (op == "editParameter") {
+        QList<libblockdia::BlockParameter*> params = block->getParameters();
+        if (index < 0 || index >= params.size()) {
+            *errorString = "no such parameter";
+            return false;
+        }
+        libblockdia::BlockParameterData data = SessionRecorder::parameterFromJson(operation.value("parameter").toObject());
+        QString paramType = params.at(index)->metaObject()->className();
+        if (data.type == "int" && paramType == "libblockdia::BlockParameterInt") {
+            libblockdia::DialogEditParameterInt dialog((libblockdia::BlockParameterInt *) params.at(index));
+            dialog.loadData(data);
+            dialog.accept();
+        } else if (data.type == "str" && paramType == "libblockdia::BlockParameterStr") {
+            libblockdia::DialogEditParameterStr dialog((libblockdia::BlockParameterStr *) params.at(index));
+            dialog.loadData(data);
+            dialog.accept();
+        } else if (data.type == "enum" && paramType == "libblockdia::BlockParameterEnum") {
+            libblockdia::DialogEditParameterEnum dialog((libblockdia::BlockParameterEnum *) params.at(index));
+            dialog.loadData(data);
+            dialog.accept();
+        } else if (data.type == "array" && paramType == "libblockdia::BlockParameterArray") {
+            libblockdia::DialogEditParameterArray dialog((libblockdia::BlockParameterArray *) params.at(index));
+            dialog.loadData(data);
+            dialog.accept();
+        } else {
+            *errorString = "parameter type mismatch";
+            return false;
+        }
+    }
+
+    else if (op == "addParameter") {
+        QString type = operation.value("type").toString();
+        if (type == "int") new libblockdia::BlockParameterInt("new parameter", block);
+        else if (type == "str") new libblockdia::BlockParameterStr("new parameter", block);
+        else if (type == "enum") new libblockdia::BlockParameterEnum("new parameter", block);
+        else if (type == "array") new libblockdia::BlockParameterArray("new parameter", block);
+        else {
+            *errorString = "unknown parameter type '" + type + "'";
+            return false;
+        }
+    }
+
+    else if (op == "removeParameter") {
+        QList<libblockdia::BlockParameter*> params = block->getParameters();
+        if (index < 0 || index >= params.size()) {
+            *errorString = "no such parameter";
+            return false;
+        }
+        params.at(index)->deleteLater();
+    }
+
+    else if (op == "addInput") {
+        new libblockdia::BlockInput("new input", block);
+    }
+
+    else if (op == "editInput" || op == "removeInput") {
+        QList<libblockdia::BlockInput*> inputs = block->getInputs();
+        if (index < 0 || index >= inputs.size()) {
+            *errorString = "no such input";
+            return false;
+        }
+        if (op == "removeInput") {
+            inputs.at(index)->deleteLater();
+        } else {
+            libblockdia::DialogEditInput dialog(inputs.at(index));
+            dialog.loadName(operation.value("name").toString());
+            dialog.accept();
+        }
+    }
+
+    else if (op == "addOutput") {
+        new libblockdia::BlockOutput("new output", block);
+    }
+
+    else if (op == "editOutput" || op == "removeOutput") {
+        QList<libblockdia::BlockOutput*> outputs = block->getOutputs();
+        if (index < 0 || index >= outputs.size()) {
+            *errorString = "no such output";
+            return false;
+        }
+        if (op == "removeOutput") {
+            outputs.at(index)->deleteLater();
+        } else {
+            libblockdia::DialogEditOutput dialog(outputs.at(index));
+            dialog.loadName(operation.value("name").toString());
+            dialog.accept();
+        }
+    }
+
+    // undo and redo work on the current tab
+    else if (op == "undo" || op == "redo") {
+        tw->setCurrentWidget(editor);
+        if (op == "undo") this->window->slotActionUndo();
+        else this->window->slotActionRedo();
+    }
+
+    // blocks are saved into the temporary directory (including the time for writing the file)
+    else if (op == "save") {
+        QString filePath = QDir(this->saveDir.path()).filePath(QString("%1.xml").arg(this->countSaves++));
+        this->window->saveBlock(block, filePath);
+        this->window->blockSaver->waitForFinished();
+    }
+
+    else {
+        *errorString = "unknown operation";
+        return false;
+    }
+
+    return true;
+}
+
+libblockdia::ViewBlockEditor *SessionPlayer::editor(const QJsonObject &operation)
+{
+    // operations without tab work on the current tab
+    QTabWidget *tw = this->window->widgetMain;
+    int index = operation.value("tab").toInt(tw->currentIndex());
+    if (index < 0 || index >= tw->count()) return Q_NULLPTR;
+    return static_cast<libblockdia::ViewBlockEditor*>(tw->widget(index));
+}
+
+void SessionPlayer::settle(libblockdia::ViewBlockEditor *editor)
+{
+    // children are deleted delayed and the graphic items follow the block by signals
+    QApplication::processEvents();
+    QApplication::sendPostedEvents(Q_NULLPTR, QEvent::DeferredDelete);
+    QApplication::processEvents();
+
+    // the frame is painted synchronously, as it would be shown to the user
+    if (editor) editor->viewport()->repaint();
+}
+
+double SessionPlayer::percentile(const QList<double> &sortedValues, double p)
+{
+    // nearest-rank method
+    if (sortedValues.isEmpty()) return 0;
+    int rank = qCeil(p / 100.0 * sortedValues.size());
+    return sortedValues.at(qBound(1, rank, sortedValues.size()) - 1);
+}
@@ -0,0 +1,82 @@
+#ifndef SESSIONPLAYER_H
+#define SESSIONPLAYER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QMap>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <mainwindow.h>
+
+/**
+ * @brief Replaying a recorded editor session (see SessionRecorder) and measuring the latency of each operation.
+ *
+ * The operations are executed through the same code paths as user input
+ * (edits through the DialogEdit* dialogs, hovering through mouse events of the viewport),
+ * but without any delay between them and without interactive dialogs.
+ * Blocks are saved into a temporary directory instead of their original files.
+ *
+ * The latency of an operation includes processing all resulting events
+ * (delayed deletions, layout) and repainting the current editor.
+ */
+class SessionPlayer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SessionPlayer(MainWindow *window, QObject *parent = nullptr);
+
+    /**
+     * @details Loading a session file.
+     * @param filePath The path of the session file
+     * @param errorString Set to a description of the error on failure
+     * @return True on success
+     */
+    bool load(const QString &filePath, QString *errorString = Q_NULLPTR);
+
+    /**
+     * @details Overriding the library root that relative block paths are resolved against
+     * (by default the library of the recording).
+     * @param libraryPath The root directory of the block library
+     */
+    void setLibraryPath(const QString &libraryPath);
+
+    /**
+     * @details Executing all operations of the session.
+     * The replay stops at the first operation that cannot be executed.
+     * @param errorString Set to a description of the error on failure
+     * @return True if all operations have been executed
+     */
+    bool run(QString *errorString = Q_NULLPTR);
+
+    /**
+     * @return A summary of the latencies per operation type (one line per type)
+     */
+    QString report() const;
+
+    /**
+     * @details Writing the latencies per operation type as CSV
+     * (columns: operation, count, p50_ms, p90_ms, p99_ms, max_ms).
+     * @param filePath The path of the CSV file
+     * @param errorString Set to a description of the error on failure
+     * @return True on success
+     */
+    bool writeCsv(const QString &filePath, QString *errorString = Q_NULLPTR) const;
+
+private:
+    bool execute(const QJsonObject &operation, QString *errorString);
+    libblockdia::ViewBlockEditor *editor(const QJsonObject &operation);
+    void settle(libblockdia::ViewBlockEditor *editor);
+    static double percentile(const QList<double> &sortedValues, double p);
+
+    MainWindow *window;
+    QString libraryPath;
+    QJsonArray operations;
+    QTemporaryDir saveDir;
+    int countSaves;
+    QMap<QString, QList<double> > latencies;
+};
+
+#endif // SESSIONPLAYER_H
@@ -0,0 +1,349 @@
+#include "sessionrecorder.h"
+
+#include <QDir>
+#include <QEvent>
+#include <QMouseEvent>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+#include <graphicitemblock.h>
+
+// version of the session file format
+#define SESSION_VERSION 1
+
+SessionRecorder::SessionRecorder(const QString &libraryPath, QObject *parent) : QObject(parent)
+{
+    this->libraryPath = QDir(libraryPath).absolutePath();
+    this->currentTab = -1;
+    this->timer.start();
+}
+
+void SessionRecorder::attachEditor(libblockdia::ViewBlockEditor *editor)
+{
+    libblockdia::Block *block = editor->block();
+    this->editors.append(editor);
+    this->currentTab = this->editors.size() - 1;
+    this->baselines.insert(block, block->snapshot());
+
+    connect(editor, SIGNAL(signalZoomed(qreal)), this, SLOT(slotZoomed(qreal)));
+    connect(editor->graphicItem(), SIGNAL(signalEdited()), this, SLOT(slotEdited()));
+    connect(block, SIGNAL(signalDataChanged(libblockdia::Block*)), this, SLOT(slotBlockDataChanged(libblockdia::Block*)));
+
+    // hovering is recorded from the mouse moves of the viewport
+    editor->viewport()->installEventFilter(this);
+    connect(editor->viewport(), SIGNAL(destroyed(QObject*)), this, SLOT(slotViewportDestroyed(QObject*)));
+}
+
+void SessionRecorder::recordOpen(const QString &filePath)
+{
+    // files of the library are recorded relative, so sessions can be replayed with another checkout
+    QString path = QDir(filePath).absolutePath();
+    if (path.startsWith(this->libraryPath + "/")) path = QDir(this->libraryPath).relativeFilePath(path);
+
+    QJsonObject operation;
+    operation.insert("path", path);
+    this->append("open", operation);
+}
+
+void SessionRecorder::recordNewBlock()
+{
+    this->append("new");
+}
+
+void SessionRecorder::recordClose(int index)
+{
+    if (index < 0 || index >= this->editors.size()) return;
+    this->flushEdits();
+
+    libblockdia::ViewBlockEditor *editor = this->editors.takeAt(index);
+    disconnect(editor, Q_NULLPTR, this, Q_NULLPTR);
+    disconnect(editor->block(), Q_NULLPTR, this, Q_NULLPTR);
+    editor->viewport()->removeEventFilter(this);
+    this->hoveredItems.remove(editor->viewport());
+    this->baselines.remove(editor->block());
+    this->editedBlocks.remove(editor->block());
+    this->currentTab = -1;
+
+    QJsonObject operation;
+    operation.insert("tab", index);
+    this->append("close", operation);
+}
+
+void SessionRecorder::recordTab(int index)
+{
+    // new and closed tabs change the current tab on their own
+    if (index == this->currentTab || index >= this->editors.size()) return;
+    this->currentTab = index;
+
+    QJsonObject operation;
+    operation.insert("tab", index);
+    this->append("tab", operation);
+}
+
+void SessionRecorder::recordZoomDefault()
+{
+    this->append("zoomDefault");
+}
+
+void SessionRecorder::recordSave(libblockdia::Block *block)
+{
+    this->recordEdits(block);
+
+    QJsonObject operation;
+    operation.insert("tab", this->indexOfBlock(block));
+    this->append("save", operation);
+}
+
+void SessionRecorder::recordUndo(libblockdia::Block *block)
+{
+    QJsonObject operation;
+    operation.insert("tab", this->indexOfBlock(block));
+    this->append("undo", operation);
+
+    // the block is compared against its restored state from now on
+    this->baselines.insert(block, block->snapshot());
+}
+
+void SessionRecorder::recordRedo(libblockdia::Block *block)
+{
+    QJsonObject operation;
+    operation.insert("tab", this->indexOfBlock(block));
+    this->append("redo", operation);
+
+    this->baselines.insert(block, block->snapshot());
+}
+
+void SessionRecorder::flushEdits()
+{
+    QList<libblockdia::Block*> blocks = this->editedBlocks.values();
+    for (int i=0; i < blocks.size(); ++i) this->recordEdits(blocks.at(i));
+}
+
+int SessionRecorder::countOperations() const
+{
+    return this->operations.size();
+}
+
+bool SessionRecorder::save(const QString &filePath, QString *errorString) const
+{
+    QJsonObject root;
+    root.insert("version", SESSION_VERSION);
+    root.insert("library", this->libraryPath);
+    root.insert("operations", this->operations);
+
+    QSaveFile f(filePath);
+    if (!f.open(QIODevice::WriteOnly) || f.write(QJsonDocument(root).toJson()) < 0 || !f.commit()) {
+        if (errorString) *errorString = f.errorString();
+        return false;
+    }
+    return true;
+}
+
+QJsonObject SessionRecorder::parameterToJson(const libblockdia::BlockParameterData &param)
+{
+    QJsonObject obj;
+    obj.insert("type", param.type);
+    obj.insert("name", param.name);
+    obj.insert("isPublic", param.isPublic);
+    obj.insert("defaultValue", param.defaultValue);
+    if (param.type == "int") {
+        obj.insert("minimum", param.minimum);
+        obj.insert("maximum", param.maximum);
+    }
+    if (param.type == "enum") obj.insert("enumItems", QJsonArray::fromStringList(param.enumItems));
+    if (param.type == "array") {
+        obj.insert("elementType", param.elementType);
+        obj.insert("elementMinimum", param.elementMinimum);
+        obj.insert("elementMaximum", param.elementMaximum);
+    }
+    if (!param.expression.isEmpty()) obj.insert("expression", param.expression);
+    return obj;
+}
+
+libblockdia::BlockParameterData SessionRecorder::parameterFromJson(const QJsonObject &obj)
+{
+    libblockdia::BlockParameterData param;
+    param.type = obj.value("type").toString();
+    param.name = obj.value("name").toString();
+    param.isPublic = obj.value("isPublic").toBool();
+    param.defaultValue = obj.value("defaultValue").toString();
+    param.expression = obj.value("expression").toString();
+    param.minimum = obj.value("minimum").toInt(param.minimum);
+    param.maximum = obj.value("maximum").toInt(param.maximum);
+    param.elementType = obj.value("elementType").toString();
+    param.elementMinimum = obj.value("elementMinimum").toDouble(param.elementMinimum);
+    param.elementMaximum = obj.value("elementMaximum").toDouble(param.elementMaximum);
+    QJsonArray items = obj.value("enumItems").toArray();
+    for (int i=0; i < items.size(); ++i) param.enumItems.append(items.at(i).toString());
+    return param;
+}
+
+void SessionRecorder::slotZoomed(qreal factor)
+{
+    QJsonObject operation;
+    operation.insert("factor", factor);
+    this->append("zoom", operation);
+}
+
+void SessionRecorder::slotEdited()
+{
+    // children are added and deleted delayed,
+    // so the block is compared again on its next data change
+    libblockdia::GraphicItemBlock *item = qobject_cast<libblockdia::GraphicItemBlock*>(this->sender());
+    for (int i=0; i < this->editors.size(); ++i) {
+        if (this->editors.at(i)->graphicItem() == item) {
+            libblockdia::Block *block = this->editors.at(i)->block();
+            this->editedBlocks.insert(block);
+            this->recordEdits(block);
+            break;
+        }
+    }
+}
+
+void SessionRecorder::slotBlockDataChanged(libblockdia::Block *block)
+{
+    // changes from undo, redo or reloading are not recorded as edits
+    if (this->editedBlocks.contains(block)) this->recordEdits(block);
+}
+
+void SessionRecorder::slotViewportDestroyed(QObject *obj)
+{
+    this->hoveredItems.remove(obj);
+}
+
+bool SessionRecorder::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() != QEvent::MouseMove) return false;
+
+    for (int i=0; i < this->editors.size(); ++i) {
+        libblockdia::ViewBlockEditor *editor = this->editors.at(i);
+        if (editor->viewport() != watched) continue;
+
+        // only moves onto another item are recorded (the hover highlighting changes)
+        QPoint pos = static_cast<QMouseEvent*>(event)->pos();
+        QGraphicsItem *item = editor->itemAt(pos);
+        if (this->hoveredItems.value(watched, Q_NULLPTR) == item) break;
+        this->hoveredItems.insert(watched, item);
+
+        QPointF scenePos = editor->mapToScene(pos);
+        QJsonObject operation;
+        operation.insert("tab", i);
+        operation.insert("x", scenePos.x());
+        operation.insert("y", scenePos.y());
+        this->append("hover", operation);
+        break;
+    }
+
+    return false;
+}
+
+void SessionRecorder::append(const QString &op, QJsonObject operation)
+{
+    operation.insert("op", op);
+    operation.insert("t", this->timer.elapsed());
+    this->operations.append(operation);
+}
+
+void SessionRecorder::recordEdits(libblockdia::Block *block)
+{
+    int index = this->indexOfBlock(block);
+    if (index < 0 || !this->baselines.contains(block)) return;
+
+    libblockdia::BlockData &baseline = this->baselines[block];
+    libblockdia::BlockData current = block->snapshot();
+
+    // header
+    if (baseline.typeId != current.typeId || baseline.typeName != current.typeName
+            || baseline.instanceId != current.instanceId || baseline.instanceName != current.instanceName
+            || baseline.color != current.color) {
+        QJsonObject operation;
+        operation.insert("tab", index);
+        operation.insert("typeId", current.typeId);
+        operation.insert("typeName", current.typeName);
+        operation.insert("instanceId", current.instanceId);
+        operation.insert("instanceName", current.instanceName);
+        operation.insert("color", current.color.name(QColor::HexArgb));
+        this->append("editHeader", operation);
+        baseline.typeId = current.typeId;
+        baseline.typeName = current.typeName;
+        baseline.instanceId = current.instanceId;
+        baseline.instanceName = current.instanceName;
+        baseline.color = current.color;
+    }
+
+    // deleted parameters (the first differing parameter is the deleted one)
+    while (baseline.parameters.size() > current.parameters.size()) {
+        int i = 0;
+        while (i < current.parameters.size() && baseline.parameters.at(i) == current.parameters.at(i)) ++i;
+        QJsonObject operation;
+        operation.insert("tab", index);
+        operation.insert("index", i);
+        this->append("removeParameter", operation);
+        baseline.parameters.removeAt(i);
+    }
+
+    // added parameters (new parameters are appended)
+    while (baseline.parameters.size() < current.parameters.size()) {
+        const libblockdia::BlockParameterData &param = current.parameters.at(baseline.parameters.size());
+        QJsonObject operation;
+        operation.insert("tab", index);
+        operation.insert("type", param.type);
+        this->append("addParameter", operation);
+        baseline.parameters.append(param);
+    }
+
+    // edited parameters
+    for (int i=0; i < current.parameters.size(); ++i) {
+        if (baseline.parameters.at(i) == current.parameters.at(i)) continue;
+        QJsonObject operation;
+        operation.insert("tab", index);
+        operation.insert("index", i);
+        operation.insert("parameter", SessionRecorder::parameterToJson(current.parameters.at(i)));
+        this->append("editParameter", operation);
+        baseline.parameters[i] = current.parameters.at(i);
+    }
+
+    this->recordNames(index, "Input", &baseline.inputs, current.inputs);
+    this->recordNames(index, "Output", &baseline.outputs, current.outputs);
+}
+
+void SessionRecorder::recordNames(int index, const QString &kind, QStringList *baseline, const QStringList &names)
+{
+    // deleted
+    while (baseline->size() > names.size()) {
+        int i = 0;
+        while (i < names.size() && baseline->at(i) == names.at(i)) ++i;
+        QJsonObject operation;
+        operation.insert("tab", index);
+        operation.insert("index", i);
+        this->append("remove" + kind, operation);
+        baseline->removeAt(i);
+    }
+
+    // added
+    while (baseline->size() < names.size()) {
+        QJsonObject operation;
+        operation.insert("tab", index);
+        this->append("add" + kind, operation);
+        baseline->append(names.at(baseline->size()));
+    }
+
+    // renamed
+    for (int i=0; i < names.size(); ++i) {
+        if (baseline->at(i) == names.at(i)) continue;
+        QJsonObject operation;
+        operation.insert("tab", index);
+        operation.insert("index", i);
+        operation.insert("name", names.at(i));
+        this->append("edit" + kind, operation);
+        (*baseline)[i] = names.at(i);
+    }
+}
+
+int SessionRecorder::indexOfBlock(libblockdia::Block *block)
+{
+    for (int i=0; i < this->editors.size(); ++i) {
+        if (this->editors.at(i)->block() == block) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,106 @@
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QGraphicsItem>
+
+#include <libblockdia.h>
+
+/**
+ * @brief Recording the user operations of the block editor into a session file.
+ *
+ * The session is a JSON document:
+ * {"version": 1, "library": <library root>, "operations": [{"op": .., "t": <ms since start>, ..}, ..]}
+ *
+ * Operations are recorded on the level of the block model, not as raw input events:
+ * opening and closing blocks, switching tabs, zooming, hovering items and saving are recorded directly.
+ * Edits from the context menu of a block are recorded as the difference of the block data
+ * before and after the edit (eg. "editParameter" with the new parameter data),
+ * so they can be replayed through the same edit dialogs (see SessionPlayer).
+ * Undo and redo are recorded as such.
+ *
+ * The MainWindow notifies the recorder about its operations,
+ * the recorder follows the editors on its own (zoom, hover, edits).
+ */
+class SessionRecorder : public QObject
+{
+    Q_OBJECT
+public:
+
+    /**
+     * @param libraryPath The root directory of the block library (paths inside are recorded relative to it)
+     * @param parent The parent object
+     */
+    explicit SessionRecorder(const QString &libraryPath, QObject *parent = nullptr);
+
+    /**
+     * @details Following the user operations of an editor.
+     * Editors are expected to be attached in the order of their tabs (new editors are appended).
+     * @param editor The editor of a newly opened block
+     */
+    void attachEditor(libblockdia::ViewBlockEditor *editor);
+
+    void recordOpen(const QString &filePath);
+    void recordNewBlock();
+    void recordClose(int index);
+    void recordTab(int index);
+    void recordZoomDefault();
+    void recordSave(libblockdia::Block *block);
+    void recordUndo(libblockdia::Block *block);
+    void recordRedo(libblockdia::Block *block);
+
+    /**
+     * @details Recording all edits of the blocks that have not been recorded yet.
+     * Must be called before operations that change blocks without the context menu (eg. undo).
+     */
+    void flushEdits();
+
+    /**
+     * @return The number of recorded operations
+     */
+    int countOperations() const;
+
+    /**
+     * @details Writing the session file.
+     * @param filePath The path of the session file
+     * @param errorString Set to a description of the error on failure
+     * @return True on success
+     */
+    bool save(const QString &filePath, QString *errorString = Q_NULLPTR) const;
+
+    /**
+     * @details Converting parameter data into the JSON object of a session (and back).
+     */
+    static QJsonObject parameterToJson(const libblockdia::BlockParameterData &param);
+    static libblockdia::BlockParameterData parameterFromJson(const QJsonObject &obj);
+
+private slots:
+    void slotZoomed(qreal factor);
+    void slotEdited();
+    void slotBlockDataChanged(libblockdia::Block *block);
+    void slotViewportDestroyed(QObject *obj);
+
+private:
+    bool eventFilter(QObject *watched, QEvent *event);
+    void append(const QString &op, QJsonObject operation = QJsonObject());
+    void recordEdits(libblockdia::Block *block);
+    void recordNames(int index, const QString &kind, QStringList *baseline, const QStringList &names);
+    int indexOfBlock(libblockdia::Block *block);
+
+    QString libraryPath;
+    QElapsedTimer timer;
+    QJsonArray operations;
+    QList<libblockdia::ViewBlockEditor*> editors;
+    int currentTab;
+    QHash<libblockdia::Block*, libblockdia::BlockData> baselines;
+    QSet<libblockdia::Block*> editedBlocks;
+    QHash<QObject*, QGraphicsItem*> hoveredItems;
+};
+
+#endif // SESSIONRECORDER_H
@@ -0,0 +1,307 @@
+#include "blocklayout.h"
+
+#include <QFontMetrics>
+#include <QBrush>
+#include <blocktrace.h>
+
+// padding between text and border of a text box
+#define TEXTBOX_PADDING     5
+
+// padding within the header
+#define HEADER_PADDING_H    10
+#define HEADER_PADDING_V    5
+
+// colors
+#define COLOR_HOVERED       "#444"
+#define COLOR_PARAMETER     "#ffe"
+#define COLOR_INPUT         "#eef"
+#define COLOR_OUTPUT        "#fee"
+
+libblockdia::BlockLayout::BlockLayout()
+{
+    this->header = layoutHeader(QString(), QString(), QString(), QColor("#fff"));
+}
+
+libblockdia::BlockLayout::BlockLayout(const libblockdia::BlockData &data)
+{
+    BLOCKDIA_TRACE_SCOPE("BlockLayout::BlockLayout");
+    qreal widthMaximum = 0;
+    qreal widthInputs = 0;
+    qreal widthOutputs = 0;
+    qreal heightMaximum = 0;
+
+
+    // ------------------------------------------------------------------------
+    //                                Create Boxes
+    // ------------------------------------------------------------------------
+
+    // header
+    this->header = layoutHeader(data.instanceName, data.typeName, data.typeId + data.instanceId, data.color);
+    if (this->header.neededWidth > widthMaximum) widthMaximum = this->header.neededWidth;
+    this->header.pos.setY(heightMaximum + this->header.rect.height() / 2.0);
+    heightMaximum += this->header.rect.height();
+
+    // public parameters
+    for (int i=0; i < data.parameters.size(); ++i) {
+        const BlockParameterData &param = data.parameters.at(i);
+        if (!param.isPublic) continue;
+        TextBox box = layoutTextBox(param.name + " = " + param.displayValue(), Align::Center, QColor(COLOR_PARAMETER));
+        box.index = i;
+        if (box.neededWidth > widthMaximum) widthMaximum = box.neededWidth;
+        box.pos.setY(heightMaximum + box.rect.height() / 2.0);
+        heightMaximum += box.rect.height();
+        this->publicParameters.append(box);
+    }
+
+    // inputs/outputs
+    int countInOuts = (data.inputs.size() > data.outputs.size()) ? data.inputs.size() : data.outputs.size();
+    for (int i=0; i < countInOuts; ++i) {
+        TextBox input = layoutTextBox((i < data.inputs.size()) ? data.inputs.at(i) : QString(), Align::Left, QColor(COLOR_INPUT));
+        TextBox output = layoutTextBox((i < data.outputs.size()) ? data.outputs.at(i) : QString(), Align::Right, QColor(COLOR_OUTPUT));
+        input.index = (i < data.inputs.size()) ? i : -1;
+        output.index = (i < data.outputs.size()) ? i : -1;
+
+        // calculate width
+        if (input.neededWidth > widthInputs) widthInputs = input.neededWidth;
+        if (output.neededWidth > widthOutputs) widthOutputs = output.neededWidth;
+        qreal w = widthInputs + widthOutputs;
+        if (w > widthMaximum) widthMaximum = w;
+
+        // calculate height
+        input.pos.setY(heightMaximum + input.rect.height() / 2.0);
+        output.pos.setY(heightMaximum + output.rect.height() / 2.0);
+        heightMaximum += (input.rect.height() > output.rect.height()) ? input.rect.height() : output.rect.height();
+
+        this->inputs.append(input);
+        this->outputs.append(output);
+    }
+
+    // private parameters
+    for (int i=0; i < data.parameters.size(); ++i) {
+        const BlockParameterData &param = data.parameters.at(i);
+        if (param.isPublic) continue;
+        TextBox box = layoutTextBox(param.name + " = " + param.displayValue(), Align::Center, QColor(COLOR_PARAMETER));
+        box.index = i;
+        if (box.neededWidth > widthMaximum) widthMaximum = box.neededWidth;
+        box.pos.setY(heightMaximum + box.rect.height() / 2.0);
+        heightMaximum += box.rect.height();
+        this->privateParameters.append(box);
+    }
+
+
+    // ------------------------------------------------------------------------
+    //                              Update Positons
+    // ------------------------------------------------------------------------
+
+    // header
+    setMinWidth(&this->header, widthMaximum);
+    this->header.pos.ry() -= heightMaximum / 2.0;
+
+    // parameters
+    for (int i=0; i < this->publicParameters.size(); ++i) {
+        setMinWidth(&this->publicParameters[i], widthMaximum);
+        this->publicParameters[i].pos.ry() -= heightMaximum / 2.0;
+    }
+    for (int i=0; i < this->privateParameters.size(); ++i) {
+        setMinWidth(&this->privateParameters[i], widthMaximum);
+        this->privateParameters[i].pos.ry() -= heightMaximum / 2.0;
+    }
+
+    // stretch i/o widths
+    if ((widthInputs + widthOutputs) < widthMaximum) {
+        int w = widthMaximum - widthInputs - widthOutputs;
+        widthInputs += w/2.0;
+        widthOutputs += w/2.0;
+    }
+
+    // inputs/outputs
+    for (int i=0; i < this->inputs.size(); ++i) {
+        TextBox &input = this->inputs[i];
+        setMinWidth(&input, widthInputs);
+        input.pos.ry() -= heightMaximum / 2.0;
+        input.pos.setX(- widthMaximum / 2.0 + input.rect.width() / 2.0);
+
+        TextBox &output = this->outputs[i];
+        setMinWidth(&output, widthOutputs);
+        output.pos.ry() -= heightMaximum / 2.0;
+        output.pos.setX(widthMaximum / 2.0 - output.rect.width() / 2.0);
+    }
+
+    this->boundingRect = QRectF(- widthMaximum / 2.0, - heightMaximum / 2.0, widthMaximum, heightMaximum);
+}
+
+void libblockdia::BlockLayout::paint(QPainter *painter) const
+{
+    BLOCKDIA_TRACE_SCOPE("BlockLayout::paint");
+    painter->save();
+    painter->translate(this->header.pos);
+    paintHeader(painter, this->header);
+    painter->restore();
+
+    QList<const QList<TextBox> *> lists;
+    lists << &this->publicParameters << &this->inputs << &this->outputs << &this->privateParameters;
+    for (int l=0; l < lists.size(); ++l) {
+        for (int i=0; i < lists.at(l)->size(); ++i) {
+            const TextBox &box = lists.at(l)->at(i);
+            painter->save();
+            painter->translate(box.pos);
+            paintTextBox(painter, box);
+            painter->restore();
+        }
+    }
+}
+
+libblockdia::BlockLayout::TextBox libblockdia::BlockLayout::layoutTextBox(const QString &text, Align align, const QColor &bgColor, qreal minWidth)
+{
+    TextBox box;
+    box.text = text;
+    box.align = align;
+    box.bgColor = bgColor;
+    box.index = -1;
+
+    // calculate text size
+    QFontMetrics fm = QFontMetrics(textBoxFont());
+    box.neededWidth = 2.0 * TEXTBOX_PADDING + fm.width(text);
+    qreal height = 2.0 * TEXTBOX_PADDING + fm.height();
+
+    // calculate bounding rect
+    qreal width = (minWidth > box.neededWidth) ? minWidth : box.neededWidth;
+    box.rect = QRectF(- width/2.0, - height/2.0, width, height);
+
+    return box;
+}
+
+void libblockdia::BlockLayout::paintTextBox(QPainter *painter, const TextBox &box, bool isHovered)
+{
+    // draw box
+    painter->fillRect(box.rect, QBrush((isHovered) ? QColor(COLOR_HOVERED) : box.bgColor));
+    painter->setPen(QColor(Qt::black));
+    painter->drawRect(box.rect);
+
+    // calculate text y position
+    QFont font = textBoxFont();
+    QFontMetrics fm = QFontMetrics(font);
+    qreal textY = - fm.descent() + fm.height() / 2.0;
+
+    // calculate text x position
+    qreal textX = 0.0;
+    if (box.align == Align::Left) {
+        textX = - box.rect.width() / 2.0 + TEXTBOX_PADDING;
+    } else if (box.align == Align::Center) {
+        textX = - box.neededWidth / 2.0 + TEXTBOX_PADDING;
+    } else if (box.align == Align::Right) {
+        textX = box.rect.width() / 2.0 - box.neededWidth + TEXTBOX_PADDING;
+    }
+
+    // draw text
+    painter->setFont(font);
+    painter->setPen((isHovered) ? QColor(Qt::white) : QColor(Qt::black));
+    painter->drawText(textX, textY, box.text);
+}
+
+libblockdia::BlockLayout::Header libblockdia::BlockLayout::layoutHeader(const QString &instanceName, const QString &typeName, const QString &ids, const QColor &color, qreal minWidth)
+{
+    Header header;
+    header.instanceName = instanceName;
+    header.typeName = typeName;
+    header.ids = ids;
+    header.color = color;
+
+    QFontMetrics fmInstanceName = QFontMetrics(instanceNameFont());
+    QFontMetrics fmTypeName = QFontMetrics(typeNameFont());
+    QFontMetrics fmId = QFontMetrics(idFont());
+
+    // calculate text widths
+    qreal widthInstanceName = fmInstanceName.width(instanceName);
+    qreal widthTypeName   = fmTypeName.width(typeName);
+    qreal widthId   = fmId.width(ids);
+    qreal widthTypeId = widthTypeName + HEADER_PADDING_H + widthId;
+    qreal widthTextMax = (widthInstanceName > widthTypeId) ? widthInstanceName : widthTypeId;
+
+    // calculate text heights
+    qreal heightTextMax = 0;
+    heightTextMax += fmInstanceName.height();
+    heightTextMax += HEADER_PADDING_V;
+    heightTextMax += (fmId.height() > fmTypeName.height()) ? fmId.height() : fmTypeName.height();
+
+    // set text positions
+    header.posInstanceName = QPointF(- widthInstanceName / 2.0, fmInstanceName.ascent() - heightTextMax / 2.0);
+    header.posTypeName = QPointF(- widthTypeId / 2.0, fmTypeName.ascent() - heightTextMax / 2.0 + fmInstanceName.height() + HEADER_PADDING_V);
+    header.posIds = QPointF(- widthTypeId / 2.0 + widthTypeName + HEADER_PADDING_H, fmId.ascent() - heightTextMax / 2.0 + fmInstanceName.height() + HEADER_PADDING_V);
+
+    // calculate bounding rect
+    header.neededWidth = widthTextMax + 2.0 * HEADER_PADDING_H;
+    qreal height = heightTextMax + 2.0 * HEADER_PADDING_V;
+    qreal width = (minWidth > header.neededWidth) ? minWidth : header.neededWidth;
+    header.rect = QRectF(- width / 2.0, - height / 2.0, width, height);
+
+    return header;
+}
+
+void libblockdia::BlockLayout::paintHeader(QPainter *painter, const Header &header, bool isHovered)
+{
+    // draw box
+    painter->fillRect(header.rect, QBrush((isHovered) ? QColor(COLOR_HOVERED) : header.color));
+    painter->setPen(QColor(Qt::black));
+    painter->drawRect(header.rect);
+
+    // set pen for text
+    painter->setPen((isHovered) ? QColor(Qt::white) : QColor(Qt::black));
+
+    // draw instance name
+    painter->setFont(instanceNameFont());
+    painter->drawText(header.posInstanceName, header.instanceName);
+
+    // draw type name
+    painter->setFont(typeNameFont());
+    painter->drawText(header.posTypeName, header.typeName);
+
+    // draw typeId + instacneId
+    painter->setFont(idFont());
+    painter->drawText(header.posIds, header.ids);
+}
+
+void libblockdia::BlockLayout::setMinWidth(TextBox *box, qreal minWidth)
+{
+    qreal width = (minWidth > box->neededWidth) ? minWidth : box->neededWidth;
+    box->rect.setX(- width / 2.0);
+    box->rect.setWidth(width);
+}
+
+void libblockdia::BlockLayout::setMinWidth(Header *header, qreal minWidth)
+{
+    qreal width = (minWidth > header->neededWidth) ? minWidth : header->neededWidth;
+    header->rect.setX(- width / 2.0);
+    header->rect.setWidth(width);
+}
+
+QFont libblockdia::BlockLayout::textBoxFont()
+{
+    return QFont();
+}
+
+QFont libblockdia::BlockLayout::instanceNameFont()
+{
+    QFont font;
+    font.setPointSize(font.pointSize() + 1);
+    font.setBold(true);
+    font.setItalic(false);
+    return font;
+}
+
+QFont libblockdia::BlockLayout::typeNameFont()
+{
+    QFont font;
+    font.setBold(false);
+    font.setItalic(false);
+    return font;
+}
+
+QFont libblockdia::BlockLayout::idFont()
+{
+    QFont font;
+    font.setPointSize(font.pointSize() - 3);
+    font.setBold(false);
+    font.setItalic(true);
+    return font;
+}
@@ -0,0 +1,160 @@
+#include "blockrenderer.h"
+
+#include <QRunnable>
+#include <QPainter>
+#include <QSvgGenerator>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QFontDatabase>
+#include <QtMath>
+
+#include <blocklayout.h>
+#include <blocktrace.h>
+
+// margin around the block (in block coordinates)
+#define RENDER_MARGIN 10
+
+namespace libblockdia {
+
+/**
+ * @brief A worker job that renders one block into a file.
+ */
+class BlockRendererJob : public QRunnable
+{
+public:
+    BlockRendererJob(BlockRenderer *renderer, const BlockData &data, const QString &filePath, qreal scale)
+    {
+        this->renderer = renderer;
+        this->data = data;
+        this->filePath = filePath;
+        this->scale = scale;
+    }
+
+    void run()
+    {
+        QString errorString;
+        bool success = BlockRenderer::renderFile(this->data, this->filePath, this->scale, &errorString);
+        this->renderer->countPendingJobs.fetchAndAddOrdered(-1);
+        emit this->renderer->signalRendered(this->filePath, success, errorString);
+    }
+
+private:
+    BlockRenderer *renderer;
+    BlockData data;
+    QString filePath;
+    qreal scale;
+};
+
+} // namespace libblockdia
+
+libblockdia::BlockRenderer::BlockRenderer(QObject *parent) : QObject(parent)
+{
+    this->threadPool = new QThreadPool(this);
+    this->countPendingJobs.store(0);
+    this->imageScale = 1.0;
+    this->isThreaded = QFontDatabase::supportsThreadedFontRendering();
+}
+
+libblockdia::BlockRenderer::~BlockRenderer()
+{
+    // jobs reference this object
+    this->threadPool->waitForDone();
+}
+
+void libblockdia::BlockRenderer::setMaxThreadCount(int count)
+{
+    this->threadPool->setMaxThreadCount(count);
+}
+
+void libblockdia::BlockRenderer::setScale(qreal scale)
+{
+    this->imageScale = scale;
+}
+
+void libblockdia::BlockRenderer::render(const libblockdia::BlockData &data, const QString &filePath)
+{
+    this->countPendingJobs.fetchAndAddOrdered(1);
+    BlockRendererJob *job = new BlockRendererJob(this, data, filePath, this->imageScale);
+
+    if (this->isThreaded) {
+        this->threadPool->start(job);
+    } else {
+        job->run();
+        delete job;
+    }
+}
+
+bool libblockdia::BlockRenderer::isRunning()
+{
+    return this->countPendingJobs.load() > 0;
+}
+
+void libblockdia::BlockRenderer::waitForFinished()
+{
+    this->threadPool->waitForDone();
+}
+
+QImage libblockdia::BlockRenderer::renderImage(const libblockdia::BlockData &data, qreal scale)
+{
+    BLOCKDIA_TRACE_SCOPE("BlockRenderer::renderImage");
+    BlockLayout layout(data);
+    QRectF source = layout.boundingRect.adjusted(-RENDER_MARGIN, -RENDER_MARGIN, RENDER_MARGIN, RENDER_MARGIN);
+
+    QImage image(qCeil(source.width() * scale), qCeil(source.height() * scale), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.scale(scale, scale);
+    painter.translate(- source.topLeft());
+    layout.paint(&painter);
+    painter.end();
+
+    return image;
+}
+
+bool libblockdia::BlockRenderer::renderSvg(const libblockdia::BlockData &data, QIODevice *dev)
+{
+    BLOCKDIA_TRACE_SCOPE("BlockRenderer::renderSvg");
+    BlockLayout layout(data);
+    QRectF source = layout.boundingRect.adjusted(-RENDER_MARGIN, -RENDER_MARGIN, RENDER_MARGIN, RENDER_MARGIN);
+
+    QSvgGenerator generator;
+    generator.setOutputDevice(dev);
+    generator.setSize(source.size().toSize());
+    generator.setViewBox(source);
+    generator.setTitle(data.typeName);
+
+    QPainter painter;
+    if (!painter.begin(&generator)) return false;
+    layout.paint(&painter);
+    return painter.end();
+}
+
+bool libblockdia::BlockRenderer::renderFile(const libblockdia::BlockData &data, const QString &filePath, qreal scale, QString *errorString)
+{
+    QString error;
+
+    // the file is replaced atomically
+    QSaveFile f(filePath);
+    if (!f.open(QIODevice::WriteOnly)) {
+        error = f.errorString();
+    }
+
+    // SVG
+    else if (QFileInfo(filePath).suffix().toLower() == "svg") {
+        if (!renderSvg(data, &f)) error = "cannot paint SVG";
+    }
+
+    // image (format by suffix)
+    else {
+        QImageWriter writer(&f, QFileInfo(filePath).suffix().toLatin1());
+        if (!writer.write(renderImage(data, scale))) error = writer.errorString();
+    }
+
+    if (error.isEmpty() && !f.commit()) error = f.errorString();
+    if (!error.isEmpty()) f.cancelWriting();
+
+    if (errorString) *errorString = error;
+    return error.isEmpty();
+}
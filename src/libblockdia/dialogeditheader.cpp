@@ -95,3 +95,13 @@ void libblockdia::DialogEditHeader::slotColorDialog()
     this->colorEdit = dialog.getColor(this->colorEdit);
     this->btnColor.setText(this->colorEdit.name());
 }
+
+void libblockdia::DialogEditHeader::loadData(const libblockdia::BlockData &data)
+{
+    this->lineInstanceId.setText(data.instanceId);
+    this->lineInstanceName.setText(data.instanceName);
+    this->lineTypeId.setText(data.typeId);
+    this->lineTypeName.setText(data.typeName);
+    this->colorEdit = data.color;
+    this->btnColor.setText(this->colorEdit.name());
+}
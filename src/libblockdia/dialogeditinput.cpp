@@ -38,3 +38,8 @@ void libblockdia::DialogEditInput::slotWriteData()
 {
     this->input->setName(this->lineEditName.text().trimmed());
 }
+
+void libblockdia::DialogEditInput::loadName(const QString &name)
+{
+    this->lineEditName.setText(name);
+}
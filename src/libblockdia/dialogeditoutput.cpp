@@ -38,3 +38,8 @@ void libblockdia::DialogEditOutput::slotWriteData()
 {
     this->output->setName(this->lineEditName.text().trimmed());
 }
+
+void libblockdia::DialogEditOutput::loadName(const QString &name)
+{
+    this->lineEditName.setText(name);
+}
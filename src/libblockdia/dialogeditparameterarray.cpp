@@ -0,0 +1,304 @@
+#include "dialogeditparameterarray.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGridLayout>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QHeaderView>
+#include <QAbstractTableModel>
+#include <QApplication>
+#include <QClipboard>
+#include <QRegularExpression>
+#include <cmath>
+
+// largest number of elements that can be entered (80 MB of double elements)
+#define ARRAY_MAX_SIZE 10000000
+
+// significant digits of displayed elements
+#define ARRAY_DISPLAY_PRECISION 15
+
+namespace libblockdia {
+
+/*
+ * The elements of the edited array.
+ * Cells are only formatted when they are visible, so the table does not depend on the number of elements.
+ */
+class DialogEditParameterArrayModel : public QAbstractTableModel
+{
+public:
+    explicit DialogEditParameterArrayModel(QObject *parent) : QAbstractTableModel(parent)
+    {
+        this->isInt = false;
+    }
+
+    void setValues(const QVector<double> &values)
+    {
+        this->beginResetModel();
+        this->values = values;
+        this->endResetModel();
+    }
+
+    void setIntElements(bool isInt)
+    {
+        this->beginResetModel();
+        this->isInt = isInt;
+        if (isInt) {
+            for (int i=0; i < this->values.size(); ++i) this->values[i] = std::round(this->values.at(i));
+        }
+        this->endResetModel();
+    }
+
+    void resize(int size)
+    {
+        if (size > this->values.size()) {
+            this->beginInsertRows(QModelIndex(), this->values.size(), size - 1);
+            this->values.resize(size);
+            this->endInsertRows();
+        } else if (size < this->values.size()) {
+            this->beginRemoveRows(QModelIndex(), size, this->values.size() - 1);
+            this->values.resize(size);
+            this->endRemoveRows();
+        }
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const
+    {
+        return parent.isValid() ? 0 : this->values.size();
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const
+    {
+        return parent.isValid() ? 0 : 1;
+    }
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const
+    {
+        if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole)) return QVariant();
+        double v = this->values.at(index.row());
+        if (this->isInt) return QString::number((qint64) v);
+        return QString::number(v, 'g', ARRAY_DISPLAY_PRECISION);
+    }
+
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole)
+    {
+        if (!index.isValid() || role != Qt::EditRole) return false;
+
+        // unchanged text keeps the exact element
+        QString text = value.toString().trimmed();
+        if (text == this->data(index, Qt::EditRole).toString()) return true;
+
+        bool ok;
+        double d = text.toDouble(&ok);
+        if (!ok) return false;
+        this->values[index.row()] = (this->isInt) ? std::round(d) : d;
+        emit dataChanged(index, index);
+        return true;
+    }
+
+    Qt::ItemFlags flags(const QModelIndex &index) const
+    {
+        return QAbstractTableModel::flags(index) | Qt::ItemIsEditable;
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const
+    {
+        if (role != Qt::DisplayRole) return QVariant();
+        if (orientation == Qt::Vertical) return QString::number(section);
+        return QString("Value");
+    }
+
+    QVector<double> values;
+    bool isInt;
+};
+
+} // namespace libblockdia
+
+libblockdia::DialogEditParameterArray::DialogEditParameterArray(BlockParameterArray *param, QWidget *parent) : QDialog(parent)
+{
+    // setup configuration
+    this->setWindowTitle("Edit Array - " + param->name());
+    this->param = param;
+    this->setSizeGripEnabled(true);
+    connect(this, SIGNAL(accepted()), this, SLOT(slotWriteData()));
+
+    // element table
+    this->model = new DialogEditParameterArrayModel(this);
+    this->tableElements.setModel(this->model);
+    this->tableElements.horizontalHeader()->setStretchLastSection(true);
+    this->tableElements.verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);  // no per row size calculation
+    this->spinSize.setRange(0, ARRAY_MAX_SIZE);
+    this->comboElementType.addItem(BlockParameterArray::elementTypeName(BlockParameterArray::Int), BlockParameterArray::Int);
+    this->comboElementType.addItem(BlockParameterArray::elementTypeName(BlockParameterArray::Double), BlockParameterArray::Double);
+
+    // load values from block
+    this->lineEditName.setText(this->param->name());
+    this->checkPublic.setChecked(this->param->isPublic());
+    this->comboElementType.setCurrentIndex(this->comboElementType.findData(this->param->elementType()));
+    this->lineEditMin.setText(QString::number(this->param->minimum(), 'g', 17));
+    this->lineEditMax.setText(QString::number(this->param->maximum(), 'g', 17));
+    this->model->setIntElements(this->param->elementType() == BlockParameterArray::Int);
+    this->loadElements(this->param->defaultValues());
+    connect(&this->comboElementType, SIGNAL(currentIndexChanged(int)), this, SLOT(slotElementTypeChanged(int)));
+    connect(&this->spinSize, SIGNAL(valueChanged(int)), this, SLOT(slotSizeChanged(int)));
+
+    // create layout
+    QGridLayout *layoutGrid = new QGridLayout();
+    int gridRowCount = 0;
+
+    // add header row
+    layoutGrid->setColumnStretch(0, 0);
+    layoutGrid->setColumnStretch(1, 1);
+    layoutGrid->setRowStretch(gridRowCount, 0);
+    ++gridRowCount;
+
+    // add name edit
+    layoutGrid->addWidget(new QLabel("Name"), gridRowCount, 0, Qt::AlignRight);
+    layoutGrid->addWidget(&this->lineEditName, gridRowCount, 1);
+    layoutGrid->setRowStretch(gridRowCount, 0);
+    ++gridRowCount;
+
+    // add public edit
+    layoutGrid->addWidget(new QLabel("Public"), gridRowCount, 0, Qt::AlignRight);
+    layoutGrid->addWidget(&this->checkPublic, gridRowCount, 1);
+    layoutGrid->setRowStretch(gridRowCount, 0);
+    ++gridRowCount;
+
+    // add element type edit
+    layoutGrid->addWidget(new QLabel("Element Type"), gridRowCount, 0, Qt::AlignRight);
+    layoutGrid->addWidget(&this->comboElementType, gridRowCount, 1);
+    layoutGrid->setRowStretch(gridRowCount, 0);
+    ++gridRowCount;
+
+    // add min edit
+    layoutGrid->addWidget(new QLabel("Element Minimum"), gridRowCount, 0, Qt::AlignRight);
+    layoutGrid->addWidget(&this->lineEditMin, gridRowCount, 1);
+    layoutGrid->setRowStretch(gridRowCount, 0);
+    ++gridRowCount;
+
+    // add max edit
+    layoutGrid->addWidget(new QLabel("Element Maximum"), gridRowCount, 0, Qt::AlignRight);
+    layoutGrid->addWidget(&this->lineEditMax, gridRowCount, 1);
+    layoutGrid->setRowStretch(gridRowCount, 0);
+    ++gridRowCount;
+
+    // add size edit
+    QPushButton *btnPaste = new QPushButton("Paste");
+    btnPaste->setToolTip("Replacing all elements with numbers from the clipboard");
+    connect(btnPaste, SIGNAL(clicked()), this, SLOT(slotPaste()));
+    QHBoxLayout *layoutSize = new QHBoxLayout();
+    layoutSize->addWidget(&this->spinSize, 1);
+    layoutSize->addWidget(btnPaste);
+    layoutGrid->addWidget(new QLabel("Size"), gridRowCount, 0, Qt::AlignRight);
+    layoutGrid->addLayout(layoutSize, gridRowCount, 1);
+    layoutGrid->setRowStretch(gridRowCount, 0);
+    ++gridRowCount;
+
+    // add default elements edit
+    layoutGrid->addWidget(new QLabel("Default"), gridRowCount, 0 , Qt::AlignRight | Qt::AlignTop);
+    layoutGrid->addWidget(&this->tableElements, gridRowCount, 1);
+    layoutGrid->setRowStretch(gridRowCount, 10);
+    ++gridRowCount;
+
+    // add status
+    layoutGrid->addWidget(&this->labelStatus, gridRowCount, 1);
+    layoutGrid->setRowStretch(gridRowCount, 0);
+    ++gridRowCount;
+
+    // buttons
+    QDialogButtonBox *btnBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(btnBox, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(btnBox, SIGNAL(rejected()), this, SLOT(reject()));
+
+    // setup main layout
+    QVBoxLayout *layoutMain = new QVBoxLayout();
+    this->setLayout(layoutMain);
+    layoutMain->addLayout(layoutGrid, 1);
+    layoutMain->addWidget(btnBox);
+
+}
+
+void libblockdia::DialogEditParameterArray::slotWriteData()
+{
+    // all changes are signaled at once (one journal step, the elements are clipped once)
+    QByteArray oldContentHash = this->param->contentHash();
+    bool signalsWereBlocked = this->param->blockSignals(true);
+
+    this->param->setName(this->lineEditName.text().trimmed());
+    this->param->setPublic(this->checkPublic.isChecked());
+    this->param->setElementType((BlockParameterArray::ElementType) this->comboElementType.currentData().toInt());
+
+    // range (minimum and maximum are applied together)
+    bool ok;
+    double min = this->lineEditMin.text().trimmed().toDouble(&ok);
+    if (!ok) min = this->param->minimum();
+    double max = this->lineEditMax.text().trimmed().toDouble(&ok);
+    if (!ok) max = this->param->maximum();
+    this->param->setRange(min, max);
+
+    // default elements (clipped to the range)
+    this->param->setDefaultValues(this->model->values);
+
+    this->param->blockSignals(signalsWereBlocked);
+    this->param->invalidateCache();
+    if (this->param->contentHash() != oldContentHash) emit this->param->somethingHasChanged();
+}
+
+void libblockdia::DialogEditParameterArray::loadData(const libblockdia::BlockParameterData &data)
+{
+    this->lineEditName.setText(data.name);
+    this->checkPublic.setChecked(data.isPublic);
+    this->lineEditMin.setText(QString::number(data.elementMinimum, 'g', 17));
+    this->lineEditMax.setText(QString::number(data.elementMaximum, 'g', 17));
+
+    // the elements are decoded by a temporary parameter of the same configuration
+    BlockParameterArray decoder(data.name);
+    decoder.importParamData(data);
+    decoder.setDefaultValue(data.defaultValue);
+    this->comboElementType.setCurrentIndex(this->comboElementType.findData(decoder.elementType()));
+    this->loadElements(decoder.defaultValues());
+}
+
+void libblockdia::DialogEditParameterArray::loadElements(const QVector<double> &values)
+{
+    this->model->setValues(values);
+    bool signalsWereBlocked = this->spinSize.blockSignals(true);
+    this->spinSize.setValue(values.size());
+    this->spinSize.blockSignals(signalsWereBlocked);
+    this->labelStatus.setText(QString("%1 elements").arg(values.size()));
+}
+
+void libblockdia::DialogEditParameterArray::slotElementTypeChanged(int index)
+{
+    this->model->setIntElements(this->comboElementType.itemData(index).toInt() == BlockParameterArray::Int);
+}
+
+void libblockdia::DialogEditParameterArray::slotSizeChanged(int size)
+{
+    this->model->resize(size);
+    this->labelStatus.setText(QString("%1 elements").arg(size));
+}
+
+void libblockdia::DialogEditParameterArray::slotPaste()
+{
+    QStringList tokens = QApplication::clipboard()->text().split(QRegularExpression("[\\s,;]+"), QString::SkipEmptyParts);
+
+    if (tokens.size() > ARRAY_MAX_SIZE) {
+        this->labelStatus.setText(QString("Cannot paste %1 elements, the maximum size is %2").arg(tokens.size()).arg(ARRAY_MAX_SIZE));
+        return;
+    }
+
+    QVector<double> values;
+    values.reserve(tokens.size());
+    for (int i=0; i < tokens.size(); ++i) {
+        bool ok;
+        double d = tokens.at(i).toDouble(&ok);
+        if (!ok) {
+            this->labelStatus.setText(QString("Cannot paste, '%1' is not a number (element %2)").arg(tokens.at(i)).arg(i));
+            return;
+        }
+        values.append((this->model->isInt) ? std::round(d) : d);
+    }
+
+    this->loadElements(values);
+}
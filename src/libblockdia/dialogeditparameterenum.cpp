@@ -18,6 +18,7 @@ libblockdia::DialogEditParameterEnum::DialogEditParameterEnum(BlockParameterEnum
     // load values from block
     this->lineEditName.setText(this->param->name());
     this->checkPublic.setChecked(this->param->isPublic());
+    this->lineEditExpression.setText(this->param->expression());
     this->lineEditDefault.setText(this->param->strDefaultValue());
 
     // load enum items from block
@@ -54,6 +55,13 @@ libblockdia::DialogEditParameterEnum::DialogEditParameterEnum(BlockParameterEnum
     layoutGrid->setRowStretch(gridRowCount, 10);
     ++gridRowCount;
 
+    // add expression edit (the value is derived from other parameters, see BlockExpression)
+    this->lineEditExpression.setPlaceholderText("eg. 2 * rate");
+    layoutGrid->addWidget(new QLabel("Expression"), gridRowCount, 0, Qt::AlignRight);
+    layoutGrid->addWidget(&this->lineEditExpression, gridRowCount, 1);
+    layoutGrid->setRowStretch(gridRowCount, 10);
+    ++gridRowCount;
+
     // add enum items edit
     layoutGrid->addWidget(new QLabel("Items"), gridRowCount, 0 , Qt::AlignRight);
     layoutGrid->addWidget(&this->textEditEnumItems, gridRowCount, 1);
@@ -78,6 +86,7 @@ void libblockdia::DialogEditParameterEnum::slotWriteData()
 {
     this->param->setName(this->lineEditName.text().trimmed());
     this->param->setPublic(this->checkPublic.isChecked());
+    this->param->setExpression(this->lineEditExpression.text());
 
     // enum items
     QStringList items = this->textEditEnumItems.toPlainText().split("\n");
@@ -86,3 +95,12 @@ void libblockdia::DialogEditParameterEnum::slotWriteData()
     // default value
     this->param->setDefaultValue(this->lineEditDefault.text().trimmed());
 }
+
+void libblockdia::DialogEditParameterEnum::loadData(const libblockdia::BlockParameterData &data)
+{
+    this->lineEditName.setText(data.name);
+    this->checkPublic.setChecked(data.isPublic);
+    this->lineEditExpression.setText(data.expression);
+    this->lineEditDefault.setText(data.defaultValue);
+    this->textEditEnumItems.setPlainText(data.enumItems.join("\n"));
+}
@@ -17,6 +17,7 @@ libblockdia::DialogEditParameterInt::DialogEditParameterInt(BlockParameterInt *p
     // load values from block
     this->lineEditName.setText(this->param->name());
     this->checkPublic.setChecked(this->param->isPublic());
+    this->lineEditExpression.setText(this->param->expression());
     this->lineEditMax.setText(QString::number(this->param->maximum()));
     this->lineEditMin.setText(QString::number(this->param->minimum()));
     this->lineEditDefault.setText(QString::number(this->param->defaultValue()));
@@ -61,6 +62,13 @@ libblockdia::DialogEditParameterInt::DialogEditParameterInt(BlockParameterInt *p
     layoutGrid->setRowStretch(gridRowCount, 10);
     ++gridRowCount;
 
+    // add expression edit (the value is derived from other parameters, see BlockExpression)
+    this->lineEditExpression.setPlaceholderText("eg. 2 * rate");
+    layoutGrid->addWidget(new QLabel("Expression"), gridRowCount, 0, Qt::AlignRight);
+    layoutGrid->addWidget(&this->lineEditExpression, gridRowCount, 1);
+    layoutGrid->setRowStretch(gridRowCount, 10);
+    ++gridRowCount;
+
 
 
     // buttons
@@ -81,7 +89,18 @@ void libblockdia::DialogEditParameterInt::slotWriteData()
 {
     this->param->setName(this->lineEditName.text().trimmed());
     this->param->setPublic(this->checkPublic.isChecked());
+    this->param->setExpression(this->lineEditExpression.text());
     this->param->setMaximum(this->lineEditMax.text().trimmed().toInt());
     this->param->setMinimum(this->lineEditMin.text().trimmed().toInt());
     this->param->setDefaultValue(this->lineEditDefault.text().trimmed());
 }
+
+void libblockdia::DialogEditParameterInt::loadData(const libblockdia::BlockParameterData &data)
+{
+    this->lineEditName.setText(data.name);
+    this->checkPublic.setChecked(data.isPublic);
+    this->lineEditExpression.setText(data.expression);
+    this->lineEditMax.setText(QString::number(data.maximum));
+    this->lineEditMin.setText(QString::number(data.minimum));
+    this->lineEditDefault.setText(data.defaultValue);
+}
@@ -67,3 +67,10 @@ void libblockdia::DialogEditParameterStr::slotWriteData()
     this->param->setPublic(this->checkPublic.isChecked());
     this->param->setDefaultValue(this->lineEditDefault.text().trimmed());
 }
+
+void libblockdia::DialogEditParameterStr::loadData(const libblockdia::BlockParameterData &data)
+{
+    this->lineEditName.setText(data.name);
+    this->checkPublic.setChecked(data.isPublic);
+    this->lineEditDefault.setText(data.defaultValue);
+}
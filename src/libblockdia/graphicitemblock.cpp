@@ -7,6 +7,7 @@
 #include <QAction>
 
 #include <blockparameterint.h>
+#include <blockparameterarray.h>
 #include <blockinput.h>
 #include <blockoutput.h>
 #include <dialogeditheader.h>
@@ -15,14 +16,20 @@
 #include <dialogeditparameterint.h>
 #include <dialogeditparameterstr.h>
 #include <dialogeditparameterenum.h>
+#include <dialogeditparameterarray.h>
+#include <blocktrace.h>
 
-libblockdia::GraphicItemBlock::GraphicItemBlock(Block *block, QGraphicsItem *parent) : QGraphicsItem(parent)
+libblockdia::GraphicItemBlock::GraphicItemBlock(Block *block, QGraphicsItem *parent) : QGraphicsObject(parent)
 {
     this->block = block;
     this->isMouseHovered = false;
     this->giBlockHead = Q_NULLPTR;
     this->updateData();
     this->setAcceptHoverEvents(true);
+
+    // follow the block
+    connect(block, SIGNAL(signalDataChanged(libblockdia::Block*)), this, SLOT(updateData()));
+    connect(block, SIGNAL(destroyed()), this, SLOT(slotBlockDestroyed()));
 }
 
 QRectF libblockdia::GraphicItemBlock::boundingRect() const
@@ -59,28 +66,38 @@ void libblockdia::GraphicItemBlock::paint(QPainter *painter, const QStyleOptionG
 //    painter->drawLine(0, -200, 0, 200);
 }
 
+void libblockdia::GraphicItemBlock::addMemoryUsage(libblockdia::BlockMemory *usage) const
+{
+    usage->addObject(BlockMemory::GraphicItems, sizeof(GraphicItemBlock) + BlockMemory::GraphicsItemPrivateBytes + BlockMemory::QObjectPrivateBytes);
+    qint64 countItems = this->giParamsPublic.size() + this->giInOuts.size() + this->giParamsPrivate.size();
+    usage->addBytes(BlockMemory::GraphicItems, countItems * (qint64) sizeof(void *));
+
+    // child items (the derived items only add a few members to the text box)
+    if (this->giBlockHead) this->giBlockHead->addMemoryUsage(usage);
+    for (int i=0; i < this->giParamsPublic.size(); ++i) {
+        this->giParamsPublic.at(i)->addMemoryUsage(usage);
+        usage->addBytes(BlockMemory::GraphicItems, sizeof(GraphicItemParameter) - sizeof(GraphicItemTextBox));
+    }
+    for (int i=0; i < this->giInOuts.size(); ++i) {
+        this->giInOuts.at(i).first->addMemoryUsage(usage);
+        this->giInOuts.at(i).second->addMemoryUsage(usage);
+        usage->addBytes(BlockMemory::GraphicItems, sizeof(GraphicItemInput) + sizeof(GraphicItemOutput) - 2 * sizeof(GraphicItemTextBox));
+    }
+    for (int i=0; i < this->giParamsPrivate.size(); ++i) {
+        this->giParamsPrivate.at(i)->addMemoryUsage(usage);
+        usage->addBytes(BlockMemory::GraphicItems, sizeof(GraphicItemParameter) - sizeof(GraphicItemTextBox));
+    }
+}
+
 void libblockdia::GraphicItemBlock::updateData()
 {
+    BLOCKDIA_TRACE_SCOPE("GraphicItemBlock::updateData");
+    if (this->block == Q_NULLPTR) return;
+
     this->prepareGeometryChange();
 
-    qreal widthMaximum = 0;
-    qreal widthInputs = 0;
-    qreal widthOutputs = 0;
-    qreal heightMaximum = 0;
-
-    // get block information
-    QList<BlockInput *> blockInputList = this->block->getInputs();
-    QList<BlockOutput *> blockOutputsList = this->block->getOutputs();
-    QList<BlockParameter *> blockParameters = this->block->getParameters();
-    int countPublicParams = 0;
-    int countPrivateParams = 0;
-    for (int i=0; i < blockParameters.size(); ++i) {
-        if (blockParameters.at(i)->isPublic()) {
-            ++countPublicParams;
-        } else {
-            ++countPrivateParams;
-        }
-    }
+    // the geometry is shared with offscreen renderings
+    BlockLayout layout(this->block->snapshot());
 
 
     // ------------------------------------------------------------------------
@@ -92,148 +109,74 @@ void libblockdia::GraphicItemBlock::updateData()
         this->giBlockHead = new GraphicItemBlockHeader(this->block, this);
     }
 
-    // update header
-    this->giBlockHead->updateData();
-    if (this->giBlockHead->actualNeededWidth() > widthMaximum) widthMaximum = this->giBlockHead->actualNeededWidth();
-    this->giBlockHead->setY(heightMaximum + this->giBlockHead->boundingRect().height() / 2.0);
-    heightMaximum += this->giBlockHead->boundingRect().height();
-
     // resize public parameters list
-    while (this->giParamsPublic.size() > countPublicParams) delete this->giParamsPublic.takeLast();
-    while (this->giParamsPublic.size() < countPublicParams) this->giParamsPublic.append(new GraphicItemParameter(this->block, 0, this));
-
-    // update public parameters
-    int idxParamPub = 0;
-    for (int i=0; i < blockParameters.size(); ++i) {
-        if (blockParameters.at(i)->isPublic()) {
-            GraphicItemParameter *giParam = this->giParamsPublic.at(idxParamPub);
-            giParam->updateData(i);
-            if (giParam->actualNeededWidth() > widthMaximum) widthMaximum = giParam->actualNeededWidth();
-            giParam->setY(heightMaximum + giParam->boundingRect().height()/2.0);
-            heightMaximum += giParam->boundingRect().height();
-
-            // update maximum width
-            if (giParam->actualNeededWidth() > widthMaximum) widthMaximum = giParam->actualNeededWidth();
-
-            ++idxParamPub;
-        }
-    }
+    while (this->giParamsPublic.size() > layout.publicParameters.size()) delete this->giParamsPublic.takeLast();
+    while (this->giParamsPublic.size() < layout.publicParameters.size()) this->giParamsPublic.append(new GraphicItemParameter(this->block, 0, this));
 
     // resize IO list
-    while (this->giInOuts.size() > blockInputList.size() || this->giInOuts.size() > blockOutputsList.size()) {
+    while (this->giInOuts.size() > layout.inputs.size()) {
         QPair<GraphicItemInput *, GraphicItemOutput *> p = this->giInOuts.takeLast();
         delete p.first;
         delete p.second;
     }
-    while (this->giInOuts.size() < blockInputList.size() || this->giInOuts.size() < blockOutputsList.size()) {
+    while (this->giInOuts.size() < layout.inputs.size()) {
         QPair<GraphicItemInput *, GraphicItemOutput *> p;
         p.first = new GraphicItemInput(this->block, -1, this);
         p.second = new GraphicItemOutput(this->block, -1, this);
         this->giInOuts.append(p);
     }
 
-    // update inputs/output list
-    for (int i = 0; i < this->giInOuts.size(); ++i) {
-        QPair<GraphicItemInput *, GraphicItemOutput *> p = this->giInOuts.at(i);
-
-        // create new input
-        if (i <= blockInputList.size()) {
-            p.first->updateData(i);
-        } else {
-            p.first->updateData();
-        }
-
-        // create new output
-        if (i < blockOutputsList.size()) {
-            p.second->updateData(i);
-        } else {
-            p.second->updateData();
-        }
-
-        // calculate width
-        if (p.first->actualNeededWidth() > widthInputs) widthInputs = p.first->actualNeededWidth();
-        if (p.second->actualNeededWidth() > widthOutputs) widthOutputs = p.second->actualNeededWidth();
-        qreal w = widthInputs + widthOutputs;
-        if (w > widthMaximum) widthMaximum = w;
-
-        // calculate height
-        p.first->setY(heightMaximum + p.first->boundingRect().height() / 2.0);
-        p.second->setY(heightMaximum + p.second->boundingRect().height() / 2.0);
-        heightMaximum += (p.first->boundingRect().height() > p.second->boundingRect().height()) ? p.first->boundingRect().height() : p.second->boundingRect().height();
-    }
-
     // resize private parameters list
-    while (this->giParamsPrivate.size() > countPrivateParams) delete this->giParamsPrivate.takeLast();
-    while (this->giParamsPrivate.size() < countPrivateParams) this->giParamsPrivate.append(new GraphicItemParameter(this->block, -1, this));
-
-    // update private parameters
-    int idxParamPriv = 0;
-    for (int i=0; i < blockParameters.size(); ++i) {
-        if (!blockParameters.at(i)->isPublic()) {
-            GraphicItemParameter *giParam = this->giParamsPrivate.at(idxParamPriv);
-            giParam->updateData(i);
-            if (giParam->actualNeededWidth() > widthMaximum) widthMaximum = giParam->actualNeededWidth();
-            giParam->setY(heightMaximum + giParam->boundingRect().height()/2.0);
-            heightMaximum += giParam->boundingRect().height();
-
-            // update maximum width
-            if (giParam->actualNeededWidth() > widthMaximum) widthMaximum = giParam->actualNeededWidth();
-
-            ++idxParamPriv;
-        }
-    }
-
+    while (this->giParamsPrivate.size() > layout.privateParameters.size()) delete this->giParamsPrivate.takeLast();
+    while (this->giParamsPrivate.size() < layout.privateParameters.size()) this->giParamsPrivate.append(new GraphicItemParameter(this->block, -1, this));
 
 
     // ------------------------------------------------------------------------
-    //                              Update Positons
+    //                         Update Data And Positons
     // ------------------------------------------------------------------------
 
     // header
-    this->giBlockHead->setMinWidth(widthMaximum);
-    this->giBlockHead->setX(0);
-    this->giBlockHead->moveBy(0, - heightMaximum/2.0);
-
-    // private parameters
-    for (int i=0; i < this->giParamsPrivate.size(); ++i) {
-        GraphicItemParameter *giParam = this->giParamsPrivate.at(i);
-        giParam->setMinWidth(widthMaximum);
-        giParam->moveBy(0, - heightMaximum/2.0);
-    }
+    this->giBlockHead->updateData();
+    this->giBlockHead->setMinWidth(layout.header.rect.width());
+    this->giBlockHead->setPos(layout.header.pos);
 
-    // stretch i/o widths
-    if ((widthInputs + widthOutputs) < widthMaximum) {
-        int w = widthMaximum - widthInputs - widthOutputs;
-        widthInputs += w/2.0;
-        widthOutputs += w/2.0;
+    // public parameters
+    for (int i=0; i < this->giParamsPublic.size(); ++i) {
+        const BlockLayout::TextBox &box = layout.publicParameters.at(i);
+        this->giParamsPublic.at(i)->updateData(box.index);
+        this->giParamsPublic.at(i)->setMinWidth(box.rect.width());
+        this->giParamsPublic.at(i)->setPos(box.pos);
     }
 
     // In-/Outputs
     for (int i=0; i < this->giInOuts.size(); ++i) {
         QPair<GraphicItemInput *, GraphicItemOutput *> p = this->giInOuts.at(i);
+        const BlockLayout::TextBox &boxInput = layout.inputs.at(i);
+        const BlockLayout::TextBox &boxOutput = layout.outputs.at(i);
 
-        // update input
-        p.first->setMinWidth(widthInputs);
-        p.first->moveBy(0,  - heightMaximum/2.0);
-        p.first->setX(- widthMaximum / 2.0 + p.first->boundingRect().width() / 2.0);
+        p.first->updateData(boxInput.index);
+        p.first->setMinWidth(boxInput.rect.width());
+        p.first->setPos(boxInput.pos);
 
-        // update output
-        p.second->setMinWidth(widthOutputs);
-        p.second->moveBy(0,  - heightMaximum/2.0);
-        p.second->setX(widthMaximum / 2.0 - p.second->boundingRect().width() / 2.0);
+        p.second->updateData(boxOutput.index);
+        p.second->setMinWidth(boxOutput.rect.width());
+        p.second->setPos(boxOutput.pos);
     }
 
-    // public parameters
-    for (int i=0; i < this->giParamsPublic.size(); ++i) {
-        GraphicItemParameter *giParam = this->giParamsPublic.at(i);
-        giParam->setMinWidth(widthMaximum);
-        giParam->moveBy(0, - heightMaximum/2.0);
+    // private parameters
+    for (int i=0; i < this->giParamsPrivate.size(); ++i) {
+        const BlockLayout::TextBox &box = layout.privateParameters.at(i);
+        this->giParamsPrivate.at(i)->updateData(box.index);
+        this->giParamsPrivate.at(i)->setMinWidth(box.rect.width());
+        this->giParamsPrivate.at(i)->setPos(box.pos);
     }
 
     // calculate new bounding rect
-    this->currentBoundingRect = QRectF(- widthMaximum / 2.0, - heightMaximum / 2.0, widthMaximum, heightMaximum);
+    this->currentBoundingRect = layout.boundingRect;
     this->currentBoundingRectHighlighted = this->currentBoundingRect;
     this->currentBoundingRectHighlighted.adjust(-4, -5, 5, 4);
+
+    emit signalLayoutChanged();
 }
 
 void libblockdia::GraphicItemBlock::hoverEnterEvent(QGraphicsSceneHoverEvent *e)
@@ -252,6 +195,8 @@ void libblockdia::GraphicItemBlock::hoverLeaveEvent(QGraphicsSceneHoverEvent *e)
 
 void libblockdia::GraphicItemBlock::contextMenuEvent(QGraphicsSceneContextMenuEvent *e)
 {
+    if (this->block == Q_NULLPTR) return;
+
     BlockParameter *param = Q_NULLPTR;
     BlockInput *input = Q_NULLPTR;
     BlockOutput *output = Q_NULLPTR;
@@ -329,6 +274,7 @@ void libblockdia::GraphicItemBlock::contextMenuEvent(QGraphicsSceneContextMenuEv
     QAction *actionParameterAddInt  = menuAddParam.addAction("Integer Parameter");
     QAction *actionParameterAddStr  = menuAddParam.addAction("String Parameter");
     QAction *actionParameterAddEnum = menuAddParam.addAction("Enum arameter");
+    QAction *actionParameterAddArray = menuAddParam.addAction("Array Parameter");
 
     // create menu - main
     QMenu menu;
@@ -411,6 +357,11 @@ void libblockdia::GraphicItemBlock::contextMenuEvent(QGraphicsSceneContextMenuEv
         new BlockParameterEnum("new parameter", this->block);
     }
 
+    // add pramter array
+    else if (action == actionParameterAddArray) {
+        new BlockParameterArray("new parameter", this->block);
+    }
+
     // edit parameter
     else if (action == actionParameterEdit) {
         QString paramType = param->metaObject()->className();
@@ -423,6 +374,9 @@ void libblockdia::GraphicItemBlock::contextMenuEvent(QGraphicsSceneContextMenuEv
         } else if (paramType == "libblockdia::BlockParameterEnum") {
             DialogEditParameterEnum dialog((BlockParameterEnum *) param);
             dialog.exec();
+        } else if (paramType == "libblockdia::BlockParameterArray") {
+            DialogEditParameterArray dialog((BlockParameterArray *) param);
+            dialog.exec();
         }
     }
 
@@ -472,4 +426,14 @@ void libblockdia::GraphicItemBlock::contextMenuEvent(QGraphicsSceneContextMenuEv
     else if (action == actionOutputDelete) {
         output->deleteLater();
     }
+
+    if (action != Q_NULLPTR) emit signalEdited();
+}
+
+void libblockdia::GraphicItemBlock::slotBlockDestroyed()
+{
+    // the child items keep pointers to the block, so they must not be painted anymore
+    this->block = Q_NULLPTR;
+    this->hide();
+    this->deleteLater();
 }
@@ -18,10 +18,10 @@ void libblockdia::GraphicItemParameter::updateData()
     QList<BlockParameter *> paramList = this->block->getParameters();
 
     // get parameter data
-    if (this->_parameterIndex >= 0 && this->_parameterIndex <= paramList.size()) {
+    if (this->_parameterIndex >= 0 && this->_parameterIndex < paramList.size()) {
         txt = paramList.at(this->_parameterIndex)->name();
         txt += " = ";
-        txt += paramList.at(this->_parameterIndex)->strValue();
+        txt += paramList.at(this->_parameterIndex)->displayValue();
     }
 
     // update text
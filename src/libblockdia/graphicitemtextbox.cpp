@@ -2,16 +2,12 @@
 
 #include <QColor>
 #include <QBrush>
+#include <blocktrace.h>
 
 libblockdia::GraphicItemTextBox::GraphicItemTextBox(QGraphicsItem *parent) : QGraphicsItem(parent)
 {
-    this->text = "";
     this->minWidth = 0;
-    this->font = QFont();
-    this->padding = 5;
-    this->bgColor = QColor("#fdd");
-    this->algn = Align::Center;
-    this->calculateDimensions();
+    this->box = BlockLayout::layoutTextBox("", Align::Center, QColor("#fdd"));
     this->_isMouseHovered = false;
 
     // configurations
@@ -20,55 +16,34 @@ libblockdia::GraphicItemTextBox::GraphicItemTextBox(QGraphicsItem *parent) : QGr
 
 QRectF libblockdia::GraphicItemTextBox::boundingRect() const
 {
-    return this->currentBoundingRect;
+    return this->box.rect;
 }
 
 void libblockdia::GraphicItemTextBox::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
+    BLOCKDIA_TRACE_SCOPE("GraphicItemTextBox::paint");
     Q_UNUSED(option);
     Q_UNUSED(widget);
 
-    // draw box
-    painter->fillRect(this->currentBoundingRect, QBrush((this->_isMouseHovered) ? QColor("#444") : this->bgColor));
-    painter->setPen(QColor(Qt::black));
-    painter->drawRect(this->currentBoundingRect);
-
-    // calculate text y position
-    QFontMetrics fm = QFontMetrics(this->font);
-    qreal textY = - fm.descent() + fm.height() / 2.0;
-
-    // calculate text x position
-    qreal textX = 0.0;
-    if (this->algn == Align::Left) {
-        textX = -this->boundingRect().width()/2.0 + this->padding;
-    } else if (this->algn == Align::Center) {
-        textX = - this->_actualNeededWidth / 2.0 + this->padding;
-    } else if (this->algn == Align::Right) {
-        textX = this->boundingRect().width()/2 - this->_actualNeededWidth + this->padding;
-    }
-
-    // draw text
-    painter->setFont(this->font);
-    painter->setPen((this->_isMouseHovered) ? QColor(Qt::white) : QColor(Qt::black));
-    painter->drawText(textX, textY, this->text);
+    BlockLayout::paintTextBox(painter, this->box, this->_isMouseHovered);
 }
 
 void libblockdia::GraphicItemTextBox::updateData(const QString &text, Align align)
 {
     this->prepareGeometryChange();
-    this->text = text;
-    this->algn = align;
+    this->box.text = text;
+    this->box.align = align;
     this->calculateDimensions();
 }
 
 qreal libblockdia::GraphicItemTextBox::actualNeededWidth()
 {
-    return this->_actualNeededWidth;
+    return this->box.neededWidth;
 }
 
 qreal libblockdia::GraphicItemTextBox::actualNeededHeight()
 {
-    return this->_actaulNeededHeight;
+    return this->box.rect.height();
 }
 
 void libblockdia::GraphicItemTextBox::setMinWidth(qreal minWidth)
@@ -81,7 +56,7 @@ void libblockdia::GraphicItemTextBox::setMinWidth(qreal minWidth)
 void libblockdia::GraphicItemTextBox::setBgColor(QColor bgColor)
 {
     this->prepareGeometryChange();
-    this->bgColor = bgColor;
+    this->box.bgColor = bgColor;
 }
 
 bool libblockdia::GraphicItemTextBox::isMouseHovered()
@@ -109,13 +84,11 @@ void libblockdia::GraphicItemTextBox::hoverLeaveEvent(QGraphicsSceneHoverEvent *
 
 void libblockdia::GraphicItemTextBox::calculateDimensions()
 {
-    // calculate new text size
-    QFontMetrics fm = QFontMetrics(this->font);
-    this->_actualNeededWidth = 2.0 * this->padding + fm.width(this->text);
-    this->_actaulNeededHeight = 2.0 * this->padding + fm.height();
-
-    // calculate new bounding rect
-    qreal width = (this->minWidth > this->_actualNeededWidth) ? this->minWidth : this->_actualNeededWidth;
-    qreal height = this->_actaulNeededHeight;
-    this->currentBoundingRect = QRectF ( - width/2.0, - height/2.0, width, height);
+    this->box = BlockLayout::layoutTextBox(this->box.text, this->box.align, this->box.bgColor, this->minWidth);
+}
+
+void libblockdia::GraphicItemTextBox::addMemoryUsage(libblockdia::BlockMemory *usage) const
+{
+    usage->addObject(BlockMemory::GraphicItems, sizeof(GraphicItemTextBox) + BlockMemory::GraphicsItemPrivateBytes);
+    usage->addString(BlockMemory::GraphicItems, this->box.text);
 }
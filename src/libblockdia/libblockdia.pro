@@ -6,6 +6,7 @@ VERSION = 0.0.0
 # defining Qt modules
 QT += widgets
 QT += gui
+QT += svg
 
 # specify the target filename
 # for debug version a "_d" is appended
@@ -33,6 +34,11 @@ CONFIG(release, debug|release) {
 
 DEFINES += LIBBLOCKDIA_LIBRARY
 
+# trace points are compiled in with "CONFIG+=blockdia_tracing" (see blocktrace.h)
+blockdia_tracing {
+    DEFINES += BLOCKDIA_TRACING
+}
+
 # The following define makes your compiler emit warnings if you use
 # any feature of Qt which as been marked as deprecated (the exact warnings
 # depend on your compiler). Please consult the documentation of the
@@ -49,7 +55,6 @@ DEFINES += QT_DEPRECATED_WARNINGS
 INCLUDEPATH += ../../include/
 
 SOURCES +=  \
-            block.cpp \
             graphicitemblock.cpp \
             viewblock.cpp \
             viewblockeditor.cpp \
@@ -64,21 +69,17 @@ SOURCES +=  \
             dialogeditparameterint.cpp \
             dialogeditparameterstr.cpp \
             dialogeditparameterenum.cpp \
-    blockinput.cpp \
-    blockoutput.cpp \
-    blockparameter.cpp \
-    blockparameterenum.cpp \
-    blockparameterint.cpp \
-    blockparameterstr.cpp
+            dialogeditparameterarray.cpp \
+            blocklayout.cpp \
+            blockrenderer.cpp
 
 HEADERS +=  ../../include/libglobals.h \
             ../../include/libblockdia.h \
-            ../../include/block.h \
             ../../include/graphicitemblock.h \
             ../../include/viewblock.h \
             ../../include/viewblockeditor.h \
             ../../include/graphicitemblockheader.h \
-            ../../include/graphicitemtextbox.h \            
+            ../../include/graphicitemtextbox.h \
             ../../include/graphicitemparameter.h \
             ../../include/graphiciteminput.h \
             ../../include/graphicitemoutput.h \
@@ -88,12 +89,16 @@ HEADERS +=  ../../include/libglobals.h \
             ../../include/dialogeditparameterint.h \
             ../../include/dialogeditparameterenum.h \
             ../../include/dialogeditparameterstr.h \
-    ../../include/blockinput.h \
-    ../../include/blockoutput.h \
-    ../../include/blockparameter.h \
-    ../../include/blockparameterenum.h \
-    ../../include/blockparameterint.h \
-    ../../include/blockparameterstr.h
+            ../../include/dialogeditparameterarray.h \
+            ../../include/blocklayout.h \
+            ../../include/blockrenderer.h
+
+# link core library
+CONFIG(debug, debug|release) {
+    LIBS += -L$$PWD/../../bin/ -llibblockdiacore_d
+} else {
+    LIBS += -L$$PWD/../../bin/ -llibblockdiacore
+}
 
 unix {
     target.path = /usr/lib
@@ -5,6 +5,8 @@
 
 #include <block.h>
 #include <blockparameterint.h>
+#include <blockparameterarray.h>
+#include <graphicitemblock.h>
 #include <blockinput.h>
 #include <blockoutput.h>
 
@@ -30,6 +32,9 @@ libblockdia::ViewBlock::ViewBlock(QWidget *parent) : QGraphicsView(parent)
     param = new BlockParameterInt("Parameter3", myBlock);
     param->setValue("123");
     param->setPublic(true);
+    BlockParameterArray *coefficients = new BlockParameterArray("Coefficients", myBlock);
+    coefficients->setValues(QVector<double>() << 0.5 << 1.02 << -3.1e-4 << 2.7e-7);
+    coefficients->setPublic(true);
 
     // add inputs
     new BlockInput("Input1", myBlock);
@@ -42,7 +47,7 @@ libblockdia::ViewBlock::ViewBlock(QWidget *parent) : QGraphicsView(parent)
 
     QGraphicsScene *scene = new QGraphicsScene(this);
     scene->setBackgroundBrush(QBrush(QColor("#fffcfc")));
-    scene->addItem(myBlock->getGraphicsItem());
+    scene->addItem(new GraphicItemBlock(myBlock));
 
     this->setScene(scene);
     this->show();
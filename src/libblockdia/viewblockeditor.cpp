@@ -3,8 +3,22 @@
 #include <QGraphicsScene>
 #include <QDebug>
 #include <QTimer>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
 
 #include <blockparameterint.h>
+#include <graphicitemblock.h>
+
+// number of frames in the histogram of the performance overlay
+#define HUD_HISTORY 120
+
+// size of the performance overlay
+#define HUD_WIDTH 260
+#define HUD_HEIGHT 130
+#define HUD_MARGIN 8
+
+// frame time of the reference line in the histogram (60 fps)
+#define HUD_FRAME_BUDGET_NS 16666667
 
 libblockdia::ViewBlockEditor::ViewBlockEditor(Block *block, QWidget *parent) : QGraphicsView(parent)
 {
@@ -12,9 +26,19 @@ libblockdia::ViewBlockEditor::ViewBlockEditor(Block *block, QWidget *parent) : Q
 
     QGraphicsScene *scene = new QGraphicsScene(this);
 //    scene->setBackgroundBrush(QBrush(QColor("#fffcfc")));
-    scene->addItem(this->_block->getGraphicsItem());
+    this->_graphicItem = new GraphicItemBlock(this->_block);
+    scene->addItem(this->_graphicItem);
     this->setScene(scene);
 
+    // performance overlay
+    this->hudVisible = false;
+    this->hudRepaintPending = false;
+    this->hudFrameTimes.fill(0, HUD_HISTORY);
+    this->hudFrameIndex = 0;
+    this->hudFrameCount = 0;
+    this->hudClock.start();
+    connect(this->_graphicItem, SIGNAL(signalLayoutChanged()), this, SLOT(slotLayoutChanged()));
+
     this->show();
 }
 
@@ -23,6 +47,11 @@ libblockdia::Block *libblockdia::ViewBlockEditor::block()
     return this->_block;
 }
 
+libblockdia::GraphicItemBlock *libblockdia::ViewBlockEditor::graphicItem()
+{
+    return this->_graphicItem;
+}
+
 void libblockdia::ViewBlockEditor::wheelEvent(QWheelEvent *e)
 {
     // zoom if CTRL was pressed
@@ -30,15 +59,160 @@ void libblockdia::ViewBlockEditor::wheelEvent(QWheelEvent *e)
 
         // zoom in
         if (e->angleDelta().y() > 0) {
-            this->scale(1.07, 1.07);
+            this->zoom(1.07);
         }
 
         // zoom out
         else if (e->angleDelta().y() < 0){
-            this->scale(0.93, 0.93);
+            this->zoom(0.93);
         }
 
     } else {
         e->ignore();
     }
 }
+
+void libblockdia::ViewBlockEditor::zoom(qreal factor)
+{
+    this->scale(factor, factor);
+    emit signalZoomed(factor);
+}
+
+void libblockdia::ViewBlockEditor::setHudVisible(bool visible)
+{
+    this->hudVisible = visible;
+    this->hudFrameCount = 0;
+    this->hudFrameIndex = 0;
+    this->hudLayoutTimes.clear();
+    this->viewport()->update();
+}
+
+bool libblockdia::ViewBlockEditor::isHudVisible()
+{
+    return this->hudVisible;
+}
+
+QString libblockdia::ViewBlockEditor::levelOfDetailBucket(qreal levelOfDetail)
+{
+    if (levelOfDetail < 0.25) return "overview";
+    if (levelOfDetail < 0.75) return "low";
+    if (levelOfDetail < 2.0) return "normal";
+    return "high";
+}
+
+void libblockdia::ViewBlockEditor::slotLayoutChanged()
+{
+    if (this->hudVisible) this->hudLayoutTimes.enqueue(this->hudClock.elapsed());
+}
+
+void libblockdia::ViewBlockEditor::paintEvent(QPaintEvent *e)
+{
+    if (!this->hudVisible) {
+        QGraphicsView::paintEvent(e);
+        return;
+    }
+
+    // measure the scene only
+    QElapsedTimer timer;
+    timer.start();
+    QGraphicsView::paintEvent(e);
+    qint64 frameTime = timer.nsecsElapsed();
+
+    // repaints of the overlay only are not counted as frames
+    QRect hudRect = this->hudRect();
+    bool isHudRepaint = this->hudRepaintPending && hudRect.contains(e->region().boundingRect());
+    this->hudRepaintPending = false;
+    if (!isHudRepaint) {
+        this->hudFrameTimes[this->hudFrameIndex] = frameTime;
+        this->hudFrameIndex = (this->hudFrameIndex + 1) % HUD_HISTORY;
+        if (this->hudFrameCount < HUD_HISTORY) ++this->hudFrameCount;
+    }
+
+    QPainter painter(this->viewport());
+    this->paintHud(&painter, this->items(e->region().boundingRect()).size());
+
+    // a partial update did not repaint the whole overlay
+    if (!e->region().contains(hudRect)) {
+        this->hudRepaintPending = true;
+        this->viewport()->update(hudRect);
+    }
+}
+
+void libblockdia::ViewBlockEditor::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+
+    // scrolling moves the pixels of the overlay as well,
+    // the moved copy must be repainted together with the overlay
+    if (this->hudVisible) {
+        QRect hudRect = this->hudRect();
+        this->viewport()->update(QRegion(hudRect) + hudRect.translated(dx, dy));
+    }
+}
+
+void libblockdia::ViewBlockEditor::paintHud(QPainter *painter, int countItems)
+{
+    QRect rect = this->hudRect();
+
+    // frame statistics
+    qint64 lastTime = this->hudFrameTimes.at((this->hudFrameIndex + HUD_HISTORY - 1) % HUD_HISTORY);
+    qint64 sumTime = 0;
+    qint64 maxTime = 0;
+    for (int i=0; i < this->hudFrameCount; ++i) {
+        sumTime += this->hudFrameTimes.at(i);
+        maxTime = qMax(maxTime, this->hudFrameTimes.at(i));
+    }
+    qint64 avgTime = (this->hudFrameCount > 0) ? sumTime / this->hudFrameCount : 0;
+
+    // relayouts within the last second
+    qint64 now = this->hudClock.elapsed();
+    while (!this->hudLayoutTimes.isEmpty() && this->hudLayoutTimes.head() < now - 1000) this->hudLayoutTimes.dequeue();
+
+    // level of detail
+    qreal levelOfDetail = QStyleOptionGraphicsItem::levelOfDetailFromTransform(this->transform());
+
+    // background
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->fillRect(rect, QColor(0, 0, 0, 170));
+
+    // texts
+    QFont font("monospace");
+    font.setStyleHint(QFont::TypeWriter);
+    font.setPixelSize(11);
+    painter->setFont(font);
+    painter->setPen(Qt::white);
+    int lineHeight = QFontMetrics(font).height();
+    int y = rect.top() + 4 + QFontMetrics(font).ascent();
+    painter->drawText(rect.left() + 6, y, QString("frame %1 ms (avg %2, max %3)").arg(lastTime / 1e6, 0, 'f', 2).arg(avgTime / 1e6, 0, 'f', 2).arg(maxTime / 1e6, 0, 'f', 2));
+    y += lineHeight;
+    painter->drawText(rect.left() + 6, y, QString("items %1").arg(countItems));
+    y += lineHeight;
+    painter->drawText(rect.left() + 6, y, QString("relayouts %1/s").arg(this->hudLayoutTimes.size()));
+    y += lineHeight;
+    painter->drawText(rect.left() + 6, y, QString("lod %1 (%2)").arg(levelOfDetail, 0, 'f', 2).arg(levelOfDetailBucket(levelOfDetail)));
+
+    // histogram of the frame times (oldest left, scaled to at least two frame budgets)
+    QRect histogram(rect.left() + 6, y + 6, rect.width() - 12, rect.bottom() - y - 10);
+    qint64 scaleTime = qMax(maxTime, (qint64) 2 * HUD_FRAME_BUDGET_NS);
+    qreal barWidth = histogram.width() / (qreal) HUD_HISTORY;
+    for (int i=0; i < this->hudFrameCount; ++i) {
+        int index = (this->hudFrameIndex - this->hudFrameCount + i + HUD_HISTORY) % HUD_HISTORY;
+        qint64 frameTime = this->hudFrameTimes.at(index);
+        qreal barHeight = histogram.height() * frameTime / (qreal) scaleTime;
+        QColor color = (frameTime > HUD_FRAME_BUDGET_NS) ? QColor("#e05050") : QColor("#50c050");
+        painter->fillRect(QRectF(histogram.left() + (HUD_HISTORY - this->hudFrameCount + i) * barWidth, histogram.bottom() - barHeight, qMax(barWidth - 0.5, 1.0), barHeight), color);
+    }
+
+    // frame budget line
+    int budgetY = histogram.bottom() - histogram.height() * HUD_FRAME_BUDGET_NS / scaleTime;
+    painter->setPen(QColor(255, 255, 255, 120));
+    painter->drawLine(histogram.left(), budgetY, histogram.right(), budgetY);
+
+    painter->restore();
+}
+
+QRect libblockdia::ViewBlockEditor::hudRect()
+{
+    return QRect(HUD_MARGIN, HUD_MARGIN, HUD_WIDTH, HUD_HEIGHT);
+}
@@ -0,0 +1,925 @@
+#include "block.h"
+#include "blockdefwriter.h"
+
+#include <QDebug>
+#include <QMetaClassInfo>
+#include <QObjectList>
+#include <QSet>
+#include <QXmlStreamReader>
+#include <blocktrace.h>
+#include <blockparameterint.h>
+#include <algorithm>
+
+libblockdia::BlockParameterEdit::BlockParameterEdit()
+{
+    this->block = Q_NULLPTR;
+    this->parameter = Q_NULLPTR;
+}
+
+libblockdia::BlockParameterEdit::BlockParameterEdit(libblockdia::Block *block, const QString &parameterName, const libblockdia::BlockParameterValue &value)
+{
+    this->block = block;
+    this->parameter = Q_NULLPTR;
+    this->parameterName = parameterName;
+    this->value = value;
+}
+
+libblockdia::BlockParameterEdit::BlockParameterEdit(libblockdia::Block *block, libblockdia::BlockParameter *parameter, const libblockdia::BlockParameterValue &value)
+{
+    this->block = block;
+    this->parameter = parameter;
+    this->parameterName = (parameter) ? parameter->name() : QString();
+    this->value = value;
+}
+
+
+
+libblockdia::Block::Block(QObject *parent) : QObject(parent)
+{
+    // set default params
+    this->_TypeId       = "";
+    this->_TypeName     = "";
+    this->_InstanceId   = "";
+    this->_InstanceName = "";
+    this->_Color        = QColor("#fff");
+    this->isSnapshotValid = false;
+    for (int i=0; i < LazySectionCount; ++i) {
+        this->lazySectionOffset[i] = -1;
+        this->lazySectionLength[i] = 0;
+    }
+    connect(this, SIGNAL(signalSomethingChanged(libblockdia::Block*)), this, SLOT(slotDataChanged()));
+}
+
+
+
+QString libblockdia::Block::typeId()
+{
+    return this->_TypeId;
+}
+
+void libblockdia::Block::setTypeId(const QString &id)
+{
+    if (id != this->_TypeId) {
+        this->_TypeId = id;
+        this->slotInvalidateCache();
+        emit signalSomethingChanged(this);
+    }
+}
+
+QString libblockdia::Block::typeName()
+{
+    return this->_TypeName;
+}
+
+void libblockdia::Block::setTypeName(const QString &name)
+{
+    if (name != this->_TypeName) {
+        this->_TypeName = name;
+        this->slotInvalidateCache();
+        emit signalSomethingChanged(this);
+    }
+}
+
+
+QString libblockdia::Block::instanceId()
+{
+    return this->_InstanceId;
+}
+
+void libblockdia::Block::setInstanceId(const QString &id)
+{
+    if (id != this->_InstanceId) {
+        this->_InstanceId = id;
+        this->slotInvalidateCache();
+        emit signalSomethingChanged(this);
+    }
+}
+
+QString libblockdia::Block::instanceName()
+{
+    return this->_InstanceName;
+}
+
+void libblockdia::Block::setInstanceName(const QString &name)
+{
+    if (name != this->_InstanceName) {
+        this->_InstanceName = name;
+        this->slotInvalidateCache();
+        emit signalSomethingChanged(this);
+    }
+}
+
+QColor libblockdia::Block::color()
+{
+    return this->_Color;
+}
+
+void libblockdia::Block::setColor(QColor color)
+{
+    if (color != this->_Color) {
+        this->_Color = color;
+        this->slotInvalidateCache();
+        emit signalSomethingChanged(this);
+    }
+}
+
+QList<libblockdia::BlockParameter *> libblockdia::Block::getParameters()
+{
+    this->materializeSection(LazyParameters);
+    return this->parametersList;
+}
+
+libblockdia::BlockParameter *libblockdia::Block::getParameter(const QString name)
+{
+    BlockParameter *ret = Q_NULLPTR;
+    this->materializeSection(LazyParameters);
+
+    // find parameter by name
+    for (int i = 0; i < this->parametersList.size(); ++i) {
+        if (this->parametersList.at(i)->name() == name) {
+            ret = this->parametersList.at(i);
+            break;
+        }
+    }
+
+    return ret;
+}
+
+QList<libblockdia::BlockInput *> libblockdia::Block::getInputs()
+{
+    this->materializeSection(LazyInputs);
+    return this->inputsList;
+}
+
+libblockdia::BlockInput *libblockdia::Block::getInput(const QString name)
+{
+    BlockInput *ret = Q_NULLPTR;
+    this->materializeSection(LazyInputs);
+
+    // find input by name
+    for (int i = 0; i < this->inputsList.size(); ++i) {
+        if (this->inputsList.at(i)->name() == name) {
+            ret = this->inputsList.at(i);
+            break;
+        }
+    }
+
+    return ret;
+}
+
+QList<libblockdia::BlockOutput *> libblockdia::Block::getOutputs()
+{
+    this->materializeSection(LazyOutputs);
+    return this->outputsList;
+}
+
+libblockdia::BlockOutput *libblockdia::Block::getOutput(const QString name)
+{
+    BlockOutput *ret = NULL;
+    this->materializeSection(LazyOutputs);
+
+    // find input by name
+    for (int i = 0; i < this->outputsList.size(); ++i) {
+        if (this->outputsList.at(i)->name() == name) {
+            ret = this->outputsList.at(i);
+            break;
+        }
+    }
+
+    return ret;
+}
+
+libblockdia::Block *libblockdia::Block::parseBlockDef(QIODevice *dev, libblockdia::Block *block, ParseMode mode)
+{
+    BLOCKDIA_TRACE_SCOPE("Block::parseBlockDef");
+    // lazy parsing needs to keep the source for later access
+    QString source;
+    if (mode == ParseMode::Lazy) source = QString::fromUtf8(dev->readAll());
+    QXmlStreamReader xml;
+    if (mode == ParseMode::Lazy) xml.addData(source);
+    else xml.setDevice(dev);
+
+    while (!xml.atEnd()) {
+
+        if (xml.readNextStartElement()) {
+
+            // no block definition found
+            if (xml.name() != "BlockDef") {
+                qWarning() << "parseBlockDef: unknown root element:" << xml.name();
+                xml.skipCurrentElement();
+            } else {
+
+                // parse different versions
+                if (xml.attributes().value("version") == "1") {
+                    if (!block) block = new Block();
+                    if (mode == ParseMode::Lazy) block->lazySource = source;
+                    parseBlockDefVersion1(&xml, block, mode);
+                    break;
+                }
+
+                // unknwon version
+                else {
+                    qWarning() << "parseBlockDef: unsupported version:" << xml.attributes().value("version");
+                    xml.skipCurrentElement();
+                }
+            }
+        }
+    }
+
+    return block;
+}
+
+bool libblockdia::Block::exportBlockDef(QIODevice *dev, bool autoFormatting)
+{
+    BlockDefWriter *writer = BlockDefWriter::threadWriter();
+    writer->setAutoFormatting(autoFormatting);
+    if (!writer->write(this->exportBlockData(), dev)) {
+        qWarning() << "Block::exportBlockDef:" << writer->errorString();
+        return false;
+    }
+    return true;
+}
+
+libblockdia::Block *libblockdia::Block::parseBlockDefCbor(QIODevice *dev, libblockdia::Block *block)
+{
+    BLOCKDIA_TRACE_SCOPE("Block::parseBlockDefCbor");
+    BlockData data;
+    if (!BlockData::parseBlockDefCbor(dev, &data)) return block;
+    return importBlockData(data, block);
+}
+
+bool libblockdia::Block::exportBlockDefCbor(QIODevice *dev)
+{
+    return this->exportBlockData().exportBlockDefCbor(dev);
+}
+
+libblockdia::Block *libblockdia::Block::importBlockData(const libblockdia::BlockData &data, libblockdia::Block *block)
+{
+    BLOCKDIA_TRACE_SCOPE("Block::importBlockData");
+    if (!block) block = new Block();
+
+    // header
+    block->setTypeName(data.typeName);
+    block->setTypeId(data.typeId);
+    block->setInstanceName(data.instanceName);
+    block->setInstanceId(data.instanceId);
+    block->setColor(data.color);
+
+    // parameters
+    for (int i=0; i < data.parameters.size(); ++i) {
+        BlockParameter::importBlockData(data.parameters.at(i), block);
+    }
+
+    // inputs
+    for (int i=0; i < data.inputs.size(); ++i) {
+        new BlockInput(data.inputs.at(i), block);
+    }
+
+    // outputs
+    for (int i=0; i < data.outputs.size(); ++i) {
+        new BlockOutput(data.outputs.at(i), block);
+    }
+
+    // children must be available immediately,
+    // the block may live in a thread without event loop
+    block->slotUpdateChildObjects();
+
+    return block;
+}
+
+libblockdia::BlockData libblockdia::Block::exportBlockData()
+{
+    return this->snapshot();
+}
+
+libblockdia::BlockData libblockdia::Block::snapshot()
+{
+    BLOCKDIA_TRACE_SCOPE("Block::snapshot");
+    // children must be parsed before the snapshot is valid
+    QList<BlockParameter *> params = this->getParameters();
+    QList<BlockInput *> inputs = this->getInputs();
+    QList<BlockOutput *> outputs = this->getOutputs();
+
+    if (!this->isSnapshotValid) {
+        BlockData data;
+
+        // header
+        data.typeName = this->typeName();
+        data.typeId = this->typeId();
+        data.instanceName = this->instanceName();
+        data.instanceId = this->instanceId();
+        data.color = this->color();
+
+        // parameters (unchanged parameters return their cached snapshot)
+        data.parameters.reserve(params.size());
+        for (int i=0; i < params.size(); ++i) {
+            data.parameters.append(params.at(i)->snapshot());
+        }
+
+        // inputs
+        for (int i=0; i < inputs.size(); ++i) {
+            data.inputs.append(inputs.at(i)->name());
+        }
+
+        // outputs
+        for (int i=0; i < outputs.size(); ++i) {
+            data.outputs.append(outputs.at(i)->name());
+        }
+
+        this->cachedSnapshot = data;
+        this->isSnapshotValid = true;
+    }
+
+    return this->cachedSnapshot;
+}
+
+bool libblockdia::Block::applyBlockData(const libblockdia::BlockData &data)
+{
+    BLOCKDIA_TRACE_SCOPE("Block::applyBlockData");
+    bool somethingChanged = false;
+
+    // all changes are collected and announced once
+    bool signalsWereBlocked = this->blockSignals(true);
+
+
+    // ------------------------------------------------------------------------
+    //                                  Header
+    // ------------------------------------------------------------------------
+
+    if (this->typeName() != data.typeName || this->typeId() != data.typeId ||
+        this->instanceName() != data.instanceName || this->instanceId() != data.instanceId ||
+        this->color() != data.color) {
+        this->setTypeName(data.typeName);
+        this->setTypeId(data.typeId);
+        this->setInstanceName(data.instanceName);
+        this->setInstanceId(data.instanceId);
+        this->setColor(data.color);
+        somethingChanged = true;
+    }
+
+
+    // ------------------------------------------------------------------------
+    //                                Parameters
+    // ------------------------------------------------------------------------
+
+    // parameters are identified by their name
+    QList<BlockParameter *> params = this->getParameters();
+    QHash<QString, BlockParameter *> paramsByName;
+    for (int i=0; i < params.size(); ++i) {
+        paramsByName.insert(params.at(i)->name(), params.at(i));
+    }
+
+    // the parameters in the order of the data
+    QList<BlockParameter *> orderedParams;
+    orderedParams.reserve(data.parameters.size());
+
+    for (int i=0; i < data.parameters.size(); ++i) {
+        const BlockParameterData &d = data.parameters.at(i);
+        BlockParameter *param = paramsByName.take(d.name);
+
+        // the type of a parameter cannot be changed
+        if (param && param->type() != d.type) {
+            delete param;
+            param = Q_NULLPTR;
+        }
+
+        // new parameter
+        if (!param) {
+            param = BlockParameter::importBlockData(d, this);
+            if (param) orderedParams.append(param);
+            somethingChanged = true;
+            continue;
+        }
+        orderedParams.append(param);
+
+        // update existing parameter only if it differs
+        BlockParameterData current = param->snapshot();
+        if (current.isPublic != d.isPublic || current.defaultValue != d.defaultValue ||
+            current.minimum != d.minimum || current.maximum != d.maximum ||
+            current.enumItems != d.enumItems || current.expression != d.expression ||
+            current.elementType != d.elementType || current.elementMinimum != d.elementMinimum ||
+            current.elementMaximum != d.elementMaximum ||
+            (!d.value.isNull() && current.value != d.value)) {
+            bool paramSignalsWereBlocked = param->blockSignals(true);
+            param->importParamData(d);
+            param->setPublic(d.isPublic);
+            param->setDefaultValue(d.defaultValue);
+            param->setExpression(d.expression);
+            if (!d.value.isNull()) param->setValue(d.value);
+            param->blockSignals(paramSignalsWereBlocked);
+            param->invalidateCache();
+            somethingChanged = true;
+        }
+    }
+
+    // remove parameters that do not exist anymore
+    for (QHash<QString, BlockParameter *>::iterator it = paramsByName.begin(); it != paramsByName.end(); ++it) {
+        delete it.value();
+        somethingChanged = true;
+    }
+
+
+    // ------------------------------------------------------------------------
+    //                             Inputs / Outputs
+    // ------------------------------------------------------------------------
+
+    // inputs are identified by their position
+    QList<BlockInput *> inputs = this->getInputs();
+    for (int i=0; i < inputs.size() && i < data.inputs.size(); ++i) {
+        if (inputs.at(i)->name() != data.inputs.at(i)) {
+            bool inputSignalsWereBlocked = inputs.at(i)->blockSignals(true);
+            inputs.at(i)->setName(data.inputs.at(i));
+            inputs.at(i)->blockSignals(inputSignalsWereBlocked);
+            somethingChanged = true;
+        }
+    }
+    for (int i=data.inputs.size(); i < inputs.size(); ++i) {
+        delete inputs.at(i);
+        somethingChanged = true;
+    }
+    for (int i=inputs.size(); i < data.inputs.size(); ++i) {
+        new BlockInput(data.inputs.at(i), this);
+        somethingChanged = true;
+    }
+
+    // outputs are identified by their position
+    QList<BlockOutput *> outputs = this->getOutputs();
+    for (int i=0; i < outputs.size() && i < data.outputs.size(); ++i) {
+        if (outputs.at(i)->name() != data.outputs.at(i)) {
+            bool outputSignalsWereBlocked = outputs.at(i)->blockSignals(true);
+            outputs.at(i)->setName(data.outputs.at(i));
+            outputs.at(i)->blockSignals(outputSignalsWereBlocked);
+            somethingChanged = true;
+        }
+    }
+    for (int i=data.outputs.size(); i < outputs.size(); ++i) {
+        delete outputs.at(i);
+        somethingChanged = true;
+    }
+    for (int i=outputs.size(); i < data.outputs.size(); ++i) {
+        new BlockOutput(data.outputs.at(i), this);
+        somethingChanged = true;
+    }
+
+
+    // ------------------------------------------------------------------------
+    //                                  Finish
+    // ------------------------------------------------------------------------
+
+    // update child lists immediately and relayout only once
+    this->slotUpdateChildObjects();
+
+    // new parameters are appended to the list, so restore the order of the data
+    if (this->parametersList != orderedParams && this->parametersList.size() == orderedParams.size()) {
+        this->parametersList = orderedParams;
+        somethingChanged = true;
+    }
+
+    this->blockSignals(signalsWereBlocked);
+    if (somethingChanged) {
+        this->slotInvalidateCache();
+        this->slotDataChanged();
+    }
+
+    return somethingChanged;
+}
+
+QByteArray libblockdia::Block::canonicalSerialization()
+{
+    return this->exportBlockData().canonicalSerialization();
+}
+
+QByteArray libblockdia::Block::contentHash()
+{
+    BLOCKDIA_TRACE_SCOPE("Block::contentHash");
+    if (this->cachedContentHash.isEmpty()) {
+
+        // header, inputs and outputs
+        BlockData data;
+        data.typeName = this->typeName();
+        data.typeId = this->typeId();
+        data.instanceName = this->instanceName();
+        data.instanceId = this->instanceId();
+        data.color = this->color();
+        QList<BlockInput *> inputs = this->getInputs();
+        for (int i=0; i < inputs.size(); ++i) data.inputs.append(inputs.at(i)->name());
+        QList<BlockOutput *> outputs = this->getOutputs();
+        for (int i=0; i < outputs.size(); ++i) data.outputs.append(outputs.at(i)->name());
+
+        // cached parameter hashes
+        QList<BlockParameter *> params = this->getParameters();
+        QList<QByteArray> parameterHashes;
+        parameterHashes.reserve(params.size());
+        for (int i=0; i < params.size(); ++i) parameterHashes.append(params.at(i)->contentHash());
+
+        this->cachedContentHash = BlockData::combineContentHash(data, parameterHashes);
+    }
+
+    return this->cachedContentHash;
+}
+
+QByteArray libblockdia::Block::contentHash(const QList<libblockdia::Block *> &blocks)
+{
+    BLOCKDIA_TRACE_SCOPE("Block::contentHash(blocks)");
+    QList<QByteArray> hashes;
+    hashes.reserve(blocks.size());
+    for (int i=0; i < blocks.size(); ++i) hashes.append(blocks.at(i)->contentHash());
+    return BlockData::combineContentHashes(hashes);
+}
+
+void libblockdia::Block::addMemoryUsage(libblockdia::BlockMemory *usage)
+{
+    // the block and its lists of children
+    usage->addObject(BlockMemory::Blocks, sizeof(Block) + BlockMemory::QObjectPrivateBytes);
+    qint64 countChildren = this->children().size() + this->parametersList.size() + this->inputsList.size() + this->outputsList.size();
+    usage->addBytes(BlockMemory::Blocks, countChildren * (qint64) sizeof(void *));
+    usage->addString(BlockMemory::Strings, this->_TypeId);
+    usage->addString(BlockMemory::Strings, this->_TypeName);
+    usage->addString(BlockMemory::Strings, this->_InstanceId);
+    usage->addString(BlockMemory::Strings, this->_InstanceName);
+
+    // children
+    for (int i=0; i < this->parametersList.size(); ++i) this->parametersList.at(i)->addMemoryUsage(usage);
+    for (int i=0; i < this->inputsList.size(); ++i) {
+        usage->addObject(BlockMemory::Inputs, sizeof(BlockInput) + BlockMemory::QObjectPrivateBytes);
+        usage->addString(BlockMemory::Strings, this->inputsList.at(i)->name());
+    }
+    for (int i=0; i < this->outputsList.size(); ++i) {
+        usage->addObject(BlockMemory::Outputs, sizeof(BlockOutput) + BlockMemory::QObjectPrivateBytes);
+        usage->addString(BlockMemory::Strings, this->outputsList.at(i)->name());
+    }
+
+    // caches (after the children, so shared strings are accounted to the children)
+    usage->addByteArray(BlockMemory::Caches, this->cachedContentHash);
+    if (this->isSnapshotValid) usage->addBlockData(BlockMemory::Caches, this->cachedSnapshot);
+    usage->addString(BlockMemory::Caches, this->lazySource);
+}
+
+libblockdia::BlockMemory libblockdia::Block::memoryUsage()
+{
+    BlockMemory usage;
+    this->addMemoryUsage(&usage);
+    return usage;
+}
+
+libblockdia::BlockMemory libblockdia::Block::memoryUsage(const QList<libblockdia::Block *> &blocks)
+{
+    BlockMemory usage;
+    for (int i=0; i < blocks.size(); ++i) blocks.at(i)->addMemoryUsage(&usage);
+    return usage;
+}
+
+int libblockdia::Block::applyParameterValues(const QVector<libblockdia::BlockParameterEdit> &edits, QStringList *errors)
+{
+    BLOCKDIA_TRACE_SCOPE("Block::applyParameterValues");
+    QVector<BlockParameter *> resolved(edits.size(), Q_NULLPTR);
+
+
+    // ------------------------------------------------------------------------
+    //                                 Validate
+    // ------------------------------------------------------------------------
+
+    // the parameters of a block are looked up by name only once
+    QHash<Block *, QHash<QString, BlockParameter *> > parametersByName;
+
+    // integer values are collected to be clipped at once
+    QVector<int> intEdits;
+    QVector<qint32> intValues, intMinimums, intMaximums;
+
+    for (int i=0; i < edits.size(); ++i) {
+        const BlockParameterEdit &edit = edits.at(i);
+        if (edit.block == Q_NULLPTR) {
+            if (errors) errors->append(QString("Edit %1 has no block").arg(i));
+            continue;
+        }
+
+        // find parameter
+        BlockParameter *param = edit.parameter;
+        if (param == Q_NULLPTR) {
+            QHash<Block *, QHash<QString, BlockParameter *> >::iterator it = parametersByName.find(edit.block);
+            if (it == parametersByName.end()) {
+                it = parametersByName.insert(edit.block, QHash<QString, BlockParameter *>());
+                QList<BlockParameter *> params = edit.block->getParameters();
+                it->reserve(params.size());
+                for (int j=0; j < params.size(); ++j) {
+                    if (!it->contains(params.at(j)->name())) it->insert(params.at(j)->name(), params.at(j));
+                }
+            }
+            param = it->value(edit.parameterName, Q_NULLPTR);
+        } else if (param->parent() != edit.block) {
+            param = Q_NULLPTR;
+        }
+        if (param == Q_NULLPTR) {
+            if (errors) errors->append(QString("%1: Unknown parameter '%2'").arg(edit.block->instanceId(), edit.parameterName));
+            continue;
+        }
+
+        // check integer values
+        BlockParameterInt *paramInt = qobject_cast<BlockParameterInt *>(param);
+        if (paramInt) {
+            bool ok;
+            int value = edit.value.toInt(&ok);
+            if (!ok) {
+                if (errors) errors->append(QString("%1: Parameter '%2' requires an integer value").arg(edit.block->instanceId(), param->name()));
+                continue;
+            }
+            intEdits.append(i);
+            intValues.append(value);
+            intMinimums.append(paramInt->minimum());
+            intMaximums.append(paramInt->maximum());
+        }
+
+        resolved[i] = param;
+    }
+
+
+    // ------------------------------------------------------------------------
+    //                              Clip Integers
+    // ------------------------------------------------------------------------
+
+    // branch free, so the compiler can vectorize the loop
+    QVector<char> intClipped(intValues.size());
+    qint32 *values = intValues.data();
+    const qint32 *minimums = intMinimums.constData();
+    const qint32 *maximums = intMaximums.constData();
+    char *clipped = intClipped.data();
+    for (int k=0; k < intValues.size(); ++k) {
+        qint32 value = std::min(std::max(values[k], minimums[k]), maximums[k]);
+        clipped[k] = (value != values[k]);
+        values[k] = value;
+    }
+
+    if (errors) {
+        for (int k=0; k < intEdits.size(); ++k) {
+            if (!clipped[k]) continue;
+            const BlockParameterEdit &edit = edits.at(intEdits.at(k));
+            errors->append(QString("%1: Value of parameter '%2' clipped to %3").arg(edit.block->instanceId(), resolved.at(intEdits.at(k))->name()).arg(values[k]));
+        }
+    }
+
+
+    // ------------------------------------------------------------------------
+    //                                  Apply
+    // ------------------------------------------------------------------------
+
+    // neither the blocks nor the parameters announce the single changes
+    QList<Block *> blocks;
+    QHash<Block *, bool> signalsWereBlocked;
+    QHash<Block *, QList<BlockParameter *> > changedParameters;
+    QSet<BlockParameter *> isParameterChanged;
+    int countChanged = 0;
+    int nextIntEdit = 0;
+
+    for (int i=0; i < edits.size(); ++i) {
+        BlockParameter *param = resolved.at(i);
+        if (param == Q_NULLPTR) continue;
+        Block *block = edits.at(i).block;
+
+        if (!signalsWereBlocked.contains(block)) {
+            blocks.append(block);
+            signalsWereBlocked.insert(block, block->blockSignals(true));
+        }
+
+        bool changed;
+        bool paramSignalsWereBlocked = param->blockSignals(true);
+        if (nextIntEdit < intEdits.size() && intEdits.at(nextIntEdit) == i) {
+            BlockParameterInt *paramInt = (BlockParameterInt *) param;
+            int value = values[nextIntEdit];
+            ++nextIntEdit;
+            changed = (paramInt->value() != value);
+            if (changed) paramInt->setValue(value);
+        } else {
+            BlockParameterValue previous = param->typedValue();
+            if (!param->setTypedValue(edits.at(i).value) && errors) {
+                errors->append(QString("%1: Value of parameter '%2' could not be set exactly").arg(block->instanceId(), param->name()));
+            }
+            changed = (param->typedValue() != previous);
+        }
+        param->blockSignals(paramSignalsWereBlocked);
+
+        if (changed) {
+            ++countChanged;
+            param->invalidateCache();
+            if (!isParameterChanged.contains(param)) {
+                isParameterChanged.insert(param);
+                changedParameters[block].append(param);
+            }
+        }
+    }
+
+    // announce every changed block once
+    for (int i=0; i < blocks.size(); ++i) {
+        Block *block = blocks.at(i);
+        block->blockSignals(signalsWereBlocked.value(block));
+        QHash<Block *, QList<BlockParameter *> >::const_iterator it = changedParameters.constFind(block);
+        if (it == changedParameters.constEnd()) continue;
+        block->slotInvalidateCache();
+        emit block->signalParametersChanged(block, it.value());
+        emit block->signalSomethingChanged(block);
+    }
+
+    return countChanged;
+}
+
+void libblockdia::Block::childEvent(QChildEvent *e)
+{
+    Q_UNUSED(e)
+
+    // the content changes with the children
+    this->slotInvalidateCache();
+
+    // catch child add/delete event
+    // delayed timer ensures that child is add/deleted completely
+    // when calling the timer slot function
+    QTimer::singleShot(0, this, SLOT(slotUpdateChildObjects()));
+}
+
+void libblockdia::Block::parseBlockDefVersion1(QXmlStreamReader *xml, libblockdia::Block *block, ParseMode mode)
+{
+    Q_ASSERT(xml->isStartElement() && xml->name() == "BlockDef");
+
+    // read block definitions
+    while (xml->readNextStartElement()) {
+
+        // read type name
+        if (xml->name() == "TypeName") {
+            QString t = xml->readElementText(QXmlStreamReader::SkipChildElements);
+            block->setTypeName(t);
+        }
+
+        // read type id
+        else if (xml->name() == "TypeId") {
+            QString t = xml->readElementText(QXmlStreamReader::SkipChildElements);
+            block->setTypeId(t);
+        }
+
+        // read color
+        else if (xml->name() == "Color") {
+            QString t = xml->readElementText(QXmlStreamReader::SkipChildElements);
+            block->setColor(QColor(t));
+        }
+
+        // remember sections for lazy parsing
+        else if (mode == ParseMode::Lazy && (xml->name() == "Parameters" || xml->name() == "Inputs" || xml->name() == "Outputs")) {
+            LazySection section = LazyParameters;
+            if (xml->name() == "Inputs") section = LazyInputs;
+            else if (xml->name() == "Outputs") section = LazyOutputs;
+
+            // the start tag is already read, so search back for its beginning
+            // ('<' is not allowed within attribute values)
+            int offset = block->lazySource.lastIndexOf(QLatin1Char('<'), (int) xml->characterOffset() - 1);
+            xml->skipCurrentElement();
+            block->lazySectionOffset[section] = offset;
+            block->lazySectionLength[section] = (int) xml->characterOffset() - offset;
+        }
+
+        // check for inputs
+        else if (xml->name() == "Inputs") {
+            BlockInput::parseBlockDef(xml, block);
+        }
+
+        // check for outputs
+        else if (xml->name() == "Outputs") {
+            BlockOutput::parseBlockDef(xml, block);
+        }
+
+        // check for parameters
+        else if (xml->name() == "Parameters") {
+            BlockParameter::importBlockDef(xml, block);
+        }
+
+        // unknown tag
+        else {
+            xml->skipCurrentElement();
+        }
+    }
+}
+
+void libblockdia::Block::materializeSection(libblockdia::Block::LazySection section)
+{
+    // check if section is already parsed
+    int offset = this->lazySectionOffset[section];
+    if (offset < 0) return;
+    int length = this->lazySectionLength[section];
+    this->lazySectionOffset[section] = -1;
+
+    // parse the section
+    // materializing is not a change of the block, so no signals are emitted
+    bool signalsWereBlocked = this->blockSignals(true);
+    QXmlStreamReader xml(this->lazySource.mid(offset, length));
+    if (xml.readNextStartElement()) {
+        if (section == LazyParameters) BlockParameter::importBlockDef(&xml, this);
+        else if (section == LazyInputs) BlockInput::parseBlockDef(&xml, this);
+        else if (section == LazyOutputs) BlockOutput::parseBlockDef(&xml, this);
+    }
+
+    // children must be available immediately, not after the next event loop cycle
+    this->slotUpdateChildObjects();
+    this->blockSignals(signalsWereBlocked);
+
+    // free the source when all sections are parsed
+    bool allSectionsParsed = true;
+    for (int i=0; i < LazySectionCount; ++i) {
+        if (this->lazySectionOffset[i] >= 0) allSectionsParsed = false;
+    }
+    if (allSectionsParsed) this->lazySource.clear();
+}
+
+void libblockdia::Block::slotDataChanged()
+{
+    emit signalDataChanged(this);
+}
+
+void libblockdia::Block::slotUpdateChildObjects()
+{
+    BLOCKDIA_TRACE_SCOPE("Block::slotUpdateChildObjects");
+    bool emitSomethignChanged = false;
+    QObjectList listChildren = this->children();
+
+
+    // ------------------------------------------------------------------------
+    //                               Find New Children
+    // ------------------------------------------------------------------------
+
+    for (int i=0; i < listChildren.size(); ++i) {
+        // get liblock dia meta data
+        QString childClass = listChildren.at(i)->metaObject()->className();
+        QString childSuperClass = listChildren.at(i)->metaObject()->superClass()->className();
+
+        // check for new parameters
+        if (childSuperClass == "libblockdia::BlockParameter") {
+            BlockParameter *child = (BlockParameter *) listChildren.at(i);
+            if (this->parametersList.count(child) == 0) {
+                this->parametersList.append(child);
+                connect(child, SIGNAL(somethingHasChanged()), this, SLOT(slotDataChanged()));
+                connect(child, SIGNAL(somethingHasChanged()), this, SLOT(slotInvalidateCache()));
+                emitSomethignChanged = true;
+            }
+        }
+
+        // check for new inputs
+        else if (childClass == "libblockdia::BlockInput") {
+            BlockInput *child = (BlockInput *) listChildren.at(i);
+            if (this->inputsList.count(child) == 0) {
+                this->inputsList.append(child);
+                connect(child, SIGNAL(somethingHasChanged()), this, SLOT(slotDataChanged()));
+                connect(child, SIGNAL(somethingHasChanged()), this, SLOT(slotInvalidateCache()));
+                emitSomethignChanged = true;
+            }
+        }
+
+        // check for new outputs
+        else if (childClass == "libblockdia::BlockOutput") {
+            BlockOutput *child = (BlockOutput *) listChildren.at(i);
+            if (this->outputsList.count(child) == 0) {
+                this->outputsList.append(child);
+                connect(child, SIGNAL(somethingHasChanged()), this, SLOT(slotDataChanged()));
+                connect(child, SIGNAL(somethingHasChanged()), this, SLOT(slotInvalidateCache()));
+                emitSomethignChanged = true;
+            }
+        }
+    }
+
+
+
+    // ------------------------------------------------------------------------
+    //                           Delete Lost Children
+    // ------------------------------------------------------------------------
+
+    for (int i=0; i < this->parametersList.size(); ++i) {
+        if (!listChildren.contains(this->parametersList.at(i))) {
+            this->parametersList.removeAt(i);
+            --i;
+            emitSomethignChanged = true;
+        }
+    }
+
+    for (int i=0; i < this->inputsList.size(); ++i) {
+        if (!listChildren.contains(this->inputsList.at(i))) {
+            this->inputsList.removeAt(i);
+            --i;
+            emitSomethignChanged = true;
+        }
+    }
+
+    for (int i=0; i < this->outputsList.size(); ++i) {
+        if (!listChildren.contains(this->outputsList.at(i))) {
+            this->outputsList.removeAt(i);
+            --i;
+            emitSomethignChanged = true;
+        }
+    }
+
+
+    // emit singal
+    if (emitSomethignChanged) {
+        this->slotInvalidateCache();
+        emit signalSomethingChanged(this);
+    }
+}
+
+void libblockdia::Block::slotInvalidateCache()
+{
+    this->cachedContentHash.clear();
+    this->isSnapshotValid = false;
+}
@@ -0,0 +1,619 @@
+#include "blockdata.h"
+
+#include <QDebug>
+#include <QSet>
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <limits.h>
+#include <limits>
+#include <blocktrace.h>
+
+// version of the CBOR block definition
+#define CBOR_BLOCKDEF_VERSION 1
+
+// hash algorithm of content hashes
+#define CONTENT_HASH_ALGORITHM QCryptographicHash::Sha1
+
+/**
+ * @details Reading a (possibly chunked) CBOR text string.
+ * Other types are skipped and an empty string is returned.
+ */
+static QString readCborString(QCborStreamReader &reader)
+{
+    QString result;
+
+    if (!reader.isString()) {
+        reader.next();
+        return result;
+    }
+
+    QCborStreamReader::StringResult<QString> r = reader.readString();
+    while (r.status == QCborStreamReader::Ok) {
+        result += r.data;
+        r = reader.readString();
+    }
+
+    return result;
+}
+
+/**
+ * @details Reading a CBOR integer.
+ * Other types are skipped and the default value is returned.
+ */
+static int readCborInt(QCborStreamReader &reader, int defaultValue)
+{
+    int result = defaultValue;
+    if (reader.isInteger()) result = (int) reader.toInteger();
+    reader.next();
+    return result;
+}
+
+/**
+ * @details Reading a CBOR number (integer or floating point).
+ * Other types are skipped and the default value is returned.
+ */
+static double readCborDouble(QCborStreamReader &reader, double defaultValue)
+{
+    double result = defaultValue;
+    if (reader.isInteger()) result = (double) reader.toInteger();
+    else if (reader.isDouble()) result = reader.toDouble();
+    else if (reader.isFloat()) result = reader.toFloat();
+    reader.next();
+    return result;
+}
+
+/**
+ * @details Reading a CBOR array of text strings.
+ */
+static QStringList readCborStringList(QCborStreamReader &reader)
+{
+    QStringList result;
+
+    if (!reader.isArray()) {
+        reader.next();
+        return result;
+    }
+
+    reader.enterContainer();
+    while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+        result.append(readCborString(reader));
+    }
+    reader.leaveContainer();
+
+    return result;
+}
+
+libblockdia::BlockParameterData::BlockParameterData()
+{
+    this->type = "";
+    this->name = "";
+    this->isPublic = false;
+    this->defaultValue = "";
+    this->minimum = INT_MIN;
+    this->maximum = INT_MAX;
+    this->elementMinimum = std::numeric_limits<double>::lowest();
+    this->elementMaximum = std::numeric_limits<double>::max();
+}
+
+bool libblockdia::BlockParameterData::operator==(const libblockdia::BlockParameterData &other) const
+{
+    return this->type == other.type && this->name == other.name && this->isPublic == other.isPublic &&
+           this->defaultValue == other.defaultValue && this->value == other.value &&
+           this->minimum == other.minimum && this->maximum == other.maximum && this->enumItems == other.enumItems &&
+           this->expression == other.expression && this->elementType == other.elementType &&
+           this->elementMinimum == other.elementMinimum && this->elementMaximum == other.elementMaximum;
+}
+
+bool libblockdia::BlockParameterData::operator!=(const libblockdia::BlockParameterData &other) const
+{
+    return !(*this == other);
+}
+
+QString libblockdia::BlockParameterData::displayValue() const
+{
+    if (this->type != "array") return this->value;
+
+    // the number of elements follows from the length of the base64 encoding
+    QString v = this->value.trimmed();
+    int bytes = v.size() / 4 * 3;
+    if (v.endsWith("==")) bytes -= 2;
+    else if (v.endsWith("=")) bytes -= 1;
+    bool isInt = this->elementType.trimmed().toLower() == "int";
+    return QString("[%1 x %2]").arg(bytes / (isInt ? 4 : 8)).arg(isInt ? "int" : "double");
+}
+
+libblockdia::BlockParameterData libblockdia::BlockParameterData::normalized() const
+{
+    BlockParameterData param = *this;
+    param.type = this->type.trimmed().toLower();
+
+    // integers are normalized, a null value (not set) stays null
+    if (param.type == "int") {
+        bool ok;
+        int i = param.defaultValue.trimmed().toInt(&ok);
+        if (ok) param.defaultValue = QString::number(i);
+        i = param.value.trimmed().toInt(&ok);
+        if (ok) param.value = QString::number(i);
+    } else {
+        param.minimum = INT_MIN;
+        param.maximum = INT_MAX;
+    }
+
+    if (param.type != "enum") param.enumItems.clear();
+
+    // arrays are base64 encoded, the element type defaults to double
+    if (param.type == "array") {
+        param.elementType = param.elementType.trimmed().toLower();
+        if (param.elementType != "int") param.elementType = "double";
+        param.defaultValue = param.defaultValue.trimmed();
+        if (!param.value.isNull()) param.value = param.value.trimmed();
+    } else {
+        param.elementType = QString();
+        param.elementMinimum = std::numeric_limits<double>::lowest();
+        param.elementMaximum = std::numeric_limits<double>::max();
+    }
+    param.expression = param.expression.trimmed();
+
+    return param;
+}
+
+QByteArray libblockdia::BlockParameterData::canonicalSerialization() const
+{
+    QByteArray result;
+    QDataStream ds(&result, QIODevice::WriteOnly);
+    ds.setVersion(QDataStream::Qt_5_6);
+
+    BlockParameterData param = this->normalized();
+
+    // standard data
+    ds << param.type << param.name << param.isPublic << param.defaultValue << param.value;
+
+    // type specific data
+    if (param.type == "int") ds << (qint32) param.minimum << (qint32) param.maximum;
+    else if (param.type == "enum") ds << param.enumItems;
+    else if (param.type == "array") ds << param.elementType << param.elementMinimum << param.elementMaximum;
+
+    // expressions are optional (parameters without expression keep their serialization)
+    if (!param.expression.isEmpty()) ds << QString("expression") << param.expression;
+
+    return result;
+}
+
+QByteArray libblockdia::BlockParameterData::contentHash() const
+{
+    return QCryptographicHash::hash(this->canonicalSerialization(), CONTENT_HASH_ALGORITHM);
+}
+
+bool libblockdia::BlockParameterData::parseParamDef(QXmlStreamReader *xml, libblockdia::BlockParameterData *param)
+{
+    QXmlStreamAttributes attr = xml->attributes();
+
+    // parameters without type are ignored
+    if (!attr.hasAttribute("type")) {
+        xml->skipCurrentElement();
+        return false;
+    }
+
+    *param = BlockParameterData();
+    param->type = attr.value("type").toString().trimmed();
+    param->name = attr.value("name").toString();
+
+    // public
+    if (attr.hasAttribute("isPublic")) {
+        QString v = attr.value("isPublic").toString().trimmed().toLower();
+        param->isPublic = v == "yes" || v == "true" || v == "1";
+    }
+
+    // default
+    if (attr.hasAttribute("default")) {
+        param->defaultValue = attr.value("default").toString().trimmed();
+    }
+
+    // expression
+    if (attr.hasAttribute("expression")) {
+        param->expression = attr.value("expression").toString().trimmed();
+    }
+
+    // type specific data
+    if (param->type == "int") {
+        while (xml->readNextStartElement()) {
+            if (xml->name() == "Min" || xml->name() == "Max") {
+                bool isMin = xml->name() == "Min";
+                bool ok;
+                int i = xml->readElementText(QXmlStreamReader::SkipChildElements).toInt(&ok);
+                if (ok && isMin) param->minimum = i;
+                else if (ok) param->maximum = i;
+            } else {
+                qWarning() << "ERROR Parsing XML: unknown element (at line" << xml->lineNumber() << ")";
+                xml->skipCurrentElement();
+            }
+        }
+    } else if (param->type == "enum") {
+        QSet<QString> knownItems;
+        while (xml->readNextStartElement()) {
+            if (xml->name() == "EnumItems") {
+                while (xml->readNextStartElement()) {
+                    if (xml->name() == "Item") {
+                        QString item = xml->attributes().value("name").toString();
+                        if (!knownItems.contains(item)) {
+                            knownItems.insert(item);
+                            param->enumItems.append(item);
+                        }
+                    } else {
+                        qWarning() << "ERROR Parsing XML: unknown element (at line" << xml->lineNumber() << ")";
+                    }
+                    xml->skipCurrentElement();
+                }
+            } else {
+                qWarning() << "ERROR Parsing XML: unknown element (at line" << xml->lineNumber() << ")";
+                xml->skipCurrentElement();
+            }
+        }
+    } else if (param->type == "array") {
+        param->elementType = "double";
+        while (xml->readNextStartElement()) {
+            if (xml->name() == "ElementType") {
+                param->elementType = xml->readElementText(QXmlStreamReader::SkipChildElements).trimmed();
+            } else if (xml->name() == "ElementMin" || xml->name() == "ElementMax") {
+                bool isMin = xml->name() == "ElementMin";
+                bool ok;
+                double d = xml->readElementText(QXmlStreamReader::SkipChildElements).toDouble(&ok);
+                if (ok && isMin) param->elementMinimum = d;
+                else if (ok) param->elementMaximum = d;
+            } else {
+                qWarning() << "ERROR Parsing XML: unknown element (at line" << xml->lineNumber() << ")";
+                xml->skipCurrentElement();
+            }
+        }
+    } else if (param->type == "str") {
+        xml->skipCurrentElement();
+    } else {
+        qWarning() << "ERROR Parsing XML: unknown parameter type (at line" << xml->lineNumber() << ")";
+        xml->skipCurrentElement();
+        return false;
+    }
+
+    return true;
+}
+
+libblockdia::BlockData::BlockData()
+{
+    this->typeId = "";
+    this->typeName = "";
+    this->instanceId = "";
+    this->instanceName = "";
+    this->color = QColor("#fff");
+}
+
+bool libblockdia::BlockData::parseBlockDef(QIODevice *dev, libblockdia::BlockData *data)
+{
+    BLOCKDIA_TRACE_SCOPE("BlockData::parseBlockDef");
+    QXmlStreamReader xml(dev);
+
+    while (!xml.atEnd()) {
+
+        if (xml.readNextStartElement()) {
+
+            // no block definition found
+            if (xml.name() != "BlockDef") {
+                qWarning() << "BlockData::parseBlockDef: unknown root element:" << xml.name();
+                xml.skipCurrentElement();
+            } else {
+
+                // parse different versions
+                if (xml.attributes().value("version") == "1") {
+                    parseBlockDefVersion1(&xml, data);
+                    return !xml.hasError();
+                }
+
+                // unknwon version
+                else {
+                    qWarning() << "BlockData::parseBlockDef: unsupported version:" << xml.attributes().value("version");
+                    xml.skipCurrentElement();
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+void libblockdia::BlockData::parseBlockDefVersion1(QXmlStreamReader *xml, libblockdia::BlockData *data)
+{
+    Q_ASSERT(xml->isStartElement() && xml->name() == "BlockDef");
+
+    // read block definitions
+    while (xml->readNextStartElement()) {
+
+        // read type name
+        if (xml->name() == "TypeName") {
+            data->typeName = xml->readElementText(QXmlStreamReader::SkipChildElements);
+        }
+
+        // read type id
+        else if (xml->name() == "TypeId") {
+            data->typeId = xml->readElementText(QXmlStreamReader::SkipChildElements);
+        }
+
+        // read color
+        else if (xml->name() == "Color") {
+            data->color = QColor(xml->readElementText(QXmlStreamReader::SkipChildElements));
+        }
+
+        // read inputs
+        else if (xml->name() == "Inputs") {
+            while (xml->readNextStartElement()) {
+                if (xml->name() == "Input") data->inputs.append(xml->attributes().value("name").toString().trimmed());
+                xml->skipCurrentElement();
+            }
+        }
+
+        // read outputs
+        else if (xml->name() == "Outputs") {
+            while (xml->readNextStartElement()) {
+                if (xml->name() == "Output") data->outputs.append(xml->attributes().value("name").toString().trimmed());
+                xml->skipCurrentElement();
+            }
+        }
+
+        // read parameters
+        else if (xml->name() == "Parameters") {
+            while (xml->readNextStartElement()) {
+                BlockParameterData param;
+                if (BlockParameterData::parseParamDef(xml, &param)) data->parameters.append(param);
+            }
+        }
+
+        // unknown tag
+        else {
+            xml->skipCurrentElement();
+        }
+    }
+}
+
+bool libblockdia::BlockData::parseBlockDefCbor(QIODevice *dev, libblockdia::BlockData *data)
+{
+    BLOCKDIA_TRACE_SCOPE("BlockData::parseBlockDefCbor");
+    QCborStreamReader reader(dev);
+    bool versionFound = false;
+
+    // a block definition is a map
+    if (!reader.isMap()) {
+        qWarning() << "BlockData::parseBlockDefCbor: unknown root element";
+        return false;
+    }
+
+    reader.enterContainer();
+    while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+        QString key = readCborString(reader);
+
+        // version
+        if (key == "BlockDef") {
+            int version = readCborInt(reader, 0);
+            if (version != CBOR_BLOCKDEF_VERSION) {
+                qWarning() << "BlockData::parseBlockDefCbor: unsupported version:" << version;
+                return false;
+            }
+            versionFound = true;
+        }
+
+        // header
+        else if (key == "TypeName") data->typeName = readCborString(reader);
+        else if (key == "TypeId") data->typeId = readCborString(reader);
+        else if (key == "Color") data->color = QColor(readCborString(reader));
+
+        // inputs / outputs
+        else if (key == "Inputs") data->inputs = readCborStringList(reader);
+        else if (key == "Outputs") data->outputs = readCborStringList(reader);
+
+        // parameters
+        else if (key == "Parameters" && reader.isArray()) {
+            reader.enterContainer();
+            while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+
+                // every parameter is a map
+                if (!reader.isMap()) {
+                    reader.next();
+                    continue;
+                }
+
+                BlockParameterData param;
+                reader.enterContainer();
+                while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+                    QString paramKey = readCborString(reader);
+                    if (paramKey == "type") param.type = readCborString(reader);
+                    else if (paramKey == "name") param.name = readCborString(reader);
+                    else if (paramKey == "default") param.defaultValue = readCborString(reader);
+                    else if (paramKey == "Min") param.minimum = readCborInt(reader, param.minimum);
+                    else if (paramKey == "Max") param.maximum = readCborInt(reader, param.maximum);
+                    else if (paramKey == "EnumItems") param.enumItems = readCborStringList(reader);
+                    else if (paramKey == "ElementType") param.elementType = readCborString(reader);
+                    else if (paramKey == "ElementMin") param.elementMinimum = readCborDouble(reader, param.elementMinimum);
+                    else if (paramKey == "ElementMax") param.elementMaximum = readCborDouble(reader, param.elementMaximum);
+                    else if (paramKey == "expression") param.expression = readCborString(reader);
+                    else if (paramKey == "isPublic") {
+                        if (reader.isBool()) param.isPublic = reader.toBool();
+                        reader.next();
+                    } else {
+                        reader.next();
+                    }
+                }
+                reader.leaveContainer();
+
+                // parameters without type are ignored
+                if (!param.type.isEmpty()) data->parameters.append(param);
+            }
+            reader.leaveContainer();
+        }
+
+        // unknown key
+        else {
+            reader.next();
+        }
+    }
+    reader.leaveContainer();
+
+    if (reader.lastError() != QCborError::NoError) {
+        qWarning() << "BlockData::parseBlockDefCbor:" << reader.lastError().toString();
+        return false;
+    }
+
+    return versionFound;
+}
+
+bool libblockdia::BlockData::exportBlockDefCbor(QIODevice *dev) const
+{
+    // QCborStreamWriter does not report write errors,
+    // so the definition is encoded into a buffer that is written at once
+    QByteArray buffer;
+    QCborStreamWriter writer(&buffer);
+
+    // start block element
+    writer.startMap();
+    writer.append(QLatin1String("BlockDef"));
+    writer.append((qint64) CBOR_BLOCKDEF_VERSION);
+
+        // header
+        writer.append(QLatin1String("TypeName"));
+        writer.append(this->typeName);
+        writer.append(QLatin1String("TypeId"));
+        writer.append(this->typeId);
+        writer.append(QLatin1String("Color"));
+        writer.append(this->color.name());
+
+        // parameters
+        writer.append(QLatin1String("Parameters"));
+        writer.startArray(this->parameters.size());
+        for (int i=0; i < this->parameters.size(); ++i) {
+            const BlockParameterData &param = this->parameters.at(i);
+            writer.startMap();
+
+            // standard attributes
+            writer.append(QLatin1String("type"));
+            writer.append(param.type);
+            writer.append(QLatin1String("name"));
+            writer.append(param.name);
+            writer.append(QLatin1String("isPublic"));
+            writer.append(param.isPublic);
+            writer.append(QLatin1String("default"));
+            writer.append(param.defaultValue);
+            if (!param.expression.isEmpty()) {
+                writer.append(QLatin1String("expression"));
+                writer.append(param.expression);
+            }
+
+            // type specific data
+            if (param.type == "int") {
+                writer.append(QLatin1String("Min"));
+                writer.append((qint64) param.minimum);
+                writer.append(QLatin1String("Max"));
+                writer.append((qint64) param.maximum);
+            } else if (param.type == "enum") {
+                writer.append(QLatin1String("EnumItems"));
+                writer.startArray(param.enumItems.size());
+                for (int k=0; k < param.enumItems.size(); ++k) writer.append(param.enumItems.at(k));
+                writer.endArray();
+            } else if (param.type == "array") {
+                writer.append(QLatin1String("ElementType"));
+                writer.append(param.elementType.isEmpty() ? QString("double") : param.elementType);
+                writer.append(QLatin1String("ElementMin"));
+                writer.append(param.elementMinimum);
+                writer.append(QLatin1String("ElementMax"));
+                writer.append(param.elementMaximum);
+            }
+
+            writer.endMap();
+        }
+        writer.endArray();
+
+        // inputs
+        writer.append(QLatin1String("Inputs"));
+        writer.startArray(this->inputs.size());
+        for (int i=0; i < this->inputs.size(); ++i) writer.append(this->inputs.at(i));
+        writer.endArray();
+
+        // outputs
+        writer.append(QLatin1String("Outputs"));
+        writer.startArray(this->outputs.size());
+        for (int i=0; i < this->outputs.size(); ++i) writer.append(this->outputs.at(i));
+        writer.endArray();
+
+    // end block element
+    writer.endMap();
+
+    if (!dev->isWritable()) {
+        qWarning() << "BlockData::exportBlockDefCbor: device is not writable";
+        return false;
+    }
+    if (dev->write(buffer) != buffer.size()) {
+        qWarning() << "BlockData::exportBlockDefCbor:" << dev->errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @details Writing the canonical header of a block (everything except parameters, inputs and outputs).
+ */
+static void writeCanonicalHeader(QDataStream &ds, const libblockdia::BlockData &data)
+{
+    ds << data.typeId << data.typeName << data.instanceId << data.instanceName << data.color.name();
+}
+
+libblockdia::BlockData libblockdia::BlockData::normalized() const
+{
+    BlockData data = *this;
+    for (int i=0; i < data.parameters.size(); ++i) {
+        data.parameters[i] = this->parameters.at(i).normalized();
+    }
+    return data;
+}
+
+QByteArray libblockdia::BlockData::canonicalSerialization() const
+{
+    BLOCKDIA_TRACE_SCOPE("BlockData::canonicalSerialization");
+    QByteArray result;
+    QDataStream ds(&result, QIODevice::WriteOnly);
+    ds.setVersion(QDataStream::Qt_5_6);
+
+    writeCanonicalHeader(ds, *this);
+    ds << (quint32) this->parameters.size();
+    for (int i=0; i < this->parameters.size(); ++i) {
+        ds << this->parameters.at(i).canonicalSerialization();
+    }
+    ds << this->inputs << this->outputs;
+
+    return result;
+}
+
+QByteArray libblockdia::BlockData::contentHash() const
+{
+    QList<QByteArray> parameterHashes;
+    parameterHashes.reserve(this->parameters.size());
+    for (int i=0; i < this->parameters.size(); ++i) {
+        parameterHashes.append(this->parameters.at(i).contentHash());
+    }
+    return combineContentHash(*this, parameterHashes);
+}
+
+QByteArray libblockdia::BlockData::combineContentHash(const libblockdia::BlockData &data, const QList<QByteArray> &parameterHashes)
+{
+    QByteArray canonical;
+    QDataStream ds(&canonical, QIODevice::WriteOnly);
+    ds.setVersion(QDataStream::Qt_5_6);
+
+    writeCanonicalHeader(ds, data);
+    ds << parameterHashes;
+    ds << data.inputs << data.outputs;
+
+    return QCryptographicHash::hash(canonical, CONTENT_HASH_ALGORITHM);
+}
+
+QByteArray libblockdia::BlockData::combineContentHashes(const QList<QByteArray> &hashes)
+{
+    QCryptographicHash hash(CONTENT_HASH_ALGORITHM);
+    for (int i=0; i < hashes.size(); ++i) hash.addData(hashes.at(i));
+    return hash.result();
+}
@@ -0,0 +1,299 @@
+#include "blockdefwriter.h"
+
+#include <QDebug>
+#include <blocktrace.h>
+
+// the initial capacity of the output buffer
+#define INITIAL_BUFFER_SIZE 4096
+
+// number of spaces per indentation level (same as QXmlStreamWriter)
+#define INDENT_SIZE 4
+
+libblockdia::BlockDefWriter::BlockDefWriter()
+{
+    this->isAutoFormatting = true;
+
+    // reserving marks the capacity as reserved, so that it is kept on resize(0)
+    this->outputBuffer.reserve(INITIAL_BUFFER_SIZE);
+}
+
+libblockdia::BlockDefWriter *libblockdia::BlockDefWriter::threadWriter()
+{
+    thread_local BlockDefWriter writer;
+    return &writer;
+}
+
+void libblockdia::BlockDefWriter::setAutoFormatting(bool enable)
+{
+    this->isAutoFormatting = enable;
+}
+
+bool libblockdia::BlockDefWriter::autoFormatting()
+{
+    return this->isAutoFormatting;
+}
+
+bool libblockdia::BlockDefWriter::write(const libblockdia::BlockData &data)
+{
+    BLOCKDIA_TRACE_SCOPE("BlockDefWriter::write");
+    this->outputBuffer.resize(0);
+    this->error.clear();
+
+    this->outputBuffer.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+
+    // start block element
+    this->writeNewLine(0);
+    this->outputBuffer.append("<BlockDef version=\"1\">");
+
+        // header
+        this->writeTextElement(1, "TypeName", data.typeName);
+        this->writeTextElement(1, "TypeId", data.typeId);
+        this->writeNewLine(1);
+        this->outputBuffer.append("<Color>");
+        this->writeColor(data.color);
+        this->outputBuffer.append("</Color>");
+
+        // parameters
+        this->writeNewLine(1);
+        if (data.parameters.isEmpty()) {
+            this->outputBuffer.append("<Parameters/>");
+        } else {
+            this->outputBuffer.append("<Parameters>");
+            for (int i=0; i < data.parameters.size(); ++i) {
+                if (!this->writeParameter(data.parameters.at(i))) return false;
+            }
+            this->writeNewLine(1);
+            this->outputBuffer.append("</Parameters>");
+        }
+
+        // inputs / outputs
+        this->writeNameList("Inputs", "Input", data.inputs);
+        this->writeNameList("Outputs", "Output", data.outputs);
+
+    // end block element
+    this->writeNewLine(0);
+    this->outputBuffer.append("</BlockDef>");
+    if (this->isAutoFormatting) this->outputBuffer.append('\n');
+
+    return this->error.isEmpty();
+}
+
+bool libblockdia::BlockDefWriter::write(const libblockdia::BlockData &data, QIODevice *dev)
+{
+    if (!this->write(data)) return false;
+
+    if (!dev->isWritable()) {
+        this->error = "device is not writable";
+        return false;
+    }
+
+    if (dev->write(this->outputBuffer) != this->outputBuffer.size()) {
+        this->error = dev->errorString();
+        return false;
+    }
+
+    return true;
+}
+
+const QByteArray &libblockdia::BlockDefWriter::buffer()
+{
+    return this->outputBuffer;
+}
+
+QString libblockdia::BlockDefWriter::errorString()
+{
+    return this->error;
+}
+
+void libblockdia::BlockDefWriter::writeNewLine(int level)
+{
+    if (!this->isAutoFormatting) return;
+    this->outputBuffer.append('\n');
+    this->outputBuffer.append(level * INDENT_SIZE, ' ');
+}
+
+void libblockdia::BlockDefWriter::writeText(const QString &text, bool isAttribute)
+{
+    const QChar *c = text.constData();
+    const QChar *end = c + text.size();
+
+    for (; c < end; ++c) {
+        ushort u = c->unicode();
+
+        // escaping
+        if (u == '<') this->outputBuffer.append("&lt;");
+        else if (u == '>') this->outputBuffer.append("&gt;");
+        else if (u == '&') this->outputBuffer.append("&amp;");
+        else if (u == '"' && isAttribute) this->outputBuffer.append("&quot;");
+        else if (u == '\n' && isAttribute) this->outputBuffer.append("&#10;");
+        else if (u == '\r' && isAttribute) this->outputBuffer.append("&#13;");
+        else if (u == '\t' && isAttribute) this->outputBuffer.append("&#9;");
+
+        // characters that are not allowed in XML
+        else if (u < 0x20 && u != '\n' && u != '\r' && u != '\t') {
+            this->error = "invalid character in text";
+        }
+
+        // UTF-8 encoding
+        else if (u < 0x80) {
+            this->outputBuffer.append((char) u);
+        } else if (u < 0x800) {
+            this->outputBuffer.append((char) (0xc0 | (u >> 6)));
+            this->outputBuffer.append((char) (0x80 | (u & 0x3f)));
+        } else if (c->isHighSurrogate() && c + 1 < end && (c + 1)->isLowSurrogate()) {
+            uint ucs4 = QChar::surrogateToUcs4(*c, *(c + 1));
+            ++c;
+            this->outputBuffer.append((char) (0xf0 | (ucs4 >> 18)));
+            this->outputBuffer.append((char) (0x80 | ((ucs4 >> 12) & 0x3f)));
+            this->outputBuffer.append((char) (0x80 | ((ucs4 >> 6) & 0x3f)));
+            this->outputBuffer.append((char) (0x80 | (ucs4 & 0x3f)));
+        } else if (c->isSurrogate()) {
+            this->error = "invalid surrogate in text";
+        } else {
+            this->outputBuffer.append((char) (0xe0 | (u >> 12)));
+            this->outputBuffer.append((char) (0x80 | ((u >> 6) & 0x3f)));
+            this->outputBuffer.append((char) (0x80 | (u & 0x3f)));
+        }
+    }
+}
+
+void libblockdia::BlockDefWriter::writeNumber(int number)
+{
+    // formatting from the end of a scratch buffer on the stack
+    char scratch[12];
+    char *p = scratch + sizeof(scratch);
+    unsigned int u = (number < 0) ? 0u - (unsigned int) number : (unsigned int) number;
+
+    do {
+        *--p = '0' + (u % 10);
+        u /= 10;
+    } while (u > 0);
+    if (number < 0) *--p = '-';
+
+    this->outputBuffer.append(p, scratch + sizeof(scratch) - p);
+}
+
+void libblockdia::BlockDefWriter::writeColor(const QColor &color)
+{
+    // same format as QColor::name()
+    static const char hex[] = "0123456789abcdef";
+    int components[3] = {color.red(), color.green(), color.blue()};
+
+    this->outputBuffer.append('#');
+    for (int i=0; i < 3; ++i) {
+        this->outputBuffer.append(hex[(components[i] >> 4) & 0xf]);
+        this->outputBuffer.append(hex[components[i] & 0xf]);
+    }
+}
+
+void libblockdia::BlockDefWriter::writeAttribute(const char *name, const QString &value)
+{
+    this->outputBuffer.append(' ');
+    this->outputBuffer.append(name);
+    this->outputBuffer.append("=\"");
+    this->writeText(value, true);
+    this->outputBuffer.append('"');
+}
+
+void libblockdia::BlockDefWriter::writeTextElement(int level, const char *name, const QString &text)
+{
+    this->writeNewLine(level);
+    this->outputBuffer.append('<');
+    this->outputBuffer.append(name);
+    this->outputBuffer.append('>');
+    this->writeText(text, false);
+    this->outputBuffer.append("</");
+    this->outputBuffer.append(name);
+    this->outputBuffer.append('>');
+}
+
+bool libblockdia::BlockDefWriter::writeParameter(const libblockdia::BlockParameterData &param)
+{
+    bool isInt = param.type == "int";
+    bool isEnum = param.type == "enum";
+    bool isArray = param.type == "array";
+    if (!isInt && !isEnum && !isArray && param.type != "str") {
+        this->error = QString("unknown parameter type '%1'").arg(param.type);
+        return false;
+    }
+
+    // begin parameter
+    this->writeNewLine(2);
+    this->outputBuffer.append("<Parameter");
+
+    // standard attributes
+    this->writeAttribute("type", param.type);
+    this->writeAttribute("name", param.name);
+    if (param.isPublic) this->outputBuffer.append(" isPublic=\"yes\"");
+    this->writeAttribute("default", param.defaultValue);
+    if (!param.expression.isEmpty()) this->writeAttribute("expression", param.expression);
+
+    // type specific data
+    if (isInt) {
+        this->outputBuffer.append('>');
+        this->writeNewLine(3);
+        this->outputBuffer.append("<Min>");
+        this->writeNumber(param.minimum);
+        this->outputBuffer.append("</Min>");
+        this->writeNewLine(3);
+        this->outputBuffer.append("<Max>");
+        this->writeNumber(param.maximum);
+        this->outputBuffer.append("</Max>");
+        this->writeNewLine(2);
+        this->outputBuffer.append("</Parameter>");
+    } else if (isEnum) {
+        this->outputBuffer.append('>');
+        this->writeNewLine(3);
+        if (param.enumItems.isEmpty()) {
+            this->outputBuffer.append("<EnumItems/>");
+        } else {
+            this->outputBuffer.append("<EnumItems>");
+            for (int i=0; i < param.enumItems.size(); ++i) {
+                this->writeNewLine(4);
+                this->outputBuffer.append("<Item");
+                this->writeAttribute("name", param.enumItems.at(i));
+                this->outputBuffer.append("/>");
+            }
+            this->writeNewLine(3);
+            this->outputBuffer.append("</EnumItems>");
+        }
+        this->writeNewLine(2);
+        this->outputBuffer.append("</Parameter>");
+    } else if (isArray) {
+        this->outputBuffer.append('>');
+        this->writeTextElement(3, "ElementType", param.elementType.isEmpty() ? QString("double") : param.elementType);
+        this->writeTextElement(3, "ElementMin", QString::number(param.elementMinimum, 'g', 17));
+        this->writeTextElement(3, "ElementMax", QString::number(param.elementMaximum, 'g', 17));
+        this->writeNewLine(2);
+        this->outputBuffer.append("</Parameter>");
+    } else {
+        this->outputBuffer.append("/>");
+    }
+
+    return this->error.isEmpty();
+}
+
+void libblockdia::BlockDefWriter::writeNameList(const char *listName, const char *elementName, const QStringList &names)
+{
+    this->writeNewLine(1);
+    this->outputBuffer.append('<');
+    this->outputBuffer.append(listName);
+
+    if (names.isEmpty()) {
+        this->outputBuffer.append("/>");
+        return;
+    }
+
+    this->outputBuffer.append('>');
+    for (int i=0; i < names.size(); ++i) {
+        this->writeNewLine(2);
+        this->outputBuffer.append('<');
+        this->outputBuffer.append(elementName);
+        this->writeAttribute("name", names.at(i));
+        this->outputBuffer.append("/>");
+    }
+    this->writeNewLine(1);
+    this->outputBuffer.append("</");
+    this->outputBuffer.append(listName);
+    this->outputBuffer.append('>');
+}
@@ -0,0 +1,387 @@
+#include "blockexpression.h"
+
+#include <QVarLengthArray>
+#include <qmath.h>
+#include <cmath>
+#include <limits>
+
+// stack size that is evaluated without heap allocation
+#define EXPRESSION_STACK_PREALLOC 32
+
+namespace libblockdia {
+
+/*
+ * Recursive descent parser that emits the stack program directly.
+ *
+ * expression := term (('+' | '-') term)*
+ * term       := unary (('*' | '/' | '%') unary)*
+ * unary      := ('+' | '-') unary | power
+ * power      := primary ('^' unary)?
+ * primary    := number | reference | function '(' expression (',' expression)* ')' | '(' expression ')'
+ * reference  := name ('.' name)?
+ * name       := identifier | '{' any characters except braces '}'
+ */
+class BlockExpressionCompiler
+{
+public:
+    BlockExpressionCompiler(const QString &source, BlockExpression *expr)
+    {
+        this->source = source;
+        this->expr = expr;
+        this->pos = 0;
+        this->stackSize = 0;
+    }
+
+    bool compile()
+    {
+        if (!this->parseExpression()) return false;
+        this->skipSpaces();
+        if (this->pos < this->source.size()) return this->fail("unexpected '" + QString(this->source.at(this->pos)) + "'");
+        if (this->expr->code.isEmpty()) return this->fail("empty expression");
+        return true;
+    }
+
+    QString errorString;
+
+private:
+    bool fail(const QString &error)
+    {
+        if (this->errorString.isEmpty()) this->errorString = QString("%1 (at position %2)").arg(error).arg(this->pos + 1);
+        return false;
+    }
+
+    void skipSpaces()
+    {
+        while (this->pos < this->source.size() && this->source.at(this->pos).isSpace()) ++this->pos;
+    }
+
+    bool accept(QChar c)
+    {
+        this->skipSpaces();
+        if (this->pos < this->source.size() && this->source.at(this->pos) == c) {
+            ++this->pos;
+            return true;
+        }
+        return false;
+    }
+
+    // emitting instructions (and tracking the stack depth)
+
+    void appendInstruction(int op, int operand, int stackChange)
+    {
+        BlockExpression::Instruction instruction;
+        instruction.op = op;
+        instruction.operand = operand;
+        this->expr->code.append(instruction);
+        this->stackSize += stackChange;
+        if (this->stackSize > this->expr->maxStackSize) this->expr->maxStackSize = this->stackSize;
+    }
+
+    void emitConstant(double value)
+    {
+        this->appendInstruction(BlockExpression::PushConstant, this->expr->constants.size(), 1);
+        this->expr->constants.append(value);
+    }
+
+    // true if the last n instructions push constants
+    bool endsWithConstants(int n)
+    {
+        if (this->expr->code.size() < n) return false;
+        for (int i = this->expr->code.size() - n; i < this->expr->code.size(); ++i) {
+            if (this->expr->code.at(i).op != BlockExpression::PushConstant) return false;
+        }
+        return true;
+    }
+
+    // operations on constants are evaluated at compile time
+    void emitOperation(int op, int countOperands)
+    {
+        if (this->endsWithConstants(countOperands)) {
+            double values[EXPRESSION_STACK_PREALLOC];
+            int first = this->expr->code.size() - countOperands;
+            for (int i=0; i < countOperands; ++i) values[i] = this->expr->constants.at(this->expr->code.at(first + i).operand);
+            BlockExpression folded;
+            folded.valid = true;
+            folded.maxStackSize = countOperands;
+            for (int i=0; i < countOperands; ++i) {
+                BlockExpression::Instruction push;
+                push.op = BlockExpression::PushReference;
+                push.operand = i;
+                folded.code.append(push);
+            }
+            BlockExpression::Instruction instruction;
+            instruction.op = op;
+            instruction.operand = countOperands;
+            folded.code.append(instruction);
+            double result = folded.evaluate(values);
+
+            // remove the constants (they are always the last ones of the pool)
+            this->expr->code.resize(first);
+            this->expr->constants.resize(this->expr->constants.size() - countOperands);
+            this->stackSize -= countOperands;
+            this->emitConstant(result);
+            return;
+        }
+
+        this->appendInstruction(op, countOperands, 1 - countOperands);
+    }
+
+    // grammar
+
+    bool parseExpression()
+    {
+        if (!this->parseTerm()) return false;
+        while (true) {
+            if (this->accept('+')) {
+                if (!this->parseTerm()) return false;
+                this->emitOperation(BlockExpression::Add, 2);
+            } else if (this->accept('-')) {
+                if (!this->parseTerm()) return false;
+                this->emitOperation(BlockExpression::Subtract, 2);
+            } else {
+                return true;
+            }
+        }
+    }
+
+    bool parseTerm()
+    {
+        if (!this->parseUnary()) return false;
+        while (true) {
+            int op;
+            if (this->accept('*')) op = BlockExpression::Multiply;
+            else if (this->accept('/')) op = BlockExpression::Divide;
+            else if (this->accept('%')) op = BlockExpression::Modulo;
+            else return true;
+            if (!this->parseUnary()) return false;
+            this->emitOperation(op, 2);
+        }
+    }
+
+    bool parseUnary()
+    {
+        if (this->accept('+')) return this->parseUnary();
+        if (this->accept('-')) {
+            if (!this->parseUnary()) return false;
+            this->emitOperation(BlockExpression::Negate, 1);
+            return true;
+        }
+        return this->parsePower();
+    }
+
+    bool parsePower()
+    {
+        if (!this->parsePrimary()) return false;
+        if (this->accept('^')) {
+            if (!this->parseUnary()) return false;
+            this->emitOperation(BlockExpression::Power, 2);
+        }
+        return true;
+    }
+
+    bool parsePrimary()
+    {
+        this->skipSpaces();
+        if (this->pos >= this->source.size()) return this->fail("unexpected end");
+        QChar c = this->source.at(this->pos);
+
+        // parentheses
+        if (this->accept('(')) {
+            if (!this->parseExpression()) return false;
+            if (!this->accept(')')) return this->fail("missing ')'");
+            return true;
+        }
+
+        // number
+        if (c.isDigit() || c == '.') return this->parseNumber();
+
+        // function or reference
+        QString name;
+        bool isBraced = c == '{';
+        if (!this->parseName(&name)) return false;
+        if (!isBraced && this->accept('(')) return this->parseFunction(name);
+        if (this->accept('.')) {
+            QString parameterName;
+            if (!this->parseName(&parameterName)) return false;
+            name += "." + parameterName;
+        }
+
+        int index = this->expr->_references.indexOf(name);
+        if (index < 0) {
+            index = this->expr->_references.size();
+            this->expr->_references.append(name);
+        }
+        this->appendInstruction(BlockExpression::PushReference, index, 1);
+        return true;
+    }
+
+    bool parseNumber()
+    {
+        int start = this->pos;
+        while (this->pos < this->source.size() && (this->source.at(this->pos).isDigit() || this->source.at(this->pos) == '.')) ++this->pos;
+
+        // exponent
+        if (this->pos < this->source.size() && (this->source.at(this->pos) == 'e' || this->source.at(this->pos) == 'E')) {
+            int exponentStart = this->pos++;
+            if (this->pos < this->source.size() && (this->source.at(this->pos) == '+' || this->source.at(this->pos) == '-')) ++this->pos;
+            if (this->pos >= this->source.size() || !this->source.at(this->pos).isDigit()) this->pos = exponentStart;
+            while (this->pos < this->source.size() && this->source.at(this->pos).isDigit()) ++this->pos;
+        }
+
+        bool ok;
+        double value = this->source.mid(start, this->pos - start).toDouble(&ok);
+        if (!ok) {
+            this->pos = start;
+            return this->fail("invalid number");
+        }
+        this->emitConstant(value);
+        return true;
+    }
+
+    bool parseName(QString *name)
+    {
+        this->skipSpaces();
+
+        // braced name
+        if (this->accept('{')) {
+            int start = this->pos;
+            while (this->pos < this->source.size() && this->source.at(this->pos) != '}' && this->source.at(this->pos) != '{') ++this->pos;
+            if (this->pos >= this->source.size() || this->source.at(this->pos) != '}') return this->fail("missing '}'");
+            *name = this->source.mid(start, this->pos - start);
+            ++this->pos;
+            return true;
+        }
+
+        // identifier
+        int start = this->pos;
+        while (this->pos < this->source.size() && (this->source.at(this->pos).isLetterOrNumber() || this->source.at(this->pos) == '_')) {
+            if (this->pos == start && this->source.at(this->pos).isDigit()) break;
+            ++this->pos;
+        }
+        if (this->pos == start) {
+            if (this->pos >= this->source.size()) return this->fail("unexpected end");
+            return this->fail("unexpected '" + QString(this->source.at(this->pos)) + "'");
+        }
+        *name = this->source.mid(start, this->pos - start);
+        return true;
+    }
+
+    bool parseFunction(const QString &name)
+    {
+        int op;
+        int minArguments = 1;
+        int maxArguments = 1;
+        if (name == "min") { op = BlockExpression::Minimum; maxArguments = EXPRESSION_STACK_PREALLOC; }
+        else if (name == "max") { op = BlockExpression::Maximum; maxArguments = EXPRESSION_STACK_PREALLOC; }
+        else if (name == "abs") op = BlockExpression::Absolute;
+        else if (name == "round") op = BlockExpression::Round;
+        else if (name == "floor") op = BlockExpression::Floor;
+        else if (name == "ceil") op = BlockExpression::Ceil;
+        else return this->fail("unknown function '" + name + "'");
+
+        // arguments
+        int countArguments = 0;
+        do {
+            if (!this->parseExpression()) return false;
+            ++countArguments;
+        } while (this->accept(','));
+        if (!this->accept(')')) return this->fail("missing ')'");
+        if (countArguments < minArguments || countArguments > maxArguments) return this->fail("wrong number of arguments for '" + name + "'");
+
+        this->emitOperation(op, countArguments);
+        return true;
+    }
+
+    QString source;
+    BlockExpression *expr;
+    int pos;
+    int stackSize;
+};
+
+} // namespace libblockdia
+
+libblockdia::BlockExpression::BlockExpression()
+{
+    this->maxStackSize = 0;
+    this->valid = false;
+}
+
+libblockdia::BlockExpression libblockdia::BlockExpression::compile(const QString &source, QString *errorString)
+{
+    BlockExpression expr;
+    expr._source = source;
+
+    BlockExpressionCompiler compiler(source, &expr);
+    expr.valid = compiler.compile();
+    if (!expr.valid) {
+        if (errorString) *errorString = compiler.errorString;
+        expr.code.clear();
+        expr.constants.clear();
+        expr._references.clear();
+    }
+
+    expr.code.squeeze();
+    expr.constants.squeeze();
+    return expr;
+}
+
+bool libblockdia::BlockExpression::isValid() const
+{
+    return this->valid;
+}
+
+QString libblockdia::BlockExpression::source() const
+{
+    return this->_source;
+}
+
+QStringList libblockdia::BlockExpression::references() const
+{
+    return this->_references;
+}
+
+double libblockdia::BlockExpression::evaluate(const double *values) const
+{
+    if (!this->valid) return std::numeric_limits<double>::quiet_NaN();
+
+    QVarLengthArray<double, EXPRESSION_STACK_PREALLOC> stack(this->maxStackSize);
+    int top = 0;
+
+    const Instruction *instruction = this->code.constData();
+    const Instruction *end = instruction + this->code.size();
+    for (; instruction != end; ++instruction) {
+        switch (instruction->op) {
+        case PushConstant:  stack[top++] = this->constants.at(instruction->operand); break;
+        case PushReference: stack[top++] = values[instruction->operand]; break;
+        case Add:           --top; stack[top - 1] += stack[top]; break;
+        case Subtract:      --top; stack[top - 1] -= stack[top]; break;
+        case Multiply:      --top; stack[top - 1] *= stack[top]; break;
+        case Divide:        --top; stack[top - 1] /= stack[top]; break;
+        case Modulo:        --top; stack[top - 1] = std::fmod(stack[top - 1], stack[top]); break;
+        case Power:         --top; stack[top - 1] = qPow(stack[top - 1], stack[top]); break;
+        case Negate:        stack[top - 1] = -stack[top - 1]; break;
+        case Absolute:      stack[top - 1] = qAbs(stack[top - 1]); break;
+        case Round:         stack[top - 1] = std::round(stack[top - 1]); break;
+        case Floor:         stack[top - 1] = std::floor(stack[top - 1]); break;
+        case Ceil:          stack[top - 1] = std::ceil(stack[top - 1]); break;
+        case Minimum:
+        case Maximum: {
+            int first = top - instruction->operand;
+            double result = stack[first];
+            for (int i = first + 1; i < top; ++i) {
+                result = (instruction->op == Minimum) ? qMin(result, stack[i]) : qMax(result, stack[i]);
+            }
+            top = first;
+            stack[top++] = result;
+            break;
+        }
+        }
+    }
+
+    return stack[0];
+}
+
+int libblockdia::BlockExpression::countInstructions() const
+{
+    return this->code.size();
+}
@@ -0,0 +1,442 @@
+#include "blockexpressiongraph.h"
+#include "blockjournal.h"
+#include "blockparameterint.h"
+#include "blockparameterenum.h"
+#include "blocktrace.h"
+
+#include <QVarLengthArray>
+#include <qnumeric.h>
+#include <algorithm>
+#include <limits>
+#include <limits.h>
+
+// number of reference values that are gathered without heap allocation
+#define GRAPH_VALUES_PREALLOC 16
+
+libblockdia::BlockExpressionGraph::BlockExpressionGraph(QObject *parent) : QObject(parent)
+{
+    this->isDirty = false;
+    this->isUpdating = false;
+    this->currentMark = 0;
+    this->_countExpressions = 0;
+    this->_countEvaluations = 0;
+
+    // structural changes are collected and rebuilt once
+    this->timerRebuild = new QTimer(this);
+    this->timerRebuild->setSingleShot(true);
+    this->timerRebuild->setInterval(0);
+    connect(this->timerRebuild, SIGNAL(timeout()), this, SLOT(slotRebuild()));
+}
+
+void libblockdia::BlockExpressionGraph::addBlock(libblockdia::Block *block)
+{
+    if (!block || this->_blocks.contains(block)) return;
+    this->_blocks.append(block);
+    connect(block, SIGNAL(signalDataChanged(libblockdia::Block*)), this, SLOT(slotBlockDataChanged(libblockdia::Block*)));
+    connect(block, SIGNAL(signalParametersChanged(libblockdia::Block*,QList<libblockdia::BlockParameter*>)),
+            this, SLOT(slotParametersChanged(libblockdia::Block*,QList<libblockdia::BlockParameter*>)));
+    connect(block, SIGNAL(destroyed(QObject*)), this, SLOT(slotBlockDestroyed(QObject*)));
+    this->setDirty();
+}
+
+void libblockdia::BlockExpressionGraph::removeBlock(libblockdia::Block *block)
+{
+    if (!this->_blocks.contains(block)) return;
+    this->_blocks.removeAll(block);
+    disconnect(block, 0, this, 0);
+
+    // the parameters of the nodes are still alive (destroyed parameters are removed from the nodes)
+    for (int i=0; i < this->nodes.size(); ++i) {
+        if (this->nodes.at(i).block == block && this->nodes.at(i).param) disconnect(this->nodes.at(i).param, 0, this, 0);
+    }
+
+    this->setDirty();
+}
+
+QList<libblockdia::Block *> libblockdia::BlockExpressionGraph::blocks()
+{
+    return this->_blocks;
+}
+
+void libblockdia::BlockExpressionGraph::recomputeAll()
+{
+    this->isDirty = true;
+    this->ensureBuilt();
+}
+
+QString libblockdia::BlockExpressionGraph::errorString(libblockdia::BlockParameter *param)
+{
+    this->ensureBuilt();
+    int i = this->nodeIndex.value(param, -1);
+    return (i < 0) ? QString() : this->nodes.at(i).error;
+}
+
+QList<libblockdia::BlockParameter *> libblockdia::BlockExpressionGraph::dependents(libblockdia::BlockParameter *param)
+{
+    QList<BlockParameter *> ret;
+    this->ensureBuilt();
+    int i = this->nodeIndex.value(param, -1);
+    if (i < 0) return ret;
+
+    const QVector<int> &dependents = this->nodes.at(i).dependents;
+    for (int d=0; d < dependents.size(); ++d) {
+        BlockParameter *dependent = this->nodes.at(dependents.at(d)).param;
+        if (!ret.contains(dependent)) ret.append(dependent);
+    }
+    return ret;
+}
+
+int libblockdia::BlockExpressionGraph::countExpressions()
+{
+    this->ensureBuilt();
+    return this->_countExpressions;
+}
+
+qint64 libblockdia::BlockExpressionGraph::countEvaluations()
+{
+    return this->_countEvaluations;
+}
+
+void libblockdia::BlockExpressionGraph::slotParameterChanged()
+{
+    // changes caused by evaluating expressions
+    if (this->isUpdating) return;
+
+    // rebuilding evaluates everything anyway
+    if (this->isDirty) {
+        this->ensureBuilt();
+        return;
+    }
+
+    int i = this->nodeIndex.value(this->sender(), -1);
+    if (i < 0) {
+        this->setDirty();
+        return;
+    }
+
+    if (this->isStructureChanged(i)) {
+        this->setDirty();
+        return;
+    }
+
+    this->propagate(QVector<int>(1, i));
+}
+
+void libblockdia::BlockExpressionGraph::slotParametersChanged(libblockdia::Block *block, const QList<libblockdia::BlockParameter *> &parameters)
+{
+    Q_UNUSED(block);
+    if (this->isUpdating) return;
+    if (this->isDirty) {
+        this->ensureBuilt();
+        return;
+    }
+
+    // all changed parameters are propagated at once
+    QVector<int> changedNodes;
+    changedNodes.reserve(parameters.size());
+    for (int p=0; p < parameters.size(); ++p) {
+        int i = this->nodeIndex.value(parameters.at(p), -1);
+        if (i < 0 || this->isStructureChanged(i)) {
+            this->setDirty();
+            return;
+        }
+        changedNodes.append(i);
+    }
+
+    this->propagate(changedNodes);
+}
+
+void libblockdia::BlockExpressionGraph::slotParameterDestroyed(QObject *obj)
+{
+    int i = this->nodeIndex.value(obj, -1);
+    if (i < 0) return;
+    this->nodes[i].param = Q_NULLPTR;
+    this->nodeIndex.remove(obj);
+    this->setDirty();
+}
+
+void libblockdia::BlockExpressionGraph::slotBlockDataChanged(libblockdia::Block *block)
+{
+    // the signal is also emitted for every value change,
+    // so only added or removed parameters and a changed instance id are structural changes
+    // (the lists share their data as long as the block does not change its parameter list)
+    if (this->isUpdating || this->isDirty) return;
+    QHash<Block *, BlockState>::const_iterator it = this->blockStates.constFind(block);
+    if (it == this->blockStates.constEnd()) return;
+    if (it.value().params != block->getParameters() || it.value().instanceId != block->instanceId()) this->setDirty();
+}
+
+void libblockdia::BlockExpressionGraph::slotBlockDestroyed(QObject *obj)
+{
+    for (int i = this->_blocks.size() - 1; i >= 0; --i) {
+        if (static_cast<QObject *>(this->_blocks.at(i)) == obj) this->_blocks.removeAt(i);
+    }
+
+    // the nodes of the block are not valid anymore
+    this->blockStates.clear();
+    this->nodes.clear();
+    this->nodeIndex.clear();
+    this->setDirty();
+}
+
+void libblockdia::BlockExpressionGraph::slotRebuild()
+{
+    this->ensureBuilt();
+}
+
+void libblockdia::BlockExpressionGraph::setDirty()
+{
+    this->isDirty = true;
+    this->timerRebuild->start();
+}
+
+void libblockdia::BlockExpressionGraph::ensureBuilt()
+{
+    if (!this->isDirty) return;
+    this->isDirty = false;
+    this->timerRebuild->stop();
+    this->build();
+    emit signalRebuilt();
+}
+
+void libblockdia::BlockExpressionGraph::build()
+{
+    BLOCKDIA_TRACE_SCOPE("BlockExpressionGraph::build");
+
+    // release the parameters of the old graph
+    for (int i=0; i < this->nodes.size(); ++i) {
+        if (this->nodes.at(i).param) disconnect(this->nodes.at(i).param, 0, this, 0);
+    }
+    this->nodes.clear();
+    this->nodeIndex.clear();
+    this->blockStates.clear();
+    this->_countExpressions = 0;
+
+
+    // ------------------------------------------------------------------------
+    //                               Create Nodes
+    // ------------------------------------------------------------------------
+
+    QHash<QString, int> blocksById;                     // -1 if the instance id is ambiguous
+    QVector<QHash<QString, int> > nodesByName(this->_blocks.size());
+
+    for (int b=0; b < this->_blocks.size(); ++b) {
+        Block *block = this->_blocks.at(b);
+        BlockState state;
+        state.params = block->getParameters();
+        state.instanceId = block->instanceId();
+        this->blockStates.insert(block, state);
+        blocksById.insert(state.instanceId, blocksById.contains(state.instanceId) ? -1 : b);
+
+        for (int p=0; p < state.params.size(); ++p) {
+            BlockParameter *param = state.params.at(p);
+            Node node;
+            node.param = param;
+            node.block = block;
+            node.name = param->name();
+            node.expression = param->expression();
+            node.rank = -1;
+            node.value = numericValue(param);
+            node.mark = 0;
+
+            int index = this->nodes.size();
+            this->nodes.append(node);
+            this->nodeIndex.insert(param, index);
+            if (!nodesByName[b].contains(node.name)) nodesByName[b].insert(node.name, index);
+
+            connect(param, SIGNAL(somethingHasChanged()), this, SLOT(slotParameterChanged()), Qt::UniqueConnection);
+            connect(param, SIGNAL(destroyed(QObject*)), this, SLOT(slotParameterDestroyed(QObject*)), Qt::UniqueConnection);
+        }
+    }
+
+
+    // ------------------------------------------------------------------------
+    //                          Compile And Resolve Expressions
+    // ------------------------------------------------------------------------
+
+    QHash<Block *, int> blockIndices;
+    for (int b=0; b < this->_blocks.size(); ++b) blockIndices.insert(this->_blocks.at(b), b);
+
+    // only expressions of the current nodes are kept compiled
+    QHash<QString, BlockExpression> usedExpressions;
+
+    for (int i=0; i < this->nodes.size(); ++i) {
+        Node &node = this->nodes[i];
+        if (node.expression.isEmpty()) continue;
+        ++this->_countExpressions;
+
+        if (!qobject_cast<BlockParameterInt *>(node.param) && !qobject_cast<BlockParameterEnum *>(node.param)) {
+            node.error = "only int and enum parameters can have an expression";
+            continue;
+        }
+
+        // equal expressions (eg. of several instances of the same block type) are compiled once
+        QHash<QString, BlockExpression>::const_iterator cached = this->compiledExpressions.constFind(node.expression);
+        if (cached != this->compiledExpressions.constEnd()) {
+            node.compiled = cached.value();
+        } else {
+            node.compiled = BlockExpression::compile(node.expression);
+            this->compiledExpressions.insert(node.expression, node.compiled);
+        }
+        usedExpressions.insert(node.expression, node.compiled);
+        if (!node.compiled.isValid()) {
+            BlockExpression::compile(node.expression, &node.error);
+            continue;
+        }
+
+        // resolve references (parameters of the own block first, then instanceId.parameter)
+        QStringList references = node.compiled.references();
+        node.inputs.resize(references.size());
+        int b = blockIndices.value(node.block);
+        for (int r=0; r < references.size() && node.error.isEmpty(); ++r) {
+            const QString &reference = references.at(r);
+            int input = nodesByName.at(b).value(reference, -1);
+            int dot = reference.indexOf('.');
+            if (input < 0 && dot > 0) {
+                int other = blocksById.value(reference.left(dot), -2);
+                if (other == -1) node.error = "ambiguous instance id '" + reference.left(dot) + "'";
+                else if (other >= 0) input = nodesByName.at(other).value(reference.mid(dot + 1), -1);
+            }
+            if (!node.error.isEmpty()) break;
+
+            if (input < 0) node.error = "unknown parameter '" + reference + "'";
+            else if (!qobject_cast<BlockParameterInt *>(this->nodes.at(input).param) && !qobject_cast<BlockParameterEnum *>(this->nodes.at(input).param)) node.error = "parameter '" + reference + "' is not numeric";
+            else node.inputs[r] = input;
+        }
+
+        // nodes with errors keep their value
+        if (!node.error.isEmpty()) {
+            node.compiled = BlockExpression();
+            node.inputs.clear();
+        }
+    }
+    this->compiledExpressions.swap(usedExpressions);
+
+    for (int i=0; i < this->nodes.size(); ++i) {
+        const QVector<int> &inputs = this->nodes.at(i).inputs;
+        for (int r=0; r < inputs.size(); ++r) this->nodes[inputs.at(r)].dependents.append(i);
+    }
+
+
+    // ------------------------------------------------------------------------
+    //                             Topological Order
+    // ------------------------------------------------------------------------
+
+    QVector<int> indegree(this->nodes.size());
+    QVector<int> order;
+    order.reserve(this->nodes.size());
+    for (int i=0; i < this->nodes.size(); ++i) {
+        indegree[i] = this->nodes.at(i).inputs.size();
+        if (indegree.at(i) == 0) order.append(i);
+    }
+
+    for (int o=0; o < order.size(); ++o) {
+        Node &node = this->nodes[order.at(o)];
+        node.rank = o;
+        for (int d=0; d < node.dependents.size(); ++d) {
+            if (--indegree[node.dependents.at(d)] == 0) order.append(node.dependents.at(d));
+        }
+    }
+
+    // nodes that have not been reached are part of a cycle (or depend on one)
+    for (int i=0; i < this->nodes.size(); ++i) {
+        if (this->nodes.at(i).rank < 0) this->nodes[i].error = "cyclic dependency";
+    }
+
+
+    // ------------------------------------------------------------------------
+    //                               Evaluate All
+    // ------------------------------------------------------------------------
+
+    this->isUpdating = true;
+    BlockJournal::beginDerivedChanges();
+    for (int o=0; o < order.size(); ++o) {
+        if (this->nodes.at(order.at(o)).compiled.isValid()) this->evaluate(order.at(o));
+    }
+    BlockJournal::endDerivedChanges();
+    this->isUpdating = false;
+}
+
+bool libblockdia::BlockExpressionGraph::isStructureChanged(int node)
+{
+    // a changed name or expression changes the edges of the graph
+    const Node &n = this->nodes.at(node);
+    return n.param->name() != n.name || n.param->expression() != n.expression;
+}
+
+void libblockdia::BlockExpressionGraph::propagate(const QVector<int> &changedNodes)
+{
+    BLOCKDIA_TRACE_SCOPE("BlockExpressionGraph::propagate");
+
+    // collect all nodes that depend on the changed nodes (and the nodes themselves if they have an expression)
+    QVector<int> affected;
+    QVector<int> stack;
+    ++this->currentMark;
+    for (int c=0; c < changedNodes.size(); ++c) {
+        Node &node = this->nodes[changedNodes.at(c)];
+        node.value = numericValue(node.param);
+        if (node.mark == this->currentMark) continue;
+        node.mark = this->currentMark;
+        stack.append(changedNodes.at(c));
+    }
+    while (!stack.isEmpty()) {
+        int i = stack.takeLast();
+        const Node &n = this->nodes.at(i);
+        if (n.compiled.isValid() && n.rank >= 0) affected.append(i);
+        for (int d=0; d < n.dependents.size(); ++d) {
+            Node &dependent = this->nodes[n.dependents.at(d)];
+            if (dependent.mark == this->currentMark || dependent.rank < 0) continue;
+            dependent.mark = this->currentMark;
+            stack.append(n.dependents.at(d));
+        }
+    }
+
+    // every affected node is evaluated once, after all of its inputs
+    const QVector<Node> &nodes = this->nodes;
+    std::sort(affected.begin(), affected.end(), [&nodes](int a, int b) { return nodes.at(a).rank < nodes.at(b).rank; });
+
+    // the journal does not record the evaluated values (they follow the changed parameter on undo)
+    this->isUpdating = true;
+    BlockJournal::beginDerivedChanges();
+    for (int i=0; i < affected.size(); ++i) this->evaluate(affected.at(i));
+    BlockJournal::endDerivedChanges();
+    this->isUpdating = false;
+}
+
+bool libblockdia::BlockExpressionGraph::evaluate(int node)
+{
+    Node &n = this->nodes[node];
+
+    // gather the values of the references
+    QVarLengthArray<double, GRAPH_VALUES_PREALLOC> values(n.inputs.size());
+    for (int r=0; r < n.inputs.size(); ++r) values[r] = this->nodes.at(n.inputs.at(r)).value;
+
+    double result = n.compiled.evaluate(values.constData());
+    ++this->_countEvaluations;
+
+    n.error.clear();
+    if (!qIsFinite(result)) {
+        n.error = "the result is not a finite number";
+    } else if (BlockParameterInt *paramInt = qobject_cast<BlockParameterInt *>(n.param)) {
+        // the parameter clips the value at its range
+        paramInt->setValue((int) qRound64(qBound((double) INT_MIN, result, (double) INT_MAX)));
+    } else if (BlockParameterEnum *paramEnum = qobject_cast<BlockParameterEnum *>(n.param)) {
+        int index = (int) qRound64(qBound((double) INT_MIN, result, (double) INT_MAX));
+        if (!paramEnum->setValueIndex(index)) n.error = QString("there is no enum item with index %1").arg(index);
+    }
+
+    n.value = numericValue(n.param);
+    return n.error.isEmpty();
+}
+
+double libblockdia::BlockExpressionGraph::numericValue(libblockdia::BlockParameter *param)
+{
+    BlockParameterValue value = param->typedValue();
+    switch (value.type()) {
+    case BlockParameterValue::Int:          return value.toInt();
+    case BlockParameterValue::EnumIndex:    if (value.toEnumIndex() >= 0) return value.toEnumIndex(); break;
+    case BlockParameterValue::Float:        return value.toFloat();
+    default:                                break;
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
@@ -0,0 +1,200 @@
+#include "blockgenerator.h"
+
+#include <QXmlStreamWriter>
+#include <QHash>
+#include <QVector>
+#include <blocktrace.h>
+
+// independent random streams (combined with the seed and an index)
+#define STREAM_BLOCK    1
+#define STREAM_PROCESS  2
+
+// number of preceding instances an input can be connected to
+#define CONNECTION_WINDOW 16
+
+libblockdia::BlockGenerator::BlockGenerator(quint32 seed)
+{
+    this->seed = seed;
+    this->minParameters = 5;
+    this->maxParameters = 20;
+    this->minInputs = 1;
+    this->maxInputs = 5;
+    this->minOutputs = 1;
+    this->maxOutputs = 5;
+    this->minEnumItems = 2;
+    this->maxEnumItems = 10;
+    this->weightInt = 1;
+    this->weightStr = 1;
+    this->weightEnum = 1;
+}
+
+void libblockdia::BlockGenerator::setSeed(quint32 seed)
+{
+    this->seed = seed;
+}
+
+void libblockdia::BlockGenerator::setParameterCount(int minimum, int maximum)
+{
+    this->minParameters = minimum;
+    this->maxParameters = maximum;
+}
+
+void libblockdia::BlockGenerator::setInputCount(int minimum, int maximum)
+{
+    this->minInputs = minimum;
+    this->maxInputs = maximum;
+}
+
+void libblockdia::BlockGenerator::setOutputCount(int minimum, int maximum)
+{
+    this->minOutputs = minimum;
+    this->maxOutputs = maximum;
+}
+
+void libblockdia::BlockGenerator::setEnumItemCount(int minimum, int maximum)
+{
+    this->minEnumItems = minimum;
+    this->maxEnumItems = maximum;
+}
+
+void libblockdia::BlockGenerator::setParameterTypeWeights(int weightInt, int weightStr, int weightEnum)
+{
+    this->weightInt = weightInt;
+    this->weightStr = weightStr;
+    this->weightEnum = weightEnum;
+}
+
+libblockdia::BlockData libblockdia::BlockGenerator::generateBlock(int index) const
+{
+    BLOCKDIA_TRACE_SCOPE("BlockGenerator::generateBlock");
+    QRandomGenerator rng = this->randomGenerator(STREAM_BLOCK, index);
+    BlockData data;
+
+    // header
+    data.typeId = QString("gen.block%1").arg(index);
+    data.typeName = QString("Generated Block %1").arg(index);
+    data.color = QColor::fromHsv(bounded(&rng, 0, 359), bounded(&rng, 40, 120), 230);
+
+    // parameters
+    int countParameters = bounded(&rng, this->minParameters, this->maxParameters);
+    int weightSum = this->weightInt + this->weightStr + this->weightEnum;
+    for (int i=0; i < countParameters; ++i) {
+        BlockParameterData param;
+        param.name = QString("param%1").arg(i);
+        param.isPublic = rng.bounded(2) == 0;
+
+        // type by weight
+        int w = (weightSum > 0) ? bounded(&rng, 0, weightSum - 1) : 0;
+        if (w < this->weightInt || weightSum <= 0) {
+            param.type = "int";
+            param.minimum = bounded(&rng, -10000, 0);
+            param.maximum = bounded(&rng, 0, 10000);
+            param.defaultValue = QString::number(bounded(&rng, param.minimum, param.maximum));
+        } else if (w < this->weightInt + this->weightStr) {
+            param.type = "str";
+            param.defaultValue = randomText(&rng, 0, 24);
+        } else {
+            param.type = "enum";
+            int countItems = bounded(&rng, qMax(1, this->minEnumItems), qMax(1, this->maxEnumItems));
+            for (int e=0; e < countItems; ++e) param.enumItems << QString("item%1_%2").arg(e).arg(randomText(&rng, 1, 8));
+            param.defaultValue = param.enumItems.at(bounded(&rng, 0, countItems - 1));
+        }
+
+        param.value = param.defaultValue;
+        data.parameters.append(param);
+    }
+
+    // inputs/outputs
+    int countInputs = bounded(&rng, this->minInputs, this->maxInputs);
+    for (int i=0; i < countInputs; ++i) data.inputs << QString("in%1").arg(i);
+    int countOutputs = bounded(&rng, this->minOutputs, this->maxOutputs);
+    for (int i=0; i < countOutputs; ++i) data.outputs << QString("out%1").arg(i);
+
+    return data;
+}
+
+bool libblockdia::BlockGenerator::writeProcessDef(QIODevice *dev, int countBlocks, int countTypes) const
+{
+    BLOCKDIA_TRACE_SCOPE("BlockGenerator::writeProcessDef");
+    if (countTypes < 1) countTypes = 1;
+    QRandomGenerator rng = this->randomGenerator(STREAM_PROCESS, 0);
+
+    // block types are generated once
+    QVector<BlockData> types;
+    types.reserve(countTypes);
+    for (int t=0; t < countTypes; ++t) types.append(this->generateBlock(t));
+
+    // the type of every instance is needed for the connections
+    QVector<int> instanceTypes(countBlocks);
+    for (int i=0; i < countBlocks; ++i) instanceTypes[i] = bounded(&rng, 0, countTypes - 1);
+
+    QXmlStreamWriter xml(dev);
+    xml.setAutoFormatting(true);
+    xml.writeStartDocument();
+    xml.writeStartElement("ProcessDef");
+    xml.writeAttribute("version", "1");
+
+        // instances
+        xml.writeStartElement("Blocks");
+        for (int i=0; i < countBlocks; ++i) {
+            const BlockData &type = types.at(instanceTypes.at(i));
+            xml.writeStartElement("Block");
+            xml.writeAttribute("typeId", type.typeId);
+            xml.writeAttribute("instanceId", QString("I%1").arg(i));
+            xml.writeAttribute("instanceName", QString("Instance %1").arg(i));
+            for (int p=0; p < type.parameters.size(); ++p) {
+                const BlockParameterData &param = type.parameters.at(p);
+                QString value = param.defaultValue;
+                if (param.type == "int") value = QString::number(bounded(&rng, param.minimum, param.maximum));
+                else if (param.type == "enum") value = param.enumItems.at(bounded(&rng, 0, param.enumItems.size() - 1));
+                xml.writeEmptyElement("Parameter");
+                xml.writeAttribute("name", param.name);
+                xml.writeAttribute("value", value);
+            }
+            xml.writeEndElement();
+        }
+        xml.writeEndElement();
+
+        // connections (always from a preceding instance, so there are no cycles)
+        xml.writeStartElement("Connections");
+        for (int i=1; i < countBlocks; ++i) {
+            const BlockData &toType = types.at(instanceTypes.at(i));
+            int from = bounded(&rng, qMax(0, i - CONNECTION_WINDOW), i - 1);
+            const BlockData &fromType = types.at(instanceTypes.at(from));
+            if (toType.inputs.isEmpty() || fromType.outputs.isEmpty()) continue;
+            xml.writeEmptyElement("Connection");
+            xml.writeAttribute("fromBlock", QString("I%1").arg(from));
+            xml.writeAttribute("fromOutput", fromType.outputs.at(bounded(&rng, 0, fromType.outputs.size() - 1)));
+            xml.writeAttribute("toBlock", QString("I%1").arg(i));
+            xml.writeAttribute("toInput", toType.inputs.first());
+        }
+        xml.writeEndElement();
+
+    xml.writeEndElement();
+    xml.writeEndDocument();
+
+    return !xml.hasError();
+}
+
+QRandomGenerator libblockdia::BlockGenerator::randomGenerator(quint32 stream, int index) const
+{
+    // independent of the generation order
+    quint32 seeds[3] = {this->seed, stream, (quint32) index};
+    return QRandomGenerator(seeds, 3);
+}
+
+int libblockdia::BlockGenerator::bounded(QRandomGenerator *rng, int minimum, int maximum)
+{
+    if (maximum <= minimum) return minimum;
+    return minimum + (int) rng->bounded((quint32) (maximum - minimum) + 1);
+}
+
+QString libblockdia::BlockGenerator::randomText(QRandomGenerator *rng, int minimum, int maximum)
+{
+    static const char characters[] = "abcdefghijklmnopqrstuvwxyz0123456789 ";
+    int length = bounded(rng, minimum, maximum);
+    QString text;
+    text.reserve(length);
+    for (int i=0; i < length; ++i) text.append(QLatin1Char(characters[rng->bounded((quint32) (sizeof(characters) - 1))]));
+    return text.trimmed();
+}
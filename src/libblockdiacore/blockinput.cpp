@@ -35,11 +35,3 @@ void libblockdia::BlockInput::parseBlockDef(QXmlStreamReader *xml, QObject *pare
         xml->skipCurrentElement();
     }
 }
-
-bool libblockdia::BlockInput::exportBlockDef(QXmlStreamWriter *xml)
-{
-    xml->writeStartElement("Input");
-    xml->writeAttribute("name", this->name());
-    xml->writeEndElement();
-    return xml->hasError();
-}
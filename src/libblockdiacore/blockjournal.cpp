@@ -0,0 +1,672 @@
+#include "blockjournal.h"
+
+#include <QDateTime>
+#include <QSet>
+#include <blocktrace.h>
+
+// default memory budget of all undo and redo steps
+#define DEFAULT_MEMORY_BUDGET (4 * 1024 * 1024)
+
+// default interval for merging changes of the same item
+#define DEFAULT_MERGE_INTERVAL_MS 1000
+
+// nesting depth of beginDerivedChanges() of the current thread
+static thread_local int derivedChangesDepth = 0;
+
+/**
+ * @details Setting all data of a parameter (the type must match).
+ */
+static void applyParameterData(libblockdia::BlockParameter *param, const libblockdia::BlockParameterData &data)
+{
+    param->setName(data.name);
+    param->importParamData(data);
+    param->setPublic(data.isPublic);
+    param->setDefaultValue(data.defaultValue);
+    param->setExpression(data.expression);
+    if (!data.value.isNull()) param->setValue(data.value);
+}
+
+libblockdia::BlockJournal::BlockJournal(libblockdia::Block *block, QObject *parent) : QObject(parent)
+{
+    this->_block = block;
+    this->memoryBudget = DEFAULT_MEMORY_BUDGET;
+    this->usedMemory = 0;
+    this->mergeInterval = DEFAULT_MERGE_INTERVAL_MS;
+    this->isApplying = false;
+    this->macroDepth = 0;
+
+    // header changes and added/removed children are found by comparing with the known state
+    connect(block, SIGNAL(signalSomethingChanged(libblockdia::Block*)), this, SLOT(slotBlockChanged()));
+    connect(block, SIGNAL(signalParametersChanged(libblockdia::Block*,QList<libblockdia::BlockParameter*>)),
+            this, SLOT(slotParametersChanged(libblockdia::Block*,QList<libblockdia::BlockParameter*>)));
+    this->readKnownState();
+}
+
+libblockdia::Block *libblockdia::BlockJournal::block()
+{
+    return this->_block;
+}
+
+void libblockdia::BlockJournal::setMemoryBudget(qint64 bytes)
+{
+    this->memoryBudget = bytes;
+    this->enforceMemoryBudget();
+}
+
+qint64 libblockdia::BlockJournal::memoryUsage()
+{
+    return this->usedMemory;
+}
+
+void libblockdia::BlockJournal::setMergeInterval(int ms)
+{
+    this->mergeInterval = ms;
+}
+
+bool libblockdia::BlockJournal::canUndo()
+{
+    return !this->undoSteps.isEmpty();
+}
+
+bool libblockdia::BlockJournal::canRedo()
+{
+    return !this->redoSteps.isEmpty();
+}
+
+QString libblockdia::BlockJournal::undoText()
+{
+    return (this->undoSteps.isEmpty()) ? QString() : this->undoSteps.last().text;
+}
+
+QString libblockdia::BlockJournal::redoText()
+{
+    return (this->redoSteps.isEmpty()) ? QString() : this->redoSteps.last().text;
+}
+
+void libblockdia::BlockJournal::beginMacro(const QString &text)
+{
+    if (this->macroDepth == 0) {
+        this->macroStep = Step();
+        this->macroStep.text = text;
+    }
+    ++this->macroDepth;
+}
+
+void libblockdia::BlockJournal::endMacro()
+{
+    if (this->macroDepth == 0) return;
+    if (--this->macroDepth > 0) return;
+
+    // the macro is recorded as one step
+    QList<Change> changes = this->macroStep.changes;
+    QString text = this->macroStep.text;
+    this->macroStep = Step();
+    this->record(changes, text);
+}
+
+void libblockdia::BlockJournal::clear()
+{
+    this->undoSteps.clear();
+    this->redoSteps.clear();
+    this->usedMemory = 0;
+    this->readKnownState();
+    emit signalChanged();
+}
+
+void libblockdia::BlockJournal::beginDerivedChanges()
+{
+    ++derivedChangesDepth;
+}
+
+void libblockdia::BlockJournal::endDerivedChanges()
+{
+    if (derivedChangesDepth > 0) --derivedChangesDepth;
+}
+
+void libblockdia::BlockJournal::undo()
+{
+    BLOCKDIA_TRACE_SCOPE("BlockJournal::undo");
+    if (this->undoSteps.isEmpty()) return;
+
+    // changes are reverted in reverse order
+    Step step = this->undoSteps.takeLast();
+    this->isApplying = true;
+    for (int i=step.changes.size() - 1; i >= 0; --i) {
+        this->applyChange(step.changes.at(i), true);
+    }
+    this->isApplying = false;
+
+    // following changes are not merged with the step before the undone one
+    if (!this->undoSteps.isEmpty()) this->undoSteps.last().timestamp = 0;
+    this->redoSteps.append(step);
+    emit signalChanged();
+}
+
+void libblockdia::BlockJournal::redo()
+{
+    BLOCKDIA_TRACE_SCOPE("BlockJournal::redo");
+    if (this->redoSteps.isEmpty()) return;
+
+    Step step = this->redoSteps.takeLast();
+    this->isApplying = true;
+    for (int i=0; i < step.changes.size(); ++i) {
+        this->applyChange(step.changes.at(i), false);
+    }
+    this->isApplying = false;
+
+    // a redone step is never merged with following changes
+    step.timestamp = 0;
+    this->undoSteps.append(step);
+    emit signalChanged();
+}
+
+void libblockdia::BlockJournal::readKnownState()
+{
+    // children must be known by the block before they can be observed
+    this->_block->slotUpdateChildObjects();
+
+    // header
+    for (int i=0; i < HeaderFieldCount; ++i) {
+        this->knownHeader[i] = this->headerValue(i);
+    }
+
+    // children that are not known anymore may still be connected,
+    // their signals are ignored (and some of them may already be deleted)
+
+    // parameters
+    this->knownParameters = this->_block->getParameters();
+    this->knownParameterData.clear();
+    for (int i=0; i < this->knownParameters.size(); ++i) {
+        this->knownParameterData.append(this->knownParameters.at(i)->snapshot());
+        connect(this->knownParameters.at(i), SIGNAL(somethingHasChanged()), this, SLOT(slotParameterChanged()), Qt::UniqueConnection);
+    }
+
+    // inputs
+    this->knownInputs = this->_block->getInputs();
+    this->knownInputNames.clear();
+    for (int i=0; i < this->knownInputs.size(); ++i) {
+        this->knownInputNames.append(this->knownInputs.at(i)->name());
+        connect(this->knownInputs.at(i), SIGNAL(somethingHasChanged()), this, SLOT(slotInputChanged()), Qt::UniqueConnection);
+    }
+
+    // outputs
+    this->knownOutputs = this->_block->getOutputs();
+    this->knownOutputNames.clear();
+    for (int i=0; i < this->knownOutputs.size(); ++i) {
+        this->knownOutputNames.append(this->knownOutputs.at(i)->name());
+        connect(this->knownOutputs.at(i), SIGNAL(somethingHasChanged()), this, SLOT(slotOutputChanged()), Qt::UniqueConnection);
+    }
+}
+
+QString libblockdia::BlockJournal::headerValue(int field)
+{
+    switch (field) {
+    case HeaderTypeId: return this->_block->typeId();
+    case HeaderTypeName: return this->_block->typeName();
+    case HeaderInstanceId: return this->_block->instanceId();
+    case HeaderInstanceName: return this->_block->instanceName();
+    case HeaderColor: return this->_block->color().name();
+    }
+    return QString();
+}
+
+void libblockdia::BlockJournal::setHeaderValue(int field, const QString &value)
+{
+    switch (field) {
+    case HeaderTypeId: this->_block->setTypeId(value); break;
+    case HeaderTypeName: this->_block->setTypeName(value); break;
+    case HeaderInstanceId: this->_block->setInstanceId(value); break;
+    case HeaderInstanceName: this->_block->setInstanceName(value); break;
+    case HeaderColor: this->_block->setColor(QColor(value)); break;
+    }
+    this->knownHeader[field] = value;
+}
+
+void libblockdia::BlockJournal::record(const QList<libblockdia::BlockJournal::Change> &changes, const QString &text)
+{
+    if (changes.isEmpty()) return;
+
+    // within a macro all changes are collected
+    if (this->macroDepth > 0) {
+        this->macroStep.changes.append(changes);
+        return;
+    }
+
+    // a new change invalidates all redo steps
+    for (int i=0; i < this->redoSteps.size(); ++i) this->usedMemory -= this->redoSteps.at(i).memorySize;
+    this->redoSteps.clear();
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    // merge with the previous change of the same item
+    if (changes.size() == 1 && !this->undoSteps.isEmpty()) {
+        Step &last = this->undoSteps.last();
+        if (last.changes.size() == 1 && now - last.timestamp < this->mergeInterval && isMergeable(last.changes.at(0), changes.at(0))) {
+            Change &merged = last.changes[0];
+            const Change &next = changes.at(0);
+            merged.newText = next.newText;
+
+            // fields that change for the first time keep their old value from the next change
+            copyParameterFields(next.oldParameter, &merged.oldParameter, next.parameterFields & ~merged.parameterFields);
+            copyParameterFields(next.newParameter, &merged.newParameter, next.parameterFields);
+            merged.parameterFields |= next.parameterFields;
+
+            last.timestamp = now;
+            this->usedMemory -= last.memorySize;
+            last.memorySize = estimateSize(merged);
+            this->usedMemory += last.memorySize;
+
+            // a merged step can grow
+            this->enforceMemoryBudget();
+            emit signalChanged();
+            return;
+        }
+    }
+
+    // new step
+    Step step;
+    step.text = text;
+    step.changes = changes;
+    step.timestamp = now;
+    step.memorySize = 0;
+    for (int i=0; i < changes.size(); ++i) step.memorySize += estimateSize(changes.at(i));
+    this->usedMemory += step.memorySize;
+    this->undoSteps.append(step);
+
+    this->enforceMemoryBudget();
+    emit signalChanged();
+}
+
+void libblockdia::BlockJournal::applyChange(const libblockdia::BlockJournal::Change &change, bool isUndo)
+{
+    // adding is undone by removing and vice versa
+    Change::Kind kind = change.kind;
+    if (isUndo) {
+        if (kind == Change::ParameterAdded) kind = Change::ParameterRemoved;
+        else if (kind == Change::ParameterRemoved) kind = Change::ParameterAdded;
+        else if (kind == Change::InputAdded) kind = Change::InputRemoved;
+        else if (kind == Change::InputRemoved) kind = Change::InputAdded;
+        else if (kind == Change::OutputAdded) kind = Change::OutputRemoved;
+        else if (kind == Change::OutputRemoved) kind = Change::OutputAdded;
+    }
+
+    const QString &text = (isUndo) ? change.oldText : change.newText;
+    const BlockParameterData &parameter = (isUndo) ? change.oldParameter : change.newParameter;
+    const BlockParameterData &addedParameter = (change.kind == Change::ParameterAdded) ? change.newParameter : change.oldParameter;
+    const QString &addedName = (change.kind == Change::InputAdded || change.kind == Change::OutputAdded) ? change.newText : change.oldText;
+    int index = change.index;
+    Block *block = this->_block;
+
+    switch (kind) {
+
+    case Change::HeaderChanged:
+        this->setHeaderValue(index, text);
+        break;
+
+    case Change::ParameterChanged: {
+        // only the recorded fields are changed
+        BlockParameterData data = this->knownParameterData.at(index);
+        copyParameterFields(parameter, &data, change.parameterFields);
+        applyParameterData(this->knownParameters.at(index), data);
+        this->knownParameterData[index] = data;
+        break;
+    }
+
+    case Change::ParameterRemoved:
+        delete this->knownParameters.takeAt(index);
+        this->knownParameterData.removeAt(index);
+        block->slotUpdateChildObjects();
+        break;
+
+    case Change::ParameterAdded: {
+        BlockParameter *param = BlockParameter::importBlockData(addedParameter, block);
+        if (!param) break;
+        block->slotUpdateChildObjects();
+        block->parametersList.move(block->parametersList.indexOf(param), index);
+        this->knownParameters.insert(index, param);
+        this->knownParameterData.insert(index, param->snapshot());
+        connect(param, SIGNAL(somethingHasChanged()), this, SLOT(slotParameterChanged()), Qt::UniqueConnection);
+        break;
+    }
+
+    case Change::InputChanged:
+        this->knownInputs.at(index)->setName(text);
+        this->knownInputNames[index] = text;
+        break;
+
+    case Change::InputRemoved:
+        delete this->knownInputs.takeAt(index);
+        this->knownInputNames.removeAt(index);
+        block->slotUpdateChildObjects();
+        break;
+
+    case Change::InputAdded: {
+        BlockInput *input = new BlockInput(addedName, block);
+        block->slotUpdateChildObjects();
+        block->inputsList.move(block->inputsList.indexOf(input), index);
+        this->knownInputs.insert(index, input);
+        this->knownInputNames.insert(index, addedName);
+        connect(input, SIGNAL(somethingHasChanged()), this, SLOT(slotInputChanged()), Qt::UniqueConnection);
+        break;
+    }
+
+    case Change::OutputChanged:
+        this->knownOutputs.at(index)->setName(text);
+        this->knownOutputNames[index] = text;
+        break;
+
+    case Change::OutputRemoved:
+        delete this->knownOutputs.takeAt(index);
+        this->knownOutputNames.removeAt(index);
+        block->slotUpdateChildObjects();
+        break;
+
+    case Change::OutputAdded: {
+        BlockOutput *output = new BlockOutput(addedName, block);
+        block->slotUpdateChildObjects();
+        block->outputsList.move(block->outputsList.indexOf(output), index);
+        this->knownOutputs.insert(index, output);
+        this->knownOutputNames.insert(index, addedName);
+        connect(output, SIGNAL(somethingHasChanged()), this, SLOT(slotOutputChanged()), Qt::UniqueConnection);
+        break;
+    }
+    }
+
+    // the order of children may have changed
+    block->slotInvalidateCache();
+    block->slotDataChanged();
+}
+
+void libblockdia::BlockJournal::enforceMemoryBudget()
+{
+    // drop the oldest steps (but keep the last one)
+    while (this->usedMemory > this->memoryBudget && this->undoSteps.size() > 1) {
+        this->usedMemory -= this->undoSteps.takeFirst().memorySize;
+    }
+}
+
+bool libblockdia::BlockJournal::isMergeable(const libblockdia::BlockJournal::Change &last, const libblockdia::BlockJournal::Change &next)
+{
+    if (last.kind != next.kind || last.index != next.index) return false;
+    return next.kind == Change::HeaderChanged || next.kind == Change::ParameterChanged ||
+           next.kind == Change::InputChanged || next.kind == Change::OutputChanged;
+}
+
+qint64 libblockdia::BlockJournal::estimateSize(const libblockdia::BlockJournal::Change &change)
+{
+    qint64 size = sizeof(Change);
+    size += (change.oldText.size() + change.newText.size()) * sizeof(QChar);
+
+    // only the stored data of a parameter is counted
+    // (the unchanged fields of a ParameterChanged change are empty)
+    const BlockParameterData *params[2] = {&change.oldParameter, &change.newParameter};
+    for (int i=0; i < 2; ++i) {
+        const BlockParameterData *p = params[i];
+        size += (p->type.size() + p->name.size() + p->defaultValue.size() + p->value.size() + p->expression.size()) * sizeof(QChar);
+        for (int k=0; k < p->enumItems.size(); ++k) size += p->enumItems.at(k).size() * sizeof(QChar);
+    }
+
+    return size;
+}
+
+libblockdia::BlockJournal::Change libblockdia::BlockJournal::parameterChange(int index, const libblockdia::BlockParameterData &oldData, const libblockdia::BlockParameterData &newData)
+{
+    Change c;
+    c.kind = Change::ParameterChanged;
+    c.index = index;
+    c.parameterFields = changedParameterFields(oldData, newData);
+    copyParameterFields(oldData, &c.oldParameter, c.parameterFields);
+    copyParameterFields(newData, &c.newParameter, c.parameterFields);
+    return c;
+}
+
+int libblockdia::BlockJournal::changedParameterFields(const libblockdia::BlockParameterData &a, const libblockdia::BlockParameterData &b)
+{
+    int fields = 0;
+    if (a.name != b.name) fields |= ParameterName;
+    if (a.isPublic != b.isPublic) fields |= ParameterPublic;
+    if (a.defaultValue != b.defaultValue) fields |= ParameterDefault;
+    if (a.value != b.value || a.value.isNull() != b.value.isNull()) fields |= ParameterValue;
+    if (a.minimum != b.minimum || a.maximum != b.maximum) fields |= ParameterRange;
+    if (a.enumItems != b.enumItems) fields |= ParameterEnumItems;
+    if (a.elementType != b.elementType || a.elementMinimum != b.elementMinimum || a.elementMaximum != b.elementMaximum) fields |= ParameterElements;
+    if (a.expression != b.expression) fields |= ParameterExpression;
+    return fields;
+}
+
+void libblockdia::BlockJournal::copyParameterFields(const libblockdia::BlockParameterData &from, libblockdia::BlockParameterData *to, int fields)
+{
+    if (fields & ParameterName) to->name = from.name;
+    if (fields & ParameterPublic) to->isPublic = from.isPublic;
+    if (fields & ParameterDefault) to->defaultValue = from.defaultValue;
+    if (fields & ParameterValue) to->value = from.value;
+    if (fields & ParameterRange) {
+        to->minimum = from.minimum;
+        to->maximum = from.maximum;
+    }
+    if (fields & ParameterEnumItems) to->enumItems = from.enumItems;
+    if (fields & ParameterElements) {
+        to->elementType = from.elementType;
+        to->elementMinimum = from.elementMinimum;
+        to->elementMaximum = from.elementMaximum;
+    }
+    if (fields & ParameterExpression) to->expression = from.expression;
+}
+
+void libblockdia::BlockJournal::slotBlockChanged()
+{
+    if (this->isApplying) return;
+    QList<Change> changes;
+    QString text = "change block";
+
+
+    // ------------------------------------------------------------------------
+    //                                  Header
+    // ------------------------------------------------------------------------
+
+    for (int i=0; i < HeaderFieldCount; ++i) {
+        QString value = this->headerValue(i);
+        if (value != this->knownHeader[i]) {
+            Change c;
+            c.kind = Change::HeaderChanged;
+            c.index = i;
+            c.oldText = this->knownHeader[i];
+            c.newText = value;
+            changes.append(c);
+            this->knownHeader[i] = value;
+        }
+    }
+
+
+    // ------------------------------------------------------------------------
+    //                                Parameters
+    // ------------------------------------------------------------------------
+
+    QList<BlockParameter *> params = this->_block->getParameters();
+    if (params != this->knownParameters) {
+        QSet<BlockParameter *> current = QSet<BlockParameter *>::fromList(params);
+        QSet<BlockParameter *> known = QSet<BlockParameter *>::fromList(this->knownParameters);
+
+        // removed parameters (from the end, so that undo restores the positions)
+        for (int i=this->knownParameters.size() - 1; i >= 0; --i) {
+            if (current.contains(this->knownParameters.at(i))) continue;
+            Change c;
+            c.kind = Change::ParameterRemoved;
+            c.index = i;
+            c.oldParameter = this->knownParameterData.at(i);
+            changes.append(c);
+            this->knownParameters.removeAt(i);
+            this->knownParameterData.removeAt(i);
+            text = "remove parameter";
+        }
+
+        // added parameters
+        for (int i=0; i < params.size(); ++i) {
+            if (known.contains(params.at(i))) continue;
+            Change c;
+            c.kind = Change::ParameterAdded;
+            c.index = i;
+            c.newParameter = params.at(i)->snapshot();
+            changes.append(c);
+            this->knownParameters.insert(i, params.at(i));
+            this->knownParameterData.insert(i, c.newParameter);
+            connect(params.at(i), SIGNAL(somethingHasChanged()), this, SLOT(slotParameterChanged()), Qt::UniqueConnection);
+            text = "add parameter";
+        }
+    }
+
+
+    // ------------------------------------------------------------------------
+    //                             Inputs / Outputs
+    // ------------------------------------------------------------------------
+
+    QList<BlockInput *> inputs = this->_block->getInputs();
+    if (inputs != this->knownInputs) {
+        QSet<BlockInput *> current = QSet<BlockInput *>::fromList(inputs);
+        QSet<BlockInput *> known = QSet<BlockInput *>::fromList(this->knownInputs);
+
+        for (int i=this->knownInputs.size() - 1; i >= 0; --i) {
+            if (current.contains(this->knownInputs.at(i))) continue;
+            Change c;
+            c.kind = Change::InputRemoved;
+            c.index = i;
+            c.oldText = this->knownInputNames.at(i);
+            changes.append(c);
+            this->knownInputs.removeAt(i);
+            this->knownInputNames.removeAt(i);
+            text = "remove input";
+        }
+
+        for (int i=0; i < inputs.size(); ++i) {
+            if (known.contains(inputs.at(i))) continue;
+            Change c;
+            c.kind = Change::InputAdded;
+            c.index = i;
+            c.newText = inputs.at(i)->name();
+            changes.append(c);
+            this->knownInputs.insert(i, inputs.at(i));
+            this->knownInputNames.insert(i, c.newText);
+            connect(inputs.at(i), SIGNAL(somethingHasChanged()), this, SLOT(slotInputChanged()), Qt::UniqueConnection);
+            text = "add input";
+        }
+    }
+
+    QList<BlockOutput *> outputs = this->_block->getOutputs();
+    if (outputs != this->knownOutputs) {
+        QSet<BlockOutput *> current = QSet<BlockOutput *>::fromList(outputs);
+        QSet<BlockOutput *> known = QSet<BlockOutput *>::fromList(this->knownOutputs);
+
+        for (int i=this->knownOutputs.size() - 1; i >= 0; --i) {
+            if (current.contains(this->knownOutputs.at(i))) continue;
+            Change c;
+            c.kind = Change::OutputRemoved;
+            c.index = i;
+            c.oldText = this->knownOutputNames.at(i);
+            changes.append(c);
+            this->knownOutputs.removeAt(i);
+            this->knownOutputNames.removeAt(i);
+            text = "remove output";
+        }
+
+        for (int i=0; i < outputs.size(); ++i) {
+            if (known.contains(outputs.at(i))) continue;
+            Change c;
+            c.kind = Change::OutputAdded;
+            c.index = i;
+            c.newText = outputs.at(i)->name();
+            changes.append(c);
+            this->knownOutputs.insert(i, outputs.at(i));
+            this->knownOutputNames.insert(i, c.newText);
+            connect(outputs.at(i), SIGNAL(somethingHasChanged()), this, SLOT(slotOutputChanged()), Qt::UniqueConnection);
+            text = "add output";
+        }
+    }
+
+    this->record(changes, text);
+}
+
+void libblockdia::BlockJournal::slotParameterChanged()
+{
+    // derived values are followed even while applying a step (they are derived again on undo/redo)
+    bool isDerived = derivedChangesDepth > 0;
+    if (this->isApplying && !isDerived) return;
+
+    int index = this->knownParameters.indexOf((BlockParameter *) this->sender());
+    if (index < 0) return;
+
+    // the parameter has already invalidated its snapshot
+    BlockParameterData data = this->knownParameters.at(index)->snapshot();
+    if (data == this->knownParameterData.at(index)) return;
+    if (isDerived) {
+        this->knownParameterData[index] = data;
+        return;
+    }
+
+    Change c = parameterChange(index, this->knownParameterData.at(index), data);
+    this->knownParameterData[index] = data;
+    this->record(QList<Change>() << c, "change parameter " + data.name);
+}
+
+void libblockdia::BlockJournal::slotParametersChanged(libblockdia::Block *block, const QList<libblockdia::BlockParameter *> &parameters)
+{
+    Q_UNUSED(block);
+    if (this->isApplying) return;
+
+    // the positions are looked up once for all parameters
+    QHash<BlockParameter *, int> indices;
+    indices.reserve(this->knownParameters.size());
+    for (int i=0; i < this->knownParameters.size(); ++i) indices.insert(this->knownParameters.at(i), i);
+
+    QList<Change> changes;
+    for (int i=0; i < parameters.size(); ++i) {
+        int index = indices.value(parameters.at(i), -1);
+        if (index < 0) continue;
+
+        BlockParameterData data = this->knownParameters.at(index)->snapshot();
+        if (data == this->knownParameterData.at(index)) continue;
+
+        changes.append(parameterChange(index, this->knownParameterData.at(index), data));
+        this->knownParameterData[index] = data;
+    }
+
+    QString text = (changes.size() == 1) ? "change parameter " + this->knownParameterData.at(changes.first().index).name : "change parameters";
+    this->record(changes, text);
+}
+
+void libblockdia::BlockJournal::slotInputChanged()
+{
+    if (this->isApplying) return;
+
+    int index = this->knownInputs.indexOf((BlockInput *) this->sender());
+    if (index < 0) return;
+
+    QString name = this->knownInputs.at(index)->name();
+    if (name == this->knownInputNames.at(index)) return;
+
+    Change c;
+    c.kind = Change::InputChanged;
+    c.index = index;
+    c.oldText = this->knownInputNames.at(index);
+    c.newText = name;
+    this->knownInputNames[index] = name;
+    this->record(QList<Change>() << c, "rename input");
+}
+
+void libblockdia::BlockJournal::slotOutputChanged()
+{
+    if (this->isApplying) return;
+
+    int index = this->knownOutputs.indexOf((BlockOutput *) this->sender());
+    if (index < 0) return;
+
+    QString name = this->knownOutputs.at(index)->name();
+    if (name == this->knownOutputNames.at(index)) return;
+
+    Change c;
+    c.kind = Change::OutputChanged;
+    c.index = index;
+    c.oldText = this->knownOutputNames.at(index);
+    c.newText = name;
+    this->knownOutputNames[index] = name;
+    this->record(QList<Change>() << c, "rename output");
+}
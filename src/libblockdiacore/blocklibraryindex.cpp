@@ -0,0 +1,439 @@
+#include "blocklibraryindex.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QXmlStreamReader>
+#include <QVector>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QMutexLocker>
+
+#include <blocklibrarypack.h>
+#include <blocktrace.h>
+
+// file format identification of the index file
+#define INDEX_FILE_MAGIC   0x42444958
+#define INDEX_FILE_VERSION 1
+
+namespace libblockdia {
+
+/**
+ * @brief A worker job that parses the meta data of one block definition file.
+ */
+class BlockLibraryIndexJob : public QRunnable
+{
+public:
+    BlockLibraryIndexJob(const QString &absolutePath, BlockLibraryIndex::Entry *entry)
+    {
+        this->absolutePath = absolutePath;
+        this->entry = entry;
+    }
+
+    void run()
+    {
+        BLOCKDIA_TRACE_SCOPE("BlockLibraryIndexJob::run");
+        QFile f(this->absolutePath);
+        if (f.open(QIODevice::ReadOnly)) {
+            BlockLibraryIndex::parseEntry(&f, this->entry);
+            f.close();
+        } else {
+            this->entry->isValid = false;
+        }
+    }
+
+private:
+    QString absolutePath;
+    BlockLibraryIndex::Entry *entry;
+};
+
+/**
+ * @brief A worker job that scans the base directory in the background.
+ */
+class BlockLibraryIndexScanJob : public QRunnable
+{
+public:
+    BlockLibraryIndexScanJob(BlockLibraryIndex *index, int generation, const QString &basePath, const QHash<QString, BlockLibraryIndex::Entry> &oldEntries)
+    {
+        this->index = index;
+        this->generation = generation;
+        this->basePath = basePath;
+        this->oldEntries = oldEntries;
+    }
+
+    void run()
+    {
+        BLOCKDIA_TRACE_SCOPE("BlockLibraryIndexScanJob::run");
+        BlockLibraryIndex::ScanResult result;
+        result.generation = this->generation;
+        result.somethingChanged = false;
+        result.countRead = 0;
+
+        // outdated scans are skipped
+        if (this->index->generation.load() == this->generation) {
+            result.countRead = BlockLibraryIndex::scanDirectory(this->basePath, this->oldEntries, &result.entries, &result.somethingChanged);
+        }
+
+        this->index->addScanResult(result);
+    }
+
+private:
+    BlockLibraryIndex *index;
+    int generation;
+    QString basePath;
+    QHash<QString, BlockLibraryIndex::Entry> oldEntries;
+};
+
+} // namespace libblockdia
+
+libblockdia::BlockLibraryIndex::BlockLibraryIndex(QObject *parent) : QObject(parent)
+{
+    this->_basePath = "";
+    this->threadPool = new QThreadPool(this);
+    this->threadPool->setMaxThreadCount(1);  // a scan parses the files in parallel by itself
+    this->countPendingScans = 0;
+    this->generation.store(0);
+}
+
+libblockdia::BlockLibraryIndex::~BlockLibraryIndex()
+{
+    // jobs reference this object
+    this->generation.fetchAndAddOrdered(1);
+    this->threadPool->waitForDone();
+}
+
+QString libblockdia::BlockLibraryIndex::basePath()
+{
+    return this->_basePath;
+}
+
+void libblockdia::BlockLibraryIndex::setBasePath(const QString &path)
+{
+    QString p = QDir::cleanPath(path);
+    if (p != this->_basePath) {
+        this->_basePath = p;
+        this->generation.fetchAndAddOrdered(1);
+        this->entriesHash.clear();
+        emit signalIndexChanged();
+    }
+}
+
+QList<libblockdia::BlockLibraryIndex::Entry> libblockdia::BlockLibraryIndex::entries()
+{
+    QList<Entry> list;
+
+    // only valid block definitions are of interest
+    for (QHash<QString, Entry>::const_iterator it = this->entriesHash.constBegin(); it != this->entriesHash.constEnd(); ++it) {
+        if (it.value().isValid) list.append(it.value());
+    }
+
+    return list;
+}
+
+const libblockdia::BlockLibraryIndex::Entry *libblockdia::BlockLibraryIndex::entry(const QString &filePath)
+{
+    QHash<QString, Entry>::const_iterator it = this->entriesHash.constFind(filePath);
+    return (it == this->entriesHash.constEnd()) ? Q_NULLPTR : &it.value();
+}
+
+int libblockdia::BlockLibraryIndex::scan()
+{
+    BLOCKDIA_TRACE_SCOPE("BlockLibraryIndex::scan");
+    bool somethingChanged = false;
+    QHash<QString, Entry> newEntries;
+    int countRead = scanDirectory(this->_basePath, this->entriesHash, &newEntries, &somethingChanged);
+
+    // running background scans are outdated now
+    this->generation.fetchAndAddOrdered(1);
+    this->entriesHash = newEntries;
+    if (somethingChanged) emit signalIndexChanged();
+    return countRead;
+}
+
+void libblockdia::BlockLibraryIndex::startScan()
+{
+    // a new scan makes scans that are still running outdated
+    int generation = this->generation.fetchAndAddOrdered(1) + 1;
+    ++this->countPendingScans;
+    this->threadPool->start(new BlockLibraryIndexScanJob(this, generation, this->_basePath, this->entriesHash));
+}
+
+bool libblockdia::BlockLibraryIndex::isScanning()
+{
+    return this->countPendingScans > 0;
+}
+
+void libblockdia::BlockLibraryIndex::addScanResult(const ScanResult &result)
+{
+    // called from the worker thread
+    QMutexLocker locker(&this->scanResultsMutex);
+    this->scanResults.append(result);
+    QMetaObject::invokeMethod(this, "slotCollectScanResults", Qt::QueuedConnection);
+}
+
+void libblockdia::BlockLibraryIndex::slotCollectScanResults()
+{
+    QList<ScanResult> results;
+    {
+        QMutexLocker locker(&this->scanResultsMutex);
+        results.swap(this->scanResults);
+    }
+
+    for (int i=0; i < results.size(); ++i) {
+        const ScanResult &result = results.at(i);
+        --this->countPendingScans;
+
+        // results of outdated scans are dropped silently
+        if (result.generation != this->generation.load()) continue;
+
+        this->entriesHash = result.entries;
+        if (result.somethingChanged) emit signalIndexChanged();
+        emit signalScanFinished(result.countRead);
+    }
+}
+
+int libblockdia::BlockLibraryIndex::scanDirectory(const QString &basePath, const QHash<QString, Entry> &oldEntries, QHash<QString, Entry> *newEntries, bool *somethingChanged)
+{
+    QDir baseDir(basePath);
+
+    if (basePath.isEmpty() || !baseDir.exists()) {
+        *somethingChanged = oldEntries.size() > 0;
+        return 0;
+    }
+
+    // walk through all block definition files
+    int countPackEntriesRead = 0;
+    QVector<Entry> changedEntries;
+    QStringList changedFiles;
+    QDirIterator it(basePath, QStringList() << "*.xml" << "*.bdpack", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        QFileInfo fi = it.fileInfo();
+        QString relPath = baseDir.relativeFilePath(fi.filePath());
+        qint64 lastModified = fi.lastModified().toMSecsSinceEpoch();
+
+        // packs are indexed like sub directories
+        if (BlockLibraryPack::isPackFile(relPath)) {
+            countPackEntriesRead += scanPack(relPath, fi, oldEntries, newEntries);
+            continue;
+        }
+
+        // reuse unchanged entries
+        QHash<QString, Entry>::const_iterator itOld = oldEntries.constFind(relPath);
+        if (itOld != oldEntries.constEnd() && itOld.value().lastModified == lastModified && itOld.value().size == fi.size()) {
+            newEntries->insert(relPath, itOld.value());
+            continue;
+        }
+
+        // remember new or changed file
+        Entry e;
+        e.filePath = relPath;
+        e.isValid = false;
+        e.lastModified = lastModified;
+        e.size = fi.size();
+        changedEntries.append(e);
+        changedFiles.append(fi.filePath());
+    }
+
+    // parse new or changed files in parallel
+    // (every job writes to its own entry, so no locking is needed)
+    QThreadPool pool;
+    for (int i=0; i < changedEntries.size(); ++i) {
+        pool.start(new BlockLibraryIndexJob(changedFiles.at(i), &changedEntries[i]));
+    }
+    pool.waitForDone();
+    for (int i=0; i < changedEntries.size(); ++i) {
+        newEntries->insert(changedEntries.at(i).filePath, changedEntries.at(i));
+        *somethingChanged = true;
+    }
+
+    // check for changed packs and removed files
+    if (countPackEntriesRead > 0) *somethingChanged = true;
+    if (newEntries->size() != oldEntries.size()) *somethingChanged = true;
+
+    return changedEntries.size() + countPackEntriesRead;
+}
+
+int libblockdia::BlockLibraryIndex::scanPack(const QString &relPackPath, const QFileInfo &packFileInfo, const QHash<QString, Entry> &indexEntries, QHash<QString, Entry> *newEntries)
+{
+    QString prefix = relPackPath + "/";
+    qint64 lastModified = packFileInfo.lastModified().toMSecsSinceEpoch();
+
+    // entries of a pack carry the modification time and size of the pack file
+    QList<Entry> oldEntries;
+    bool packChanged = false;
+    for (QHash<QString, Entry>::const_iterator it = indexEntries.constBegin(); it != indexEntries.constEnd(); ++it) {
+        if (it.key().startsWith(prefix)) {
+            oldEntries.append(it.value());
+            if (it.value().lastModified != lastModified || it.value().size != packFileInfo.size()) packChanged = true;
+        }
+    }
+
+    // reuse unchanged pack
+    if (!packChanged && oldEntries.size() > 0) {
+        for (int i=0; i < oldEntries.size(); ++i) newEntries->insert(oldEntries.at(i).filePath, oldEntries.at(i));
+        return 0;
+    }
+
+    // the directory of the pack already contains all meta data
+    BlockLibraryPack pack;
+    if (!pack.open(packFileInfo.filePath())) return 0;
+    QList<Entry> packEntries = pack.entries();
+    for (int i=0; i < packEntries.size(); ++i) {
+        Entry e = packEntries.at(i);
+        e.filePath = prefix + e.filePath;
+        e.lastModified = lastModified;
+        e.size = packFileInfo.size();
+        newEntries->insert(e.filePath, e);
+    }
+
+    return packEntries.size();
+}
+
+bool libblockdia::BlockLibraryIndex::load(const QString &indexFilePath)
+{
+    BLOCKDIA_TRACE_SCOPE("BlockLibraryIndex::load");
+    QFile f(indexFilePath);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream ds(&f);
+    ds.setVersion(QDataStream::Qt_5_6);
+
+    // check file header
+    quint32 magic, version;
+    ds >> magic >> version;
+    if (magic != INDEX_FILE_MAGIC || version != INDEX_FILE_VERSION) {
+        qWarning() << "BlockLibraryIndex: unsupported index file" << indexFilePath;
+        return false;
+    }
+
+    // the index must belong to the current library
+    QString basePath;
+    ds >> basePath;
+    if (basePath != this->_basePath) return false;
+
+    // read entries
+    quint32 count;
+    ds >> count;
+    QHash<QString, Entry> newEntries;
+    newEntries.reserve(count);
+    for (quint32 i=0; i < count && ds.status() == QDataStream::Ok; ++i) {
+        Entry e;
+        qint32 countParameters, countInputs, countOutputs;
+        ds >> e.filePath >> e.isValid >> e.typeId >> e.typeName >> e.color;
+        ds >> countParameters >> countInputs >> countOutputs;
+        ds >> e.lastModified >> e.size;
+        e.countParameters = countParameters;
+        e.countInputs = countInputs;
+        e.countOutputs = countOutputs;
+        newEntries.insert(e.filePath, e);
+    }
+
+    if (ds.status() != QDataStream::Ok) {
+        qWarning() << "BlockLibraryIndex: corrupt index file" << indexFilePath;
+        return false;
+    }
+
+    // running background scans are outdated now
+    this->generation.fetchAndAddOrdered(1);
+    this->entriesHash = newEntries;
+    emit signalIndexChanged();
+    return true;
+}
+
+bool libblockdia::BlockLibraryIndex::save(const QString &indexFilePath)
+{
+    BLOCKDIA_TRACE_SCOPE("BlockLibraryIndex::save");
+    QSaveFile f(indexFilePath);
+    if (!f.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream ds(&f);
+    ds.setVersion(QDataStream::Qt_5_6);
+
+    // file header
+    ds << (quint32) INDEX_FILE_MAGIC << (quint32) INDEX_FILE_VERSION;
+    ds << this->_basePath;
+
+    // entries
+    ds << (quint32) this->entriesHash.size();
+    for (QHash<QString, Entry>::const_iterator it = this->entriesHash.constBegin(); it != this->entriesHash.constEnd(); ++it) {
+        const Entry &e = it.value();
+        ds << e.filePath << e.isValid << e.typeId << e.typeName << e.color;
+        ds << (qint32) e.countParameters << (qint32) e.countInputs << (qint32) e.countOutputs;
+        ds << e.lastModified << e.size;
+    }
+
+    if (ds.status() != QDataStream::Ok) {
+        f.cancelWriting();
+        return false;
+    }
+
+    return f.commit();
+}
+
+bool libblockdia::BlockLibraryIndex::parseEntry(QIODevice *dev, libblockdia::BlockLibraryIndex::Entry *entry)
+{
+    QXmlStreamReader xml(dev);
+
+    entry->isValid = false;
+    entry->typeId = "";
+    entry->typeName = "";
+    entry->color = QColor("#fff");
+    entry->countParameters = 0;
+    entry->countInputs = 0;
+    entry->countOutputs = 0;
+
+    // find block definition root element
+    if (!xml.readNextStartElement()) return false;
+    if (xml.name() != "BlockDef" || xml.attributes().value("version") != "1") return false;
+
+    // read block definition
+    while (xml.readNextStartElement()) {
+
+        // read header
+        if (xml.name() == "TypeName") {
+            entry->typeName = xml.readElementText(QXmlStreamReader::SkipChildElements);
+        } else if (xml.name() == "TypeId") {
+            entry->typeId = xml.readElementText(QXmlStreamReader::SkipChildElements);
+        } else if (xml.name() == "Color") {
+            entry->color = QColor(xml.readElementText(QXmlStreamReader::SkipChildElements));
+        }
+
+        // count parameters
+        else if (xml.name() == "Parameters") {
+            while (xml.readNextStartElement()) {
+                if (xml.attributes().hasAttribute("type")) ++entry->countParameters;
+                xml.skipCurrentElement();
+            }
+        }
+
+        // count inputs
+        else if (xml.name() == "Inputs") {
+            while (xml.readNextStartElement()) {
+                if (xml.name() == "Input") ++entry->countInputs;
+                xml.skipCurrentElement();
+            }
+        }
+
+        // count outputs
+        else if (xml.name() == "Outputs") {
+            while (xml.readNextStartElement()) {
+                if (xml.name() == "Output") ++entry->countOutputs;
+                xml.skipCurrentElement();
+            }
+        }
+
+        // unknown tag
+        else {
+            xml.skipCurrentElement();
+        }
+    }
+
+    entry->isValid = !xml.hasError();
+    return entry->isValid;
+}
@@ -0,0 +1,203 @@
+#include "blocklibraryloader.h"
+
+#include <QFile>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QMetaObject>
+#include <QBuffer>
+#include <QHash>
+
+#include <blocklibrarypack.h>
+#include <blocktrace.h>
+
+// maximum number of blocks that are created within one event loop cycle
+#define BLOCKS_PER_CYCLE 64
+
+namespace libblockdia {
+
+/**
+ * @brief A worker job that parses one block definition file into plain data.
+ */
+class BlockLibraryLoaderJob : public QRunnable
+{
+public:
+    BlockLibraryLoaderJob(BlockLibraryLoader *loader, int generation, const QString &filePath, const QByteArray &compressedData = QByteArray())
+    {
+        this->loader = loader;
+        this->generation = generation;
+        this->filePath = filePath;
+        this->compressedData = compressedData;
+    }
+
+    void run()
+    {
+        BLOCKDIA_TRACE_SCOPE("BlockLibraryLoaderJob::run");
+        BlockLibraryLoader::Result result;
+        result.generation = this->generation;
+        result.filePath = this->filePath;
+        result.isValid = false;
+        bool isCanceled = this->loader->generation.load() != this->generation;
+
+        // parse block definition from pack (skipped when canceled)
+        if (!isCanceled && !this->compressedData.isEmpty()) {
+            QByteArray content = qUncompress(this->compressedData);
+            QBuffer buffer(&content);
+            if (buffer.open(QIODevice::ReadOnly)) {
+                result.isValid = BlockData::parseBlockDef(&buffer, &result.data);
+            }
+        }
+
+        // parse file (skipped when canceled)
+        else if (!isCanceled) {
+            QFile f(this->filePath);
+            if (f.open(QIODevice::ReadOnly)) {
+                result.isValid = BlockData::parseBlockDef(&f, &result.data);
+                f.close();
+            }
+        }
+
+        this->loader->addResult(result);
+    }
+
+private:
+    BlockLibraryLoader *loader;
+    int generation;
+    QString filePath;
+    QByteArray compressedData;
+};
+
+} // namespace libblockdia
+
+libblockdia::BlockLibraryLoader::BlockLibraryLoader(QObject *parent) : QObject(parent)
+{
+    this->threadPool = new QThreadPool(this);
+    this->countPendingJobs = 0;
+    this->generation.store(0);
+}
+
+libblockdia::BlockLibraryLoader::~BlockLibraryLoader()
+{
+    // jobs reference this object
+    this->cancel();
+    this->threadPool->waitForDone();
+}
+
+void libblockdia::BlockLibraryLoader::setMaxThreadCount(int count)
+{
+    this->threadPool->setMaxThreadCount(count);
+}
+
+void libblockdia::BlockLibraryLoader::load(const QStringList &filePaths)
+{
+    BLOCKDIA_TRACE_SCOPE("BlockLibraryLoader::load");
+    int generation = this->generation.load();
+    this->countPendingJobs += filePaths.size();
+
+    // every pack is opened only once
+    QHash<QString, BlockLibraryPack *> packs;
+
+    // start a job for every file
+    for (int i=0; i < filePaths.size(); ++i) {
+        QString packFilePath, entryPath;
+
+        // block definitions in packs are read here (one seek each)
+        // and uncompressed and parsed by the job
+        if (BlockLibraryPack::splitPackPath(filePaths.at(i), &packFilePath, &entryPath)) {
+            BlockLibraryPack *pack = packs.value(packFilePath, Q_NULLPTR);
+            if (!pack) {
+                pack = new BlockLibraryPack();
+                pack->open(packFilePath);
+                packs.insert(packFilePath, pack);
+            }
+            QByteArray compressedData = pack->compressedBlockDef(entryPath);
+            if (compressedData.isEmpty()) {
+                Result result;
+                result.generation = generation;
+                result.filePath = filePaths.at(i);
+                result.isValid = false;
+                this->addResult(result);
+            } else {
+                this->threadPool->start(new BlockLibraryLoaderJob(this, generation, filePaths.at(i), compressedData));
+            }
+        }
+
+        // normal files are read by the job
+        else {
+            this->threadPool->start(new BlockLibraryLoaderJob(this, generation, filePaths.at(i)));
+        }
+    }
+    qDeleteAll(packs);
+
+    // nothing to do
+    if (this->countPendingJobs == 0) {
+        QMetaObject::invokeMethod(this, "signalFinished", Qt::QueuedConnection);
+    }
+}
+
+void libblockdia::BlockLibraryLoader::cancel()
+{
+    // results of the running jobs are recognized by their old generation
+    this->generation.fetchAndAddOrdered(1);
+    this->countPendingJobs = 0;
+}
+
+bool libblockdia::BlockLibraryLoader::isRunning()
+{
+    return this->countPendingJobs > 0;
+}
+
+void libblockdia::BlockLibraryLoader::addResult(const libblockdia::BlockLibraryLoader::Result &result)
+{
+    QMutexLocker locker(&this->resultsMutex);
+    this->results.append(result);
+
+    // the first result of a portion triggers the collection in the loader thread
+    if (this->results.size() == 1) {
+        QMetaObject::invokeMethod(this, "slotCollectResults", Qt::QueuedConnection);
+    }
+}
+
+void libblockdia::BlockLibraryLoader::slotCollectResults()
+{
+    // take a portion of results
+    QList<Result> portion;
+    bool moreResults = false;
+    {
+        QMutexLocker locker(&this->resultsMutex);
+        int count = qMin(this->results.size(), BLOCKS_PER_CYCLE);
+        portion = this->results.mid(0, count);
+        this->results.erase(this->results.begin(), this->results.begin() + count);
+        moreResults = this->results.size() > 0;
+    }
+
+    // continue in next event loop cycle to keep the thread responsive
+    if (moreResults) {
+        QMetaObject::invokeMethod(this, "slotCollectResults", Qt::QueuedConnection);
+    }
+
+    // create blocks (results of canceled loads are dropped silently)
+    int generation = this->generation.load();
+    int countProcessed = 0;
+    for (int i=0; i < portion.size(); ++i) {
+        const Result &r = portion.at(i);
+        if (r.generation != this->generation.load()) {
+            continue;
+        } else if (r.isValid) {
+            Block *block = Block::importBlockData(r.data);
+            emit signalBlockLoaded(r.filePath, block);
+        } else {
+            emit signalLoadFailed(r.filePath);
+        }
+        ++countProcessed;
+    }
+
+    // check if all files are processed
+    // (unless a receiver has canceled the load in the meantime)
+    if (countProcessed > 0 && generation == this->generation.load()) {
+        this->countPendingJobs -= countProcessed;
+        if (this->countPendingJobs <= 0) {
+            this->countPendingJobs = 0;
+            emit signalFinished();
+        }
+    }
+}
@@ -0,0 +1,236 @@
+#include "blocklibrarypack.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QBuffer>
+
+// file format identification of pack files
+#define PACK_FILE_MAGIC   0x4244504b
+#define PACK_FILE_VERSION 1
+#define PACK_FILE_SUFFIX  ".bdpack"
+
+libblockdia::BlockLibraryPack::BlockLibraryPack()
+{
+    this->dataOffset = 0;
+}
+
+libblockdia::BlockLibraryPack::~BlockLibraryPack()
+{
+    this->close();
+}
+
+bool libblockdia::BlockLibraryPack::open(const QString &packFilePath)
+{
+    this->close();
+
+    this->packFile.setFileName(packFilePath);
+    if (!this->packFile.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream ds(&this->packFile);
+    ds.setVersion(QDataStream::Qt_5_6);
+
+    // check file header
+    quint32 magic, version;
+    ds >> magic >> version;
+    if (magic != PACK_FILE_MAGIC || version != PACK_FILE_VERSION) {
+        qWarning() << "BlockLibraryPack: unsupported pack file" << packFilePath;
+        this->close();
+        return false;
+    }
+
+    // read directory
+    quint32 count;
+    ds >> count;
+    this->directory.reserve(count);
+    this->locationsByPath.reserve(count);
+    for (quint32 i=0; i < count && ds.status() == QDataStream::Ok; ++i) {
+        BlockLibraryIndex::Entry e;
+        Location l;
+        qint32 countParameters, countInputs, countOutputs;
+        ds >> e.filePath >> e.typeId >> e.typeName >> e.color;
+        ds >> countParameters >> countInputs >> countOutputs;
+        ds >> e.lastModified >> e.size;
+        ds >> l.offset >> l.size;
+        e.isValid = true;
+        e.countParameters = countParameters;
+        e.countInputs = countInputs;
+        e.countOutputs = countOutputs;
+        this->directory.append(e);
+        this->locationsByPath.insert(e.filePath, l);
+        if (!this->pathsByTypeId.contains(e.typeId)) this->pathsByTypeId.insert(e.typeId, e.filePath);
+    }
+
+    if (ds.status() != QDataStream::Ok) {
+        qWarning() << "BlockLibraryPack: corrupt pack file" << packFilePath;
+        this->close();
+        return false;
+    }
+
+    // block definitions are stored behind the directory
+    this->dataOffset = this->packFile.pos();
+    return true;
+}
+
+void libblockdia::BlockLibraryPack::close()
+{
+    if (this->packFile.isOpen()) this->packFile.close();
+    this->dataOffset = 0;
+    this->directory.clear();
+    this->locationsByPath.clear();
+    this->pathsByTypeId.clear();
+}
+
+bool libblockdia::BlockLibraryPack::isOpen()
+{
+    return this->packFile.isOpen();
+}
+
+QList<libblockdia::BlockLibraryIndex::Entry> libblockdia::BlockLibraryPack::entries()
+{
+    return this->directory;
+}
+
+QByteArray libblockdia::BlockLibraryPack::blockDef(const QString &filePath)
+{
+    QByteArray compressed = this->compressedBlockDef(filePath);
+    if (compressed.isEmpty()) return QByteArray();
+    return qUncompress(compressed);
+}
+
+QByteArray libblockdia::BlockLibraryPack::blockDefByTypeId(const QString &typeId)
+{
+    QHash<QString, QString>::const_iterator it = this->pathsByTypeId.constFind(typeId);
+    if (it == this->pathsByTypeId.constEnd()) return QByteArray();
+    return this->blockDef(it.value());
+}
+
+QByteArray libblockdia::BlockLibraryPack::compressedBlockDef(const QString &filePath)
+{
+    QHash<QString, Location>::const_iterator it = this->locationsByPath.constFind(filePath);
+    if (it == this->locationsByPath.constEnd() || !this->packFile.isOpen()) return QByteArray();
+
+    // one seek and one read
+    if (!this->packFile.seek(this->dataOffset + it.value().offset)) return QByteArray();
+    return this->packFile.read(it.value().size);
+}
+
+bool libblockdia::BlockLibraryPack::create(const QString &packFilePath, const QString &basePath)
+{
+    QDir baseDir(basePath);
+    if (!baseDir.exists()) return false;
+
+    // read and compress all block definitions
+    QList<BlockLibraryIndex::Entry> entries;
+    QList<QByteArray> blobs;
+    QDirIterator it(basePath, QStringList("*.xml"), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        QFileInfo fi = it.fileInfo();
+
+        // read file
+        QFile f(fi.filePath());
+        if (!f.open(QIODevice::ReadOnly)) continue;
+        QByteArray content = f.readAll();
+        f.close();
+
+        // only valid block definitions are packed
+        BlockLibraryIndex::Entry e;
+        QBuffer buffer(&content);
+        buffer.open(QIODevice::ReadOnly);
+        if (!BlockLibraryIndex::parseEntry(&buffer, &e)) continue;
+        e.filePath = baseDir.relativeFilePath(fi.filePath());
+        e.lastModified = fi.lastModified().toMSecsSinceEpoch();
+        e.size = fi.size();
+
+        entries.append(e);
+        blobs.append(qCompress(content));
+    }
+
+    // write pack file
+    QSaveFile f(packFilePath);
+    if (!f.open(QIODevice::WriteOnly)) return false;
+    QDataStream ds(&f);
+    ds.setVersion(QDataStream::Qt_5_6);
+
+    // file header
+    ds << (quint32) PACK_FILE_MAGIC << (quint32) PACK_FILE_VERSION;
+
+    // directory (offsets are relative to the end of the directory)
+    ds << (quint32) entries.size();
+    qint64 offset = 0;
+    for (int i=0; i < entries.size(); ++i) {
+        const BlockLibraryIndex::Entry &e = entries.at(i);
+        ds << e.filePath << e.typeId << e.typeName << e.color;
+        ds << (qint32) e.countParameters << (qint32) e.countInputs << (qint32) e.countOutputs;
+        ds << e.lastModified << e.size;
+        ds << offset << (qint64) blobs.at(i).size();
+        offset += blobs.at(i).size();
+    }
+
+    // block definitions
+    for (int i=0; i < blobs.size(); ++i) {
+        ds.writeRawData(blobs.at(i).constData(), blobs.at(i).size());
+    }
+
+    if (ds.status() != QDataStream::Ok) {
+        f.cancelWriting();
+        return false;
+    }
+
+    return f.commit();
+}
+
+bool libblockdia::BlockLibraryPack::isPackFile(const QString &filePath)
+{
+    return filePath.endsWith(PACK_FILE_SUFFIX, Qt::CaseInsensitive);
+}
+
+bool libblockdia::BlockLibraryPack::splitPackPath(const QString &path, QString *packFilePath, QString *entryPath)
+{
+    QString p = QDir::fromNativeSeparators(path);
+
+    // find a pack file within the path
+    QString marker = QString(PACK_FILE_SUFFIX) + "/";
+    int idx = p.indexOf(marker, 0, Qt::CaseInsensitive);
+    while (idx >= 0) {
+        QString packPath = p.left(idx + marker.size() - 1);
+        if (QFileInfo(packPath).isFile()) {
+            if (packFilePath) *packFilePath = packPath;
+            if (entryPath) *entryPath = p.mid(idx + marker.size());
+            return true;
+        }
+        idx = p.indexOf(marker, idx + 1, Qt::CaseInsensitive);
+    }
+
+    return false;
+}
+
+QIODevice *libblockdia::BlockLibraryPack::openBlockDef(const QString &path)
+{
+    QString packFilePath, entryPath;
+
+    // block definition within a pack
+    if (splitPackPath(path, &packFilePath, &entryPath)) {
+        BlockLibraryPack pack;
+        if (!pack.open(packFilePath)) return Q_NULLPTR;
+        QByteArray data = pack.blockDef(entryPath);
+        if (data.isEmpty()) return Q_NULLPTR;
+        QBuffer *buffer = new QBuffer();
+        buffer->setData(data);
+        buffer->open(QIODevice::ReadOnly);
+        return buffer;
+    }
+
+    // normal file
+    QFile *f = new QFile(path);
+    if (!f->open(QIODevice::ReadOnly)) {
+        delete f;
+        return Q_NULLPTR;
+    }
+    return f;
+}
@@ -0,0 +1,158 @@
+#include "blockmemory.h"
+
+#include <QFile>
+
+#if defined(Q_OS_LINUX)
+#  include <unistd.h>
+#elif defined(Q_OS_WIN)
+#  include <windows.h>
+#  include <psapi.h>
+#elif defined(Q_OS_MACOS)
+#  include <mach/mach.h>
+#endif
+
+// header of the heap data of strings, byte arrays and lists (QArrayData, QListData::Data)
+#define MEMORY_ARRAY_HEADER 24
+
+libblockdia::BlockMemory::BlockMemory()
+{
+    for (int i=0; i < CategoryCount; ++i) {
+        this->usages[i].bytes = 0;
+        this->usages[i].count = 0;
+    }
+}
+
+void libblockdia::BlockMemory::addObject(Category category, qint64 bytes)
+{
+    this->usages[category].bytes += bytes;
+    this->usages[category].count += 1;
+}
+
+void libblockdia::BlockMemory::addBytes(Category category, qint64 bytes)
+{
+    this->usages[category].bytes += bytes;
+}
+
+void libblockdia::BlockMemory::addSharedBytes(Category category, const void *data, qint64 bytes)
+{
+    if (this->isNewSharedData(data)) this->addBytes(category, bytes);
+}
+
+void libblockdia::BlockMemory::addString(Category category, const QString &str)
+{
+    // the shared null and empty strings are not allocated
+    if (str.capacity() == 0) return;
+    if (!this->isNewSharedData(const_cast<QString &>(str).data_ptr())) return;
+    this->addObject(category, MEMORY_ARRAY_HEADER + (str.capacity() + 1) * (qint64) sizeof(QChar));
+}
+
+void libblockdia::BlockMemory::addStringList(Category category, const QStringList &list)
+{
+    if (list.isEmpty()) return;
+
+    // the list storage is shared between copies of the list
+    if (this->isNewSharedData(&(*list.constBegin()))) {
+        this->addBytes(category, MEMORY_ARRAY_HEADER + list.size() * (qint64) sizeof(void *));
+    }
+    for (int i=0; i < list.size(); ++i) this->addString(category, list.at(i));
+}
+
+void libblockdia::BlockMemory::addByteArray(Category category, const QByteArray &data)
+{
+    if (data.capacity() == 0) return;
+    if (!this->isNewSharedData(const_cast<QByteArray &>(data).data_ptr())) return;
+    this->addBytes(category, MEMORY_ARRAY_HEADER + data.capacity() + 1);
+}
+
+void libblockdia::BlockMemory::addBlockData(Category category, const BlockData &data)
+{
+    this->addString(category, data.typeId);
+    this->addString(category, data.typeName);
+    this->addString(category, data.instanceId);
+    this->addString(category, data.instanceName);
+    this->addStringList(category, data.inputs);
+    this->addStringList(category, data.outputs);
+
+    // parameters are stored as pointers to heap allocated elements
+    if (data.parameters.isEmpty()) return;
+    if (!this->isNewSharedData(&(*data.parameters.constBegin()))) return;
+    this->addBytes(category, MEMORY_ARRAY_HEADER + data.parameters.size() * (qint64) (sizeof(void *) + sizeof(BlockParameterData)));
+    for (int i=0; i < data.parameters.size(); ++i) {
+        const BlockParameterData &param = data.parameters.at(i);
+        this->addString(category, param.type);
+        this->addString(category, param.name);
+        this->addString(category, param.defaultValue);
+        this->addString(category, param.value);
+        this->addString(category, param.expression);
+        this->addString(category, param.elementType);
+        this->addStringList(category, param.enumItems);
+    }
+}
+
+libblockdia::BlockMemory::Usage libblockdia::BlockMemory::usage(Category category) const
+{
+    return this->usages[category];
+}
+
+qint64 libblockdia::BlockMemory::totalBytes() const
+{
+    qint64 bytes = 0;
+    for (int i=0; i < CategoryCount; ++i) bytes += this->usages[i].bytes;
+    return bytes;
+}
+
+libblockdia::BlockMemory &libblockdia::BlockMemory::operator+=(const libblockdia::BlockMemory &other)
+{
+    for (int i=0; i < CategoryCount; ++i) {
+        this->usages[i].bytes += other.usages[i].bytes;
+        this->usages[i].count += other.usages[i].count;
+    }
+    this->sharedData.unite(other.sharedData);
+    return *this;
+}
+
+QString libblockdia::BlockMemory::categoryName(Category category)
+{
+    switch (category) {
+    case Blocks:        return "Blocks";
+    case Parameters:    return "Parameters";
+    case Inputs:        return "Inputs";
+    case Outputs:       return "Outputs";
+    case Strings:       return "Strings";
+    case EnumItems:     return "Enum Items";
+    case Caches:        return "Caches";
+    case GraphicItems:  return "Graphic Items";
+    case CategoryCount: break;
+    }
+    return QString();
+}
+
+qint64 libblockdia::BlockMemory::processResidentBytes()
+{
+#if defined(Q_OS_LINUX)
+    // the second field of statm are the resident pages
+    QFile f("/proc/self/statm");
+    if (!f.open(QIODevice::ReadOnly)) return -1;
+    QList<QByteArray> fields = f.readAll().split(' ');
+    if (fields.size() < 2) return -1;
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return -1;
+    return counters.WorkingSetSize;
+#elif defined(Q_OS_MACOS)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS) return -1;
+    return info.resident_size;
+#else
+    return -1;
+#endif
+}
+
+bool libblockdia::BlockMemory::isNewSharedData(const void *data)
+{
+    if (this->sharedData.contains(data)) return false;
+    this->sharedData.insert(data);
+    return true;
+}
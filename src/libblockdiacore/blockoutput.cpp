@@ -34,11 +34,3 @@ void libblockdia::BlockOutput::parseBlockDef(QXmlStreamReader *xml, QObject *par
        xml->skipCurrentElement();
     }
 }
-
-bool libblockdia::BlockOutput::exportBlockDef(QXmlStreamWriter *xml)
-{
-    xml->writeStartElement("Output");
-    xml->writeAttribute("name", this->name());
-    xml->writeEndElement();
-    return xml->hasError();
-}
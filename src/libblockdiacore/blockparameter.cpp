@@ -0,0 +1,154 @@
+#include "blockparameter.h"
+
+#include <QDebug>
+#include "blockparameterint.h"
+#include "blockparameterstr.h"
+#include "blockparameterenum.h"
+#include "blockparameterarray.h"
+
+libblockdia::BlockParameter::BlockParameter(const QString &name, QObject *parent) : QObject(parent)
+{
+    this->_name = name;
+    this->_isPublic = false;
+    this->isSnapshotValid = false;
+    connect(this, SIGNAL(somethingHasChanged()), this, SLOT(invalidateCache()));
+}
+
+QString libblockdia::BlockParameter::name()
+{
+    return this->_name;
+}
+
+void libblockdia::BlockParameter::setName(QString name)
+{
+    bool emitSignal = this->_name != name;
+    this->_name = name;
+    if (emitSignal) emit somethingHasChanged();
+}
+
+bool libblockdia::BlockParameter::isPublic()
+{
+    return this->_isPublic;
+}
+
+void libblockdia::BlockParameter::setPublic(bool isPublic)
+{
+    bool emitSignal = this->_isPublic != isPublic;
+    this->_isPublic = isPublic;
+    if (emitSignal) emit somethingHasChanged();
+}
+
+QString libblockdia::BlockParameter::expression()
+{
+    return this->_expression;
+}
+
+void libblockdia::BlockParameter::setExpression(const QString &expression)
+{
+    QString e = expression.trimmed();
+    bool emitSignal = this->_expression != e;
+    this->_expression = e;
+    if (emitSignal) emit somethingHasChanged();
+}
+
+QString libblockdia::BlockParameter::displayValue()
+{
+    return this->strValue();
+}
+
+void libblockdia::BlockParameter::importBlockDef(QXmlStreamReader *xml, QObject *parent)
+{
+    Q_ASSERT(xml->isStartElement() && xml->name() == "Parameters");
+
+    // the parameters are created from the same plain data as parsed by BlockData::parseBlockDef()
+    while (xml->readNextStartElement()) {
+        BlockParameterData data;
+        if (BlockParameterData::parseParamDef(xml, &data)) importBlockData(data, parent);
+    }
+}
+
+libblockdia::BlockParameter *libblockdia::BlockParameter::importBlockData(const libblockdia::BlockParameterData &data, QObject *parent)
+{
+    BlockParameter *param = Q_NULLPTR;
+
+    // create parameter
+    if (data.type == "int") {
+        param = new BlockParameterInt(data.name, parent);
+    } else if (data.type == "enum") {
+        param = new BlockParameterEnum(data.name, parent);
+    } else if (data.type == "str") {
+        param = new BlockParameterStr(data.name, parent);
+    } else if (data.type == "array") {
+        param = new BlockParameterArray(data.name, parent);
+    } else {
+        qWarning() << "BlockParameter::importBlockData: unknown parameter type" << data.type;
+        return Q_NULLPTR;
+    }
+
+    // set values for parameter
+    param->importParamData(data);
+    param->setPublic(data.isPublic);
+    param->setDefaultValue(data.defaultValue);
+    param->setExpression(data.expression);
+    if (!data.value.isNull()) param->setValue(data.value);
+
+    return param;
+}
+
+void libblockdia::BlockParameter::exportBlockData(libblockdia::BlockParameterData *data)
+{
+    // standard data
+    data->type = this->type();
+    data->name = this->name();
+    data->isPublic = this->isPublic();
+    data->defaultValue = this->strDefaultValue();
+    data->value = this->strValue();
+    data->expression = this->expression();
+
+    // export parameter specific data
+    this->exportParamData(data);
+}
+
+libblockdia::BlockParameterData libblockdia::BlockParameter::snapshot()
+{
+    if (!this->isSnapshotValid) {
+        BlockParameterData data;
+        this->exportBlockData(&data);
+        this->cachedSnapshot = data;
+        this->isSnapshotValid = true;
+    }
+    return this->cachedSnapshot;
+}
+
+QByteArray libblockdia::BlockParameter::contentHash()
+{
+    if (this->cachedContentHash.isEmpty()) {
+        this->cachedContentHash = this->snapshot().contentHash();
+    }
+    return this->cachedContentHash;
+}
+
+void libblockdia::BlockParameter::addMemoryUsage(libblockdia::BlockMemory *usage)
+{
+    usage->addObject(BlockMemory::Parameters, sizeof(BlockParameter) + BlockMemory::QObjectPrivateBytes);
+    usage->addString(BlockMemory::Strings, this->_name);
+    usage->addString(BlockMemory::Strings, this->_expression);
+
+    // caches
+    usage->addByteArray(BlockMemory::Caches, this->cachedContentHash);
+    if (this->isSnapshotValid) {
+        const BlockParameterData &data = this->cachedSnapshot;
+        usage->addString(BlockMemory::Caches, data.type);
+        usage->addString(BlockMemory::Caches, data.name);
+        usage->addString(BlockMemory::Caches, data.defaultValue);
+        usage->addString(BlockMemory::Caches, data.value);
+        usage->addString(BlockMemory::Caches, data.expression);
+        usage->addStringList(BlockMemory::Caches, data.enumItems);
+    }
+}
+
+void libblockdia::BlockParameter::invalidateCache()
+{
+    this->cachedContentHash.clear();
+    this->isSnapshotValid = false;
+}
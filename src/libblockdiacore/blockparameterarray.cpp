@@ -0,0 +1,361 @@
+#include "blockparameterarray.h"
+#include <QDebug>
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <limits.h>
+
+// names of the element types in block definitions
+#define ARRAY_ELEMENT_TYPE_INT "int"
+#define ARRAY_ELEMENT_TYPE_DOUBLE "double"
+
+namespace {
+
+/*
+ * Range checks over all elements.
+ * The loops are branch-free (no early exit, comparisons combined bitwise),
+ * so the compiler vectorizes them (several elements per instruction).
+ * NaN elements are out of range, because all comparisons with NaN are false.
+ */
+
+template<typename T> int countOutOfRange(const T *data, int count, T min, T max)
+{
+    int n = 0;
+    for (int i=0; i < count; ++i) n += 1 - ((data[i] >= min) & (data[i] <= max));
+    return n;
+}
+
+template<typename T> void clipToRange(T *data, int count, T min, T max)
+{
+    for (int i=0; i < count; ++i) {
+        T v = data[i];
+        v = (v >= min) ? v : min;
+        v = (v <= max) ? v : max;
+        data[i] = v;
+    }
+}
+
+// the integer range that is within the element range
+qint32 intMinimum(double min)
+{
+    if (!(min > INT_MIN)) return INT_MIN;
+    if (min > INT_MAX) return INT_MAX;
+    return (qint32) std::ceil(min);
+}
+
+qint32 intMaximum(double max)
+{
+    if (!(max < INT_MAX)) return INT_MAX;
+    if (max < INT_MIN) return INT_MIN;
+    return (qint32) std::floor(max);
+}
+
+// converting the elements between host and little endian byte order (in place, symmetric)
+void swapToLittleEndian(QByteArray *elements, int elementSize)
+{
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    uchar *d = (uchar *) elements->data();
+    for (int i=0; i + elementSize <= elements->size(); i += elementSize) {
+        if (elementSize == 4) qToLittleEndian(qFromUnaligned<quint32>(d + i), d + i);
+        else qToLittleEndian(qFromUnaligned<quint64>(d + i), d + i);
+    }
+#else
+    Q_UNUSED(elements);
+    Q_UNUSED(elementSize);
+#endif
+}
+
+} // namespace
+
+libblockdia::BlockParameterArray::BlockParameterArray(const QString &name, QObject *parent) : BlockParameter(name, parent)
+{
+    this->_elementType = Double;
+    this->_minimum = std::numeric_limits<double>::lowest();
+    this->_maximum = std::numeric_limits<double>::max();
+}
+
+QString libblockdia::BlockParameterArray::type()
+{
+    return QString("array");
+}
+
+libblockdia::BlockParameterArray::ElementType libblockdia::BlockParameterArray::elementType()
+{
+    return this->_elementType;
+}
+
+void libblockdia::BlockParameterArray::setElementType(libblockdia::BlockParameterArray::ElementType type)
+{
+    if (this->_elementType == type) return;
+
+    // convert the elements
+    QVector<double> values = this->toValues(this->_value);
+    QVector<double> defaultValues = this->toValues(this->_defaultValue);
+    this->_elementType = type;
+    this->_value.clear();
+    this->_defaultValue.clear();
+    this->setElements(&this->_value, values);
+    this->setElements(&this->_defaultValue, defaultValues);
+
+    emit somethingHasChanged();
+}
+
+QString libblockdia::BlockParameterArray::elementTypeName(libblockdia::BlockParameterArray::ElementType type)
+{
+    return QString((type == Int) ? ARRAY_ELEMENT_TYPE_INT : ARRAY_ELEMENT_TYPE_DOUBLE);
+}
+
+bool libblockdia::BlockParameterArray::elementTypeFromName(const QString &name, libblockdia::BlockParameterArray::ElementType *type)
+{
+    QString n = name.trimmed().toLower();
+    if (n == ARRAY_ELEMENT_TYPE_INT) *type = Int;
+    else if (n == ARRAY_ELEMENT_TYPE_DOUBLE) *type = Double;
+    else return false;
+    return true;
+}
+
+int libblockdia::BlockParameterArray::elementSize(libblockdia::BlockParameterArray::ElementType type)
+{
+    return (type == Int) ? sizeof(qint32) : sizeof(double);
+}
+
+double libblockdia::BlockParameterArray::minimum()
+{
+    return this->_minimum;
+}
+
+void libblockdia::BlockParameterArray::setMinimum(double min)
+{
+    if (this->_minimum != min) {
+        this->_minimum = min;
+        this->setElements(&this->_value, this->_value); // update for limit adjust
+        this->setElements(&this->_defaultValue, this->_defaultValue);
+        emit somethingHasChanged();
+    }
+}
+
+double libblockdia::BlockParameterArray::maximum()
+{
+    return this->_maximum;
+}
+
+void libblockdia::BlockParameterArray::setMaximum(double max)
+{
+    if (this->_maximum != max) {
+        this->_maximum = max;
+        this->setElements(&this->_value, this->_value); // update for limit adjust
+        this->setElements(&this->_defaultValue, this->_defaultValue);
+        emit somethingHasChanged();
+    }
+}
+
+void libblockdia::BlockParameterArray::setRange(double min, double max)
+{
+    if (this->_minimum != min || this->_maximum != max) {
+        this->_minimum = min;
+        this->_maximum = max;
+        this->setElements(&this->_value, this->_value); // update for limit adjust
+        this->setElements(&this->_defaultValue, this->_defaultValue);
+        emit somethingHasChanged();
+    }
+}
+
+int libblockdia::BlockParameterArray::count()
+{
+    return this->_value.size() / elementSize(this->_elementType);
+}
+
+double libblockdia::BlockParameterArray::valueAt(int index)
+{
+    Q_ASSERT(index >= 0 && index < this->count());
+    if (this->_elementType == Int) return ((const qint32 *) this->_value.constData())[index];
+    return ((const double *) this->_value.constData())[index];
+}
+
+QVector<double> libblockdia::BlockParameterArray::values()
+{
+    return this->toValues(this->_value);
+}
+
+bool libblockdia::BlockParameterArray::setValues(const QVector<double> &values)
+{
+    return this->setElements(&this->_value, values);
+}
+
+QVector<double> libblockdia::BlockParameterArray::defaultValues()
+{
+    return this->toValues(this->_defaultValue);
+}
+
+bool libblockdia::BlockParameterArray::setDefaultValues(const QVector<double> &values)
+{
+    return this->setElements(&this->_defaultValue, values);
+}
+
+QString libblockdia::BlockParameterArray::strDefaultValue()
+{
+    return this->encode(this->_defaultValue);
+}
+
+bool libblockdia::BlockParameterArray::setDefaultValue(QString value)
+{
+    QByteArray raw;
+    if (!this->decode(value, &raw)) return false;
+    return this->setElements(&this->_defaultValue, raw);
+}
+
+bool libblockdia::BlockParameterArray::setValue(QString value)
+{
+    QByteArray raw;
+    if (!this->decode(value, &raw)) return false;
+    return this->setElements(&this->_value, raw);
+}
+
+QString libblockdia::BlockParameterArray::strValue()
+{
+    return this->encode(this->_value);
+}
+
+QString libblockdia::BlockParameterArray::displayValue()
+{
+    return QString("[%1 x %2]").arg(this->count()).arg(elementTypeName(this->_elementType));
+}
+
+libblockdia::BlockParameterValue libblockdia::BlockParameterArray::typedValue()
+{
+    return BlockParameterValue::fromString(this->strValue());
+}
+
+bool libblockdia::BlockParameterArray::setTypedValue(const libblockdia::BlockParameterValue &value)
+{
+    if (value.type() != BlockParameterValue::String) return false;
+    return this->setValue(value.toString());
+}
+
+libblockdia::BlockParameterValue libblockdia::BlockParameterArray::typedDefaultValue()
+{
+    return BlockParameterValue::fromString(this->strDefaultValue());
+}
+
+bool libblockdia::BlockParameterArray::setTypedDefaultValue(const libblockdia::BlockParameterValue &value)
+{
+    if (value.type() != BlockParameterValue::String) return false;
+    return this->setDefaultValue(value.toString());
+}
+
+QString libblockdia::BlockParameterArray::allowedValues()
+{
+    if (this->_elementType == Int) {
+        return QString("int elements %1 .. %2").arg(intMinimum(this->_minimum)).arg(intMaximum(this->_maximum));
+    }
+    return QString("double elements %1 .. %2").arg(this->_minimum).arg(this->_maximum);
+}
+
+bool libblockdia::BlockParameterArray::importParamData(const libblockdia::BlockParameterData &data)
+{
+    ElementType type;
+    bool ok = elementTypeFromName(data.elementType, &type);
+    this->setElementType(ok ? type : Double);
+    this->setRange(data.elementMinimum, data.elementMaximum);
+    return ok;
+}
+
+bool libblockdia::BlockParameterArray::exportParamData(libblockdia::BlockParameterData *data)
+{
+    data->elementType = elementTypeName(this->_elementType);
+    data->elementMinimum = this->_minimum;
+    data->elementMaximum = this->_maximum;
+    return true;
+}
+
+void libblockdia::BlockParameterArray::addMemoryUsage(libblockdia::BlockMemory *usage)
+{
+    BlockParameter::addMemoryUsage(usage);
+    usage->addBytes(BlockMemory::Parameters, sizeof(BlockParameterArray) - sizeof(BlockParameter));
+    usage->addByteArray(BlockMemory::Strings, this->_value);
+    usage->addByteArray(BlockMemory::Strings, this->_defaultValue);
+}
+
+bool libblockdia::BlockParameterArray::setElements(QByteArray *elements, QByteArray raw)
+{
+    bool ret = true;
+    int n = raw.size() / elementSize(this->_elementType);
+
+    // the data is only written (detached) if an element is out of range
+    if (this->_elementType == Int) {
+        qint32 min = intMinimum(this->_minimum);
+        qint32 max = intMaximum(this->_maximum);
+        if (countOutOfRange((const qint32 *) raw.constData(), n, min, max) > 0) {
+            clipToRange((qint32 *) raw.data(), n, min, max);
+            ret = false;
+        }
+    } else {
+        if (countOutOfRange((const double *) raw.constData(), n, this->_minimum, this->_maximum) > 0) {
+            clipToRange((double *) raw.data(), n, this->_minimum, this->_maximum);
+            ret = false;
+        }
+    }
+
+    // set new elements
+    if (*elements != raw) {
+        *elements = raw;
+        emit somethingHasChanged();
+    }
+
+    return ret;
+}
+
+bool libblockdia::BlockParameterArray::setElements(QByteArray *elements, const QVector<double> &values)
+{
+    bool ret = true;
+    QByteArray raw;
+
+    if (this->_elementType == Int) {
+        // round (out of range elements are clipped by setElements())
+        raw.resize(values.size() * sizeof(qint32));
+        qint32 *d = (qint32 *) raw.data();
+        for (int i=0; i < values.size(); ++i) {
+            double v = std::round(values.at(i));
+            if (v != values.at(i)) ret = false;
+            d[i] = (v > INT_MIN) ? ((v < INT_MAX) ? (qint32) v : INT_MAX) : INT_MIN;
+            if (d[i] != v) ret = false;
+        }
+    } else {
+        raw = QByteArray((const char *) values.constData(), values.size() * sizeof(double));
+    }
+
+    ret &= this->setElements(elements, raw);
+    return ret;
+}
+
+QVector<double> libblockdia::BlockParameterArray::toValues(const QByteArray &elements)
+{
+    QVector<double> values;
+    if (this->_elementType == Int) {
+        int n = elements.size() / sizeof(qint32);
+        const qint32 *d = (const qint32 *) elements.constData();
+        values.resize(n);
+        for (int i=0; i < n; ++i) values[i] = d[i];
+    } else {
+        int n = elements.size() / sizeof(double);
+        values.resize(n);
+        memcpy(values.data(), elements.constData(), n * sizeof(double));
+    }
+    return values;
+}
+
+QString libblockdia::BlockParameterArray::encode(const QByteArray &elements)
+{
+    QByteArray littleEndian = elements;
+    swapToLittleEndian(&littleEndian, elementSize(this->_elementType));
+    return QString::fromLatin1(littleEndian.toBase64());
+}
+
+bool libblockdia::BlockParameterArray::decode(const QString &value, QByteArray *raw)
+{
+    *raw = QByteArray::fromBase64(value.trimmed().toLatin1());
+    if (raw->size() % elementSize(this->_elementType) != 0) return false;
+    swapToLittleEndian(raw, elementSize(this->_elementType));
+    return true;
+}
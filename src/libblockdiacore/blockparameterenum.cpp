@@ -0,0 +1,250 @@
+#include "blockparameterenum.h"
+#include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWeakPointer>
+#include <limits.h>
+
+// estimated size of a QHash<QString, int> node (next, hash, key, value)
+#define ENUM_HASH_NODE_BYTES 24
+
+namespace libblockdia {
+
+/*
+ * A table of enum items.
+ * Interned tables are immutable and shared between parameters (see internEnumItems()),
+ * only a table that is used by a single parameter is extended (see addEnumItem()).
+ */
+struct BlockParameterEnumItems
+{
+    QStringList items;
+    QHash<QString, int> indices;    // the first index of every item
+};
+
+} // namespace libblockdia
+
+namespace {
+
+/*
+ * All item tables that are currently in use, by their item list.
+ * The tables are not owned by the registry, they remove themselves when the last parameter releases them.
+ */
+struct EnumItemsRegistry
+{
+    QMutex mutex;
+    QHash<QStringList, QWeakPointer<const libblockdia::BlockParameterEnumItems> > tables;
+};
+
+EnumItemsRegistry *enumItemsRegistry()
+{
+    // never destroyed, parameters may be released after static destruction
+    static EnumItemsRegistry *r = new EnumItemsRegistry;
+    return r;
+}
+
+void releaseEnumItems(const libblockdia::BlockParameterEnumItems *table)
+{
+    EnumItemsRegistry *r = enumItemsRegistry();
+    {
+        // the entry may already be replaced by a new table for the same items
+        QMutexLocker locker(&r->mutex);
+        QHash<QStringList, QWeakPointer<const libblockdia::BlockParameterEnumItems> >::iterator it = r->tables.find(table->items);
+        if (it != r->tables.end() && it.value().isNull()) r->tables.erase(it);
+    }
+    delete table;
+}
+
+QSharedPointer<const libblockdia::BlockParameterEnumItems> internEnumItems(const QStringList &items)
+{
+    EnumItemsRegistry *r = enumItemsRegistry();
+
+    // use an existing table
+    {
+        QMutexLocker locker(&r->mutex);
+        QSharedPointer<const libblockdia::BlockParameterEnumItems> table = r->tables.value(items).toStrongRef();
+        if (table) return table;
+    }
+
+    // build a new table (outside of the lock, lists can be long)
+    libblockdia::BlockParameterEnumItems *newTable = new libblockdia::BlockParameterEnumItems;
+    newTable->items = items;
+    newTable->indices.reserve(items.size());
+    for (int i=0; i < items.size(); ++i) {
+        if (!newTable->indices.contains(items.at(i))) newTable->indices.insert(items.at(i), i);
+    }
+    QSharedPointer<const libblockdia::BlockParameterEnumItems> table(newTable, releaseEnumItems);
+
+    // another thread may have registered the same items meanwhile
+    // (the unused new table is released after the lock)
+    QMutexLocker locker(&r->mutex);
+    QSharedPointer<const libblockdia::BlockParameterEnumItems> existing = r->tables.value(items).toStrongRef();
+    if (existing) return existing;
+    r->tables.insert(items, table.toWeakRef());
+    return table;
+}
+
+} // namespace
+
+libblockdia::BlockParameterEnum::BlockParameterEnum(const QString &name, QObject *parent) : BlockParameter(name, parent)
+{
+    this->items = internEnumItems(QStringList());
+    this->isItemsShared = true;
+    this->_valueIndex = -1;
+    this->_defaultIndex = -1;
+}
+
+QString libblockdia::BlockParameterEnum::type()
+{
+    return QString("enum");
+}
+
+QString libblockdia::BlockParameterEnum::strDefaultValue()
+{
+    return (this->_defaultIndex >= 0) ? this->items->items.at(this->_defaultIndex) : QString("");
+}
+
+bool libblockdia::BlockParameterEnum::setDefaultValue(QString value)
+{
+    int index = this->indexOfEnumItem(value);
+    if (index < 0) return false;
+    return this->setDefaultIndex(index);
+}
+
+bool libblockdia::BlockParameterEnum::setValue(QString value)
+{
+    int index = this->indexOfEnumItem(value);
+    if (index < 0) return false;
+    return this->setValueIndex(index);
+}
+
+QString libblockdia::BlockParameterEnum::strValue()
+{
+    return (this->_valueIndex >= 0) ? this->items->items.at(this->_valueIndex) : QString("");
+}
+
+libblockdia::BlockParameterValue libblockdia::BlockParameterEnum::typedValue()
+{
+    return BlockParameterValue::fromEnumIndex(this->_valueIndex);
+}
+
+bool libblockdia::BlockParameterEnum::setTypedValue(const libblockdia::BlockParameterValue &value)
+{
+    if (value.type() == BlockParameterValue::String) return this->setValue(value.toString());
+    if (value.type() != BlockParameterValue::EnumIndex) return false;
+    return this->setValueIndex(value.toEnumIndex());
+}
+
+libblockdia::BlockParameterValue libblockdia::BlockParameterEnum::typedDefaultValue()
+{
+    return BlockParameterValue::fromEnumIndex(this->_defaultIndex);
+}
+
+bool libblockdia::BlockParameterEnum::setTypedDefaultValue(const libblockdia::BlockParameterValue &value)
+{
+    if (value.type() == BlockParameterValue::String) return this->setDefaultValue(value.toString());
+    if (value.type() != BlockParameterValue::EnumIndex) return false;
+    return this->setDefaultIndex(value.toEnumIndex());
+}
+
+QString libblockdia::BlockParameterEnum::allowedValues()
+{
+    return this->items->items.join(", ");
+}
+
+bool libblockdia::BlockParameterEnum::addEnumItem(const QString &item)
+{
+    if (this->items->indices.contains(item)) return false;
+
+    // shared tables are immutable, the table of this parameter is extended in place
+    if (this->isItemsShared) {
+        this->items = QSharedPointer<const BlockParameterEnumItems>(new BlockParameterEnumItems(*this->items));
+        this->isItemsShared = false;
+    }
+    BlockParameterEnumItems *table = (BlockParameterEnumItems *) this->items.data();
+    table->indices.insert(item, table->items.size());
+    table->items.append(item);
+
+    emit somethingHasChanged();
+    return true;
+}
+
+QStringList libblockdia::BlockParameterEnum::enumItems()
+{
+    return this->items->items;
+}
+
+bool libblockdia::BlockParameterEnum::setEnumItems(QStringList items)
+{
+    if (this->items->items == items) return true;
+
+    // keep the selected items by name
+    QString value = this->strValue();
+    QString defaultValue = this->strDefaultValue();
+    this->items = internEnumItems(items);
+    this->isItemsShared = true;
+    this->_valueIndex = this->indexOfEnumItem(value);
+    this->_defaultIndex = this->indexOfEnumItem(defaultValue);
+    if (this->_defaultIndex < 0 && this->items->items.size() > 0) this->_defaultIndex = 0;
+
+    emit somethingHasChanged();
+    return true;
+}
+
+int libblockdia::BlockParameterEnum::indexOfEnumItem(const QString &item)
+{
+    return this->items->indices.value(item, -1);
+}
+
+int libblockdia::BlockParameterEnum::valueIndex()
+{
+    return this->_valueIndex;
+}
+
+bool libblockdia::BlockParameterEnum::setValueIndex(int index)
+{
+    if (index < 0 || index >= this->items->items.size()) return false;
+    if (this->_valueIndex != index) {
+        this->_valueIndex = index;
+        emit somethingHasChanged();
+    }
+    return true;
+}
+
+int libblockdia::BlockParameterEnum::defaultIndex()
+{
+    return this->_defaultIndex;
+}
+
+bool libblockdia::BlockParameterEnum::setDefaultIndex(int index)
+{
+    if (index < 0 || index >= this->items->items.size()) return false;
+    if (this->_defaultIndex != index) {
+        this->_defaultIndex = index;
+        emit somethingHasChanged();
+    }
+    return true;
+}
+
+bool libblockdia::BlockParameterEnum::importParamData(const libblockdia::BlockParameterData &data)
+{
+    return this->setEnumItems(data.enumItems);
+}
+
+bool libblockdia::BlockParameterEnum::exportParamData(libblockdia::BlockParameterData *data)
+{
+    data->enumItems = this->enumItems();
+    return true;
+}
+
+void libblockdia::BlockParameterEnum::addMemoryUsage(libblockdia::BlockMemory *usage)
+{
+    // the item table is shared, so it is only counted once per accounting
+    const BlockParameterEnumItems *table = this->items.data();
+    usage->addStringList(BlockMemory::EnumItems, table->items);
+    usage->addSharedBytes(BlockMemory::EnumItems, table, sizeof(BlockParameterEnumItems)
+                          + table->indices.size() * (qint64) ENUM_HASH_NODE_BYTES
+                          + table->indices.capacity() * (qint64) sizeof(void *));
+    BlockParameter::addMemoryUsage(usage);
+    usage->addBytes(BlockMemory::Parameters, sizeof(BlockParameterEnum) - sizeof(BlockParameter));
+}
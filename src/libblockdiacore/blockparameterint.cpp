@@ -10,6 +10,11 @@ libblockdia::BlockParameterInt::BlockParameterInt(const QString &name, QObject *
     this->_defaultValue = this->_value;
 }
 
+QString libblockdia::BlockParameterInt::type()
+{
+    return QString("int");
+}
+
 int libblockdia::BlockParameterInt::minimum()
 {
     return this->_minimum;
@@ -115,47 +120,45 @@ QString libblockdia::BlockParameterInt::strValue()
     return QString::number(this->_value);
 }
 
-QString libblockdia::BlockParameterInt::allowedValues()
+libblockdia::BlockParameterValue libblockdia::BlockParameterInt::typedValue()
 {
-    return QString::number(this->_minimum) + " .. " + QString::number(this->_maximum);
+    return BlockParameterValue::fromInt(this->_value);
 }
 
-bool libblockdia::BlockParameterInt::importParamDef(QXmlStreamReader *xml)
+bool libblockdia::BlockParameterInt::setTypedValue(const libblockdia::BlockParameterValue &value)
 {
-    while (xml->readNextStartElement()) {
-
-        // read min
-        if (xml->name() == "Min") {
-            QString t = xml->readElementText(QXmlStreamReader::SkipChildElements);
-            bool ok;
-            int i = t.toInt(&ok);
-            if (ok) this->setMinimum(i);
-        }
+    if (value.type() != BlockParameterValue::Int) return false;
+    return this->setValue(value.toInt());
+}
 
-        // read max
-        else if (xml->name() == "Max") {
-            QString t = xml->readElementText(QXmlStreamReader::SkipChildElements);
-            bool ok;
-            int i = t.toInt(&ok);
-            if (ok) this->setMaximum(i);
-        }
+libblockdia::BlockParameterValue libblockdia::BlockParameterInt::typedDefaultValue()
+{
+    return BlockParameterValue::fromInt(this->_defaultValue);
+}
 
-        else {
-            xml->skipCurrentElement();
-            qWarning() << "ERROR Parsing XML: unknown element (at line" << xml->lineNumber() << ")";
-        }
+bool libblockdia::BlockParameterInt::setTypedDefaultValue(const libblockdia::BlockParameterValue &value)
+{
+    if (value.type() != BlockParameterValue::Int) return false;
+    return this->setDefaultValue(value.toInt());
+}
 
-    }
+QString libblockdia::BlockParameterInt::allowedValues()
+{
+    return QString::number(this->_minimum) + " .. " + QString::number(this->_maximum);
+}
 
-    return xml->hasError();
+bool libblockdia::BlockParameterInt::importParamData(const libblockdia::BlockParameterData &data)
+{
+    this->setMinimum(data.minimum);
+    this->setMaximum(data.maximum);
+    return true;
 }
 
-bool libblockdia::BlockParameterInt::exportParamDef(QXmlStreamWriter *xml)
+bool libblockdia::BlockParameterInt::exportParamData(libblockdia::BlockParameterData *data)
 {
-    // specific sub elements
-    xml->writeTextElement("Min", QString::number(this->minimum()));
-    xml->writeTextElement("Max", QString::number(this->maximum()));
-    return xml->hasError();
+    data->minimum = this->minimum();
+    data->maximum = this->maximum();
+    return true;
 }
 
 void libblockdia::BlockParameterInt::setMaximum(int max)
@@ -166,3 +169,9 @@ void libblockdia::BlockParameterInt::setMaximum(int max)
         emit somethingHasChanged();
     }
 }
+
+void libblockdia::BlockParameterInt::addMemoryUsage(libblockdia::BlockMemory *usage)
+{
+    BlockParameter::addMemoryUsage(usage);
+    usage->addBytes(BlockMemory::Parameters, sizeof(BlockParameterInt) - sizeof(BlockParameter));
+}
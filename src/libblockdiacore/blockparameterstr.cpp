@@ -0,0 +1,88 @@
+#include "blockparameterstr.h"
+#include <QDebug>
+
+libblockdia::BlockParameterStr::BlockParameterStr(const QString &name, QObject *parent) : BlockParameter(name, parent)
+{
+    this->_value = "";
+    this->_defaultValue = "";
+}
+
+QString libblockdia::BlockParameterStr::type()
+{
+    return QString("str");
+}
+
+QString libblockdia::BlockParameterStr::strDefaultValue()
+{
+    return this->_defaultValue;
+}
+
+bool libblockdia::BlockParameterStr::setDefaultValue(QString value)
+{
+    if (this->_defaultValue != value) {
+        this->_defaultValue = value;
+        emit somethingHasChanged();
+    }
+    return true;
+}
+
+bool libblockdia::BlockParameterStr::setValue(QString value)
+{
+    if (this->_value != value) {
+        this->_value = value;
+        emit somethingHasChanged();
+    }
+    return true;
+}
+
+QString libblockdia::BlockParameterStr::strValue()
+{
+    return this->_value;
+}
+
+libblockdia::BlockParameterValue libblockdia::BlockParameterStr::typedValue()
+{
+    return BlockParameterValue::fromString(this->_value);
+}
+
+bool libblockdia::BlockParameterStr::setTypedValue(const libblockdia::BlockParameterValue &value)
+{
+    if (value.type() != BlockParameterValue::String) return false;
+    return this->setValue(value.toString());
+}
+
+libblockdia::BlockParameterValue libblockdia::BlockParameterStr::typedDefaultValue()
+{
+    return BlockParameterValue::fromString(this->_defaultValue);
+}
+
+bool libblockdia::BlockParameterStr::setTypedDefaultValue(const libblockdia::BlockParameterValue &value)
+{
+    if (value.type() != BlockParameterValue::String) return false;
+    return this->setDefaultValue(value.toString());
+}
+
+QString libblockdia::BlockParameterStr::allowedValues()
+{
+    return QString("arbitrary string");
+}
+
+bool libblockdia::BlockParameterStr::importParamData(const libblockdia::BlockParameterData &data)
+{
+    Q_UNUSED(data);
+    return true;
+}
+
+bool libblockdia::BlockParameterStr::exportParamData(libblockdia::BlockParameterData *data)
+{
+    Q_UNUSED(data);
+    return true;
+}
+
+void libblockdia::BlockParameterStr::addMemoryUsage(libblockdia::BlockMemory *usage)
+{
+    usage->addString(BlockMemory::Strings, this->_value);
+    usage->addString(BlockMemory::Strings, this->_defaultValue);
+    BlockParameter::addMemoryUsage(usage);
+    usage->addBytes(BlockMemory::Parameters, sizeof(BlockParameterStr) - sizeof(BlockParameter));
+}
@@ -0,0 +1,91 @@
+#include "blockparametervalue.h"
+
+libblockdia::BlockParameterValue::BlockParameterValue()
+{
+    this->_type = Invalid;
+    this->number.f = 0;
+}
+
+libblockdia::BlockParameterValue libblockdia::BlockParameterValue::fromInt(int value)
+{
+    BlockParameterValue v;
+    v._type = Int;
+    v.number.i = value;
+    return v;
+}
+
+libblockdia::BlockParameterValue libblockdia::BlockParameterValue::fromString(const QString &value)
+{
+    BlockParameterValue v;
+    v._type = String;
+    v.str = value;
+    return v;
+}
+
+libblockdia::BlockParameterValue libblockdia::BlockParameterValue::fromEnumIndex(int index)
+{
+    BlockParameterValue v;
+    v._type = EnumIndex;
+    v.number.i = index;
+    return v;
+}
+
+libblockdia::BlockParameterValue libblockdia::BlockParameterValue::fromFloat(double value)
+{
+    BlockParameterValue v;
+    v._type = Float;
+    v.number.f = value;
+    return v;
+}
+
+libblockdia::BlockParameterValue::Type libblockdia::BlockParameterValue::type() const
+{
+    return this->_type;
+}
+
+bool libblockdia::BlockParameterValue::isValid() const
+{
+    return this->_type != Invalid;
+}
+
+int libblockdia::BlockParameterValue::toInt(bool *ok) const
+{
+    if (ok) *ok = this->_type == Int;
+    return (this->_type == Int) ? this->number.i : 0;
+}
+
+QString libblockdia::BlockParameterValue::toString(bool *ok) const
+{
+    if (ok) *ok = this->_type == String;
+    return (this->_type == String) ? this->str : QString();
+}
+
+int libblockdia::BlockParameterValue::toEnumIndex(bool *ok) const
+{
+    if (ok) *ok = this->_type == EnumIndex;
+    return (this->_type == EnumIndex) ? this->number.i : -1;
+}
+
+double libblockdia::BlockParameterValue::toFloat(bool *ok) const
+{
+    if (ok) *ok = this->_type == Float;
+    return (this->_type == Float) ? this->number.f : 0;
+}
+
+bool libblockdia::BlockParameterValue::operator==(const libblockdia::BlockParameterValue &other) const
+{
+    if (this->_type != other._type) return false;
+    switch (this->_type) {
+    case Invalid:   return true;
+    case Int:
+    case EnumIndex: return this->number.i == other.number.i;
+    case String:    return this->str == other.str;
+    case Float:     return this->number.f == other.number.f;
+    }
+    return false;
+}
+
+bool libblockdia::BlockParameterValue::operator!=(const libblockdia::BlockParameterValue &other) const
+{
+    return !(*this == other);
+}
@@ -0,0 +1,121 @@
+#include "blocksaver.h"
+
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QCryptographicHash>
+
+#include <blockdefwriter.h>
+#include <blocktrace.h>
+
+// hash of written files (to recognize own writes)
+#define WRITTEN_HASH_ALGORITHM QCryptographicHash::Sha1
+
+namespace libblockdia {
+
+/**
+ * @brief A worker job that writes the newest snapshot of one file.
+ */
+class BlockSaverJob : public QRunnable
+{
+public:
+    BlockSaverJob(BlockSaver *saver, const QString &filePath)
+    {
+        this->saver = saver;
+        this->filePath = filePath;
+    }
+
+    void run()
+    {
+        BLOCKDIA_TRACE_SCOPE("BlockSaverJob::run");
+        // the snapshot may already be written by a previous job
+        BlockData snapshot;
+        if (!this->saver->takeSnapshot(this->filePath, &snapshot)) return;
+
+        // serialize
+        // (the pool threads keep their writer, so the buffer is reused by the following jobs)
+        BlockDefWriter *writer = BlockDefWriter::threadWriter();
+        writer->setAutoFormatting(true);
+        if (!writer->write(snapshot)) {
+            emit this->saver->signalSaved(this->filePath, false, writer->errorString());
+            return;
+        }
+
+        // replace the file atomically
+        // (the content is remembered before, the file system may notify about the new file at once)
+        this->saver->setWrittenContent(this->filePath, writer->buffer());
+        QSaveFile f(this->filePath);
+        if (!f.open(QIODevice::WriteOnly) || f.write(writer->buffer()) != writer->buffer().size() || !f.commit()) {
+            QString errorString = f.errorString();
+            f.cancelWriting();
+            this->saver->setWrittenContent(this->filePath, QByteArray());
+            emit this->saver->signalSaved(this->filePath, false, errorString);
+            return;
+        }
+
+        emit this->saver->signalSaved(this->filePath, true, QString());
+    }
+
+private:
+    BlockSaver *saver;
+    QString filePath;
+};
+
+} // namespace libblockdia
+
+libblockdia::BlockSaver::BlockSaver(QObject *parent) : QObject(parent)
+{
+    // one thread writes all files in order
+    this->threadPool = new QThreadPool(this);
+    this->threadPool->setMaxThreadCount(1);
+}
+
+libblockdia::BlockSaver::~BlockSaver()
+{
+    // jobs reference this object and unsaved data must not be lost
+    this->threadPool->waitForDone();
+}
+
+void libblockdia::BlockSaver::save(const libblockdia::BlockData &snapshot, const QString &filePath)
+{
+    QMutexLocker locker(&this->pendingMutex);
+
+    // a job for this file is already waiting, it will write the newest snapshot
+    bool isScheduled = this->pendingSnapshots.contains(filePath);
+    this->pendingSnapshots.insert(filePath, snapshot);
+    if (!isScheduled) this->threadPool->start(new BlockSaverJob(this, filePath));
+}
+
+bool libblockdia::BlockSaver::isRunning()
+{
+    QMutexLocker locker(&this->pendingMutex);
+    return !this->pendingSnapshots.isEmpty() || this->threadPool->activeThreadCount() > 0;
+}
+
+void libblockdia::BlockSaver::waitForFinished()
+{
+    this->threadPool->waitForDone();
+}
+
+bool libblockdia::BlockSaver::takeSnapshot(const QString &filePath, libblockdia::BlockData *snapshot)
+{
+    QMutexLocker locker(&this->pendingMutex);
+    if (!this->pendingSnapshots.contains(filePath)) return false;
+    *snapshot = this->pendingSnapshots.take(filePath);
+    return true;
+}
+
+bool libblockdia::BlockSaver::isWrittenContent(const QString &filePath, const QByteArray &content)
+{
+    QByteArray hash = QCryptographicHash::hash(content, WRITTEN_HASH_ALGORITHM);
+    QMutexLocker locker(&this->pendingMutex);
+    return this->writtenContentHashes.value(filePath) == hash;
+}
+
+void libblockdia::BlockSaver::setWrittenContent(const QString &filePath, const QByteArray &content)
+{
+    QByteArray hash = (content.isNull()) ? QByteArray() : QCryptographicHash::hash(content, WRITTEN_HASH_ALGORITHM);
+    QMutexLocker locker(&this->pendingMutex);
+    if (hash.isEmpty()) this->writtenContentHashes.remove(filePath);
+    else this->writtenContentHashes.insert(filePath, hash);
+}
@@ -0,0 +1,280 @@
+#include "blocktrace.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+// the per-thread buffers grow in chunks (chunks are only freed by the owning thread or when the thread has finished)
+#define TRACE_CHUNK_SIZE 16384
+#define TRACE_MAX_CHUNKS 64
+#define TRACE_MAX_EVENTS_PER_THREAD (TRACE_CHUNK_SIZE * TRACE_MAX_CHUNKS)
+
+namespace {
+
+struct TraceEvent
+{
+    const char *name;
+    qint64 startNs;
+    qint64 durationNs;
+};
+
+/*
+ * The events of one thread.
+ * Only the owning thread appends events, it publishes them by increasing count (release),
+ * so readers see all events below count (acquire) without locking.
+ * Only the owning thread resets count and frees chunks, while holding the registry mutex.
+ */
+struct TraceBuffer
+{
+    int tid;
+    QString threadName;
+    QAtomicInt count;
+    QAtomicInt first;           // events below are cleared
+    QAtomicInt countDropped;
+    int clearGeneration;        // the registry clear generation of the last reset (owning thread)
+    bool isFinished;            // the thread has ended (guarded by the registry mutex)
+    TraceEvent *chunks[TRACE_MAX_CHUNKS];
+};
+
+struct TraceRegistry
+{
+    QMutex mutex;
+    QVector<TraceBuffer*> buffers;
+    QAtomicInt enabled;
+    QAtomicInt clearGeneration; // increased by every clear()
+    int nextTid;
+    QElapsedTimer timer;
+};
+
+TraceRegistry *registry()
+{
+    // never destroyed, threads may record until the process ends
+    static TraceRegistry *r = []() {
+        TraceRegistry *reg = new TraceRegistry;
+        reg->nextTid = 1;
+        reg->timer.start();
+        return reg;
+    }();
+    return r;
+}
+
+void freeChunks(TraceBuffer *buffer)
+{
+    for (int i=0; i < TRACE_MAX_CHUNKS; ++i) {
+        delete[] buffer->chunks[i];
+        buffer->chunks[i] = Q_NULLPTR;
+    }
+}
+
+/*
+ * Marks the buffer as finished when the thread ends,
+ * it is kept (for writing the trace) until the next clear().
+ */
+struct ThreadBuffer
+{
+    TraceBuffer *buffer = Q_NULLPTR;
+
+    ~ThreadBuffer()
+    {
+        if (!this->buffer) return;
+        TraceRegistry *r = registry();
+        QMutexLocker locker(&r->mutex);
+        this->buffer->isFinished = true;
+    }
+};
+
+thread_local ThreadBuffer currentBuffer;
+
+TraceBuffer *registerThread()
+{
+    TraceRegistry *r = registry();
+    TraceBuffer *buffer = new TraceBuffer;
+    for (int i=0; i < TRACE_MAX_CHUNKS; ++i) buffer->chunks[i] = Q_NULLPTR;
+    buffer->isFinished = false;
+
+    QMutexLocker locker(&r->mutex);
+    buffer->clearGeneration = r->clearGeneration.load();
+    buffer->tid = r->nextTid++;
+    QThread *thread = QThread::currentThread();
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) buffer->threadName = "main";
+    else if (thread && !thread->objectName().isEmpty()) buffer->threadName = QString("%1 %2").arg(thread->objectName()).arg(buffer->tid);
+    else buffer->threadName = QString("thread %1").arg(buffer->tid);
+    r->buffers.append(buffer);
+    return buffer;
+}
+
+void appendJsonString(QByteArray *json, const QByteArray &text)
+{
+    json->append('"');
+    for (int i=0; i < text.size(); ++i) {
+        char c = text.at(i);
+        if (c == '"' || c == '\\') json->append('\\');
+        if ((unsigned char) c < 0x20) json->append(' ');
+        else json->append(c);
+    }
+    json->append('"');
+}
+
+QByteArray microseconds(qint64 ns)
+{
+    return QByteArray::number(ns / 1000.0, 'f', 3);
+}
+
+} // namespace
+
+bool libblockdia::BlockTrace::isAvailable()
+{
+#if defined(BLOCKDIA_TRACING)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void libblockdia::BlockTrace::setEnabled(bool enabled)
+{
+    registry()->enabled.storeRelease(enabled ? 1 : 0);
+}
+
+bool libblockdia::BlockTrace::isEnabled()
+{
+    return registry()->enabled.load() != 0;
+}
+
+void libblockdia::BlockTrace::clear()
+{
+    TraceRegistry *r = registry();
+    QMutexLocker locker(&r->mutex);
+
+    // the owning threads reset their buffers on their next event
+    r->clearGeneration.ref();
+
+    for (int i = r->buffers.size() - 1; i >= 0; --i) {
+        TraceBuffer *buffer = r->buffers.at(i);
+
+        // nobody writes into the buffers of finished threads anymore
+        if (buffer->isFinished) {
+            freeChunks(buffer);
+            delete buffer;
+            r->buffers.remove(i);
+            continue;
+        }
+
+        buffer->first.storeRelease(buffer->count.loadAcquire());
+        buffer->countDropped.storeRelease(0);
+    }
+}
+
+int libblockdia::BlockTrace::countEvents()
+{
+    TraceRegistry *r = registry();
+    QMutexLocker locker(&r->mutex);
+    int count = 0;
+    for (int i=0; i < r->buffers.size(); ++i) {
+        count += r->buffers.at(i)->count.loadAcquire() - r->buffers.at(i)->first.loadAcquire();
+    }
+    return count;
+}
+
+int libblockdia::BlockTrace::countDroppedEvents()
+{
+    TraceRegistry *r = registry();
+    QMutexLocker locker(&r->mutex);
+    int count = 0;
+    for (int i=0; i < r->buffers.size(); ++i) count += r->buffers.at(i)->countDropped.loadAcquire();
+    return count;
+}
+
+bool libblockdia::BlockTrace::writeChromeTrace(QIODevice *dev)
+{
+    if (!dev || !dev->isWritable()) return false;
+
+    // the lock keeps the buffers and their chunks alive (recording goes on without locking)
+    TraceRegistry *r = registry();
+    QMutexLocker locker(&r->mutex);
+    const QVector<TraceBuffer*> &buffers = r->buffers;
+
+    QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    QByteArray json;
+    json.reserve(1 << 16);
+    json.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool firstEvent = true;
+
+    for (int b=0; b < buffers.size(); ++b) {
+        TraceBuffer *buffer = buffers.at(b);
+        QByteArray tid = QByteArray::number(buffer->tid);
+
+        // thread name (metadata event)
+        if (!firstEvent) json.append(",\n");
+        firstEvent = false;
+        json.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + tid + ",\"args\":{\"name\":");
+        appendJsonString(&json, buffer->threadName.toUtf8());
+        json.append("}}");
+
+        // complete events
+        int count = buffer->count.loadAcquire();
+        for (int i = buffer->first.loadAcquire(); i < count; ++i) {
+            const TraceEvent &event = buffer->chunks[i / TRACE_CHUNK_SIZE][i % TRACE_CHUNK_SIZE];
+            json.append(",\n{\"name\":");
+            appendJsonString(&json, QByteArray(event.name));
+            json.append(",\"cat\":\"blockdia\",\"ph\":\"X\",\"ts\":" + microseconds(event.startNs));
+            json.append(",\"dur\":" + microseconds(event.durationNs));
+            json.append(",\"pid\":" + pid + ",\"tid\":" + tid + "}");
+
+            // write in pieces
+            if (json.size() > (1 << 16)) {
+                if (dev->write(json) != json.size()) return false;
+                json.clear();
+            }
+        }
+    }
+
+    json.append("\n]}\n");
+    return dev->write(json) == json.size();
+}
+
+void libblockdia::BlockTrace::record(const char *name, qint64 startNs, qint64 endNs)
+{
+    TraceRegistry *r = registry();
+    TraceBuffer *buffer = currentBuffer.buffer;
+    if (!buffer) {
+        buffer = registerThread();
+        currentBuffer.buffer = buffer;
+    }
+
+    // start over after clear() (the chunks are allocated again on demand)
+    int clearGeneration = r->clearGeneration.loadAcquire();
+    if (buffer->clearGeneration != clearGeneration) {
+        QMutexLocker locker(&r->mutex);
+        freeChunks(buffer);
+        buffer->count.storeRelease(0);
+        buffer->first.storeRelease(0);
+        buffer->clearGeneration = clearGeneration;
+    }
+
+    // only this thread writes count
+    int index = buffer->count.load();
+    if (index >= TRACE_MAX_EVENTS_PER_THREAD) {
+        buffer->countDropped.ref();
+        return;
+    }
+
+    // a new chunk is published together with its first event
+    TraceEvent *&chunk = buffer->chunks[index / TRACE_CHUNK_SIZE];
+    if (!chunk) chunk = new TraceEvent[TRACE_CHUNK_SIZE];
+
+    TraceEvent &event = chunk[index % TRACE_CHUNK_SIZE];
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+    buffer->count.storeRelease(index + 1);
+}
+
+qint64 libblockdia::BlockTrace::now()
+{
+    return registry()->timer.nsecsElapsed();
+}
@@ -0,0 +1,113 @@
+TEMPLATE = lib
+
+# VERSION = Major . Minor . Patch
+VERSION = 0.0.0
+
+# defining Qt modules
+# the core library does not depend on QtWidgets,
+# QtGui is only needed for QColor
+QT = core
+QT += gui
+
+# specify the target filename
+# for debug version a "_d" is appended
+CONFIG(debug, debug|release) {
+    TARGET = libblockdiacore_d
+} else {
+    TARGET = libblockdiacore
+}
+
+# define output directories
+DESTDIR = $$PWD/../../bin
+CONFIG(debug, debug|release) {
+    MOC_DIR     = $$PWD/../../build/$${TARGET}_debug/
+    OBJECTS_DIR = $$PWD/../../build/$${TARGET}_debug/
+    RCC_DIR     = $$PWD/../../build/$${TARGET}_debug/
+    UI_DIR      = $$PWD/../../build/$${TARGET}_debug/
+}
+CONFIG(release, debug|release) {
+    MOC_DIR     = $$PWD/../../build/$${TARGET}_release/
+    OBJECTS_DIR = $$PWD/../../build/$${TARGET}_release/
+    RCC_DIR     = $$PWD/../../build/$${TARGET}_release/
+    UI_DIR      = $$PWD/../../build/$${TARGET}_release/
+}
+
+
+DEFINES += LIBBLOCKDIACORE_LIBRARY
+
+# trace points are compiled in with "CONFIG+=blockdia_tracing" (see blocktrace.h)
+blockdia_tracing {
+    DEFINES += BLOCKDIA_TRACING
+}
+
+# The following define makes your compiler emit warnings if you use
+# any feature of Qt which as been marked as deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# You can also make your code fail to compile if you use deprecated APIs.
+# In order to do so, uncomment the following line.
+# You can also select to disable deprecated APIs only up to a certain version of Qt.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+# the header files are put into separate directory
+# for easier deployment of the library
+INCLUDEPATH += ../../include/
+
+SOURCES +=  \
+            block.cpp \
+            blockinput.cpp \
+            blockoutput.cpp \
+            blockparameter.cpp \
+            blockparameterenum.cpp \
+            blockparameterint.cpp \
+            blockparameterstr.cpp \
+            blockparameterarray.cpp \
+            blockparametervalue.cpp \
+            blocklibraryindex.cpp \
+            blockdata.cpp \
+            blocklibraryloader.cpp \
+            blocklibrarypack.cpp \
+            blockdefwriter.cpp \
+            blocksaver.cpp \
+            blockjournal.cpp \
+            blockgenerator.cpp \
+            blocktrace.cpp \
+            blockmemory.cpp \
+            blockexpression.cpp \
+            blockexpressiongraph.cpp
+
+HEADERS +=  ../../include/libglobals.h \
+            ../../include/libblockdiacore.h \
+            ../../include/block.h \
+            ../../include/blockinput.h \
+            ../../include/blockoutput.h \
+            ../../include/blockparameter.h \
+            ../../include/blockparameterenum.h \
+            ../../include/blockparameterint.h \
+            ../../include/blockparameterstr.h \
+            ../../include/blockparameterarray.h \
+            ../../include/blockparametervalue.h \
+            ../../include/blocklibraryindex.h \
+            ../../include/blockdata.h \
+            ../../include/blocklibraryloader.h \
+            ../../include/blocklibrarypack.h \
+            ../../include/blockdefwriter.h \
+            ../../include/blocksaver.h \
+            ../../include/blockjournal.h \
+            ../../include/blockgenerator.h \
+            ../../include/blocktrace.h \
+            ../../include/blockmemory.h \
+            ../../include/blockexpression.h \
+            ../../include/blockexpressiongraph.h
+
+# resident memory of the process (see BlockMemory::processResidentBytes())
+win32 {
+    LIBS += -lpsapi
+}
+
+unix {
+    target.path = /usr/lib
+    INSTALLS += target
+}
@@ -45,9 +45,9 @@ FORMS    +=  mainwindow.ui
 
 # include library
 CONFIG(debug, debug|release) {
-    LIBS += -L$$PWD/../../bin/ -llibblockdia_d
+    LIBS += -L$$PWD/../../bin/ -llibblockdia_d -llibblockdiacore_d
 } else {
-    LIBS += -L$$PWD/../../bin/ -llibblockdia
+    LIBS += -L$$PWD/../../bin/ -llibblockdia -llibblockdiacore
 }
 INCLUDEPATH += ../../include/
 DEPENDPATH += $$PWD/../../build
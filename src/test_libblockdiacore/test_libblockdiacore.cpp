@@ -0,0 +1,741 @@
+#include <QtTest>
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <limits>
+#include <limits.h>
+
+#include <libblockdiacore.h>
+
+using namespace libblockdia;
+
+/**
+ * @brief Unit tests of the libblockdia core library.
+ *
+ * Run with "test_libblockdiacore" (or "./make.py test" to run all tests).
+ */
+class TestLibBlockDiaCore : public QObject
+{
+    Q_OBJECT
+
+private:
+
+    static BlockData generateBlockData(int countElements)
+    {
+        BlockGenerator generator;
+        generator.setParameterCount(countElements, countElements);
+        generator.setInputCount(countElements, countElements);
+        generator.setOutputCount(countElements, countElements);
+        return generator.generateBlock(0);
+    }
+
+    static QByteArray toXml(const BlockData &data)
+    {
+        BlockDefWriter writer;
+        if (!writer.write(data)) return QByteArray();
+        return writer.buffer();
+    }
+
+    // a block with int parameters (range 0..1000) and their expressions (empty for plain parameters)
+    static Block *createExpressionBlock(const QStringList &names, const QStringList &expressions)
+    {
+        BlockData data;
+        data.typeId = "EXPR";
+        data.instanceId = "E1";
+        for (int i=0; i < names.size(); ++i) {
+            BlockParameterData param;
+            param.type = "int";
+            param.name = names.at(i);
+            param.minimum = 0;
+            param.maximum = 1000;
+            param.defaultValue = "0";
+            param.value = "0";
+            param.expression = expressions.at(i);
+            data.parameters.append(param);
+        }
+        return Block::importBlockData(data);
+    }
+
+    static BlockParameterInt *intParameter(Block *block, const QString &name)
+    {
+        return qobject_cast<BlockParameterInt *>(block->getParameter(name));
+    }
+
+    static bool writeFile(const QString &filePath, const QByteArray &content)
+    {
+        QFileInfo(filePath).dir().mkpath(".");
+        QFile f(filePath);
+        if (!f.open(QIODevice::WriteOnly)) return false;
+        return f.write(content) == content.size();
+    }
+
+    static QByteArray readFile(const QString &filePath)
+    {
+        QFile f(filePath);
+        if (!f.open(QIODevice::ReadOnly)) return QByteArray();
+        return f.readAll();
+    }
+
+private slots:
+
+    // ---- CBOR ----
+
+    void cborRoundTrip_data()
+    {
+        QTest::addColumn<int>("countElements");
+        QTest::newRow("empty") << 0;
+        QTest::newRow("small") << 5;
+        QTest::newRow("large") << 500;
+    }
+    void cborRoundTrip()
+    {
+        QFETCH(int, countElements);
+        QByteArray xml = toXml(generateBlockData(countElements));
+        QVERIFY(!xml.isEmpty());
+
+        // XML -> CBOR
+        BlockData fromXml;
+        QBuffer xmlBuffer(&xml);
+        xmlBuffer.open(QIODevice::ReadOnly);
+        QVERIFY(BlockData::parseBlockDef(&xmlBuffer, &fromXml));
+        QByteArray cbor;
+        QBuffer cborOut(&cbor);
+        cborOut.open(QIODevice::WriteOnly);
+        QVERIFY(fromXml.exportBlockDefCbor(&cborOut));
+
+        // CBOR -> XML
+        BlockData fromCbor;
+        QBuffer cborIn(&cbor);
+        cborIn.open(QIODevice::ReadOnly);
+        QVERIFY(BlockData::parseBlockDefCbor(&cborIn, &fromCbor));
+        QCOMPARE(fromCbor.canonicalSerialization(), fromXml.canonicalSerialization());
+        QCOMPARE(toXml(fromCbor), xml);
+    }
+
+    void cborExportFails()
+    {
+        BlockData data = generateBlockData(5);
+
+        // closed device
+        QTest::ignoreMessage(QtWarningMsg, "BlockData::exportBlockDefCbor: device is not writable");
+        QBuffer closed;
+        QVERIFY(!data.exportBlockDefCbor(&closed));
+
+        // read only device
+        QByteArray content;
+        QBuffer readOnly(&content);
+        readOnly.open(QIODevice::ReadOnly);
+        QTest::ignoreMessage(QtWarningMsg, "BlockData::exportBlockDefCbor: device is not writable");
+        QVERIFY(!data.exportBlockDefCbor(&readOnly));
+        QVERIFY(content.isEmpty());
+    }
+
+    void cborArrayRoundTrip_data()
+    {
+        QTest::addColumn<QString>("elementType");
+        QTest::addColumn<double>("elementMinimum");
+        QTest::addColumn<double>("elementMaximum");
+        QTest::newRow("int") << "int" << -3.5 << 1000000.0;
+        QTest::newRow("double") << "double" << -0.1 << 1e300;
+        QTest::newRow("unlimited") << "double" << std::numeric_limits<double>::lowest() << std::numeric_limits<double>::max();
+    }
+    void cborArrayRoundTrip()
+    {
+        QFETCH(QString, elementType);
+        QFETCH(double, elementMinimum);
+        QFETCH(double, elementMaximum);
+
+        BlockParameterArray encoder("table");
+        BlockParameterArray::ElementType type;
+        QVERIFY(BlockParameterArray::elementTypeFromName(elementType, &type));
+        encoder.setElementType(type);
+        QVERIFY(encoder.setDefaultValues(QVector<double>() << 1 << -2 << 3));
+
+        BlockData data;
+        data.typeId = "ARRAY";
+        BlockParameterData param;
+        param.type = "array";
+        param.name = "table";
+        param.defaultValue = encoder.strDefaultValue();
+        param.elementType = elementType;
+        param.elementMinimum = elementMinimum;
+        param.elementMaximum = elementMaximum;
+        data.parameters.append(param);
+
+        // XML
+        QByteArray xml = toXml(data);
+        BlockData fromXml;
+        QBuffer xmlBuffer(&xml);
+        xmlBuffer.open(QIODevice::ReadOnly);
+        QVERIFY(BlockData::parseBlockDef(&xmlBuffer, &fromXml));
+        QCOMPARE(fromXml.parameters.size(), 1);
+        QCOMPARE(fromXml.parameters.at(0).elementType, elementType);
+        QCOMPARE(fromXml.parameters.at(0).elementMinimum, elementMinimum);
+        QCOMPARE(fromXml.parameters.at(0).elementMaximum, elementMaximum);
+        QCOMPARE(fromXml.parameters.at(0).defaultValue, param.defaultValue);
+
+        // CBOR
+        QByteArray cbor;
+        QBuffer cborOut(&cbor);
+        cborOut.open(QIODevice::WriteOnly);
+        QVERIFY(fromXml.exportBlockDefCbor(&cborOut));
+        BlockData fromCbor;
+        QBuffer cborIn(&cbor);
+        cborIn.open(QIODevice::ReadOnly);
+        QVERIFY(BlockData::parseBlockDefCbor(&cborIn, &fromCbor));
+        QCOMPARE(fromCbor.parameters.size(), 1);
+        QVERIFY(fromCbor.parameters.at(0) == fromXml.parameters.at(0));
+    }
+
+    // ---- Array Parameter ----
+
+    void arrayEncoding_data()
+    {
+        QTest::addColumn<int>("elementType");
+        QTest::addColumn<QVector<double> >("values");
+        QTest::newRow("int empty") << (int) BlockParameterArray::Int << QVector<double>();
+        QTest::newRow("int") << (int) BlockParameterArray::Int << (QVector<double>() << 1 << -1 << INT_MAX << INT_MIN);
+        QTest::newRow("double") << (int) BlockParameterArray::Double << (QVector<double>() << 0.1 << -1e-300 << 1e300);
+    }
+    void arrayEncoding()
+    {
+        QFETCH(int, elementType);
+        QFETCH(QVector<double>, values);
+
+        BlockParameterArray param("a");
+        param.setElementType((BlockParameterArray::ElementType) elementType);
+        QVERIFY(param.setValues(values));
+
+        BlockParameterArray decoded("b");
+        decoded.setElementType((BlockParameterArray::ElementType) elementType);
+        QVERIFY(decoded.setValue(param.strValue()));
+        QCOMPARE(decoded.values(), values);
+        QCOMPARE(decoded.count(), values.size());
+    }
+
+    void arrayEncodingFormat()
+    {
+        // little endian elements
+        BlockParameterArray param("a");
+        param.setElementType(BlockParameterArray::Int);
+        QVERIFY(param.setValues(QVector<double>() << 1));
+        QCOMPARE(param.strValue(), QString("AQAAAA=="));
+
+        // the encoding must contain whole elements
+        QVERIFY(!param.setValue("AQAA"));
+        QCOMPARE(param.values(), QVector<double>() << 1);
+    }
+
+    void arrayClipping()
+    {
+        // int elements are clipped to the integers within the range
+        BlockParameterArray intParam("i");
+        intParam.setElementType(BlockParameterArray::Int);
+        intParam.setRange(-1.5, 2.5);
+        QVERIFY(!intParam.setValues(QVector<double>() << -5 << 0.4 << 3));
+        QCOMPARE(intParam.values(), QVector<double>() << -1 << 0 << 2);
+        QVERIFY(intParam.setValues(QVector<double>() << -1 << 2));
+
+        // double elements
+        BlockParameterArray doubleParam("d");
+        doubleParam.setRange(0, 1);
+        QVERIFY(!doubleParam.setValues(QVector<double>() << -1 << 0.5 << 2));
+        QCOMPARE(doubleParam.values(), QVector<double>() << 0 << 0.5 << 1);
+
+        // existing elements are clipped against the new range
+        doubleParam.setRange(0.75, 0.8);
+        QCOMPARE(doubleParam.values(), QVector<double>() << 0.75 << 0.75 << 0.8);
+    }
+
+    void arrayNanIsMinimum()
+    {
+        double nan = std::numeric_limits<double>::quiet_NaN();
+
+        BlockParameterArray doubleParam("d");
+        doubleParam.setRange(-2, 5);
+        QVERIFY(!doubleParam.setValues(QVector<double>() << nan << 1));
+        QCOMPARE(doubleParam.values(), QVector<double>() << -2 << 1);
+
+        BlockParameterArray intParam("i");
+        intParam.setElementType(BlockParameterArray::Int);
+        intParam.setRange(-2, 5);
+        QVERIFY(!intParam.setValues(QVector<double>() << nan << 1));
+        QCOMPARE(intParam.values(), QVector<double>() << -2 << 1);
+    }
+
+    // ---- Library Pack ----
+
+    void packRoundTrip()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString libPath = dir.path() + "/lib";
+        QString packPath = dir.path() + "/test.bdpack";
+
+        // two block definitions and a file that is not packed
+        BlockGenerator generator;
+        generator.setParameterCount(3, 3);
+        QByteArray xml0 = toXml(generator.generateBlock(0));
+        QByteArray xml1 = toXml(generator.generateBlock(1));
+        QVERIFY(writeFile(libPath + "/block0.xml", xml0));
+        QVERIFY(writeFile(libPath + "/sub/block1.xml", xml1));
+        QVERIFY(writeFile(libPath + "/invalid.xml", "<NoBlockDef/>"));
+        QVERIFY(BlockLibraryPack::create(packPath, libPath));
+
+        // directory
+        BlockLibraryPack pack;
+        QVERIFY(pack.open(packPath));
+        QList<BlockLibraryIndex::Entry> entries = pack.entries();
+        QCOMPARE(entries.size(), 2);
+        QStringList filePaths;
+        for (int i=0; i < entries.size(); ++i) filePaths << entries.at(i).filePath;
+        filePaths.sort();
+        QCOMPARE(filePaths, QStringList() << "block0.xml" << "sub/block1.xml");
+
+        // block definitions
+        QCOMPARE(pack.blockDef("block0.xml"), xml0);
+        QCOMPARE(pack.blockDef("sub/block1.xml"), xml1);
+        QCOMPARE(pack.blockDefByTypeId("gen.block1"), xml1);
+        QCOMPARE(qUncompress(pack.compressedBlockDef("block0.xml")), xml0);
+        QVERIFY(pack.blockDef("invalid.xml").isEmpty());
+        QVERIFY(pack.blockDefByTypeId("gen.block2").isEmpty());
+
+        // paths into the pack
+        QIODevice *dev = BlockLibraryPack::openBlockDef(packPath + "/sub/block1.xml");
+        QVERIFY(dev != Q_NULLPTR);
+        QCOMPARE(dev->readAll(), xml1);
+        delete dev;
+        QVERIFY(BlockLibraryPack::openBlockDef(packPath + "/missing.xml") == Q_NULLPTR);
+    }
+
+    void packOpenFails_data()
+    {
+        QTest::addColumn<int>("truncatedSize");
+        QTest::addColumn<QString>("message");
+        QTest::newRow("empty") << 0 << "unsupported";
+        QTest::newRow("header") << 6 << "unsupported";
+        QTest::newRow("count") << 10 << "corrupt";
+        QTest::newRow("directory") << 20 << "corrupt";
+    }
+    void packOpenFails()
+    {
+        QFETCH(int, truncatedSize);
+        QFETCH(QString, message);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString packPath = dir.path() + "/test.bdpack";
+        QVERIFY(writeFile(dir.path() + "/lib/block0.xml", toXml(generateBlockData(3))));
+        QVERIFY(BlockLibraryPack::create(packPath, dir.path() + "/lib"));
+
+        // cut the pack within its header or directory
+        QByteArray content = readFile(packPath);
+        QVERIFY(content.size() > truncatedSize);
+        QVERIFY(writeFile(packPath, content.left(truncatedSize)));
+
+        BlockLibraryPack pack;
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression("^BlockLibraryPack: " + message + " pack file"));
+        QVERIFY(!pack.open(packPath));
+        QVERIFY(!pack.isOpen());
+        QVERIFY(pack.entries().isEmpty());
+        QVERIFY(pack.blockDefByTypeId("gen.block0").isEmpty());
+    }
+
+    void packOpenFailsOnWrongMagic()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString packPath = dir.path() + "/test.bdpack";
+        QVERIFY(writeFile(packPath, "<BlockDef version=\"1\"/>"));
+
+        BlockLibraryPack pack;
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression("^BlockLibraryPack: unsupported pack file"));
+        QVERIFY(!pack.open(packPath));
+        QVERIFY(!pack.isOpen());
+    }
+
+    // ---- Journal ----
+
+    void journalUndoRedo()
+    {
+        QScopedPointer<Block> block(createExpressionBlock(QStringList() << "a" << "b", QStringList() << "" << ""));
+        BlockJournal journal(block.data());
+        journal.setMergeInterval(0);
+        QByteArray initial = block->snapshot().canonicalSerialization();
+
+        intParameter(block.data(), "a")->setValue(5);
+        intParameter(block.data(), "a")->setName("x");
+        block->setInstanceName("Renamed");
+        QByteArray changed = block->snapshot().canonicalSerialization();
+        QCOMPARE(journal.undoText(), QString("change block"));
+
+        // only the recorded fields are reverted
+        journal.undo();
+        journal.undo();
+        QCOMPARE(block->getParameters().at(0)->name(), QString("a"));
+        QCOMPARE(intParameter(block.data(), "a")->value(), 5);
+        journal.undo();
+        QVERIFY(!journal.canUndo());
+        QCOMPARE(block->snapshot().canonicalSerialization(), initial);
+
+        while (journal.canRedo()) journal.redo();
+        QCOMPARE(block->snapshot().canonicalSerialization(), changed);
+        QCOMPARE(block->instanceName(), QString("Renamed"));
+        QCOMPARE(intParameter(block.data(), "x")->value(), 5);
+    }
+
+    void journalMerge()
+    {
+        QScopedPointer<Block> block(createExpressionBlock(QStringList() << "a" << "b", QStringList() << "" << ""));
+        BlockJournal journal(block.data());
+        journal.setMergeInterval(60000);
+        BlockParameterInt *a = intParameter(block.data(), "a");
+
+        // changes of the same parameter within the interval are one step (also of different fields)
+        a->setValue(1);
+        a->setValue(2);
+        a->setName("x");
+        journal.undo();
+        QVERIFY(!journal.canUndo());
+        QCOMPARE(a->value(), 0);
+        QCOMPARE(a->name(), QString("a"));
+
+        // changes of another parameter are not merged
+        journal.redo();
+        intParameter(block.data(), "b")->setValue(3);
+        journal.undo();
+        QCOMPARE(intParameter(block.data(), "b")->value(), 0);
+        QCOMPARE(a->value(), 2);
+
+        // no merging outside the interval
+        journal.setMergeInterval(0);
+        a->setValue(4);
+        a->setValue(5);
+        journal.undo();
+        QCOMPARE(a->value(), 4);
+    }
+
+    void journalMacro()
+    {
+        QScopedPointer<Block> block(createExpressionBlock(QStringList() << "a" << "b", QStringList() << "" << ""));
+        BlockJournal journal(block.data());
+        journal.setMergeInterval(0);
+
+        // the outermost macro defines the step
+        journal.beginMacro("edit");
+        intParameter(block.data(), "a")->setValue(1);
+        journal.beginMacro("inner");
+        intParameter(block.data(), "b")->setValue(2);
+        journal.endMacro();
+        QVERIFY(!journal.canUndo());
+        journal.endMacro();
+        QCOMPARE(journal.undoText(), QString("edit"));
+
+        journal.undo();
+        QVERIFY(!journal.canUndo());
+        QCOMPARE(intParameter(block.data(), "a")->value(), 0);
+        QCOMPARE(intParameter(block.data(), "b")->value(), 0);
+        journal.redo();
+        QCOMPARE(intParameter(block.data(), "a")->value(), 1);
+        QCOMPARE(intParameter(block.data(), "b")->value(), 2);
+    }
+
+    void journalMemoryBudget()
+    {
+        QScopedPointer<Block> block(createExpressionBlock(QStringList() << "a" << "b", QStringList() << "" << ""));
+        BlockJournal journal(block.data());
+        journal.setMergeInterval(0);
+
+        // the oldest steps are dropped, the last step is kept
+        for (int i=1; i <= 100; ++i) intParameter(block.data(), "a")->setValue(i);
+        QVERIFY(journal.memoryUsage() > 0);
+        journal.setMemoryBudget(1);
+        journal.undo();
+        QVERIFY(!journal.canUndo());
+        QCOMPARE(intParameter(block.data(), "a")->value(), 99);
+
+        // a step that grows by merging drops older steps too
+        journal.clear();
+        journal.setMergeInterval(60000);
+        intParameter(block.data(), "a")->setValue(1);
+        intParameter(block.data(), "b")->setValue(1);
+        journal.setMemoryBudget(journal.memoryUsage());
+        intParameter(block.data(), "b")->setName(QString(1000, 'b'));
+        journal.undo();
+        QVERIFY(!journal.canUndo());
+        QCOMPARE(block->getParameters().at(1)->name(), QString("b"));
+        QCOMPARE(intParameter(block.data(), "a")->value(), 1);
+    }
+
+    // ---- Expressions ----
+
+    void expressionEvaluate_data()
+    {
+        QTest::addColumn<QString>("source");
+        QTest::addColumn<double>("result");
+        QTest::newRow("precedence") << "1 + 2 * 3" << 7.0;
+        QTest::newRow("parentheses") << "(1 + 2) * 3" << 9.0;
+        QTest::newRow("power right associative") << "2 ^ 3 ^ 2" << 512.0;
+        QTest::newRow("unary") << "-(1 + 2) + +4" << 1.0;
+        QTest::newRow("modulo") << "7 % 4" << 3.0;
+        QTest::newRow("exponent") << "1.5e2" << 150.0;
+        QTest::newRow("functions") << "min(3, 1, 2) + max(4, 5) + abs(-2) + round(1.5) + floor(1.7) + ceil(1.2)" << 13.0;
+        QTest::newRow("references") << "rate + {buffer size} * B1.rate + rate" << 8.0;
+    }
+    void expressionEvaluate()
+    {
+        QFETCH(QString, source);
+        QFETCH(double, result);
+        QString error;
+        BlockExpression expr = BlockExpression::compile(source, &error);
+        QVERIFY2(expr.isValid(), qPrintable(error));
+
+        // values of the references "rate", "buffer size", "B1.rate"
+        const double values[] = {1, 2, 3};
+        QVERIFY(expr.references().size() <= 3);
+        QCOMPARE(expr.evaluate(values), result);
+    }
+
+    void expressionReferences()
+    {
+        BlockExpression expr = BlockExpression::compile("rate + {buffer size} * B1.rate + rate + {B 1}.{x}");
+        QVERIFY(expr.isValid());
+        QCOMPARE(expr.references(), QStringList() << "rate" << "buffer size" << "B1.rate" << "B 1.x");
+    }
+
+    void expressionSyntaxErrors_data()
+    {
+        QTest::addColumn<QString>("source");
+        QTest::newRow("empty") << "";
+        QTest::newRow("missing operand") << "1 +";
+        QTest::newRow("missing parenthesis") << "(1 + 2";
+        QTest::newRow("missing brace") << "{buffer size";
+        QTest::newRow("unknown function") << "sqrt(4)";
+        QTest::newRow("argument count") << "abs(1, 2)";
+        QTest::newRow("trailing tokens") << "1 2";
+    }
+    void expressionSyntaxErrors()
+    {
+        QFETCH(QString, source);
+        QString error;
+        BlockExpression expr = BlockExpression::compile(source, &error);
+        QVERIFY(!expr.isValid());
+        QVERIFY(!error.isEmpty());
+        QVERIFY(qIsNaN(expr.evaluate(Q_NULLPTR)));
+    }
+
+    void expressionConstantFolding_data()
+    {
+        QTest::addColumn<QString>("source");
+        QTest::addColumn<int>("countInstructions");
+        QTest::newRow("constants") << "1 + 2 * 3" << 1;
+        QTest::newRow("functions") << "max(1, 2, min(3, 4)) ^ 2" << 1;
+        QTest::newRow("negation") << "-(2 * 3)" << 1;
+        QTest::newRow("constant operand") << "a + 2 * 3" << 3;
+        QTest::newRow("reference only") << "a" << 1;
+    }
+    void expressionConstantFolding()
+    {
+        QFETCH(QString, source);
+        QFETCH(int, countInstructions);
+        BlockExpression expr = BlockExpression::compile(source);
+        QVERIFY(expr.isValid());
+        QCOMPARE(expr.countInstructions(), countInstructions);
+    }
+
+    void graphPropagationOrder()
+    {
+        // diamond: d must be evaluated after b and c
+        QScopedPointer<Block> block(createExpressionBlock(QStringList() << "d" << "c" << "b" << "a",
+                                                          QStringList() << "b + c" << "a * 2" << "a + 1" << ""));
+        BlockExpressionGraph graph;
+        graph.addBlock(block.data());
+        graph.recomputeAll();
+        QCOMPARE(intParameter(block.data(), "d")->value(), 1);
+
+        qint64 countEvaluations = graph.countEvaluations();
+        intParameter(block.data(), "a")->setValue(5);
+        QCOMPARE(intParameter(block.data(), "b")->value(), 6);
+        QCOMPARE(intParameter(block.data(), "c")->value(), 10);
+        QCOMPARE(intParameter(block.data(), "d")->value(), 16);
+
+        // every dependent is evaluated exactly once
+        QCOMPARE(graph.countEvaluations() - countEvaluations, (qint64) 3);
+    }
+
+    void graphCycles()
+    {
+        QScopedPointer<Block> block(createExpressionBlock(QStringList() << "a" << "b" << "c" << "d" << "e",
+                                                          QStringList() << "b + 1" << "a + 1" << "a + 1" << "d + 1" << "5"));
+        BlockExpressionGraph graph;
+        graph.addBlock(block.data());
+        graph.recomputeAll();
+
+        // the cycle and everything depending on it keep their values
+        QCOMPARE(graph.errorString(block->getParameter("a")), QString("cyclic dependency"));
+        QCOMPARE(graph.errorString(block->getParameter("b")), QString("cyclic dependency"));
+        QCOMPARE(graph.errorString(block->getParameter("c")), QString("cyclic dependency"));
+        QCOMPARE(graph.errorString(block->getParameter("d")), QString("cyclic dependency"));
+        QCOMPARE(intParameter(block.data(), "c")->value(), 0);
+
+        // independent expressions are evaluated
+        QVERIFY(graph.errorString(block->getParameter("e")).isEmpty());
+        QCOMPARE(intParameter(block.data(), "e")->value(), 5);
+    }
+
+    void graphJournalUndo()
+    {
+        QScopedPointer<Block> block(createExpressionBlock(QStringList() << "a" << "b",
+                                                          QStringList() << "" << "a * 2"));
+        BlockExpressionGraph graph;
+        graph.addBlock(block.data());
+        graph.recomputeAll();
+        BlockJournal journal(block.data());
+        journal.setMergeInterval(0);
+
+        // the evaluated value is not an own step
+        intParameter(block.data(), "a")->setValue(5);
+        QCOMPARE(intParameter(block.data(), "b")->value(), 10);
+        QCOMPARE(journal.undoText(), QString("change parameter a"));
+
+        // undoing the edit evaluates the expression again
+        journal.undo();
+        QCOMPARE(intParameter(block.data(), "a")->value(), 0);
+        QCOMPARE(intParameter(block.data(), "b")->value(), 0);
+        QVERIFY(!journal.canUndo());
+
+        journal.redo();
+        QCOMPARE(intParameter(block.data(), "a")->value(), 5);
+        QCOMPARE(intParameter(block.data(), "b")->value(), 10);
+        QCOMPARE(journal.undoText(), QString("change parameter a"));
+    }
+
+    // ---- Batch Parameter Update ----
+
+    void batchUndoStep()
+    {
+        QStringList names, expressions;
+        for (int i=0; i < 1000; ++i) {
+            names << QString("param%1").arg(i);
+            expressions << QString();
+        }
+        QScopedPointer<Block> block(createExpressionBlock(names, expressions));
+        BlockJournal journal(block.data());
+        journal.setMergeInterval(0);
+        QSignalSpy spy(block.data(), SIGNAL(signalSomethingChanged(libblockdia::Block*)));
+
+        QVector<BlockParameterEdit> edits;
+        for (int i=0; i < names.size(); ++i) edits.append(BlockParameterEdit(block.data(), names.at(i), BlockParameterValue::fromInt(i + 1)));
+        QCOMPARE(Block::applyParameterValues(edits), 1000);
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(intParameter(block.data(), "param999")->value(), 1000);
+
+        // all edits are one step
+        QCOMPARE(journal.undoText(), QString("change parameters"));
+        journal.undo();
+        QVERIFY(!journal.canUndo());
+        for (int i=0; i < names.size(); ++i) QCOMPARE(intParameter(block.data(), names.at(i))->value(), 0);
+
+        journal.redo();
+        for (int i=0; i < names.size(); ++i) QCOMPARE(intParameter(block.data(), names.at(i))->value(), i + 1);
+    }
+
+    void batchPropagation()
+    {
+        QScopedPointer<Block> block(createExpressionBlock(QStringList() << "a" << "b" << "c",
+                                                          QStringList() << "" << "" << "a + b"));
+        BlockExpressionGraph graph;
+        graph.addBlock(block.data());
+        graph.recomputeAll();
+
+        // the dependent parameter is evaluated once for both edits
+        qint64 countEvaluations = graph.countEvaluations();
+        QVector<BlockParameterEdit> edits;
+        edits << BlockParameterEdit(block.data(), "a", BlockParameterValue::fromInt(1));
+        edits << BlockParameterEdit(block.data(), "b", BlockParameterValue::fromInt(2));
+        QCOMPARE(Block::applyParameterValues(edits), 2);
+        QCOMPARE(intParameter(block.data(), "c")->value(), 3);
+        QCOMPARE(graph.countEvaluations() - countEvaluations, (qint64) 1);
+    }
+
+    // ---- Enum Parameter ----
+
+    void enumAddItems()
+    {
+        BlockParameterEnum param("param");
+        QSignalSpy spy(&param, SIGNAL(somethingHasChanged()));
+
+        QStringList items;
+        for (int i=0; i < 10000; ++i) {
+            items << QString("item%1").arg(i);
+            QVERIFY(param.addEnumItem(items.last()));
+        }
+        QVERIFY(!param.addEnumItem("item0"));
+        QCOMPARE(spy.count(), items.size());
+        QCOMPARE(param.enumItems(), items);
+        QCOMPARE(param.indexOfEnumItem("item9999"), 9999);
+        QVERIFY(param.setValue("item42"));
+        QCOMPARE(param.valueIndex(), 42);
+    }
+
+    void enumAddItemToSharedItems()
+    {
+        // the items of other parameters do not change
+        BlockParameterEnum param1("param1");
+        BlockParameterEnum param2("param2");
+        param1.setEnumItems(QStringList() << "a" << "b");
+        param2.setEnumItems(QStringList() << "a" << "b");
+        QVERIFY(param1.addEnumItem("c"));
+        QCOMPARE(param1.enumItems(), QStringList() << "a" << "b" << "c");
+        QCOMPARE(param2.enumItems(), QStringList() << "a" << "b");
+        QCOMPARE(param2.indexOfEnumItem("c"), -1);
+    }
+
+    // ---- Trace ----
+
+    void traceClearAfterFullBuffer()
+    {
+        BlockTrace::clear();
+
+        // record until the buffer of this thread is full
+        int countRecorded = 0;
+        while (BlockTrace::countDroppedEvents() == 0 && countRecorded < (1 << 24)) {
+            BlockTrace::record("test", 0, 1);
+            ++countRecorded;
+        }
+        QCOMPARE(BlockTrace::countDroppedEvents(), 1);
+        QCOMPARE(BlockTrace::countEvents(), countRecorded - 1);
+
+        // recording starts over after clear()
+        BlockTrace::clear();
+        QCOMPARE(BlockTrace::countEvents(), 0);
+        BlockTrace::record("test", 0, 1);
+        QCOMPARE(BlockTrace::countEvents(), 1);
+        QCOMPARE(BlockTrace::countDroppedEvents(), 0);
+        BlockTrace::clear();
+    }
+
+    void traceFinishedThread()
+    {
+        BlockTrace::clear();
+
+        // the events of a finished thread are kept until clear()
+        QThread *thread = QThread::create([]() {
+            for (int i=0; i < 100; ++i) BlockTrace::record("test", i, i + 1);
+        });
+        thread->start();
+        QVERIFY(thread->wait(5000));
+        delete thread;
+        QCOMPARE(BlockTrace::countEvents(), 100);
+
+        QBuffer trace;
+        trace.open(QIODevice::WriteOnly);
+        QVERIFY(BlockTrace::writeChromeTrace(&trace));
+        QVERIFY(trace.data().contains("\"name\":\"test\""));
+
+        BlockTrace::clear();
+        QCOMPARE(BlockTrace::countEvents(), 0);
+    }
+};
+
+QTEST_MAIN(TestLibBlockDiaCore)
+#include "test_libblockdiacore.moc"
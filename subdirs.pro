@@ -1,13 +1,33 @@
 TEMPLATE = subdirs
 
-SUBDIRS = libblockdia \
+SUBDIRS = libblockdiacore \
+          libblockdia \
           test_bdviewblock \
-          blockeditor
+          test_libblockdiacore \
+          bench_libblockdia \
+          bench_libblockdiagui \
+          blockeditor \
+          blockdiatool
+
+libblockdiacore.subdir = src/libblockdiacore
 
 libblockdia.subdir = src/libblockdia
+libblockdia.depends = libblockdiacore
 
 test_bdviewblock.subdir = src/test_bdviewblock
-test_bdviewblock.depend = libblockdia
+test_bdviewblock.depends = libblockdia
+
+test_libblockdiacore.subdir = src/test_libblockdiacore
+test_libblockdiacore.depends = libblockdiacore
+
+bench_libblockdia.subdir = src/bench_libblockdia
+bench_libblockdia.depends = libblockdiacore
+
+bench_libblockdiagui.subdir = src/bench_libblockdiagui
+bench_libblockdiagui.depends = libblockdia
 
 blockeditor.subdir = src/blockeditor
-blockeditor.depend = libblockdia
+blockeditor.depends = libblockdia
+
+blockdiatool.subdir = src/blockdiatool
+blockdiatool.depends = libblockdia